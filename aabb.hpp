@@ -2,7 +2,14 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
 
 namespace okami {
     struct AABB {
@@ -96,4 +103,71 @@ namespace okami {
 		float dy = a.m_max.y - a.m_min.y;
 		return 2.0f * (dx + dy);
 	}
-}
\ No newline at end of file
+
+	inline float DistanceSquared(const AABB& a, const glm::vec3& point) {
+		auto d = glm::max(glm::max(a.m_min - point, point - a.m_max), glm::vec3(0.0f));
+		return glm::dot(d, d);
+	}
+
+	// Half-line from m_origin along m_direction. Hit distances are measured
+	// in multiples of m_direction, so normalize it to get world units.
+	struct Ray {
+		glm::vec3 m_origin;
+		glm::vec3 m_direction;
+
+		inline glm::vec3 At(float t) const {
+			return m_origin + m_direction * t;
+		}
+	};
+
+	// Slab test against a ray given by its origin and 1 / direction (computed
+	// once per ray; infinities for zero components are fine). Returns the
+	// entry distance, clamped to 0 for rays starting inside, or a negative
+	// value if the box is missed or lies beyond tMax.
+	inline float IntersectRay(const AABB& a, const glm::vec3& origin, const glm::vec3& invDirection, float tMax) {
+		auto t0 = (a.m_min - origin) * invDirection;
+		auto t1 = (a.m_max - origin) * invDirection;
+		auto tNear = glm::min(t0, t1);
+		auto tFar = glm::max(t0, t1);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+		return enter <= exit ? enter : -1.0f;
+	}
+
+	// Six inward-facing planes (xyz = normal, w = offset), so a point p is
+	// inside when dot(plane.xyz, p) + plane.w >= 0 for every plane.
+	struct Frustum {
+		std::array<glm::vec4, 6> m_planes;
+
+		// Extracts the planes of an OpenGL-style (-1..1 depth) clip matrix,
+		// e.g. projection * view for a world-space frustum.
+		static inline Frustum FromMatrix(const glm::mat4& m) {
+			auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+			Frustum f{ {
+				row(3) + row(0), row(3) - row(0),
+				row(3) + row(1), row(3) - row(1),
+				row(3) + row(2), row(3) - row(2),
+			} };
+			for (auto& plane : f.m_planes) {
+				plane /= glm::length(glm::vec3(plane));
+			}
+			return f;
+		}
+	};
+
+	// Conservative: boxes near frustum corners may pass without intersecting
+	inline bool Intersects(const Frustum& f, const AABB& a) {
+		for (auto const& plane : f.m_planes) {
+			// Box corner furthest along the plane normal
+			glm::vec3 positive{
+				plane.x >= 0.0f ? a.m_max.x : a.m_min.x,
+				plane.y >= 0.0f ? a.m_max.y : a.m_min.y,
+				plane.z >= 0.0f ? a.m_max.z : a.m_min.z,
+			};
+			if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
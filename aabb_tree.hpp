@@ -3,9 +3,23 @@
 #include <glm/vec3.hpp>
 #include <glm/common.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <future>
 #include <queue>
+#include <span>
+#include <vector>
 #include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define OKAMI_AABB_TREE_SSE 1
+#endif
 
 #include "pool.hpp"
 #include "aabb.hpp"
@@ -26,6 +40,262 @@ namespace okami {
 		}
 	};
 
+	// Read-only copy of an AABBTree laid out in depth-first order. Each node
+	// stores where traversal continues when its subtree is skipped, so walks
+	// need no stack and read the node array front to back. Nothing mutates
+	// it after Flatten(), so any number of threads may query it at once.
+	template <typename LeafData, typename AABBType = AABB>
+	class FlatAABBTree {
+	public:
+		struct Node {
+			AABBType m_aabb;
+			// Index of the first node after this subtree
+			uint32_t m_skip = 0;
+			// Index into the leaf data, or kInvalidNodeIndex for inner nodes
+			int m_leaf = kInvalidNodeIndex;
+		};
+
+		// Walks every node for which enter(aabb) returns true and calls
+		// leaf(data, aabb) on the leaves among them. enter is re-evaluated per
+		// node, so it may tighten as leaves are found (e.g. a closest hit).
+		template <typename EnterFn, typename LeafFn>
+		void Traverse(EnterFn&& enter, LeafFn&& leaf) const {
+			uint32_t i = 0;
+			auto const count = static_cast<uint32_t>(m_nodes.size());
+			while (i < count) {
+				auto const& node = m_nodes[i];
+				if (!enter(node.m_aabb)) {
+					i = node.m_skip;
+					continue;
+				}
+				if (node.m_leaf != kInvalidNodeIndex) {
+					leaf(m_leaves[node.m_leaf], node.m_aabb);
+				}
+				++i;
+			}
+		}
+
+		// Calls fn(data) for every leaf whose box intersects aabb.
+		template <typename Fn>
+		void Query(const AABBType& aabb, Fn&& fn) const {
+			Traverse(
+				[&aabb](const AABBType& box) { return Intersects(box, aabb); },
+				[&fn](LeafData const& data, const AABBType&) { fn(data); });
+		}
+
+		inline std::span<Node const> GetNodes() const { return m_nodes; }
+		inline std::span<LeafData const> GetLeaves() const { return m_leaves; }
+		inline bool IsEmpty() const { return m_nodes.empty(); }
+
+	private:
+		std::vector<Node> m_nodes;
+		std::vector<LeafData> m_leaves;
+
+		template <typename, typename, typename>
+		friend class AABBTree;
+	};
+
+	// Read-only 4-wide tree collapsed from an AABBTree, for static scenes.
+	// Each node stores its children's boxes as structure-of-arrays, so one
+	// node is tested against a query with a handful of SSE instructions
+	// (scalar elsewhere). Nodes are in depth-first order: a node's first
+	// inner child directly follows it. Like FlatAABBTree, it is immutable
+	// and safe to query from any number of threads.
+	template <typename LeafData>
+	class WideAABBTree {
+	public:
+		static constexpr int kWidth = 4;
+
+		struct alignas(16) Node {
+			float m_minX[kWidth];
+			float m_minY[kWidth];
+			float m_minZ[kWidth];
+			float m_maxX[kWidth];
+			float m_maxY[kWidth];
+			float m_maxZ[kWidth];
+			// Index of an inner node if >= 0, else ~index into the leaf data
+			int32_t m_children[kWidth];
+			uint32_t m_count = 0;
+		};
+
+		// Calls fn(data) for every leaf whose box intersects aabb.
+		template <typename Fn>
+		void Query(const AABB& aabb, Fn&& fn) const {
+			if (m_nodes.empty()) {
+				return;
+			}
+			std::vector<int32_t> stack;
+			stack.reserve(64);
+			stack.push_back(0);
+			while (!stack.empty()) {
+				auto const& node = m_nodes[stack.back()];
+				stack.pop_back();
+
+				// Push in reverse so children are visited in memory order
+				auto mask = OverlapMask(node, aabb);
+				for (int i = kWidth - 1; i >= 0; --i) {
+					if (!(mask & (1u << i))) {
+						continue;
+					}
+					auto child = node.m_children[i];
+					if (child >= 0) {
+						stack.push_back(child);
+					}
+					else {
+						fn(m_leaves[~child]);
+					}
+				}
+			}
+		}
+
+		// Visits leaves whose box the ray enters before tMax, calling
+		// fn(data, tEnter) which returns the new tMax; return tEnter to keep
+		// only the closest hit, or tMax to see every hit. invDirection is
+		// 1 / direction, as for IntersectRay.
+		template <typename Fn>
+		void Raycast(const glm::vec3& origin, const glm::vec3& invDirection, float tMax, Fn&& fn) const {
+			if (m_nodes.empty()) {
+				return;
+			}
+			std::vector<int32_t> stack;
+			stack.reserve(64);
+			stack.push_back(0);
+			alignas(16) float tEnter[kWidth];
+			while (!stack.empty()) {
+				auto const& node = m_nodes[stack.back()];
+				stack.pop_back();
+
+				auto mask = RayMask(node, origin, invDirection, tMax, tEnter);
+				while (mask) {
+					auto i = std::countr_zero(mask);
+					mask &= mask - 1;
+					auto child = node.m_children[i];
+					if (child >= 0) {
+						stack.push_back(child);
+					}
+					else if (tEnter[i] <= tMax) {
+						tMax = fn(m_leaves[~child], tEnter[i]);
+					}
+				}
+			}
+		}
+
+		// As FlatAABBTree::Traverse, for tests with no SIMD path (frusta,
+		// distances). Children are tested one box at a time, and an inner
+		// child's box is tested again when it is popped, so enter may tighten
+		// as leaves are found.
+		template <typename EnterFn, typename LeafFn>
+		void Traverse(EnterFn&& enter, LeafFn&& leaf) const {
+			if (m_nodes.empty()) {
+				return;
+			}
+			std::vector<std::pair<int32_t, AABB>> stack;
+			stack.reserve(64);
+			auto visit = [&](Node const& node) {
+				// Push in reverse so children are visited in memory order
+				for (int i = static_cast<int>(node.m_count) - 1; i >= 0; --i) {
+					AABB box{
+						glm::vec3(node.m_minX[i], node.m_minY[i], node.m_minZ[i]),
+						glm::vec3(node.m_maxX[i], node.m_maxY[i], node.m_maxZ[i]),
+					};
+					if (!enter(box)) {
+						continue;
+					}
+					auto child = node.m_children[i];
+					if (child >= 0) {
+						stack.emplace_back(child, box);
+					}
+					else {
+						leaf(m_leaves[~child], box);
+					}
+				}
+			};
+
+			visit(m_nodes[0]);
+			while (!stack.empty()) {
+				auto [index, box] = stack.back();
+				stack.pop_back();
+				if (enter(box)) {
+					visit(m_nodes[index]);
+				}
+			}
+		}
+
+		inline std::span<Node const> GetNodes() const { return m_nodes; }
+		inline std::span<LeafData const> GetLeaves() const { return m_leaves; }
+		inline bool IsEmpty() const { return m_nodes.empty(); }
+
+	private:
+		std::vector<Node> m_nodes;
+		std::vector<LeafData> m_leaves;
+
+		static inline uint32_t ValidMask(const Node& node) {
+			return (1u << node.m_count) - 1u;
+		}
+
+		static inline uint32_t OverlapMask(const Node& node, const AABB& aabb) {
+#ifdef OKAMI_AABB_TREE_SSE
+			auto hit = _mm_and_ps(
+				_mm_and_ps(
+					_mm_cmple_ps(_mm_load_ps(node.m_minX), _mm_set1_ps(aabb.m_max.x)),
+					_mm_cmpge_ps(_mm_load_ps(node.m_maxX), _mm_set1_ps(aabb.m_min.x))),
+				_mm_and_ps(
+					_mm_and_ps(
+						_mm_cmple_ps(_mm_load_ps(node.m_minY), _mm_set1_ps(aabb.m_max.y)),
+						_mm_cmpge_ps(_mm_load_ps(node.m_maxY), _mm_set1_ps(aabb.m_min.y))),
+					_mm_and_ps(
+						_mm_cmple_ps(_mm_load_ps(node.m_minZ), _mm_set1_ps(aabb.m_max.z)),
+						_mm_cmpge_ps(_mm_load_ps(node.m_maxZ), _mm_set1_ps(aabb.m_min.z)))));
+			return static_cast<uint32_t>(_mm_movemask_ps(hit)) & ValidMask(node);
+#else
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < node.m_count; ++i) {
+				bool hit =
+					node.m_minX[i] <= aabb.m_max.x && node.m_maxX[i] >= aabb.m_min.x &&
+					node.m_minY[i] <= aabb.m_max.y && node.m_maxY[i] >= aabb.m_min.y &&
+					node.m_minZ[i] <= aabb.m_max.z && node.m_maxZ[i] >= aabb.m_min.z;
+				mask |= static_cast<uint32_t>(hit) << i;
+			}
+			return mask;
+#endif
+		}
+
+		// Slab test of all children at once, writing entry distances to tEnter
+		static inline uint32_t RayMask(const Node& node, const glm::vec3& origin, const glm::vec3& invDirection, float tMax, float* tEnter) {
+#ifdef OKAMI_AABB_TREE_SSE
+			auto slab = [](float const* mins, float const* maxs, float o, float inv, __m128& tNear, __m128& tFar) {
+				auto vo = _mm_set1_ps(o);
+				auto vinv = _mm_set1_ps(inv);
+				auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(mins), vo), vinv);
+				auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxs), vo), vinv);
+				tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+				tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+			};
+			auto tNear = _mm_setzero_ps();
+			auto tFar = _mm_set1_ps(tMax);
+			slab(node.m_minX, node.m_maxX, origin.x, invDirection.x, tNear, tFar);
+			slab(node.m_minY, node.m_maxY, origin.y, invDirection.y, tNear, tFar);
+			slab(node.m_minZ, node.m_maxZ, origin.z, invDirection.z, tNear, tFar);
+			_mm_store_ps(tEnter, tNear);
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) & ValidMask(node);
+#else
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < node.m_count; ++i) {
+				AABB box{
+					glm::vec3(node.m_minX[i], node.m_minY[i], node.m_minZ[i]),
+					glm::vec3(node.m_maxX[i], node.m_maxY[i], node.m_maxZ[i]),
+				};
+				tEnter[i] = IntersectRay(box, origin, invDirection, tMax);
+				mask |= static_cast<uint32_t>(tEnter[i] >= 0.0f) << i;
+			}
+			return mask;
+#endif
+		}
+
+		template <typename, typename, typename>
+		friend class AABBTree;
+	};
+
 	struct DefaultCostFunction {
 		template <typename AABBType>
 		inline float operator()(const AABBType& aabb) const {
@@ -129,6 +399,212 @@ namespace okami {
 			}
 		}
 
+		static constexpr int kBuildBins = 16;
+		// Ranges smaller than this are built on the calling thread
+		static constexpr size_t kParallelBuildThreshold = 4096;
+		static constexpr int kMaxParallelBuildDepth = 3;
+
+		struct BuildState {
+			using Vec = decltype(AABBType{}.m_min);
+
+			std::span<AABBType const> m_aabbs;
+			std::span<LeafData const> m_datas;
+			std::vector<Vec> m_centroids;
+			std::vector<uint32_t> m_indices;
+			std::vector<AABBNode<LeafData, AABBType>> m_nodes;
+		};
+
+		// Partitions indices[begin, end) at the cheapest of kBuildBins
+		// centroid splits along each axis and returns the split point.
+		// Falls back to the middle when every centroid is the same.
+		static size_t PartitionSAH(BuildState& state, size_t begin, size_t end) {
+			if (end - begin == 2) {
+				return begin + 1;
+			}
+
+			using Vec = typename BuildState::Vec;
+			constexpr int kDims = static_cast<int>(Vec::length());
+
+			auto centroid = [&](uint32_t i) -> Vec const& { return state.m_centroids[i]; };
+			Vec cmin = centroid(state.m_indices[begin]);
+			Vec cmax = cmin;
+			for (size_t i = begin + 1; i < end; ++i) {
+				auto c = centroid(state.m_indices[i]);
+				cmin = glm::min(cmin, c);
+				cmax = glm::max(cmax, c);
+			}
+
+			struct Bin {
+				AABBType m_aabb;
+				uint32_t m_count = 0;
+			};
+
+			float bestCost = std::numeric_limits<float>::max();
+			int bestAxis = -1;
+			int bestSplit = 0;
+			for (int axis = 0; axis < kDims; ++axis) {
+				float extent = cmax[axis] - cmin[axis];
+				if (extent <= 0.0f) {
+					continue;
+				}
+				float scale = kBuildBins / extent;
+
+				std::array<Bin, kBuildBins> bins{};
+				for (size_t i = begin; i < end; ++i) {
+					auto index = state.m_indices[i];
+					int b = std::min(static_cast<int>((centroid(index)[axis] - cmin[axis]) * scale), kBuildBins - 1);
+					auto& bin = bins[b];
+					bin.m_aabb = bin.m_count ? Union(bin.m_aabb, state.m_aabbs[index]) : state.m_aabbs[index];
+					++bin.m_count;
+				}
+
+				// Cost of everything right of each split, swept from the right
+				std::array<float, kBuildBins> rightCost{};
+				AABBType right{};
+				uint32_t rightCount = 0;
+				for (int b = kBuildBins - 1; b > 0; --b) {
+					if (bins[b].m_count) {
+						right = rightCount ? Union(right, bins[b].m_aabb) : bins[b].m_aabb;
+						rightCount += bins[b].m_count;
+					}
+					rightCost[b] = rightCount ? rightCount * CostFunction{}(right) : 0.0f;
+				}
+
+				AABBType left{};
+				uint32_t leftCount = 0;
+				for (int b = 0; b < kBuildBins - 1; ++b) {
+					if (bins[b].m_count) {
+						left = leftCount ? Union(left, bins[b].m_aabb) : bins[b].m_aabb;
+						leftCount += bins[b].m_count;
+					}
+					if (leftCount == 0 || leftCount == end - begin) {
+						continue;
+					}
+					float cost = leftCount * CostFunction{}(left) + rightCost[b + 1];
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = b + 1;
+					}
+				}
+			}
+
+			if (bestAxis < 0) {
+				return begin + (end - begin) / 2;
+			}
+
+			float scale = kBuildBins / (cmax[bestAxis] - cmin[bestAxis]);
+			auto mid = std::partition(
+				state.m_indices.begin() + begin,
+				state.m_indices.begin() + end,
+				[&](uint32_t index) {
+					int b = std::min(static_cast<int>((centroid(index)[bestAxis] - cmin[bestAxis]) * scale), kBuildBins - 1);
+					return b < bestSplit;
+				});
+			return static_cast<size_t>(mid - state.m_indices.begin());
+		}
+
+		// Builds the subtree over indices[begin, end) into the 2n - 1 nodes
+		// starting at nodeIndex, in pre-order
+		static void BuildRange(BuildState& state, size_t begin, size_t end, int nodeIndex, int parentIndex, int depth) {
+			auto& node = state.m_nodes[nodeIndex];
+			node.parent = parentIndex;
+
+			if (end - begin == 1) {
+				auto index = state.m_indices[begin];
+				node.aabb = state.m_aabbs[index];
+				node.data = state.m_datas[index];
+				return;
+			}
+
+			auto mid = PartitionSAH(state, begin, end);
+			auto leftCount = static_cast<int>(mid - begin);
+			node.left = nodeIndex + 1;
+			node.right = nodeIndex + 2 * leftCount;
+
+			if (end - begin >= kParallelBuildThreshold && depth < kMaxParallelBuildDepth) {
+				auto task = std::async(std::launch::async, [&] {
+					BuildRange(state, begin, mid, node.left, nodeIndex, depth + 1);
+				});
+				BuildRange(state, mid, end, node.right, nodeIndex, depth + 1);
+				task.get();
+			}
+			else {
+				BuildRange(state, begin, mid, node.left, nodeIndex, depth + 1);
+				BuildRange(state, mid, end, node.right, nodeIndex, depth + 1);
+			}
+			node.aabb = Union(state.m_nodes[node.left].aabb, state.m_nodes[node.right].aabb);
+		}
+
+		// Emits a wide node for the binary subtree at nodeIndex, and
+		// recursively its inner children right after it
+		void CollapseNode(int nodeIndex, WideAABBTree<LeafData>& wide) const {
+			constexpr int kWidth = WideAABBTree<LeafData>::kWidth;
+
+			// Open the largest inner child until the node is full
+			std::array<int, kWidth> children{};
+			int count = 0;
+			auto const& node = m_nodes[nodeIndex];
+			if (node.IsLeaf()) {
+				children[count++] = nodeIndex;
+			}
+			else {
+				children[count++] = node.left;
+				children[count++] = node.right;
+			}
+			while (count < kWidth) {
+				int best = -1;
+				float bestCost = -1.0f;
+				for (int i = 0; i < count; ++i) {
+					auto const& child = m_nodes[children[i]];
+					if (!child.IsLeaf() && CostFunction{}(child.aabb) > bestCost) {
+						bestCost = CostFunction{}(child.aabb);
+						best = i;
+					}
+				}
+				if (best < 0) {
+					break;
+				}
+				auto const& opened = m_nodes[children[best]];
+				children[best] = opened.left;
+				children[count++] = opened.right;
+			}
+
+			auto wideIndex = wide.m_nodes.size();
+			auto& wideNode = wide.m_nodes.emplace_back();
+			for (int i = 0; i < kWidth; ++i) {
+				// Unused slots hold empty boxes, so they also fail box tests
+				wideNode.m_minX[i] = wideNode.m_minY[i] = wideNode.m_minZ[i] = std::numeric_limits<float>::max();
+				wideNode.m_maxX[i] = wideNode.m_maxY[i] = wideNode.m_maxZ[i] = std::numeric_limits<float>::lowest();
+				wideNode.m_children[i] = 0;
+			}
+			wideNode.m_count = static_cast<uint32_t>(count);
+			for (int i = 0; i < count; ++i) {
+				auto const& aabb = m_nodes[children[i]].aabb;
+				wideNode.m_minX[i] = aabb.m_min.x;
+				wideNode.m_minY[i] = aabb.m_min.y;
+				wideNode.m_minZ[i] = aabb.m_min.z;
+				wideNode.m_maxX[i] = aabb.m_max.x;
+				wideNode.m_maxY[i] = aabb.m_max.y;
+				wideNode.m_maxZ[i] = aabb.m_max.z;
+			}
+
+			for (int i = 0; i < count; ++i) {
+				auto const& child = m_nodes[children[i]];
+				int32_t encoded;
+				if (child.IsLeaf()) {
+					encoded = ~static_cast<int32_t>(wide.m_leaves.size());
+					wide.m_leaves.push_back(child.data);
+				}
+				else {
+					encoded = static_cast<int32_t>(wide.m_nodes.size());
+					CollapseNode(children[i], wide);
+				}
+				// emplace_back above may have moved the node
+				wide.m_nodes[wideIndex].m_children[i] = encoded;
+			}
+		}
+
 	public:
 		bool Validate() const {
 			if (m_root == kInvalidNodeIndex) {
@@ -197,17 +673,36 @@ namespace okami {
 			return newNodeIndex;
 		}
 
+		// Top-down binned SAH build. Gives much better trees than inserting
+		// one by one, so use it for static geometry known up front; the
+		// result is still an ordinary dynamic tree afterwards. Nodes come out
+		// in depth-first order, and large subtrees are built in parallel.
 		static AABBTree Build(std::span<AABBType const> aabbs, std::span<LeafData const> datas) {
-			// TODO: Implement a bulk-build algorithm (e.g., top-down or bottom-up)
-			// For now, just insert one by one
 			if (aabbs.size() != datas.size()) {
 				throw std::invalid_argument("AABBs and datas size mismatch");
 			}
 
 			AABBTree tree;
+			if (aabbs.empty()) {
+				return tree;
+			}
+
+			// A subtree over n leaves always has 2n - 1 nodes, so every range
+			// knows up front where its nodes go and tasks never share a slot
+			BuildState state{ aabbs, datas };
+			state.m_indices.resize(aabbs.size());
+			state.m_centroids.resize(aabbs.size());
 			for (size_t i = 0; i < aabbs.size(); ++i) {
-				tree.Insert(aabbs[i], datas[i]);
+				state.m_indices[i] = static_cast<uint32_t>(i);
+				state.m_centroids[i] = (aabbs[i].m_min + aabbs[i].m_max) * 0.5f;
+			}
+			state.m_nodes.resize(2 * aabbs.size() - 1);
+			BuildRange(state, 0, aabbs.size(), 0, kInvalidNodeIndex, 0);
+
+			for (auto& node : state.m_nodes) {
+				tree.m_nodes[tree.m_nodes.Allocate()] = std::move(node);
 			}
+			tree.m_root = 0;
 			return tree;
 		}
 
@@ -303,6 +798,79 @@ namespace okami {
 			}
 		}
 
+		// Calls fn(data, leafIndex) for every leaf whose box intersects aabb.
+		template <typename Fn>
+		void Query(const AABBType& aabb, Fn&& fn) const {
+			if (m_root == kInvalidNodeIndex) {
+				return;
+			}
+
+			std::vector<int> stack;
+			stack.push_back(m_root);
+			while (!stack.empty()) {
+				int nodeIndex = stack.back();
+				stack.pop_back();
+
+				auto const& node = m_nodes[nodeIndex];
+				if (!Intersects(node.aabb, aabb)) {
+					continue;
+				}
+				if (node.IsLeaf()) {
+					fn(node.data, nodeIndex);
+				}
+				else {
+					stack.push_back(node.left);
+					stack.push_back(node.right);
+				}
+			}
+		}
+
+		FlatAABBTree<LeafData, AABBType> Flatten() const {
+			FlatAABBTree<LeafData, AABBType> flat;
+			if (m_root == kInvalidNodeIndex) {
+				return flat;
+			}
+
+			// Pre-order walk; a node's skip index is patched once its
+			// subtree has been emitted, i.e. when it is popped the second time
+			std::vector<std::pair<int, uint32_t>> stack;
+			stack.emplace_back(m_root, UINT32_MAX);
+			while (!stack.empty()) {
+				auto& [nodeIndex, flatIndex] = stack.back();
+				if (flatIndex != UINT32_MAX) {
+					flat.m_nodes[flatIndex].m_skip = static_cast<uint32_t>(flat.m_nodes.size());
+					stack.pop_back();
+					continue;
+				}
+
+				auto const& node = m_nodes[nodeIndex];
+				flatIndex = static_cast<uint32_t>(flat.m_nodes.size());
+				auto& flatNode = flat.m_nodes.emplace_back();
+				flatNode.m_aabb = node.aabb;
+				if (node.IsLeaf()) {
+					flatNode.m_leaf = static_cast<int>(flat.m_leaves.size());
+					flat.m_leaves.push_back(node.data);
+				}
+				else {
+					// Right is pushed first so left is emitted first
+					auto left = node.left;
+					auto right = node.right;
+					stack.emplace_back(right, UINT32_MAX);
+					stack.emplace_back(left, UINT32_MAX);
+				}
+			}
+			return flat;
+		}
+
+		// 4-wide copy of the tree for fast static queries (see WideAABBTree)
+		WideAABBTree<LeafData> Collapse() const requires std::is_same_v<AABBType, AABB> {
+			WideAABBTree<LeafData> wide;
+			if (m_root != kInvalidNodeIndex) {
+				CollapseNode(m_root, wide);
+			}
+			return wide;
+		}
+
 		void Clear() {
 			m_root = kInvalidNodeIndex;
 			m_nodes.Clear();
@@ -0,0 +1,91 @@
+#include "allocation_tracker.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace okami;
+
+thread_local AllocationCounters okami::detail::t_threadAllocations;
+
+#ifdef OKAMI_TRACK_ALLOCATIONS
+
+namespace {
+	std::atomic<uint64_t> g_totalCount{ 0 };
+	std::atomic<uint64_t> g_totalBytes{ 0 };
+
+	inline void CountAllocation(std::size_t size) {
+		auto& local = detail::t_threadAllocations;
+		local.m_count += 1;
+		local.m_bytes += size;
+		g_totalCount.fetch_add(1, std::memory_order_relaxed);
+		g_totalBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void* AlignedAllocate(std::size_t size, std::size_t alignment) {
+#ifdef _MSC_VER
+		return _aligned_malloc(size, alignment);
+#else
+		// aligned_alloc requires the size to be a multiple of the alignment
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+	}
+
+	void AlignedFree(void* ptr) {
+#ifdef _MSC_VER
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+AllocationCounters okami::GetTotalAllocations() {
+	return {
+		g_totalCount.load(std::memory_order_relaxed),
+		g_totalBytes.load(std::memory_order_relaxed),
+	};
+}
+
+// The array and nothrow forms forward to these in the standard libraries we
+// build against, so replacing the scalar and aligned forms covers them all.
+
+void* operator new(std::size_t size) {
+	CountAllocation(size);
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	CountAllocation(size);
+	if (void* ptr = AlignedAllocate(size ? size : 1, static_cast<std::size_t>(alignment))) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+	AlignedFree(ptr);
+}
+
+#else
+
+AllocationCounters okami::GetTotalAllocations() {
+	return {};
+}
+
+#endif
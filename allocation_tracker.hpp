@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace okami {
+	// Opt-in allocation accounting. Configure with -DOKAMI_TRACK_ALLOCATIONS=ON
+	// to replace the global operator new with a counting version; otherwise
+	// every counter reads zero and nothing is replaced.
+	//
+	// Counts only grow: they measure allocation traffic (calls and requested
+	// bytes), not live memory. Take differences to attribute them to a frame
+	// or scope; profiler scopes do this automatically.
+#ifdef OKAMI_TRACK_ALLOCATIONS
+	constexpr bool kAllocationTrackingEnabled = true;
+#else
+	constexpr bool kAllocationTrackingEnabled = false;
+#endif
+
+	struct AllocationCounters {
+		uint64_t m_count = 0;
+		uint64_t m_bytes = 0;
+
+		inline AllocationCounters operator-(AllocationCounters const& other) const {
+			return { m_count - other.m_count, m_bytes - other.m_bytes };
+		}
+	};
+
+	namespace detail {
+		extern thread_local AllocationCounters t_threadAllocations;
+	}
+
+	// Allocations made by the calling thread. A thread-local read, cheap
+	// enough for per-scope use.
+	inline AllocationCounters GetThreadAllocations() {
+		if constexpr (kAllocationTrackingEnabled) {
+			return detail::t_threadAllocations;
+		} else {
+			return {};
+		}
+	}
+
+	// Allocations made by every thread.
+	AllocationCounters GetTotalAllocations();
+}
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <memory_resource>
 #include <unordered_map>
 
 using namespace okami;
@@ -17,7 +18,8 @@ using namespace okami;
 // Each frame, for every entity with SkeletonComponent + SkeletonStateComponent:
 //   1. Advance playback time.
 //   2. Run SamplingJob (using the per-entity context cache stored in this module).
-//   3. Run LocalToModelJob to produce model-space matrices.
+//   3. Run LocalToModelJob to produce model-space matrices. The local-space
+//      transforms in between live in the job's frame arena.
 //   4. Send UpdateComponentSignal<SkeletonStateComponent> so the registry is
 //      updated during the frame-merge RecieveMessages phase.
 //
@@ -35,11 +37,12 @@ public:
     Error BuildGraphImpl(JobGraph& graph, BuildGraphParams const& params) override {
         graph.AddMessageNode(
             [this, &registry = params.m_registry](
-                JobContext&,
+                JobContext& jobContext,
                 In<Time> inTime,
                 Out<UpdateComponentSignal<SkeletonStateComponent>> outState) -> Error
             {
                 const float dt = inTime ? inTime->GetDeltaTimeF() : 0.0f;
+                std::pmr::vector<ozz::math::SoaTransform> localTransforms(jobContext.GetFrameResource());
 
                 registry.view<SkeletonComponent const, SkeletonStateComponent const>().each(
                     [&](entt::entity entity,
@@ -74,7 +77,7 @@ public:
                         // Build new state with pre-sized output buffers.
                         SkeletonStateComponent newState;
                         newState.m_time = newTime;
-                        newState.m_localTransforms.resize(
+                        localTransforms.resize(
                             static_cast<size_t>(skeleton.num_soa_joints()));
                         newState.m_modelMatrices.resize(
                             static_cast<size_t>(skeleton.num_joints()));
@@ -84,7 +87,7 @@ public:
                         sampleJob.animation = &anim;
                         sampleJob.context   = ctxPtr.get();
                         sampleJob.ratio     = duration > 0.0f ? newTime / duration : 0.0f;
-                        sampleJob.output    = ozz::make_span(newState.m_localTransforms);
+                        sampleJob.output    = ozz::make_span(localTransforms);
                         if (!sampleJob.Run()) {
                             LOG(WARNING) << "AnimationSystemModule: SamplingJob failed for entity "
                                          << static_cast<uint32_t>(entity);
@@ -94,7 +97,7 @@ public:
                         // Convert to model-space matrices.
                         ozz::animation::LocalToModelJob ltmJob;
                         ltmJob.skeleton = &skeleton;
-                        ltmJob.input    = ozz::make_span(newState.m_localTransforms);
+                        ltmJob.input    = ozz::make_span(localTransforms);
                         ltmJob.output   = ozz::make_span(newState.m_modelMatrices);
                         if (!ltmJob.Run()) {
                             LOG(WARNING) << "AnimationSystemModule: LocalToModelJob failed";
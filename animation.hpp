@@ -70,9 +70,8 @@ namespace okami {
     // module's per-entity context map instead.
     // ---------------------------------------------------------------------------
     struct SkeletonStateComponent {
-        // Local-space SoA transforms — output of SamplingJob.
-        std::vector<ozz::math::SoaTransform>  m_localTransforms;
-        // Model-space matrices — output of LocalToModelJob.
+        // Model-space matrices — output of LocalToModelJob. The local-space
+        // transforms sampled on the way are frame scratch and not kept.
         std::vector<ozz::math::Float4x4>      m_modelMatrices;
         // Current playback time in seconds.
         float m_time = 0.0f;
@@ -0,0 +1,171 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef OKAMI_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace okami;
+
+Expected<std::unique_ptr<MappedFile>> okami::MappedFile::Open(std::filesystem::path const& path) {
+	std::unique_ptr<MappedFile> result(new MappedFile());
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	OKAMI_UNEXPECTED_RETURN_IF(file == INVALID_HANDLE_VALUE, "Failed to open file: " + path.string());
+	result->m_file = file;
+
+	LARGE_INTEGER size;
+	OKAMI_UNEXPECTED_RETURN_IF(!GetFileSizeEx(file, &size), "Failed to get file size: " + path.string());
+	result->m_size = static_cast<size_t>(size.QuadPart);
+	if (result->m_size == 0) {
+		return result;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	OKAMI_UNEXPECTED_RETURN_IF(!mapping, "Failed to map file: " + path.string());
+	result->m_mapping = mapping;
+
+	result->m_data = static_cast<uint8_t const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	OKAMI_UNEXPECTED_RETURN_IF(!result->m_data, "Failed to map file: " + path.string());
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	OKAMI_UNEXPECTED_RETURN_IF(fd < 0, "Failed to open file: " + path.string());
+	OKAMI_DEFER(close(fd));
+
+	struct stat info;
+	OKAMI_UNEXPECTED_RETURN_IF(fstat(fd, &info) != 0, "Failed to get file size: " + path.string());
+	result->m_size = static_cast<size_t>(info.st_size);
+	if (result->m_size == 0) {
+		return result;
+	}
+
+	void* data = mmap(nullptr, result->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	OKAMI_UNEXPECTED_RETURN_IF(data == MAP_FAILED, "Failed to map file: " + path.string());
+	result->m_data = static_cast<uint8_t const*>(data);
+#endif
+
+	return result;
+}
+
+okami::MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file) {
+		CloseHandle(m_file);
+	}
+#else
+	if (m_data) {
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+#endif
+}
+
+Expected<std::shared_ptr<AssetPack>> okami::AssetPack::Open(std::filesystem::path const& path) {
+	auto file = MappedFile::Open(path);
+	OKAMI_UNEXPECTED_RETURN(file);
+
+	auto data = (*file)->GetData();
+	OKAMI_UNEXPECTED_RETURN_IF(data.size() < sizeof(AssetPackHeader),
+		"Asset pack is too small: " + path.string());
+
+	auto const* header = reinterpret_cast<AssetPackHeader const*>(data.data());
+	OKAMI_UNEXPECTED_RETURN_IF(std::memcmp(header->m_magic, kAssetPackMagic, sizeof(kAssetPackMagic)) != 0,
+		"Not an asset pack: " + path.string());
+	OKAMI_UNEXPECTED_RETURN_IF(header->m_version != kAssetPackVersion,
+		"Unsupported asset pack version " + std::to_string(header->m_version) + ": " + path.string());
+
+	uint64_t tocSize = uint64_t{ header->m_entryCount } * sizeof(AssetPackEntry);
+	OKAMI_UNEXPECTED_RETURN_IF(header->m_tocOffset % alignof(AssetPackEntry) != 0 ||
+		header->m_tocOffset > data.size() || tocSize > data.size() - header->m_tocOffset,
+		"Asset pack table of contents is out of bounds: " + path.string());
+	OKAMI_UNEXPECTED_RETURN_IF(header->m_namesOffset > data.size() ||
+		header->m_namesSize > data.size() - header->m_namesOffset,
+		"Asset pack names are out of bounds: " + path.string());
+
+	auto pack = std::make_shared<AssetPack>();
+	pack->m_path = path;
+	pack->m_header = header;
+	pack->m_entries = std::span<AssetPackEntry const>(
+		reinterpret_cast<AssetPackEntry const*>(data.data() + header->m_tocOffset),
+		header->m_entryCount);
+	pack->m_names = std::string_view(
+		reinterpret_cast<char const*>(data.data() + header->m_namesOffset),
+		header->m_namesSize);
+
+	// Checked once here so lookups and reads can trust the table
+	for (auto const& entry : pack->m_entries) {
+		OKAMI_UNEXPECTED_RETURN_IF(entry.m_nameOffset > pack->m_names.size() ||
+			entry.m_nameSize > pack->m_names.size() - entry.m_nameOffset,
+			"Asset pack entry name is out of bounds: " + path.string());
+		OKAMI_UNEXPECTED_RETURN_IF(entry.m_offset > data.size() ||
+			entry.m_size > data.size() - entry.m_offset,
+			"Asset pack entry data is out of bounds: " + path.string());
+	}
+
+	pack->m_file = std::move(*file);
+	return pack;
+}
+
+AssetPackEntry const* okami::AssetPack::Find(std::filesystem::path const& path) const {
+	return FindKey(GetAssetPackKey(path));
+}
+
+AssetPackEntry const* okami::AssetPack::FindKey(std::string_view key) const {
+	uint64_t hash = HashAssetPackKey(key);
+	auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash,
+		[](AssetPackEntry const& entry, uint64_t hash) { return entry.m_pathHash < hash; });
+
+	// Colliding hashes sit next to each other
+	for (; it != m_entries.end() && it->m_pathHash == hash; ++it) {
+		if (GetName(*it) == key) {
+			return &*it;
+		}
+	}
+	return nullptr;
+}
+
+std::string_view okami::AssetPack::GetName(AssetPackEntry const& entry) const {
+	return m_names.substr(entry.m_nameOffset, entry.m_nameSize);
+}
+
+std::span<uint8_t const> okami::AssetPack::GetStoredData(AssetPackEntry const& entry) const {
+	return m_file->GetData().subspan(entry.m_offset, entry.m_size);
+}
+
+Expected<std::vector<uint8_t>> okami::AssetPack::Decompress(AssetPackEntry const& entry) const {
+	auto stored = GetStoredData(entry);
+	if (!(entry.m_flags & kAssetPackEntryCompressed)) {
+		return std::vector<uint8_t>(stored.begin(), stored.end());
+	}
+
+#ifdef OKAMI_ZSTD
+	std::vector<uint8_t> result(entry.m_uncompressedSize);
+	size_t size = ZSTD_decompress(result.data(), result.size(), stored.data(), stored.size());
+	OKAMI_UNEXPECTED_RETURN_IF(ZSTD_isError(size),
+		"Failed to decompress " + std::string(GetName(entry)) + ": " + ZSTD_getErrorName(size));
+	OKAMI_UNEXPECTED_RETURN_IF(size != result.size(),
+		"Decompressed size mismatch for " + std::string(GetName(entry)));
+	return result;
+#else
+	return OKAMI_UNEXPECTED("Asset " + std::string(GetName(entry)) +
+		" is compressed, but zstd support was not compiled in");
+#endif
+}
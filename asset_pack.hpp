@@ -0,0 +1,66 @@
+#pragma once
+
+#include "common.hpp"
+#include "asset_pack_format.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace okami {
+	// A read-only file mapped into memory
+	class MappedFile {
+	public:
+		static Expected<std::unique_ptr<MappedFile>> Open(std::filesystem::path const& path);
+
+		~MappedFile();
+		OKAMI_NO_COPY(MappedFile);
+
+		inline std::span<uint8_t const> GetData() const { return { m_data, m_size }; }
+
+	private:
+		MappedFile() = default;
+
+		uint8_t const* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+
+	// An asset pack built by AssetBuilder --pack. The file is mapped rather
+	// than read: opening only validates the table of contents, and lookups
+	// binary search it in place, so a pack costs nothing up front however
+	// many assets it holds. Raw blobs are handed out as views into the
+	// mapping; compressed ones are decompressed on read.
+	class AssetPack {
+	public:
+		static Expected<std::shared_ptr<AssetPack>> Open(std::filesystem::path const& path);
+
+		// Null if the pack has no such asset. The path is relative to the
+		// asset root.
+		AssetPackEntry const* Find(std::filesystem::path const& path) const;
+		AssetPackEntry const* FindKey(std::string_view key) const;
+
+		inline std::span<AssetPackEntry const> GetEntries() const { return m_entries; }
+		std::string_view GetName(AssetPackEntry const& entry) const;
+
+		// The bytes as stored, compressed or not
+		std::span<uint8_t const> GetStoredData(AssetPackEntry const& entry) const;
+		// Decompresses a compressed entry into a new buffer
+		Expected<std::vector<uint8_t>> Decompress(AssetPackEntry const& entry) const;
+
+		inline std::filesystem::path const& GetPath() const { return m_path; }
+
+	private:
+		std::filesystem::path m_path;
+		std::unique_ptr<MappedFile> m_file;
+		AssetPackHeader const* m_header = nullptr;
+		std::span<AssetPackEntry const> m_entries;
+		std::string_view m_names;
+	};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// On-disk layout of asset packs (.okpak). Shared by the runtime reader and
+// AssetBuilder, so this header sticks to C++17.
+//
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   sorted by pathHash, then by name
+//   name bytes                   asset paths, not null terminated
+//   blobs                        each starts on a multiple of alignment
+//
+// Asset paths are relative to the asset root, with '/' separators. All
+// integers are little endian.
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace okami {
+	constexpr char kAssetPackMagic[4] = { 'O', 'K', 'P', 'K' };
+	constexpr uint32_t kAssetPackVersion = 1;
+	constexpr uint32_t kAssetPackDefaultAlignment = 64;
+	constexpr char kAssetPackExtension[] = ".okpak";
+
+	enum AssetPackEntryFlags : uint32_t {
+		kAssetPackEntryCompressed = 1u << 0, // zstd frame
+	};
+
+	struct AssetPackHeader {
+		char m_magic[4];
+		uint32_t m_version;
+		uint32_t m_entryCount;
+		uint32_t m_alignment;
+		uint64_t m_tocOffset;
+		uint64_t m_namesOffset;
+		uint64_t m_namesSize;
+	};
+	static_assert(sizeof(AssetPackHeader) == 40);
+
+	struct AssetPackEntry {
+		uint64_t m_pathHash;
+		uint64_t m_offset;
+		// Bytes stored in the pack
+		uint64_t m_size;
+		// Bytes once decompressed; equal to m_size if stored raw
+		uint64_t m_uncompressedSize;
+		uint32_t m_nameOffset;
+		uint32_t m_nameSize;
+		uint32_t m_flags;
+		uint32_t m_reserved;
+	};
+	static_assert(sizeof(AssetPackEntry) == 48);
+
+	// The key an asset is stored under: the path made lexically normal with
+	// '/' separators
+	inline std::string GetAssetPackKey(std::filesystem::path const& path) {
+		return path.lexically_normal().generic_string();
+	}
+
+	// 64-bit FNV-1a
+	inline uint64_t HashAssetPackKey(std::string_view key) {
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : key) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
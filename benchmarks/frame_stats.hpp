@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace okami {
+
+// Summary of a series of per-frame samples (milliseconds, counts, ...).
+// Percentiles use the nearest-rank method so every reported value is one
+// that was actually observed.
+struct SampleSummary {
+    double m_mean = 0.0;
+    double m_min  = 0.0;
+    double m_p50  = 0.0;
+    double m_p95  = 0.0;
+    double m_p99  = 0.0;
+    double m_max  = 0.0;
+};
+
+inline double NearestRankPercentile(std::vector<double> const& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sorted.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+inline SampleSummary Summarize(std::vector<double> samples) {
+    SampleSummary result;
+    if (samples.empty()) {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    result.m_mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    result.m_min  = samples.front();
+    result.m_p50  = NearestRankPercentile(samples, 50.0);
+    result.m_p95  = NearestRankPercentile(samples, 95.0);
+    result.m_p99  = NearestRankPercentile(samples, 99.0);
+    result.m_max  = samples.back();
+    return result;
+}
+
+} // namespace okami
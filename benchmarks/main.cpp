@@ -0,0 +1,405 @@
+// EngineBenchmarks: runs each sample and synthetic stress scene headlessly for
+// a fixed number of frames and writes frame-time statistics as JSON.
+//
+//   EngineBenchmarks [--frames N] [--warmup N] [--size WxH] [--filter TEXT]
+//                    [--latency N] [--replay FILE] [--label TEXT] [--out results.json]
+//
+// Frame and phase times come from the frame profiler (profiler.hpp); the
+// simulation runs at a fixed 60 Hz step so every run sees the same scene
+// state. Allocation counts need an OKAMI_TRACK_ALLOCATIONS build; they cover
+// every operator new on any thread between the end of one frame and the end
+// of the next, and per scope the allocations made inside it. GPU memory is
+// what the renderer's residency manager accounts to textures and geometry.
+//
+// --replay drives the scenes with input and frame times recorded by running
+// a sample with --record FILE, so a captured play session can be re-run as
+// a repeatable benchmark. --frames is capped to the length of the recording.
+
+#include "engine.hpp"
+#include "profiler.hpp"
+#include "allocation_tracker.hpp"
+#include "frame_stats.hpp"
+#include "residency.hpp"
+#include "stress_scenes.hpp"
+
+#include "../samples/01_hello_world/scene.hpp"
+#include "../samples/02_zoo/scene.hpp"
+#include "../samples/04_sponza/scene.hpp"
+#include "../samples/05_animation/scene.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    // Top-level phases recorded by Engine::Run; every other scope on the main
+    // thread is attributed to the phase that contains it.
+    constexpr const char* kFramePhases[] = {
+        "ProcessIO", "Render", "BuildGraph", "SendMessages", "ProcessGUI", "Execute", "ReceiveMessages",
+        "SubmitRender",
+    };
+
+    struct BenchmarkOptions {
+        size_t                m_frames = 300;
+        size_t                m_warmupFrames = 30;
+        glm::ivec2            m_size = { 1280, 720 };
+        std::string           m_filter;
+        uint32_t              m_frameLatency = 0;
+        std::filesystem::path m_replayPath;
+        std::optional<InputReplay> m_replay;
+        std::string           m_label;
+        std::filesystem::path m_output = "benchmark_results.json";
+    };
+
+    struct BenchmarkCase {
+        std::string                              m_name;
+        std::function<std::unique_ptr<Sample>()> m_create;
+    };
+
+    struct BenchmarkResult {
+        std::string                                m_name;
+        std::optional<std::string>                 m_error;
+        std::vector<double>                        m_frameMs;
+        std::map<std::string, std::vector<double>> m_phaseMs;
+        std::map<std::string, std::vector<double>> m_scopeMs;
+        std::map<std::string, std::vector<double>> m_scopeAllocations;
+        std::vector<double>                        m_allocations;
+        std::vector<double>                        m_allocatedBytes;
+        std::vector<double>                        m_gpuResidentMiB;
+        GPUResidencyStats                          m_residency; // at the end of the run
+    };
+
+    template <typename TSample>
+    BenchmarkCase MakeCase(std::string name) {
+        return BenchmarkCase{
+            .m_name = std::move(name),
+            .m_create = []() -> std::unique_ptr<Sample> { return std::make_unique<TSample>(); },
+        };
+    }
+
+    std::vector<BenchmarkCase> GetBenchmarkCases() {
+        return {
+            MakeCase<sample_hello_world::HelloWorldSample>("hello_world"),
+            MakeCase<sample_zoo::ZooSample>("zoo"),
+            MakeCase<sample_sponza::SponzaSample>("sponza"),
+            MakeCase<sample_drone::DroneSample>("animation"),
+            MakeCase<benchmark_scenes::SpriteStressScene>("stress_sprites"),
+            MakeCase<benchmark_scenes::MeshStressScene>("stress_meshes"),
+            MakeCase<benchmark_scenes::TransformChurnScene>("stress_transform_churn"),
+        };
+    }
+
+    double ToMilliseconds(uint64_t ns) {
+        return static_cast<double>(ns) / 1.0e6;
+    }
+
+    const char* FindPhase(std::string_view name) {
+        for (auto const* phase : kFramePhases) {
+            if (name == phase) {
+                return phase;
+            }
+        }
+        return nullptr;
+    }
+
+    // Appends this frame's value to every series in `series`; series missing
+    // from `frame` get zero and new ones are back-filled with zeros, so each
+    // has one sample per measured frame.
+    void AppendFrameSamples(std::map<std::string, std::vector<double>>& series,
+                            std::map<std::string, double> const& frame, size_t frameCount) {
+        for (auto& [key, samples] : series) {
+            if (!frame.contains(key)) {
+                samples.push_back(0.0);
+            }
+        }
+        for (auto const& [key, value] : frame) {
+            auto& samples = series[key];
+            samples.resize(frameCount - 1, 0.0);
+            samples.push_back(value);
+        }
+    }
+
+    // Splits the events of one frame into the frame time, per-phase totals and
+    // per-scope totals keyed "<phase>/<scope>".
+    void AccumulateFrame(std::vector<ProfileEventRecord> const& events, BenchmarkResult& result) {
+        std::map<std::string, double> phases;
+        std::map<std::string, double> scopes;
+        std::map<std::string, double> scopeAllocations;
+        std::vector<ProfileEventRecord const*> phaseEvents;
+        double frameMs = 0.0;
+
+        for (auto const& event : events) {
+            if (std::strcmp(event.m_name, "Frame") == 0) {
+                frameMs += ToMilliseconds(event.m_end - event.m_start);
+            } else if (auto const* phase = FindPhase(event.m_name)) {
+                phases[phase] += ToMilliseconds(event.m_end - event.m_start);
+                phaseEvents.push_back(&event);
+            }
+        }
+
+        for (auto const& event : events) {
+            if (std::strcmp(event.m_name, "Frame") == 0 || FindPhase(event.m_name)) {
+                continue;
+            }
+            std::string key = "Other";
+            for (auto const* phase : phaseEvents) {
+                if (phase->m_threadId == event.m_threadId &&
+                    phase->m_start <= event.m_start && event.m_end <= phase->m_end) {
+                    key = phase->m_name;
+                    break;
+                }
+            }
+            key += '/';
+            key += event.m_name;
+            scopes[key] += ToMilliseconds(event.m_end - event.m_start);
+            scopeAllocations[key] += static_cast<double>(event.m_allocations.m_count);
+        }
+
+        result.m_frameMs.push_back(frameMs);
+        for (auto const* phase : kFramePhases) {
+            result.m_phaseMs[phase].push_back(phases[phase]);
+        }
+        AppendFrameSamples(result.m_scopeMs, scopes, result.m_frameMs.size());
+        if constexpr (kAllocationTrackingEnabled) {
+            AppendFrameSamples(result.m_scopeAllocations, scopeAllocations, result.m_frameMs.size());
+        }
+    }
+
+    BenchmarkResult RunBenchmark(BenchmarkCase const& benchmark, BenchmarkOptions const& options) {
+        BenchmarkResult result{ .m_name = benchmark.m_name };
+
+        auto sample = benchmark.m_create();
+        Engine en;
+        sample->SetupModules(en, HeadlessGLParams{ .m_size = options.m_size });
+        if (auto err = en.Startup(); err.IsError()) {
+            result.m_error = err.Str();
+            return result;
+        }
+        sample->SetupScene(en);
+
+        size_t frameIndex = 0;
+        auto allocations = GetTotalAllocations();
+        auto const* residency = en.QueryInterface<IGPUResidency>();
+
+        RunParams params;
+        params.frameCount = options.m_warmupFrames + options.m_frames;
+        params.frameTime = 1.0 / 60.0;
+        params.frameLatency = options.m_frameLatency;
+
+        // Every case replays from the start
+        std::optional<InputReplay> replay = options.m_replay;
+        if (replay) {
+            params.inputReplay = &*replay;
+        }
+        params.frameCallback = [&](Time const&) {
+            auto const frameAllocations = GetTotalAllocations() - allocations;
+
+            if (frameIndex++ >= options.m_warmupFrames) {
+                result.m_allocations.push_back(static_cast<double>(frameAllocations.m_count));
+                result.m_allocatedBytes.push_back(static_cast<double>(frameAllocations.m_bytes));
+                AccumulateFrame(CollectProfileEvents(), result);
+                if (residency) {
+                    result.m_residency = residency->GetResidencyStats();
+                    result.m_gpuResidentMiB.push_back(
+                        static_cast<double>(result.m_residency.GetResidentBytes()) / (1024.0 * 1024.0));
+                }
+            }
+            ClearProfile();
+
+            // Re-read so the bookkeeping above is not charged to the next frame
+            allocations = GetTotalAllocations();
+        };
+
+        ClearProfile();
+        SetProfilerEnabled(true);
+        en.Run(params);
+        SetProfilerEnabled(false);
+        en.Shutdown();
+        return result;
+    }
+
+    std::string JsonString(std::string_view str) {
+        std::string result = "\"";
+        for (char c : str) {
+            switch (c) {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                default:   result += c;
+            }
+        }
+        result += '"';
+        return result;
+    }
+
+    std::string JsonSummary(std::vector<double> const& samples) {
+        auto s = Summarize(samples);
+        return std::format(
+            "{{\"mean\":{:.4f},\"min\":{:.4f},\"p50\":{:.4f},\"p95\":{:.4f},\"p99\":{:.4f},\"max\":{:.4f}}}",
+            s.m_mean, s.m_min, s.m_p50, s.m_p95, s.m_p99, s.m_max);
+    }
+
+    std::string JsonSummaryMap(std::map<std::string, std::vector<double>> const& series, std::string_view indent) {
+        std::string result = "{";
+        bool first = true;
+        for (auto const& [name, samples] : series) {
+            result += first ? "\n" : ",\n";
+            result += std::format("{}  {}: {}", indent, JsonString(name), JsonSummary(samples));
+            first = false;
+        }
+        result += first ? "}" : std::format("\n{}}}", indent);
+        return result;
+    }
+
+    Error WriteResults(std::vector<BenchmarkResult> const& results, BenchmarkOptions const& options) {
+        std::ofstream file(options.m_output);
+        OKAMI_ERROR_RETURN_IF(!file, "Failed to open benchmark output: " + options.m_output.string());
+
+        file << "{\n";
+        file << "  \"label\": " << JsonString(options.m_label) << ",\n";
+        file << std::format("  \"frames\": {},\n  \"warmupFrames\": {},\n", options.m_frames, options.m_warmupFrames);
+        file << std::format("  \"resolution\": [{}, {}],\n", options.m_size.x, options.m_size.y);
+        file << std::format("  \"frameLatency\": {},\n", options.m_frameLatency);
+        file << "  \"replay\": " << JsonString(options.m_replayPath.string()) << ",\n";
+        file << std::format("  \"allocationTracking\": {},\n", kAllocationTrackingEnabled);
+        file << "  \"benchmarks\": [";
+        bool first = true;
+        for (auto const& result : results) {
+            file << (first ? "\n" : ",\n");
+            first = false;
+            file << "    {\n      \"name\": " << JsonString(result.m_name) << ",\n";
+            if (result.m_error) {
+                file << "      \"error\": " << JsonString(*result.m_error) << "\n    }";
+                continue;
+            }
+            file << "      \"frameMs\": " << JsonSummary(result.m_frameMs) << ",\n";
+            if constexpr (kAllocationTrackingEnabled) {
+                file << "      \"allocationsPerFrame\": " << JsonSummary(result.m_allocations) << ",\n";
+                file << "      \"allocatedBytesPerFrame\": " << JsonSummary(result.m_allocatedBytes) << ",\n";
+                file << "      \"scopeAllocations\": " << JsonSummaryMap(result.m_scopeAllocations, "      ") << ",\n";
+            }
+            if (!result.m_gpuResidentMiB.empty()) {
+                auto const& residency = result.m_residency;
+                file << "      \"gpuResidentMiB\": " << JsonSummary(result.m_gpuResidentMiB) << ",\n";
+                file << std::format(
+                    "      \"residency\": {{\"budgetBytes\":{},\"textureBytes\":{},\"geometryBytes\":{},"
+                    "\"textures\":{},\"geometries\":{},\"evictions\":{},\"evictedBytes\":{},\"restores\":{}}},\n",
+                    residency.m_budgetBytes, residency.m_textureBytes, residency.m_geometryBytes,
+                    residency.m_textureCount, residency.m_geometryCount,
+                    residency.m_evictions, residency.m_evictedBytes, residency.m_restores);
+            }
+            file << "      \"phasesMs\": " << JsonSummaryMap(result.m_phaseMs, "      ") << ",\n";
+            file << "      \"scopesMs\": " << JsonSummaryMap(result.m_scopeMs, "      ") << "\n    }";
+        }
+        file << "\n  ]\n}\n";
+
+        OKAMI_ERROR_RETURN_IF(!file, "Failed to write benchmark output: " + options.m_output.string());
+        return {};
+    }
+
+    void PrintUsage(const char* exe) {
+        std::cerr << "Usage: " << exe
+                  << " [--frames N] [--warmup N] [--size WxH] [--filter TEXT] [--latency N] [--replay FILE] [--label TEXT] [--out FILE]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        auto const hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.m_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            options.m_warmupFrames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.m_size.x, &options.m_size.y) != 2) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.m_filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--latency") == 0 && hasValue) {
+            options.m_frameLatency = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+            options.m_replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--label") == 0 && hasValue) {
+            options.m_label = argv[++i];
+        } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+            options.m_output = argv[++i];
+        } else {
+            std::cerr << "Unknown flag: " << argv[i] << "\n";
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.m_frames == 0) {
+        std::cerr << "--frames must be at least 1\n";
+        return 1;
+    }
+
+    if (!options.m_replayPath.empty()) {
+        auto replay = InputReplay::Load(options.m_replayPath);
+        if (!replay) {
+            std::cerr << "Failed to load replay: " << replay.error() << "\n";
+            return 1;
+        }
+        if (replay->GetFrameCount() <= options.m_warmupFrames) {
+            std::cerr << "Replay has " << replay->GetFrameCount() << " frames, not enough for "
+                      << options.m_warmupFrames << " warmup frames\n";
+            return 1;
+        }
+        options.m_frames = std::min(options.m_frames, replay->GetFrameCount() - options.m_warmupFrames);
+        options.m_replay = std::move(*replay);
+    }
+
+    std::vector<BenchmarkResult> results;
+    bool failed = false;
+    for (auto const& benchmark : GetBenchmarkCases()) {
+        if (!options.m_filter.empty() && benchmark.m_name.find(options.m_filter) == std::string::npos) {
+            continue;
+        }
+
+        std::cout << "Running " << benchmark.m_name << "..." << std::endl;
+        auto& result = results.emplace_back(RunBenchmark(benchmark, options));
+        if (result.m_error) {
+            std::cerr << "  failed: " << *result.m_error << "\n";
+            failed = true;
+            continue;
+        }
+
+        auto const frame = Summarize(result.m_frameMs);
+        std::cout << std::format("  frame ms  p50 {:.3f}  p95 {:.3f}  p99 {:.3f}  max {:.3f}\n",
+            frame.m_p50, frame.m_p95, frame.m_p99, frame.m_max);
+        if constexpr (kAllocationTrackingEnabled) {
+            auto const allocations = Summarize(result.m_allocations);
+            std::cout << std::format("  allocations/frame  mean {:.1f}  max {:.0f}\n",
+                allocations.m_mean, allocations.m_max);
+        }
+        if (!result.m_gpuResidentMiB.empty()) {
+            std::cout << std::format("  GPU resident MiB  max {:.1f}  evictions {}  restores {}\n",
+                Summarize(result.m_gpuResidentMiB).m_max, result.m_residency.m_evictions,
+                result.m_residency.m_restores);
+        }
+    }
+
+    if (auto err = WriteResults(results, options); err.IsError()) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << options.m_output.string() << "\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+#include "bench_common.hpp"
+#include "aabb_tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    // Scene extent grows with the count so density, and therefore the number
+    // of overlaps per query, stays roughly constant across the sweep.
+    float ExtentFor(size_t count) {
+        return 4.0f * std::cbrt(static_cast<float>(count));
+    }
+}
+
+static void BM_AABBTree_Insert(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto boxes = RandomBoxes(count, ExtentFor(count));
+
+    for (auto _ : state) {
+        AABBTree<int> tree;
+        for (size_t i = 0; i < count; ++i) {
+            tree.Insert(boxes[i], static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AABBTree_Insert)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_AABBTree_Remove(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto boxes = RandomBoxes(count, ExtentFor(count));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        AABBTree<int> tree;
+        std::vector<int> leaves;
+        leaves.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            leaves.push_back(tree.Insert(boxes[i], static_cast<int>(i)));
+        }
+        std::shuffle(leaves.begin(), leaves.end(), std::mt19937(kSeed));
+        state.ResumeTiming();
+
+        for (int leaf : leaves) {
+            tree.Remove(leaf);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AABBTree_Remove)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_AABBTree_Query(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto const extent = ExtentFor(count);
+    auto boxes = RandomBoxes(count, extent);
+    auto queries = RandomBoxes(1024, extent, kSeed + 1);
+
+    AABBTree<int> tree;
+    for (size_t i = 0; i < count; ++i) {
+        tree.Insert(boxes[i], static_cast<int>(i));
+    }
+
+    size_t hits = 0;
+    size_t q = 0;
+    for (auto _ : state) {
+        tree.Query(queries[q++ % queries.size()], [&](int, int) { ++hits; });
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hits/query"] = static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_AABBTree_Query)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_FlatAABBTree_Query(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto const extent = ExtentFor(count);
+    auto boxes = RandomBoxes(count, extent);
+    auto queries = RandomBoxes(1024, extent, kSeed + 1);
+
+    AABBTree<int> tree;
+    for (size_t i = 0; i < count; ++i) {
+        tree.Insert(boxes[i], static_cast<int>(i));
+    }
+    auto flat = tree.Flatten();
+
+    size_t hits = 0;
+    size_t q = 0;
+    for (auto _ : state) {
+        flat.Query(queries[q++ % queries.size()], [&](int) { ++hits; });
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hits/query"] = static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_FlatAABBTree_Query)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_AABBTree_Flatten(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto boxes = RandomBoxes(count, ExtentFor(count));
+
+    AABBTree<int> tree;
+    for (size_t i = 0; i < count; ++i) {
+        tree.Insert(boxes[i], static_cast<int>(i));
+    }
+
+    for (auto _ : state) {
+        auto flat = tree.Flatten();
+        benchmark::DoNotOptimize(flat);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AABBTree_Flatten)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_AABBTree_BulkBuild(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto boxes = RandomBoxes(count, ExtentFor(count));
+    std::vector<int> datas(count);
+    for (size_t i = 0; i < count; ++i) {
+        datas[i] = static_cast<int>(i);
+    }
+
+    for (auto _ : state) {
+        auto tree = AABBTree<int>::Build(boxes, datas);
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_AABBTree_BulkBuild)->RangeMultiplier(4)->Range(256, 16384);
+
+// Same queries as BM_AABBTree_Query, against an SAH-built tree
+static void BM_AABBTree_QueryBulkBuilt(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto const extent = ExtentFor(count);
+    auto boxes = RandomBoxes(count, extent);
+    auto queries = RandomBoxes(1024, extent, kSeed + 1);
+    std::vector<int> datas(count);
+    for (size_t i = 0; i < count; ++i) {
+        datas[i] = static_cast<int>(i);
+    }
+    auto tree = AABBTree<int>::Build(boxes, datas);
+
+    size_t hits = 0;
+    size_t q = 0;
+    for (auto _ : state) {
+        tree.Query(queries[q++ % queries.size()], [&](int, int) { ++hits; });
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hits/query"] = static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_AABBTree_QueryBulkBuilt)->RangeMultiplier(4)->Range(256, 16384);
+
+static void BM_WideAABBTree_Query(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto const extent = ExtentFor(count);
+    auto boxes = RandomBoxes(count, extent);
+    auto queries = RandomBoxes(1024, extent, kSeed + 1);
+    std::vector<int> datas(count);
+    for (size_t i = 0; i < count; ++i) {
+        datas[i] = static_cast<int>(i);
+    }
+    auto wide = AABBTree<int>::Build(boxes, datas).Collapse();
+
+    size_t hits = 0;
+    size_t q = 0;
+    for (auto _ : state) {
+        wide.Query(queries[q++ % queries.size()], [&](int) { ++hits; });
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hits/query"] = static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_WideAABBTree_Query)->RangeMultiplier(4)->Range(256, 16384);
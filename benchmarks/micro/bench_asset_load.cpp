@@ -0,0 +1,48 @@
+#include "bench_common.hpp"
+#include "geometry.hpp"
+#include "texture.hpp"
+#include "paths.hpp"
+
+using namespace okami;
+
+// Load paths read the processed test assets; build BuildTestAssets first.
+
+static void BM_Geometry_LoadGLTF(benchmark::State& state, const char* asset) {
+    auto path = GetTestAssetPath(asset);
+    for (auto _ : state) {
+        auto geometry = Geometry::LoadGLTF(path);
+        if (!geometry) {
+            state.SkipWithError(geometry.error().Str().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(geometry);
+    }
+}
+BENCHMARK_CAPTURE(BM_Geometry_LoadGLTF, box, "box.glb")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Geometry_LoadGLTF, torus, "torus.glb")->Unit(benchmark::kMicrosecond);
+
+static void BM_Texture_LoadPNG(benchmark::State& state) {
+    auto path = GetTestAssetPath("test.png");
+    for (auto _ : state) {
+        auto texture = Texture::FromPNG(path);
+        if (!texture) {
+            state.SkipWithError(texture.error().Str().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(texture);
+    }
+}
+BENCHMARK(BM_Texture_LoadPNG)->Unit(benchmark::kMicrosecond);
+
+static void BM_Texture_LoadKTX2(benchmark::State& state) {
+    auto path = GetTestAssetPath("test.ktx2");
+    for (auto _ : state) {
+        auto texture = Texture::FromKTX2(path);
+        if (!texture) {
+            state.SkipWithError(texture.error().Str().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(texture);
+    }
+}
+BENCHMARK(BM_Texture_LoadKTX2)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "aabb.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace okami::bench {
+
+// Every benchmark seeds its generator with this so inputs are identical
+// across runs and machines.
+constexpr uint32_t kSeed = 42;
+
+// Unit-ish boxes scattered uniformly through a cube of side `extent`.
+inline std::vector<AABB> RandomBoxes(size_t count, float extent, uint32_t seed = kSeed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-0.5f * extent, 0.5f * extent);
+    std::uniform_real_distribution<float> size(0.1f, 1.0f);
+
+    std::vector<AABB> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 min(pos(rng), pos(rng), pos(rng));
+        glm::vec3 extentVec(size(rng), size(rng), size(rng));
+        result.push_back(AABB{ min, min + extentVec });
+    }
+    return result;
+}
+
+} // namespace okami::bench
@@ -0,0 +1,80 @@
+#include "bench_common.hpp"
+#include "entity_tree_view.hpp"
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    void AttachChild(entt::registry& registry, entity_t parent, entity_t child) {
+        auto& childNode = registry.get<EntityTreeComponent>(child);
+        auto& parentNode = registry.get<EntityTreeComponent>(parent);
+        childNode.m_parent = parent;
+        childNode.m_prevSibling = parentNode.m_lastChild;
+        if (parentNode.m_lastChild != kNullEntity) {
+            registry.get<EntityTreeComponent>(parentNode.m_lastChild).m_nextSibling = child;
+        } else {
+            parentNode.m_firstChild = child;
+        }
+        parentNode.m_lastChild = child;
+    }
+
+    // Random tree: each new entity picks a uniformly random existing parent,
+    // which gives a shallow, bushy shape similar to scene hierarchies.
+    entity_t BuildRandomTree(entt::registry& registry, size_t count) {
+        std::mt19937 rng(kSeed);
+        std::vector<entity_t> entities;
+        entities.reserve(count);
+
+        auto root = registry.create();
+        registry.emplace<EntityTreeComponent>(root);
+        entities.push_back(root);
+
+        for (size_t i = 1; i < count; ++i) {
+            auto e = registry.create();
+            registry.emplace<EntityTreeComponent>(e);
+            std::uniform_int_distribution<size_t> parent(0, entities.size() - 1);
+            AttachChild(registry, entities[parent(rng)], e);
+            entities.push_back(e);
+        }
+        return root;
+    }
+}
+
+static void BM_EntityTree_Descendants(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    entt::registry registry;
+    auto root = BuildRandomTree(registry, count);
+    EntityTreeView view(registry);
+
+    for (auto _ : state) {
+        size_t visited = 0;
+        for (auto e : view.Descendants(root)) {
+            benchmark::DoNotOptimize(e);
+            ++visited;
+        }
+        benchmark::DoNotOptimize(visited);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_EntityTree_Descendants)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_EntityTree_Children(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    entt::registry registry;
+    BuildRandomTree(registry, count);
+    EntityTreeView view(registry);
+    auto nodes = registry.view<EntityTreeComponent>();
+
+    for (auto _ : state) {
+        size_t visited = 0;
+        for (auto parent : nodes) {
+            for (auto child : view.Children(parent)) {
+                benchmark::DoNotOptimize(child);
+                ++visited;
+            }
+        }
+        benchmark::DoNotOptimize(visited);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_EntityTree_Children)->RangeMultiplier(8)->Range(64, 32768);
@@ -0,0 +1,78 @@
+#include "bench_common.hpp"
+#include "jobs.hpp"
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    // Small fixed amount of work per node so scheduling overhead dominates
+    Error SpinTask(JobContext&) {
+        uint32_t x = kSeed;
+        for (int i = 0; i < 16; ++i) {
+            x = x * 1664525u + 1013904223u;
+        }
+        benchmark::DoNotOptimize(x);
+        return {};
+    }
+
+    // One root fanning out to `width` independent nodes joined by one sink
+    void BuildWide(JobGraph& graph, size_t width) {
+        int root = graph.AddNode(SpinTask);
+        std::vector<int> middle;
+        middle.reserve(width);
+        for (size_t i = 0; i < width; ++i) {
+            int deps[] = { root };
+            middle.push_back(graph.AddNode(SpinTask, deps));
+        }
+        graph.AddNode(SpinTask, middle);
+    }
+
+    // A single chain of `depth` nodes
+    void BuildDeep(JobGraph& graph, size_t depth) {
+        int prev = graph.AddNode(SpinTask);
+        for (size_t i = 1; i < depth; ++i) {
+            int deps[] = { prev };
+            prev = graph.AddNode(SpinTask, deps);
+        }
+    }
+}
+
+static void BM_JobGraph_Wide(benchmark::State& state) {
+    auto const width = static_cast<size_t>(state.range(0));
+    MessageBus bus;
+    DefaultJobGraphExecutor executor;
+    for (auto _ : state) {
+        JobGraph graph;
+        BuildWide(graph, width);
+        auto err = executor.Execute(graph, bus);
+        benchmark::DoNotOptimize(err);
+    }
+    state.SetItemsProcessed(state.iterations() * (width + 2));
+}
+BENCHMARK(BM_JobGraph_Wide)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_JobGraph_Deep(benchmark::State& state) {
+    auto const depth = static_cast<size_t>(state.range(0));
+    MessageBus bus;
+    DefaultJobGraphExecutor executor;
+    for (auto _ : state) {
+        JobGraph graph;
+        BuildDeep(graph, depth);
+        auto err = executor.Execute(graph, bus);
+        benchmark::DoNotOptimize(err);
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_JobGraph_Deep)->RangeMultiplier(4)->Range(16, 4096);
+
+// Build cost alone, to separate graph construction from execution
+static void BM_JobGraph_BuildOnly(benchmark::State& state) {
+    auto const width = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        JobGraph graph;
+        BuildWide(graph, width);
+        benchmark::DoNotOptimize(graph);
+    }
+    state.SetItemsProcessed(state.iterations() * (width + 2));
+}
+BENCHMARK(BM_JobGraph_BuildOnly)->RangeMultiplier(4)->Range(16, 4096);
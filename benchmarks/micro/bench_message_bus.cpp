@@ -0,0 +1,60 @@
+#include "bench_common.hpp"
+#include "jobs.hpp"
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    struct BenchMessage {
+        uint32_t  m_id;
+        glm::vec3 m_value;
+    };
+}
+
+static void BM_MessageBus_Send(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    MessageBus bus;
+    bus.EnsurePort<BenchMessage>();
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            bus.Send(BenchMessage{ static_cast<uint32_t>(i), glm::vec3(1.0f) });
+        }
+        state.PauseTiming();
+        bus.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MessageBus_Send)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_MessageBus_SendBatch(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    MessageBus bus;
+    std::vector<BenchMessage> batch(count, BenchMessage{ 0, glm::vec3(1.0f) });
+
+    for (auto _ : state) {
+        bus.SendBatch(std::span<BenchMessage>(batch));
+        state.PauseTiming();
+        bus.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MessageBus_SendBatch)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_MessageBus_Handle(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    MessageBus bus;
+    for (size_t i = 0; i < count; ++i) {
+        bus.Send(BenchMessage{ static_cast<uint32_t>(i), glm::vec3(1.0f) });
+    }
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        bus.Handle<BenchMessage>([&](BenchMessage const& msg) { sum += msg.m_value.x; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MessageBus_Handle)->RangeMultiplier(8)->Range(64, 32768);
@@ -0,0 +1,52 @@
+#include "bench_common.hpp"
+#include "pool.hpp"
+
+#include <algorithm>
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    struct PoolObject {
+        float m_data[8] = {};
+    };
+}
+
+// Fill the pool, then repeatedly free a random half and allocate it back,
+// which exercises both the free-list and the tail trimming in Free().
+static void BM_Pool_Churn(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+
+    Pool<PoolObject> pool;
+    std::vector<int> live;
+    live.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        live.push_back(pool.Allocate());
+    }
+
+    std::mt19937 rng(kSeed);
+    for (auto _ : state) {
+        std::shuffle(live.begin(), live.end(), rng);
+        auto const half = live.size() / 2;
+        for (size_t i = half; i < live.size(); ++i) {
+            pool.Free(live[i]);
+        }
+        for (size_t i = half; i < live.size(); ++i) {
+            live[i] = pool.Allocate();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (count - count / 2) * 2);
+}
+BENCHMARK(BM_Pool_Churn)->RangeMultiplier(4)->Range(256, 65536);
+
+static void BM_Pool_AllocateSequential(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Pool<PoolObject> pool;
+        for (size_t i = 0; i < count; ++i) {
+            benchmark::DoNotOptimize(pool.Allocate());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Pool_AllocateSequential)->RangeMultiplier(4)->Range(256, 65536);
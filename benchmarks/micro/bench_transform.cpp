@@ -0,0 +1,59 @@
+#include "bench_common.hpp"
+#include "transform.hpp"
+
+#include <algorithm>
+
+using namespace okami;
+using namespace okami::bench;
+
+namespace {
+    std::vector<Transform> RandomTransforms(size_t count) {
+        std::mt19937 rng(kSeed);
+        std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+        std::vector<Transform> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 axis = glm::normalize(glm::vec3(pos(rng), pos(rng), pos(rng)) + glm::vec3(0.01f));
+            result.push_back(Transform(
+                glm::vec3(pos(rng), pos(rng), pos(rng)),
+                glm::angleAxis(angle(rng), axis),
+                scale(rng)));
+        }
+        return result;
+    }
+}
+
+static void BM_Transform_Compose(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto a = RandomTransforms(count);
+    auto b = RandomTransforms(count);
+    std::reverse(b.begin(), b.end());
+    std::vector<Transform> out(count);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = a[i] * b[i];
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Transform_Compose)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_Transform_Inverse(benchmark::State& state) {
+    auto const count = static_cast<size_t>(state.range(0));
+    auto a = RandomTransforms(count);
+    std::vector<Transform> out(count);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = a[i].Inverse();
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Transform_Inverse)->RangeMultiplier(8)->Range(64, 32768);
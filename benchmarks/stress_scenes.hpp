@@ -0,0 +1,133 @@
+#pragma once
+
+#include "../samples/sample.hpp"
+#include "renderer.hpp"
+#include "transform.hpp"
+#include "texture.hpp"
+#include "paths.hpp"
+#include "geometry.hpp"
+#include "camera.hpp"
+#include "ogl/ogl_renderer.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace benchmark_scenes {
+
+// ---------------------------------------------------------------------------
+// Synthetic scenes that scale one cost at a time. Entities are laid out on a
+// deterministic grid so every run renders the same frames.
+// ---------------------------------------------------------------------------
+class StressSceneBase : public okami::Sample {
+public:
+    void SetupModules(okami::Engine& en, std::optional<okami::HeadlessGLParams> headless = {}) override {
+        if (headless) {
+            en.CreateModule<okami::GLFWModuleFactory>({}, std::move(*headless));
+        } else {
+            en.CreateModule<okami::GLFWModuleFactory>();
+        }
+        en.CreateModule<okami::OGLRendererFactory>({}, okami::RendererParams{});
+    }
+
+protected:
+    // Position of cell `index` on a square grid centred on the origin, in the
+    // XY plane, spaced `spacing` apart.
+    static glm::vec3 GridPosition(size_t index, size_t count, float spacing) {
+        size_t const side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        float const half = 0.5f * spacing * static_cast<float>(side - 1);
+        return glm::vec3(
+            spacing * static_cast<float>(index % side) - half,
+            spacing * static_cast<float>(index / side) - half,
+            0.0f);
+    }
+
+    static void AddLookAtCamera(okami::Engine& en, glm::vec3 eye) {
+        using namespace okami;
+        auto cameraEntity = en.CreateEntity(kNullEntity, "Camera");
+        en.AddComponent(cameraEntity, Camera::Perspective(glm::half_pi<float>(), 0.1f, 500.0f));
+        en.AddComponent(cameraEntity, Transform::LookAt(
+            eye,
+            glm::vec3(0.0f, 0.0f, 0.0f),
+            glm::vec3(0.0f, 1.0f, 0.0f)
+        ));
+        en.SetActiveCamera(cameraEntity);
+    }
+};
+
+// Many textured sprites sharing one texture: sprite batching and sorting.
+class SpriteStressScene : public StressSceneBase {
+public:
+    size_t m_count = 10000;
+
+    void SetupScene(okami::Engine& en) override {
+        using namespace okami;
+
+        auto textureHandle = en.LoadTexture(GetSampleAssetPath("test.ktx2"));
+        auto batch = en.CreateEntityBatch(m_count);
+        for (size_t i = 0; i < m_count; ++i) {
+            batch.Add(i, SpriteComponent{ textureHandle });
+            batch.Add(i, Transform(GridPosition(i, m_count, 0.2f), 1.0f / 512.0f));
+        }
+        en.SpawnBatch(batch);
+        AddLookAtCamera(en, glm::vec3(0.0f, 0.0f, 15.0f));
+    }
+};
+
+// Many static mesh instances of one geometry: culling and draw submission.
+class MeshStressScene : public StressSceneBase {
+public:
+    size_t m_count = 5000;
+
+    void SetupScene(okami::Engine& en) override {
+        using namespace okami;
+
+        auto geometryHandle = en.LoadGeometry(GetSampleAssetPath("box.glb"));
+        auto batch = en.CreateEntityBatch(m_count);
+        for (size_t i = 0; i < m_count; ++i) {
+            batch.Add(i, StaticMeshComponent{ geometryHandle });
+            batch.Add(i, Transform(GridPosition(i, m_count, 0.5f), 0.1f));
+        }
+        en.SpawnBatch(batch);
+        AddLookAtCamera(en, glm::vec3(0.0f, -10.0f, 30.0f));
+    }
+};
+
+// Every mesh is moved by a script each frame: the transform update message
+// path and the renderer's per-instance uploads.
+class TransformChurnScene : public StressSceneBase {
+public:
+    size_t m_count = 2000;
+
+    void SetupScene(okami::Engine& en) override {
+        using namespace okami;
+
+        auto geometryHandle = en.LoadGeometry(GetSampleAssetPath("box.glb"));
+        std::vector<entity_t> entities;
+        entities.reserve(m_count);
+        for (size_t i = 0; i < m_count; ++i) {
+            auto e = en.CreateEntity();
+            en.AddComponent(e, StaticMeshComponent{ geometryHandle });
+            en.AddComponent(e, Transform(GridPosition(i, m_count, 0.5f), 0.1f));
+            entities.push_back(e);
+        }
+        AddLookAtCamera(en, glm::vec3(0.0f, -10.0f, 25.0f));
+
+        en.AddScript([&en, entities = std::move(entities)](
+            JobContext& /*job*/,
+            In<Time> inTime,
+            Out<UpdateComponentSignal<Transform>> outTransform) -> Error {
+
+            auto const rotation = Transform::RotateZ(inTime->GetDeltaTimeF());
+            auto const& registry = en.GetRegistry();
+            for (auto e : entities) {
+                outTransform.Send(UpdateComponentSignal<Transform>{
+                    .m_entity    = e,
+                    .m_component = registry.get<Transform>(e) * rotation
+                });
+            }
+            return {};
+        }, "TransformChurn");
+    }
+};
+
+} // namespace benchmark_scenes
@@ -4,6 +4,9 @@
 #include "module.hpp"
 #include "paths.hpp"
 #include "entity_manager.hpp"
+#include "load_scheduler.hpp"
+#include "vfs.hpp"
+#include "resource_table.hpp"
 
 #include <filesystem>
 
@@ -18,16 +21,19 @@ namespace okami {
 	struct Resource {
 		typename T::Desc m_desc;
 		std::filesystem::path m_path;
-		entity_t m_entity = kNullEntity;
+		ResourceId m_id = kNullResource; // slot in the owning ContentModule
 		std::atomic<bool> m_loaded{ false };
 		std::atomic<int> m_refCount{ 0 };
+		// Raised when the resource is destroyed, so a load still queued for
+		// it is skipped. Made with the resource and never replaced.
+		LoadCancelFlag m_loadCancelled;
 	};
 
 	class IResourceDestroyer {
 	public:
 		virtual ~IResourceDestroyer() = default;
 
-		virtual void DestroyResource(entity_t id) = 0;
+		virtual void DestroyResource(ResourceId id) = 0;
 	};
 
     template <ResourceType T>
@@ -36,6 +42,17 @@ namespace okami {
 		Resource<T>* m_resource = nullptr;
 		IResourceDestroyer* m_destroyer = nullptr;
 
+		inline void Release() {
+			if (m_resource) {
+				// Read first: once the count is zero the resource may go
+				auto id = m_resource->m_id;
+				auto count = m_resource->m_refCount.fetch_sub(1, std::memory_order_relaxed);
+				if (count == 1 && m_destroyer) {
+					m_destroyer->DestroyResource(id);
+				}
+			}
+		}
+
 	public:
 		using desc_t = typename T::Desc;
 
@@ -57,9 +74,7 @@ namespace okami {
 		}
 		inline ResHandle& operator=(const ResHandle& other) {
 			if (this != &other) {
-				if (m_resource) {
-					m_resource->m_refCount.fetch_sub(1, std::memory_order_relaxed);
-				}
+				Release();
 				m_resource = other.m_resource;
 				m_destroyer = other.m_destroyer;
 				if (m_resource) {
@@ -69,12 +84,7 @@ namespace okami {
 			return *this;
 		}
 		inline ~ResHandle() {
-			if (m_resource) {
-				auto count = m_resource->m_refCount.fetch_sub(1, std::memory_order_relaxed);
-				if (count == 1 && m_destroyer) {
-					m_destroyer->DestroyResource(m_resource->m_entity);
-				}
-			}
+			Release();
 		}
 		desc_t const& operator*() const {
 			if (!m_resource || !m_resource->m_loaded.load(std::memory_order_acquire)) {
@@ -100,8 +110,8 @@ namespace okami {
 		inline operator bool() const {
 			return IsLoaded();
 		}
-		inline entity_t GetEntity() const {
-			return m_resource->m_entity;
+		inline ResourceId GetId() const {
+			return m_resource ? m_resource->m_id : kNullResource;
 		}
 	};
 
@@ -112,15 +122,36 @@ namespace okami {
         virtual ResHandle<T> Load(
 			const std::filesystem::path& path,
 			typename T::LoadParams params,
-			InterfaceCollection& mi) = 0;
+			InterfaceCollection& mi,
+			LoadPriority priority = {}) = 0;
         virtual ResHandle<T> Create(T&& data) = 0;
     };
 
+	// Reloads live assets whose files changed on disk; the engine calls it
+	// for each changed file when RunParams::hotReloadAssets is set. Assets
+	// keep their handles and swap in the new data once it has loaded, and
+	// keep the old data if the load fails.
+	class IAssetReloader {
+	public:
+		virtual ~IAssetReloader() = default;
+
+		// key is the VirtualFileSystem asset key of the changed file. Returns
+		// how many live assets were queued for reload. Thread safe.
+		virtual size_t ReloadAsset(
+			std::string_view key,
+			VirtualFileSystem const& fs,
+			InterfaceCollection& ic) = 0;
+	};
+
 	template <ResourceType T>
 	struct LoadResourceSignal {
 		std::filesystem::path m_path;
 		typename T::LoadParams m_params;
 		uint32_t m_id = 0;   // opaque correlation ID echoed back in OnResourceLoadedEvent
+		LoadPriority m_priority;
+		// Raised by the requester when the result is no longer wanted; the
+		// load is then skipped if it has not started. Null if not cancellable.
+		std::shared_ptr<std::atomic<bool> const> m_cancelled;
 	};
 
 	template <typename T>
@@ -145,24 +176,28 @@ namespace okami {
     class ContentModule : 
 		public IContentManager<T>,
 		public IResourceDestroyer,
+		public IAssetReloader,
 		public EngineModule {
     private:
-		// Maps a file path to a resource pointer
-		// Protected by a mutex because it may be accessed from multiple threads
-        std::mutex m_path_mtx;
-        std::unordered_map<std::filesystem::path, entity_t, PathHash> m_path_to_res;
+		struct PathEntry {
+			ResourceId m_id = kNullResource;
+			typename T::LoadParams m_params; // to load it again on reload
+		};
+
+		// Every resource and its implementation, by ID. Lookups don't lock,
+		// so renderers resolve handles without touching the registry.
+		ResourceTable<ResourceImplPair<T, TImpl>> m_resources;
+
+		// Maps a file path to its resource. Sharded, since Load is called
+		// from many threads; resources already requested only need a
+		// shared lock on their shard.
+		ResourcePathMap<PathEntry> m_paths;
 
 		// Consumes messages regarding newly loaded resources
 		// These are sent by the IO thread
 		DefaultSignalHandler<OnResourceLoadedEvent<T>> m_loaded_handler;
 
-		// Consumes messages regarding new resources to be created
-		DefaultSignalHandler<std::unique_ptr<ResourceImplPair<T, TImpl>>> m_new_resources;
-
-		DefaultSignalHandler<entity_t> m_destroy_resource_handler;
-
-		IEntityManager* m_entityManager = nullptr;
-		entt::registry const* m_registry = nullptr;
+		DefaultSignalHandler<ResourceId> m_destroy_resource_handler;
 
 	protected:
 		virtual Expected<std::pair<typename T::Desc, TImpl>> CreateResource(T&& data) = 0;
@@ -170,52 +205,48 @@ namespace okami {
 
 		Error RegisterImpl(InterfaceCollection& ic) override {
 			ic.Register<IContentManager<T>>(this);
+			ic.Register<IAssetReloader>(this);
 			ic.RegisterSignalHandler<OnResourceLoadedEvent<T>>(&m_loaded_handler);
 			return {};
 		}
 
         Error StartupImpl(InitContext const& ic) override {
-			m_registry = &ic.m_registry;
-			m_entityManager = ic.m_interfaces.Query<IEntityManager>();
-			OKAMI_ERROR_RETURN_IF(m_entityManager == nullptr, "ContentModule requires an IEntityManager to function");
 			return {};
 		}
-		
+
         void ShutdownImpl(InitContext const& ic) override {
-			{
-				std::lock_guard<std::mutex> lock(m_path_mtx);
-				m_path_to_res.clear();
-			}
+			m_paths.Clear();
 
 			m_loaded_handler.Clear();
-			m_new_resources.Clear();
+			m_destroy_resource_handler.Clear();
 		}
 
 	public:
-		using component_t = std::unique_ptr<ResourceImplPair<T, TImpl>>;
-
-		// Protected method to access implementation for derived classes
+		// Lock-free, and the slot stays put while the handle is held. A
+		// reload applied in ReceiveMessages destroys the old impl and
+		// assigns the new one in place, though, so the impl may only be
+		// used on the thread that runs ReceiveMessages, or while it isn't
+		// running.
 		TImpl* GetImpl(const ResHandle<T>& handle) const {
-			auto implPair = m_registry->template try_get<component_t>(handle.GetEntity());
+			auto implPair = m_resources.Get(handle.GetId());
 			if (implPair) {
-				return &(*implPair)->m_impl;
+				return &implPair->m_impl;
 			} else {
 				return nullptr;
 			}
 		}
 
-		void DestroyResource(entity_t id) override {
+		size_t GetResourceCount() const {
+			return m_resources.GetLiveCount();
+		}
+
+		void DestroyResource(ResourceId id) override {
 			m_destroy_resource_handler.Send(id);
 		}
 
 		Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override {
 			Error e;
 
-			// Move everything from the new resources queue to the Resource* -> Impl map
-			m_new_resources.Handle([&](component_t msg) {
-				params.m_registry.template emplace<component_t>(msg.get()->m_resource.m_entity, std::move(msg));
-			});
-
 			// Process all just loaded resources
 			m_loaded_handler.Handle([&](OnResourceLoadedEvent<T> msg) {
 				if (!msg.m_data) {
@@ -223,44 +254,57 @@ namespace okami {
 					return;
 				}
 
+				// Destroyed while it was loading
+				auto* implPair = m_resources.Get(msg.m_id);
+				if (!implPair) {
+					return;
+				}
+
 				auto result = CreateResource(std::move(*msg.m_data));
 				if (!result) {
 					e += result.error();
 					return;
 				}
 
-				auto* implPair = params.m_registry.template try_get<component_t>(static_cast<entity_t>(msg.m_id));
-				if (!implPair) {
-					e += OKAMI_ERROR("Loaded resource entity not found in registry");
-					return;
+				// Reloaded data replaces the old in place, so existing
+				// handles see it
+				if (implPair->m_resource.m_loaded.load(std::memory_order_acquire)) {
+					DestroyResourceImpl(implPair->m_impl);
 				}
-
-				implPair->get()->m_resource.m_desc = std::move(result->first);
-				implPair->get()->m_impl = std::move(result->second);
-				implPair->get()->m_resource.m_loaded.store(true, std::memory_order_release);
+				implPair->m_resource.m_desc = std::move(result->first);
+				implPair->m_impl = std::move(result->second);
+				implPair->m_resource.m_loaded.store(true, std::memory_order_release);
 			});
 
 			// Process all just destroyed resources
-			m_destroy_resource_handler.Handle([&](entity_t entity) {
-				auto* implPair = params.m_registry.template try_get<component_t>(entity);
-
+			m_destroy_resource_handler.Handle([&](ResourceId id) {
+				// Handles can drop to zero more than once before the first
+				// destroy runs; the later ones find the slot already freed
+				auto* implPair = m_resources.Get(id);
 				if (!implPair) {
-					e += OKAMI_ERROR("Trying to destroy resource with entity that not found in registry");
 					return;
 				}
 
-				std::filesystem::path path = implPair->get()->m_resource.m_path;
-				if (!path.empty()) {
-					std::lock_guard<std::mutex> lock(m_path_mtx);
-					if (implPair->get()->m_resource.m_refCount != 0) {
-						return; // Resource still has references, don't destroy yet
+				// Load hands out handles under the shard lock, so the count
+				// can't come back up once it is seen at zero here. The load
+				// is only cancelled then, with the path gone from the map,
+				// so no handle is ever left waiting on a skipped load.
+				auto& resource = implPair->m_resource;
+				if (!resource.m_path.empty()) {
+					auto& shard = m_paths.GetShard(resource.m_path);
+					std::unique_lock<std::shared_mutex> lock(shard.m_mutex);
+					if (resource.m_refCount.load(std::memory_order_relaxed) != 0) {
+						return; // Picked up again by Load, don't destroy
+					}
+					shard.m_map.erase(resource.m_path);
+					if (resource.m_loadCancelled) {
+						resource.m_loadCancelled->store(true, std::memory_order_release);
 					}
-					m_path_to_res.erase(path);
 				}
 
 				// Ask implementation to destroy the resource
-				DestroyResourceImpl(implPair->get()->m_impl);
-				params.m_registry.template erase<component_t>(entity);
+				DestroyResourceImpl(implPair->m_impl);
+				m_resources.Erase(id);
 			});
 
 			return e;
@@ -269,56 +313,93 @@ namespace okami {
 		ResHandle<T> Load(
 			const std::filesystem::path& path,
 			typename T::LoadParams params,
-			InterfaceCollection& ic) override {
-	
-			std::unique_ptr<ResourceImplPair<T, TImpl>> impl;
-			entity_t entity = kNullEntity;
+			InterfaceCollection& ic,
+			LoadPriority priority = {}) override {
 
+			// Entries leave the map, under the exclusive lock, before their
+			// slot is freed or their load cancelled; a resource found here
+			// whose handles all dropped is simply picked up again
+			auto& shard = m_paths.GetShard(path);
 			{
-				std::lock_guard<std::mutex> lock(m_path_mtx);
-				auto it = m_path_to_res.find(path);
-				if (it != m_path_to_res.end()) {
-					auto* implPair = m_registry->template try_get<component_t>(it->second);
-					return ResHandle<T>(&implPair->get()->m_resource, this);
-				}
-				else {
-					// Create a new resource with its implementation
-					entity = m_entityManager->CreateEntity();
-					impl = std::make_unique<ResourceImplPair<T, TImpl>>();
-					m_path_to_res.emplace_hint(it, path, impl->m_resource.m_entity);
+				std::shared_lock<std::shared_mutex> lock(shard.m_mutex);
+				auto it = shard.m_map.find(path);
+				if (it != shard.m_map.end()) {
+					return ResHandle<T>(&m_resources.Get(it->second.m_id)->m_resource, this);
 				}
 			}
-			
-			// Set resource path
-			impl->m_resource.m_path = path;
-			impl->m_resource.m_entity = entity;
 
-			auto res = ResHandle<T>(&impl->m_resource, this);
+			std::unique_lock<std::shared_mutex> lock(shard.m_mutex);
+			auto it = shard.m_map.find(path);
+			if (it != shard.m_map.end()) {
+				return ResHandle<T>(&m_resources.Get(it->second.m_id)->m_resource, this);
+			}
+
+			// Create a new resource with its implementation
+			auto [id, implPair] = m_resources.Emplace();
+			if (!implPair) {
+				OKAMI_LOG_ERROR("Too many resources in " + GetName());
+				return ResHandle<T>();
+			}
+			implPair->m_resource.m_path = path;
+			implPair->m_resource.m_id = id;
+			implPair->m_resource.m_loadCancelled = MakeLoadCancelFlag();
+			shard.m_map.emplace(path, PathEntry{ id, params });
+
+			auto res = ResHandle<T>(&implPair->m_resource, this);
+			lock.unlock();
 
 			// Ask IO thread to load the resource data
 			ic.SendSignal(LoadResourceSignal<T>{
 				.m_path = path,
 				.m_params = std::move(params),
-				.m_id = static_cast<uint32_t>(entity),
+				.m_id = id,
+				.m_priority = priority,
+				.m_cancelled = implPair->m_resource.m_loadCancelled,
 			});
-			m_new_resources.Send(std::move(impl));
-			
+
 			return res;
 		}
 
+		size_t ReloadAsset(
+			std::string_view key,
+			VirtualFileSystem const& fs,
+			InterfaceCollection& ic) override {
+			size_t count = 0;
+			m_paths.ForEach([&](std::filesystem::path const& path, PathEntry const& entry) {
+				if (fs.GetAssetKey(path) != key) {
+					return;
+				}
+				// A load still in flight reads the new file anyway
+				auto* implPair = m_resources.Get(entry.m_id);
+				if (!implPair || !implPair->m_resource.m_loaded.load(std::memory_order_acquire)) {
+					return;
+				}
+				ic.SendSignal(LoadResourceSignal<T>{
+					.m_path = path,
+					.m_params = entry.m_params,
+					.m_id = entry.m_id,
+					.m_priority = LoadPriority{ .m_urgency = LoadPriority::kUrgent },
+					.m_cancelled = implPair->m_resource.m_loadCancelled,
+				});
+				++count;
+			});
+			return count;
+		}
+
         ResHandle<T> Create(T&& data) override {
 			// Create a new resource with its implementation
-			auto entity = m_entityManager->CreateEntity();
-			auto impl = std::make_unique<ResourceImplPair<T, TImpl>>();
-
-			impl->m_resource.m_entity = entity;
+			auto [id, implPair] = m_resources.Emplace();
+			if (!implPair) {
+				OKAMI_LOG_ERROR("Too many resources in " + GetName());
+				return ResHandle<T>();
+			}
+			implPair->m_resource.m_id = id;
 
-			auto res = ResHandle<T>(&impl->m_resource, this);
+			auto res = ResHandle<T>(&implPair->m_resource, this);
 
-			m_new_resources.Send(std::move(impl));
 			m_loaded_handler.Send(OnResourceLoadedEvent<T>{
 				.m_data = std::move(data),
-				.m_id = static_cast<uint32_t>(entity),
+				.m_id = id,
 			});
 			return res;
 		}
@@ -328,4 +409,4 @@ namespace okami {
 			return "Content Module <" + std::string{typeName} + ">";
 		}
     };
-}
\ No newline at end of file
+}
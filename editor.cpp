@@ -4,11 +4,17 @@
 #include "meta.hpp"
 #include "transform.hpp"
 #include "entity_tree_view.hpp"
+#include "profiler.hpp"
+#include "renderer.hpp"
+#include "residency.hpp"
+#include "scene_query.hpp"
+#include "input.hpp"
 
 #include <entt/meta/resolve.hpp>
 #include <entt/meta/meta.hpp>
 #include <imgui.h>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/matrix.hpp>
 #include <glog/logging.h>
 
 #include <string>
@@ -43,6 +49,12 @@ class EditorModule final : public EngineModule {
     bool m_showScene     = false;
     bool m_showInspector = false;
     bool m_showContext   = false;
+    bool m_showProfiler  = false;
+    int  m_captureFrames = 1;
+
+    ISceneQuery const*   m_sceneQuery   = nullptr;
+    IRenderModule const* m_renderModule = nullptr;
+    IGPUResidency const* m_residency    = nullptr;
 
     // Draw one node and its subtree recursively.
     void DrawEntityNode(EntityTreeView const& tree,
@@ -94,6 +106,7 @@ class EditorModule final : public EngineModule {
             ImGui::MenuItem("Scene",     nullptr, &m_showScene);
             ImGui::MenuItem("Inspector", nullptr, &m_showInspector);
             ImGui::MenuItem("Context",   nullptr, &m_showContext);
+            ImGui::MenuItem("Profiler",  nullptr, &m_showProfiler);
             ImGui::EndMenu();
         }
 
@@ -448,9 +461,111 @@ class EditorModule final : public EngineModule {
         ImGui::End();
     }
 
+    // ── Profiler window ───────────────────────────────────────────────────────
+    void DrawProfilerWindow(entt::registry const& registry, Out<MessageCaptureTrace> captureTrace) {
+        if (!m_showProfiler) return;
+        ImGui::SetNextWindowSize({320, 280}, ImGuiCond_FirstUseEver);
+        if (!ImGui::Begin("Profiler", &m_showProfiler)) { ImGui::End(); return; }
+
+        if (auto* stats = registry.ctx().find<FrameStatsCtx>()) {
+            ImGui::Text("%-24s  %zu", "Frame", stats->m_frame);
+            ImGui::Text("%-24s  %.3f ms", "Frame time", stats->m_frameMs);
+            ImGui::Text("%-24s  %u", "Simulation steps", stats->m_simulationSteps);
+            ImGui::Text("%-24s  %.1f KiB", "Frame arena",
+                static_cast<double>(stats->m_frameArenaBytes) / 1024.0);
+            if constexpr (kAllocationTrackingEnabled) {
+                ImGui::Text("%-24s  %llu", "Allocations",
+                    static_cast<unsigned long long>(stats->m_allocations.m_count));
+                ImGui::Text("%-24s  %.1f KiB", "Allocated",
+                    static_cast<double>(stats->m_allocations.m_bytes) / 1024.0);
+            } else {
+                ImGui::TextDisabled("Allocation tracking not built in (OKAMI_TRACK_ALLOCATIONS)");
+            }
+        }
+
+        if (m_residency) {
+            auto const residency = m_residency->GetResidencyStats();
+            auto mib = [](uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+            ImGui::Separator();
+            if (residency.m_budgetBytes > 0) {
+                ImGui::Text("%-24s  %.1f / %.1f MiB%s", "GPU resident",
+                    mib(residency.GetResidentBytes()), mib(residency.m_budgetBytes),
+                    residency.IsOverBudget() ? " (over)" : "");
+            } else {
+                ImGui::Text("%-24s  %.1f MiB", "GPU resident", mib(residency.GetResidentBytes()));
+            }
+            ImGui::Text("%-24s  %.1f MiB (%u)", "Textures", mib(residency.m_textureBytes), residency.m_textureCount);
+            ImGui::Text("%-24s  %.1f MiB (%u)", "Geometry", mib(residency.m_geometryBytes), residency.m_geometryCount);
+            ImGui::Text("%-24s  %llu (%.1f MiB)", "Evictions",
+                static_cast<unsigned long long>(residency.m_evictions), mib(residency.m_evictedBytes));
+            ImGui::Text("%-24s  %llu", "Restores", static_cast<unsigned long long>(residency.m_restores));
+        }
+
+        ImGui::Separator();
+        ImGui::SliderInt("Frames", &m_captureFrames, 1, 120);
+        if (ImGui::Button("Capture trace")) {
+            captureTrace.Send(MessageCaptureTrace{ .m_frameCount = static_cast<uint32_t>(m_captureFrames) });
+        }
+
+        ImGui::End();
+    }
+
+    // ── Viewport picking ─────────────────────────────────────────────────────
+    // Selects the entity whose bounds are under a left click ImGui did not
+    // take, or clears the selection when the click hits nothing.
+    void PickEntity(entt::registry const& registry,
+                    In<MouseButtonMessage>& clicks,
+                    In<IOState>& io,
+                    In<DisplayState>& display) {
+        if (!m_sceneQuery || !m_renderModule || !io || !display) return;
+
+        bool clicked = false;
+        clicks.Handle([&](MouseButtonMessage const& msg) {
+            if (!msg.IsCaptured() && msg.m_button == MouseButton::Left && msg.m_action == Action::Press) {
+                clicked = true;
+            }
+        });
+        if (!clicked) return;
+
+        auto cameraEntity = m_renderModule->GetActiveCamera();
+        if (cameraEntity == kNullEntity || !registry.valid(cameraEntity)) return;
+        auto const* camera          = registry.try_get<Camera>(cameraEntity);
+        auto const* cameraTransform = registry.try_get<Transform>(cameraEntity);
+        auto const  windowSize      = display->m_windowSize;
+        if (!camera || !cameraTransform || windowSize.x <= 0 || windowSize.y <= 0) return;
+
+        auto const framebufferSize = display->m_framebufferSize;
+        glm::mat4 viewProj = camera->GetProjectionMatrix(framebufferSize.x, framebufferSize.y, false)
+            * cameraTransform->Inverse().AsMatrix();
+        glm::mat4 invViewProj = glm::inverse(viewProj);
+
+        glm::vec2 ndc{
+            2.0f * static_cast<float>(io->m_mouse.m_cursorX) / static_cast<float>(windowSize.x) - 1.0f,
+            1.0f - 2.0f * static_cast<float>(io->m_mouse.m_cursorY) / static_cast<float>(windowSize.y),
+        };
+        auto unproject = [&](float depth) {
+            glm::vec4 point = invViewProj * glm::vec4(ndc, depth, 1.0f);
+            return glm::vec3(point) / point.w;
+        };
+        auto nearPoint = unproject(-1.0f);
+        auto farPoint  = unproject(1.0f);
+
+        Ray ray{ nearPoint, glm::normalize(farPoint - nearPoint) };
+        SceneRayHit hit;
+        m_sceneQuery->Raycast({ &ray, 1 }, { &hit, 1 });
+
+        m_selectedEntity = hit.m_entity;
+        if (hit.m_entity != kNullEntity) {
+            m_showInspector = true;
+        }
+    }
+
 public:
     Error StartupImpl(InitContext const& con) override {
         auto& ctx = con.m_registry.ctx().emplace<EditorPropertiesCtx>(m_initialCtx);
+        m_sceneQuery   = con.m_interfaces.Query<ISceneQuery>();
+        m_renderModule = con.m_interfaces.Query<IRenderModule>();
+        m_residency    = con.m_interfaces.Query<IGPUResidency>();
         return {};
     }
 
@@ -458,16 +573,23 @@ public:
         graph.AddMessageNode(
             [this, &registry = params.m_registry](
                 JobContext&, Pipe<ImGuiContextObject>,
+                In<MouseButtonMessage> clicks,
+                In<IOState> io,
+                In<DisplayState> display,
                 Out<UpdateComponentMetaSignal> updateComponent,
-                Out<UpdateCtxMetaSignal> updateCtx) -> Error
+                Out<UpdateCtxMetaSignal> updateCtx,
+                Out<MessageCaptureTrace> captureTrace) -> Error
             {
                 auto* ctx = registry.ctx().find<EditorPropertiesCtx>();
                 if (!ctx || !ctx->b_showEditor) return {};
 
+                PickEntity(registry, clicks, io, display);
+
                 DrawMainMenuBar();
                 DrawEntityList(registry);
                 DrawInspector(registry, updateComponent);
                 DrawContextWindow(registry, updateCtx);
+                DrawProfilerWindow(registry, captureTrace);
                 return {};
             });
         return {};
@@ -13,6 +13,8 @@ namespace okami {
     //   "Scene"    — lists all alive entities; click to select one.
     //   "Inspector" — lists components on the selected entity by name,
     //                 with expanded detail for known component types.
+    // Left-clicking the viewport selects the entity under the cursor via
+    // ISceneQuery (SceneQueryModuleFactory).
     struct EditorModuleFactory {
         std::unique_ptr<EngineModule> operator()(EditorPropertiesCtx const& ctx) const;
     };
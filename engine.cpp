@@ -6,9 +6,17 @@
 #include "io.hpp"
 #include "meta.hpp"
 #include "paths.hpp"
+#include "profiler.hpp"
+#include "scene_query.hpp"
+#include "transform.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 
 #include <glog/logging.h>
 
@@ -39,6 +47,7 @@ Engine::Engine(EngineParams params) :
 
 	CreateModule(MetaDataModuleFactory{});
     CreateModule(EntityManagerFactory{}, std::ref(m_registry));
+    CreateModule(SceneQueryModuleFactory{});
     CreateModule(ConfigModuleFactory{});
 
 	CreateModule(TextureIOModuleFactory{});
@@ -62,6 +71,42 @@ entity_t Engine::CreateEntity(entity_t parent, std::string_view name) {
     }
 }
 
+EntityBatch Engine::CreateEntityBatch(size_t count, entity_t parent) {
+    if (!m_entityManager) {
+        throw std::runtime_error("No IEntityManager available in Engine. Call Startup first!");
+    }
+    return m_entityManager->CreateEntityBatch(count, parent);
+}
+
+void Engine::SpawnBatch(EntityBatch& batch) {
+    batch.Send(m_messages);
+}
+
+Error Engine::MountAssetPack(std::filesystem::path const& path) {
+	return m_fileSystem.Mount(path);
+}
+
+void Engine::ReloadChangedAssets(std::vector<FileChange> const& changes) {
+	for (auto const& change : changes) {
+		if (change.m_type == FileChangeType::Removed) {
+			continue; // Live assets keep what they last loaded
+		}
+		if (change.m_path.extension() == kAssetPackExtension) {
+			LOG(WARNING) << "Asset pack " << change.m_path << " changed; it is remounted on restart";
+			continue;
+		}
+
+		auto key = GetAssetPackKey(change.m_path);
+		size_t count = 0;
+		m_interfaces.ForEachInterface<IAssetReloader>([&](IAssetReloader* reloader) {
+			count += reloader->ReloadAsset(key, m_fileSystem, m_interfaces);
+		});
+		if (count > 0) {
+			LOG(INFO) << "Reloading " << key << " (" << count << " live)";
+		}
+	}
+}
+
 void Engine::RemoveEntity(entity_t entity) {
 	m_messages.Send(EntityRemoveMessage{entity});
 }
@@ -89,6 +134,15 @@ Error Engine::Startup() {
 	LOG(INFO) << "Starting Okami Engine";
 
 	m_interfaces.RegisterSignalHandler<SignalExit>(&m_exitHandler);
+	m_interfaces.Register<FrameAllocator>(&m_frameAllocator);
+	m_interfaces.Register<RenderSnapshotSchema>(&m_renderSnapshotSchema);
+	m_interfaces.Register<ILoadScheduler>(&m_loadScheduler);
+	m_interfaces.Register<VirtualFileSystem>(&m_fileSystem);
+
+	// Packs are optional; assets are read loose if there are none
+	if (auto e = m_fileSystem.MountAll(m_fileSystem.GetRoot()); e.IsError()) {
+		LOG(WARNING) << "Failed to mount asset packs: " << e;
+	}
 
 	auto initContext = GetInitContext();
 
@@ -213,6 +267,86 @@ public:
 	}
 };
 
+// Renders submitted snapshots in order on a dedicated thread. The render
+// modules are detached from the calling thread for the thread's lifetime
+// and attached back once it has drained and exited.
+class RenderThread {
+private:
+	std::function<void(bool)> m_attach;
+	std::function<void(entt::registry const&)> m_render;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<entt::registry const*> m_queue;
+	size_t m_inFlight = 0;
+	bool b_stop = false;
+
+	std::thread m_thread;
+
+	void ThreadMain() {
+		m_attach(true);
+		while (true) {
+			entt::registry const* snapshot = nullptr;
+			{
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock, [this] { return b_stop || !m_queue.empty(); });
+				if (m_queue.empty()) {
+					break;
+				}
+				snapshot = m_queue.front();
+				m_queue.pop_front();
+			}
+
+			m_render(*snapshot);
+
+			{
+				std::lock_guard lock(m_mutex);
+				--m_inFlight;
+			}
+			m_cv.notify_all();
+		}
+		m_attach(false);
+	}
+
+public:
+	// attach(true) takes the render modules' thread-affine state onto the
+	// calling thread and attach(false) releases it.
+	RenderThread(std::function<void(bool)> attach, std::function<void(entt::registry const&)> render) :
+		m_attach(std::move(attach)), m_render(std::move(render)) {
+		m_attach(false);
+		m_thread = std::thread([this] { ThreadMain(); });
+	}
+
+	OKAMI_NO_COPY(RenderThread);
+	OKAMI_NO_MOVE(RenderThread);
+
+	// Blocks until at most maxInFlight snapshots are queued or rendering
+	void WaitForFrames(size_t maxInFlight) {
+		std::unique_lock lock(m_mutex);
+		m_cv.wait(lock, [&] { return m_inFlight <= maxInFlight; });
+	}
+
+	// The snapshot must stay untouched until WaitForFrames says it is done
+	void Submit(entt::registry const& snapshot) {
+		{
+			std::lock_guard lock(m_mutex);
+			m_queue.push_back(&snapshot);
+			++m_inFlight;
+		}
+		m_cv.notify_all();
+	}
+
+	~RenderThread() {
+		{
+			std::lock_guard lock(m_mutex);
+			b_stop = true;
+		}
+		m_cv.notify_all();
+		m_thread.join();
+		m_attach(true);
+	}
+};
+
 void Engine::Run(RunParams params) {
 	bool shouldExit = false;
 
@@ -221,14 +355,61 @@ void Engine::Run(RunParams params) {
 
 	std::optional<size_t> maxFrames = params.frameCount;
 
+	// Pending trace capture; the path is kept until the last frame is written
+	std::optional<MessageCaptureTrace> traceCapture;
+	std::optional<MessageCaptureTrace> requestedCapture;
+	SetProfilerThreadName("Main");
+	auto const mainThread = std::this_thread::get_id();
+
+	m_loadScheduler.SetMaxLoadsPerFrame(params.maxLoadsPerFrame);
+
+	std::optional<FileWatcher> assetWatcher;
+	if (params.hotReloadAssets) {
+		assetWatcher.emplace(m_fileSystem.GetRoot());
+		if (assetWatcher->IsWatching()) {
+			LOG(INFO) << "Hot reloading assets under " << m_fileSystem.GetRoot();
+		} else {
+			LOG(WARNING) << "Cannot watch " << m_fileSystem.GetRoot() << "; assets will not hot reload";
+			assetWatcher.reset();
+		}
+	}
+
 	auto processIO = [&]() {
 		Error err;
+		// Reloads are queued ahead of this frame's IO
+		if (assetWatcher) {
+			ReloadChangedAssets(assetWatcher->Poll());
+		}
 		m_interfaces.ForEachInterface<IIOModule>([&](IIOModule* ioModule) {
 			err += ioModule->IOProcess(m_interfaces);
 		});
+
+		// Loads queued by the IO modules run nearest to the camera first
+		if (auto* renderModule = m_interfaces.Query<IRenderModule>()) {
+			auto camera = renderModule->GetActiveCamera();
+			if (m_registry.valid(camera)) {
+				if (auto const* transform = m_registry.try_get<Transform>(camera)) {
+					m_loadScheduler.SetViewPosition(transform->m_position);
+				}
+			}
+		}
+		m_loadScheduler.Process();
 		return err;
 	};
 
+	// Engine messages are picked up after every step, since the bus is
+	// cleared between steps, and acted on once per rendered frame
+	auto handleEngineMessages = [&]() {
+		m_messages.Handle<MessageExit>([&shouldExit](MessageExit const&) {
+			shouldExit = true;
+		});
+		m_messages.Handle<MessageCaptureTrace>([&requestedCapture](MessageCaptureTrace const& msg) {
+			if (!requestedCapture && msg.m_frameCount > 0) {
+				requestedCapture = msg;
+			}
+		});
+	};
+
 	auto processGUI = [&]() {
 		Error err;
 		m_interfaces.ForEachInterface<IGUIModule>([&](IGUIModule* guiModule) {
@@ -237,10 +418,10 @@ void Engine::Run(RunParams params) {
 		return err;
 	};
 
-	auto render = [&]() {
+	auto render = [&](entt::registry const& registry) {
 		Error err;
 		m_interfaces.ForEachInterface<IRenderModule>([&](IRenderModule* renderModule) {
-			err += renderModule->Render(m_registry);
+			err += renderModule->Render(registry);
 		});
 		return err;
 	};
@@ -262,50 +443,226 @@ void Engine::Run(RunParams params) {
 		}
 	}();
 
-	DefaultJobGraphExecutor executor;
+	// Fixed-step mode runs the update graph 0..N times per rendered frame and
+	// renders Transforms interpolated between the last two steps
+	std::optional<FixedStepClock> fixedStepClock;
+	if (params.fixedStep) {
+		if (*params.fixedStep > 0.0) {
+			fixedStepClock.emplace(*params.fixedStep, params.maxStepsPerFrame);
+		} else {
+			LOG(WARNING) << "Ignoring non-positive fixed step " << *params.fixedStep;
+		}
+	}
+	// Interpolated copy of the registry for fixed-step frames rendered on the main thread
+	entt::registry interpolatedSnapshot;
+
+	DefaultJobGraphExecutor executor{ &m_frameAllocator };
+
+	// Pipelined frames render snapshot N on the render thread while frame N+1
+	// simulates. Snapshots are used round-robin, one per frame in flight.
+	uint32_t const frameLatency = std::min(params.frameLatency, kMaxFrameLatency);
+	if (frameLatency != params.frameLatency) {
+		LOG(WARNING) << "Frame latency " << params.frameLatency << " clamped to " << kMaxFrameLatency;
+	}
+	std::vector<entt::registry> renderSnapshots(frameLatency);
+	std::optional<RenderThread> renderThread;
+	if (frameLatency > 0) {
+		renderThread.emplace(
+			[this, mainThread](bool attach) {
+				m_interfaces.ForEachInterface<IRenderModule>([attach](IRenderModule* renderModule) {
+					if (attach) {
+						renderModule->AttachRenderThread();
+					} else {
+						renderModule->DetachRenderThread();
+					}
+				});
+				if (attach && std::this_thread::get_id() != mainThread) {
+					SetProfilerThreadName("Render");
+					// Render frames do not line up with the engine's
+					m_frameAllocator.ClaimThreadArena();
+				}
+			},
+			[this](entt::registry const& snapshot) {
+				{
+					OKAMI_PROFILE_SCOPE("Render");
+					m_interfaces.ForEachInterface<IRenderModule>([&](IRenderModule* renderModule) {
+						if (auto err = renderModule->Render(snapshot); err.IsError()) {
+							LOG(ERROR) << "Render failed: " << err;
+						}
+					});
+				}
+				m_frameAllocator.ResetThreadArena();
+			});
+	}
 
 	while (!shouldExit) {
 		okami::Time time = frameTimeEstimator->GetTime();
 
+		// Closed manually before the trace is written below
+		std::optional<ProfileScope> frameScope;
+		frameScope.emplace("Frame");
+		auto const frameStart = std::chrono::steady_clock::now();
+		auto const frameStartAllocations = GetTotalAllocations();
+
 		// Clear message bus for this frame
 		m_messages.Clear();
 
-       	processIO();
-		render();
+		{
+			OKAMI_PROFILE_SCOPE("ProcessIO");
+			processIO();
+		}
+		if (!renderThread) {
+			OKAMI_PROFILE_SCOPE("Render");
+			if (fixedStepClock) {
+				m_renderSnapshotSchema.Extract(m_registry, interpolatedSnapshot);
+				InterpolateTransforms(m_registry, interpolatedSnapshot, fixedStepClock->GetAlpha());
+				render(interpolatedSnapshot);
+			} else {
+				render(m_registry);
+			}
+		}
 
 		// Check for exit conditions
 		if (maxFrames && frameTimeEstimator->GetTime().m_nextFrame >= *maxFrames) {
 			return;
 		}
 
-		// Execute the update job graph
-		JobGraph updateJobGraph;
-		BuildGraphParams graphParams{ .m_registry = m_registry };
-		m_modules.BuildGraph(updateJobGraph, graphParams);
+		uint32_t const steps = fixedStepClock ? fixedStepClock->Advance(time.m_deltaTime) : 1;
+		for (uint32_t step = 0; step < steps; ++step) {
+			if (params.inputReplay && params.inputReplay->IsFinished()) {
+				shouldExit = true;
+				break;
+			}
+			okami::Time const stepTime = fixedStepClock ? fixedStepClock->GetStepTime() : time;
+
+			// Each step sees only its own messages
+			if (step > 0) {
+				handleEngineMessages();
+				if (shouldExit) {
+					break;
+				}
+				m_messages.Clear();
+			}
+			if (fixedStepClock) {
+				SavePreviousTransforms(m_registry);
+			}
+
+			// Execute the update job graph
+			JobGraph updateJobGraph;
+			BuildGraphParams graphParams{ .m_registry = m_registry };
+			{
+				OKAMI_PROFILE_SCOPE("BuildGraph");
+				m_modules.BuildGraph(updateJobGraph, graphParams);
+			}
+
+			// Send messages for this step
+			{
+				OKAMI_PROFILE_SCOPE("SendMessages");
+				m_messages.Send(stepTime);
+				m_modules.SendMessages(m_messages);
+
+				// Recorded input stands in for the platform's
+				if (params.inputReplay) {
+					params.inputReplay->Apply(m_messages);
+				}
+				if (params.inputRecorder) {
+					params.inputRecorder->Capture(m_messages);
+				}
+			}
+
+			// Run GUI message pump if any, once per rendered frame
+			if (step == 0) {
+				OKAMI_PROFILE_SCOPE("ProcessGUI");
+				processGUI();
+			}
 
-		// Send messages for this frame
-		m_messages.Send(time);
-		m_modules.SendMessages(m_messages);
+			// Run the message processing graph for this step
+			{
+				OKAMI_PROFILE_SCOPE("Execute");
+				executor.Execute(updateJobGraph, m_messages);
+			}
 
-		// Run GUI message pump if any
-		processGUI();
+			// Receive messages after update, commit staged object changes
+			{
+				OKAMI_PROFILE_SCOPE("ReceiveMessages");
+				m_modules.ReceiveMessages(m_messages, receiveParams);
+			}
 
-		// Run the message processing graph for this frame
-		executor.Execute(updateJobGraph, m_messages);
+			if (fixedStepClock) {
+				fixedStepClock->Step();
+			}
+		}
+		if (steps == 0) {
+			OKAMI_PROFILE_SCOPE("ProcessGUI");
+			processGUI();
+		}
 
-		// Receive messages after update, commit staged object changes
-		m_modules.ReceiveMessages(m_messages, receiveParams);
+		if (renderThread) {
+			// Blocks here if rendering has fallen frameLatency frames behind
+			OKAMI_PROFILE_SCOPE("SubmitRender");
+			renderThread->WaitForFrames(frameLatency - 1);
+			auto& snapshot = renderSnapshots[time.m_nextFrame % frameLatency];
+			m_renderSnapshotSchema.Extract(m_registry, snapshot);
+			if (fixedStepClock) {
+				InterpolateTransforms(m_registry, snapshot, fixedStepClock->GetAlpha());
+			}
+			renderThread->Submit(snapshot);
+		}
 
 		// Frame timing
 		frameTimeEstimator->Step();
 
+		frameScope.reset();
+
+		m_registry.ctx().insert_or_assign(FrameStatsCtx{
+			.m_frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count(),
+			.m_allocations = GetTotalAllocations() - frameStartAllocations,
+			.m_frame = time.m_nextFrame,
+			.m_frameArenaBytes = m_frameAllocator.GetBytesUsed(),
+			.m_simulationSteps = steps,
+		});
+
+		if (params.frameCallback) {
+			params.frameCallback(frameTimeEstimator->GetTime());
+		}
+
 		if (m_exitHandler.FetchAndReset() > 0) {
 			shouldExit = true;
 		}
 
-		m_messages.Handle<MessageExit>([&shouldExit](MessageExit const&) { 
-			shouldExit = true; 
-		});
+		handleEngineMessages();
+
+		// Finish a running capture before starting a new one
+		if (traceCapture && --traceCapture->m_frameCount == 0) {
+			SetProfilerEnabled(false);
+			if (auto err = WriteChromeTrace(traceCapture->m_path); err.IsError()) {
+				LOG(ERROR) << "Failed to write frame trace: " << err;
+			} else {
+				LOG(INFO) << "Wrote frame trace to " << traceCapture->m_path;
+			}
+			traceCapture.reset();
+		}
+
+		if (requestedCapture && !traceCapture) {
+			traceCapture = requestedCapture;
+			ClearProfile();
+			SetProfilerEnabled(true);
+		}
+		requestedCapture.reset();
+
+		// Port storage lives in the frame arena, so it has to go first
+		m_messages.Release();
+		m_frameAllocator.Reset();
+	}
+
+	// Finish the frames still in flight before the trace is written
+	renderThread.reset();
+
+	if (traceCapture) {
+		SetProfilerEnabled(false);
+		if (auto err = WriteChromeTrace(traceCapture->m_path); err.IsError()) {
+			LOG(ERROR) << "Failed to write frame trace: " << err;
+		}
 	}
 }
 
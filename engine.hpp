@@ -8,8 +8,16 @@
 #include "content.hpp"
 #include "entity_manager.hpp"
 #include "jobs.hpp"
+#include "frame_allocator.hpp"
+#include "render_snapshot.hpp"
+#include "fixed_step.hpp"
+#include "input_recording.hpp"
+#include "load_scheduler.hpp"
+#include "vfs.hpp"
+#include "file_watcher.hpp"
 #include "material.hpp"
 #include "geometry.hpp"
+#include "profiler.hpp"
 
 namespace okami {
     struct SignalExit {};
@@ -27,8 +35,35 @@ namespace okami {
     struct RunParams {
         std::optional<size_t> frameCount = std::nullopt;
         std::optional<double> frameTime = std::nullopt;
+        // Called on the main thread after each completed frame, outside the
+        // profiled "Frame" scope.
+        std::function<void(Time const&)> frameCallback = nullptr;
+        // 0 renders on the main thread at the start of each frame. 1 or 2
+        // renders on a dedicated thread from a snapshot of the render state
+        // taken after ReceiveMessages, overlapping the following simulation;
+        // the value is how many frames rendering may fall behind.
+        uint32_t frameLatency = 0;
+        // When set, the update graph runs in fixed steps of this many seconds,
+        // as many times per rendered frame as the elapsed time calls for (up
+        // to maxStepsPerFrame; time beyond that is dropped). Renderers see
+        // each Transform interpolated between the last two steps.
+        std::optional<double> fixedStep = std::nullopt;
+        uint32_t maxStepsPerFrame = FixedStepClock::kDefaultMaxStepsPerFrame;
+        // Records the input of every update graph run; save it after Run returns
+        InputRecorder* inputRecorder = nullptr;
+        // Replaces platform input and time with a recording, one recorded
+        // frame per update graph run, and exits once the recording runs out
+        InputReplay* inputReplay = nullptr;
+        // Caps how many queued resource loads start per frame, nearest to
+        // the active camera first; 0 runs them all as soon as requested
+        uint32_t maxLoadsPerFrame = 0;
+        // Watches the asset directory and reloads live assets in place when
+        // their files change, e.g. as AssetBuilder --watch rebuilds them
+        bool hotReloadAssets = false;
     };
 
+    constexpr uint32_t kMaxFrameLatency = 2;
+
     class Engine final {
 	private:
 		EngineParams m_params;
@@ -36,10 +71,17 @@ namespace okami {
         EngineModule m_modules;
 
         InterfaceCollection m_interfaces;
-        MessageBus m_messages;
+        // Declared before the bus: port storage is allocated from it
+        FrameAllocator m_frameAllocator;
+        MessageBus m_messages{ &m_frameAllocator.GetSharedArena() };
+
+        RenderSnapshotSchema m_renderSnapshotSchema;
 
         CountSignalHandler<SignalExit> m_exitHandler;
 
+        LoadScheduler m_loadScheduler;
+        VirtualFileSystem m_fileSystem;
+
 		std::atomic<bool> m_shouldExit{ false };
 
         IEntityManager* m_entityManager = nullptr;
@@ -47,6 +89,8 @@ namespace okami {
         entt::registry m_registry;
 
         InitContext GetInitContext();
+        // Asks every IAssetReloader to reload assets read from changed files
+        void ReloadChangedAssets(std::vector<FileChange> const& changes);
 
 	public:
 		Error Startup();
@@ -55,6 +99,11 @@ namespace okami {
 
         entity_t CreateEntity(entity_t parent = kNullEntity,
             std::string_view name = {});
+        // Reserves count entities under parent for bulk spawning. Fill in the
+        // batch and pass it to SpawnBatch; like CreateEntity, the entities and
+        // their components appear once the frame's messages are processed.
+        EntityBatch CreateEntityBatch(size_t count, entity_t parent = kNullEntity);
+        void SpawnBatch(EntityBatch& batch);
         void RemoveEntity(entity_t entity);
         void SetActiveCamera(entity_t e);
 
@@ -74,13 +123,16 @@ namespace okami {
         }
 
         template <ResourceType T>
-        ResHandle<T> LoadResource(const std::filesystem::path& path, typename T::LoadParams params = {}) {
+        ResHandle<T> LoadResource(
+            const std::filesystem::path& path,
+            typename T::LoadParams params = {},
+            LoadPriority priority = {}) {
             auto* cm = m_interfaces.Query<IContentManager<T>>();
             if (!cm) {
                 OKAMI_LOG_ERROR("No IContentManager<" + std::string(typeid(T).name()) + "> registered in Engine");
                 return ResHandle<T>();
             }
-            return cm->Load(path, params, m_interfaces);
+            return cm->Load(path, params, m_interfaces, priority);
         }
 
         template <ResourceType T>
@@ -105,13 +157,14 @@ namespace okami {
 
         TextureHandle LoadTexture(
             std::filesystem::path const& path,
-            TextureLoadParams params = {}) {
+            TextureLoadParams params = {},
+            LoadPriority priority = {}) {
             auto* tm = m_interfaces.Query<ITextureManager>();
             if (!tm) {
                 OKAMI_LOG_ERROR("No ITextureManager registered in Engine");
                 return TextureHandle();
             }
-            return tm->LoadTexture(path, params, m_interfaces);
+            return tm->LoadTexture(path, params, m_interfaces, priority);
         }
 
         TextureHandle CreateTexture(Texture data) {
@@ -125,13 +178,14 @@ namespace okami {
 
         GeometryHandle LoadGeometry(
             std::filesystem::path const& path,
-            GeometryLoadParams params = {}) {
+            GeometryLoadParams params = {},
+            LoadPriority priority = {}) {
             auto* gm = m_interfaces.Query<IGeometryManager>();
             if (!gm) {
                 OKAMI_LOG_ERROR("No IGeometryManager registered in Engine");
                 return GeometryHandle();
             }
-            return gm->LoadGeometry(path, params, m_interfaces);
+            return gm->LoadGeometry(path, params, m_interfaces, priority);
         }
 
         GeometryHandle CreateGeometry(Geometry data) {
@@ -156,6 +210,11 @@ namespace okami {
                 name);
         }
 
+        // Mounts an asset pack over the asset directory; its assets shadow
+        // loose files and packs mounted before it. Any *.okpak in the asset
+        // directory is mounted at startup.
+        Error MountAssetPack(std::filesystem::path const& path);
+
         entt::registry const& GetRegistry() const { return m_registry; }
 
 		std::filesystem::path GetRenderOutputPath(size_t frameIndex);
@@ -1,8 +1,10 @@
 #include "entity_manager.hpp"
 #include <unordered_map>
 #include <iostream>
+#include <span>
 
 #include "common.hpp"
+#include "frame_allocator.hpp"
 #include "pool.hpp"
 
 #include <entt/entt.hpp>
@@ -12,6 +14,7 @@ using namespace okami;
 class EntityManager : public EngineModule, public IEntityManager {
 private:
     entt::registry& m_registry;
+    FrameAllocator* m_frameAllocator = nullptr;
 
 protected:
     Error RegisterImpl(InterfaceCollection& interfaces) override {
@@ -31,6 +34,8 @@ protected:
 		a.m_messages.EnsurePort<EntityParentChangeSignal>();
         a.m_messages.EnsurePort<EntityCreatedSignal>();
 
+        m_frameAllocator = a.m_interfaces.Query<FrameAllocator>();
+
 		return {};
 	}
     void ShutdownImpl(InitContext const&) override { }
@@ -78,6 +83,11 @@ protected:
             parentTree.m_lastChild = entity;
         };
 
+        // Batches can create many entities at once; grow the storage once
+        if (auto* created = bus.GetPort<EntityCreatedSignal>()) {
+            auto& storage = reg.storage<EntityTreeComponent>();
+            storage.reserve(storage.size() + created->m_messages.size());
+        }
         bus.Handle<EntityCreatedSignal>([this](EntityCreatedSignal const& msg) {
             m_registry.emplace<EntityTreeComponent>(msg.m_entity);
         });
@@ -89,10 +99,11 @@ protected:
             attachToParent(msg.m_entity, newParent);
         });
 
-        bus.Handle<EntityRemoveMessage>([this, &reg, &detachFromParent](EntityRemoveMessage const& msg) {
+        auto* scratch = GetFrameResource(m_frameAllocator);
+        bus.Handle<EntityRemoveMessage>([this, &reg, &detachFromParent, scratch](EntityRemoveMessage const& msg) {
             // Iterative post-order destruction: collect all descendants, then destroy bottom-up.
-            std::vector<entity_t> toDestroy;
-            std::vector<entity_t> stack = {msg.m_entity};
+            std::pmr::vector<entity_t> toDestroy(scratch);
+            std::pmr::vector<entity_t> stack({ msg.m_entity }, scratch);
             while (!stack.empty()) {
                 entity_t current = stack.back();
                 stack.pop_back();
@@ -124,6 +135,10 @@ public:
 		static_assert(ENTT_USE_ATOMIC, "EntityManager requires ENTT_USE_ATOMIC to be defined for thread-safe entity creation");
         return m_registry.create(); // Assumed atmoic
     }
+
+    void CreateEntities(std::span<entity_t> entities) override {
+        m_registry.create(entities.begin(), entities.end());
+    }
 };
 
 std::unique_ptr<EngineModule> EntityManagerFactory::operator()(entt::registry& registry) {
@@ -5,6 +5,11 @@
 
 #include <memory>
 #include <cstdint>
+#include <span>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
 #include <entt/entity/entity.hpp>
 
@@ -82,9 +87,100 @@ namespace okami
 		entity_t m_rootEntity = kNullEntity;
 	};
 
+	// Builds many entities at once. Get one from Engine::CreateEntityBatch,
+	// which reserves all the entity ids up front, fill in components and
+	// parents by index, then hand it to Engine::SpawnBatch. Each signal type
+	// reaches the bus as a single SendBatch, so adding a component costs a
+	// vector push rather than a port lookup and a lock.
+	class EntityBatch final {
+	public:
+		EntityBatch() = default;
+		EntityBatch(std::vector<entity_t> entities, entity_t parent)
+			: m_entities(std::move(entities)) {
+			m_parents.reserve(m_entities.size());
+			for (auto entity : m_entities) {
+				m_parents.push_back(EntityParentChangeSignal{ entity, parent });
+			}
+		}
+
+		OKAMI_NO_COPY(EntityBatch);
+		OKAMI_MOVE(EntityBatch);
+
+		inline size_t GetSize() const { return m_entities.size(); }
+		inline entity_t operator[](size_t index) const { return m_entities[index]; }
+		inline std::span<entity_t const> GetEntities() const { return m_entities; }
+
+		// Any entity works as a parent, including others from this batch
+		inline void SetParent(size_t index, entity_t parent) {
+			m_parents[index].m_newParent = parent;
+		}
+
+		inline void SetName(size_t index, std::string name) {
+			Add(index, NameComponent{ std::move(name) });
+		}
+
+		template <typename T>
+		void Add(size_t index, T component) {
+			GetBuffer<T>().m_signals.push_back(AddComponentSignal<T>{ m_entities[index], std::move(component) });
+		}
+
+		// Optional; avoids regrowing when most entities get a T
+		template <typename T>
+		void Reserve(size_t count) {
+			GetBuffer<T>().m_signals.reserve(count);
+		}
+
+		// Sends every signal of the batch and leaves it empty
+		void Send(MessageBus& bus) {
+			std::vector<EntityCreatedSignal> created;
+			created.reserve(m_entities.size());
+			for (auto entity : m_entities) {
+				created.push_back(EntityCreatedSignal{ entity });
+			}
+			bus.SendBatch<EntityCreatedSignal>(created);
+			bus.SendBatch<EntityParentChangeSignal>(m_parents);
+			for (auto& [type, buffer] : m_components) {
+				buffer->Send(bus);
+			}
+
+			m_entities.clear();
+			m_parents.clear();
+			m_components.clear();
+		}
+
+	private:
+		struct IComponentBuffer {
+			virtual ~IComponentBuffer() = default;
+			virtual void Send(MessageBus& bus) = 0;
+		};
+
+		template <typename T>
+		struct ComponentBuffer final : IComponentBuffer {
+			std::vector<AddComponentSignal<T>> m_signals;
+
+			void Send(MessageBus& bus) override {
+				bus.SendBatch<AddComponentSignal<T>>(m_signals);
+			}
+		};
+
+		std::vector<entity_t> m_entities;
+		std::vector<EntityParentChangeSignal> m_parents;
+		std::unordered_map<std::type_index, std::unique_ptr<IComponentBuffer>> m_components;
+
+		template <typename T>
+		ComponentBuffer<T>& GetBuffer() {
+			auto& buffer = m_components[typeid(T)];
+			if (!buffer) {
+				buffer = std::make_unique<ComponentBuffer<T>>();
+			}
+			return static_cast<ComponentBuffer<T>&>(*buffer);
+		}
+	};
+
     class IEntityManager {
 	private:
 		virtual entity_t CreateEntity() = 0;
+		virtual void CreateEntities(std::span<entity_t> entities) = 0;
 
     public:
 		inline entity_t CreateEntity(
@@ -97,6 +193,14 @@ namespace okami
 			return entity;
 		}
 
+		// Reserves the ids only; the batch sends the created and parent
+		// signals when it is spawned
+		inline EntityBatch CreateEntityBatch(size_t count, entity_t parent = kNullEntity) {
+			std::vector<entity_t> entities(count);
+			CreateEntities(entities);
+			return EntityBatch(std::move(entities), parent);
+		}
+
         inline void RemoveEntity(Out<EntityRemoveMessage> port, entity_t entity) {
 			port.Send(EntityRemoveMessage{entity});
 		}
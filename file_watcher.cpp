@@ -0,0 +1,270 @@
+#include "file_watcher.hpp"
+
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace okami;
+
+namespace fs = std::filesystem;
+
+namespace {
+	// Collects changes so that each path appears once
+	class ChangeList {
+	public:
+		void Add(fs::path const& path, FileChangeType type) {
+			auto [it, inserted] = m_index.emplace(path.generic_string(), m_changes.size());
+			if (inserted) {
+				m_changes.push_back(FileChange{ path, type });
+				return;
+			}
+
+			auto& previous = m_changes[it->second].m_type;
+			if (previous == FileChangeType::Added && type == FileChangeType::Modified) {
+				return;
+			}
+			if (previous == FileChangeType::Removed && type == FileChangeType::Added) {
+				previous = FileChangeType::Modified; // replaced
+				return;
+			}
+			previous = type;
+		}
+
+		std::vector<FileChange> Take() {
+			m_index.clear();
+			return std::move(m_changes);
+		}
+
+	private:
+		std::vector<FileChange> m_changes;
+		std::unordered_map<std::string, size_t> m_index;
+	};
+}
+
+#ifdef __linux__
+
+struct okami::FileWatcher::Impl {
+	static constexpr uint32_t kMask =
+		IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+	fs::path m_root;
+	int m_fd = -1;
+	std::unordered_map<int, fs::path> m_watches; // watch descriptor -> directory relative to root
+	// Created but not yet closed after writing
+	std::unordered_set<std::string> m_created;
+	ChangeList m_changes;
+
+	explicit Impl(fs::path root) : m_root(std::move(root)) {
+		m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_fd >= 0) {
+			AddWatches({}, false);
+		}
+	}
+
+	~Impl() {
+		if (m_fd >= 0) {
+			close(m_fd);
+		}
+	}
+
+	// Watches a directory and everything below it. Files already inside a
+	// directory that appeared after startup are reported as added, since
+	// their events were missed while the watch was being set up.
+	void AddWatches(fs::path const& relDir, bool reportFiles) {
+		auto dir = relDir.empty() ? m_root : m_root / relDir;
+		int wd = inotify_add_watch(m_fd, dir.c_str(), kMask | IN_ONLYDIR);
+		if (wd < 0) {
+			return;
+		}
+		m_watches[wd] = relDir;
+
+		std::error_code ec;
+		for (auto const& entry : fs::directory_iterator(dir, ec)) {
+			auto rel = relDir / entry.path().filename();
+			if (entry.is_directory(ec)) {
+				AddWatches(rel, reportFiles);
+			} else if (reportFiles && entry.is_regular_file(ec)) {
+				m_changes.Add(rel, FileChangeType::Added);
+			}
+		}
+	}
+
+	void ReadEvents() {
+		alignas(inotify_event) char buffer[16 * 1024];
+		while (true) {
+			auto length = read(m_fd, buffer, sizeof(buffer));
+			if (length <= 0) {
+				return; // EAGAIN once the queue is empty
+			}
+
+			for (char const* ptr = buffer; ptr < buffer + length;) {
+				auto const* event = reinterpret_cast<inotify_event const*>(ptr);
+				ptr += sizeof(inotify_event) + event->len;
+				HandleEvent(*event);
+			}
+		}
+	}
+
+	void HandleEvent(inotify_event const& event) {
+		if (event.mask & IN_IGNORED) {
+			m_watches.erase(event.wd);
+			return;
+		}
+		auto it = m_watches.find(event.wd);
+		if (it == m_watches.end() || event.len == 0) {
+			return;
+		}
+		auto rel = it->second / event.name;
+
+		if (event.mask & IN_ISDIR) {
+			if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+				AddWatches(rel, true);
+			}
+			return;
+		}
+
+		auto key = rel.generic_string();
+		if (event.mask & IN_CREATE) {
+			m_created.insert(key);
+		} else if (event.mask & IN_CLOSE_WRITE) {
+			bool created = m_created.erase(key) > 0;
+			m_changes.Add(rel, created ? FileChangeType::Added : FileChangeType::Modified);
+		} else if (event.mask & IN_MOVED_TO) {
+			m_changes.Add(rel, FileChangeType::Added);
+		} else if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+			m_created.erase(key);
+			m_changes.Add(rel, FileChangeType::Removed);
+		}
+	}
+
+	std::vector<FileChange> Poll() {
+		if (m_fd >= 0) {
+			ReadEvents();
+		}
+		return m_changes.Take();
+	}
+
+	std::vector<FileChange> Wait(std::chrono::milliseconds timeout) {
+		auto changes = Poll();
+		if (!changes.empty() || m_fd < 0) {
+			return changes;
+		}
+		pollfd pfd{ m_fd, POLLIN, 0 };
+		::poll(&pfd, 1, static_cast<int>(timeout.count()));
+		return Poll();
+	}
+
+	bool IsWatching() const {
+		return !m_watches.empty();
+	}
+};
+
+#else
+
+struct okami::FileWatcher::Impl {
+	struct FileState {
+		fs::file_time_type m_writeTime;
+		uintmax_t m_size = 0;
+	};
+	using Snapshot = std::unordered_map<std::string, FileState>;
+
+	fs::path m_root;
+	Snapshot m_snapshot;
+	std::chrono::steady_clock::time_point m_lastScan;
+	bool b_valid = false;
+
+	explicit Impl(fs::path root) : m_root(std::move(root)) {
+		std::error_code ec;
+		b_valid = fs::is_directory(m_root, ec);
+		m_snapshot = Scan();
+		m_lastScan = std::chrono::steady_clock::now();
+	}
+
+	Snapshot Scan() const {
+		Snapshot result;
+		std::error_code ec;
+		auto options = fs::directory_options::skip_permission_denied;
+		for (fs::recursive_directory_iterator it(m_root, options, ec), end; !ec && it != end; it.increment(ec)) {
+			std::error_code fileEc;
+			if (!it->is_regular_file(fileEc)) {
+				continue;
+			}
+			FileState state{ it->last_write_time(fileEc), it->file_size(fileEc) };
+			if (!fileEc) {
+				result.emplace(it->path().lexically_relative(m_root).generic_string(), state);
+			}
+		}
+		return result;
+	}
+
+	std::vector<FileChange> Poll() {
+		auto now = std::chrono::steady_clock::now();
+		if (!b_valid || now - m_lastScan < kPollInterval) {
+			return {};
+		}
+		m_lastScan = now;
+
+		ChangeList changes;
+		auto snapshot = Scan();
+		for (auto const& [path, state] : snapshot) {
+			auto it = m_snapshot.find(path);
+			if (it == m_snapshot.end()) {
+				changes.Add(path, FileChangeType::Added);
+			} else if (it->second.m_writeTime != state.m_writeTime || it->second.m_size != state.m_size) {
+				changes.Add(path, FileChangeType::Modified);
+			}
+		}
+		for (auto const& [path, state] : m_snapshot) {
+			if (!snapshot.count(path)) {
+				changes.Add(path, FileChangeType::Removed);
+			}
+		}
+		m_snapshot = std::move(snapshot);
+		return changes.Take();
+	}
+
+	std::vector<FileChange> Wait(std::chrono::milliseconds timeout) {
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (true) {
+			auto changes = Poll();
+			auto now = std::chrono::steady_clock::now();
+			if (!changes.empty() || !b_valid || now >= deadline) {
+				return changes;
+			}
+			auto nextScan = m_lastScan + kPollInterval;
+			std::this_thread::sleep_until(std::min<std::chrono::steady_clock::time_point>(nextScan, deadline));
+		}
+	}
+
+	bool IsWatching() const {
+		return b_valid;
+	}
+};
+
+#endif
+
+okami::FileWatcher::FileWatcher(fs::path root) :
+	m_root(std::move(root)), m_impl(std::make_unique<Impl>(m_root)) {
+}
+
+okami::FileWatcher::~FileWatcher() = default;
+
+std::vector<FileChange> okami::FileWatcher::Poll() {
+	return m_impl->Poll();
+}
+
+std::vector<FileChange> okami::FileWatcher::Wait(std::chrono::milliseconds timeout) {
+	return m_impl->Wait(timeout);
+}
+
+bool okami::FileWatcher::IsWatching() const {
+	return m_impl->IsWatching();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Shared by the engine and AssetBuilder, so this header sticks to C++17.
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace okami {
+	enum class FileChangeType {
+		Added,
+		Modified,
+		Removed,
+	};
+
+	struct FileChange {
+		std::filesystem::path m_path; // relative to the watched root
+		FileChangeType m_type = FileChangeType::Modified;
+	};
+
+	// Reports changes to regular files anywhere under a directory. Uses
+	// inotify on Linux, where a file counts as modified once it is closed
+	// after writing or renamed into place, so half-written files are never
+	// reported. Elsewhere the tree is rescanned for changed sizes and write
+	// times, at most every kPollInterval.
+	//
+	// Not thread safe; poll from one thread.
+	class FileWatcher {
+	public:
+		static constexpr std::chrono::milliseconds kPollInterval{ 500 };
+
+		explicit FileWatcher(std::filesystem::path root);
+		~FileWatcher();
+		FileWatcher(FileWatcher const&) = delete;
+		FileWatcher& operator=(FileWatcher const&) = delete;
+
+		// Changes since the last call, without blocking. Each path is
+		// reported once, with its latest change; a file added and then
+		// modified is still reported as added.
+		std::vector<FileChange> Poll();
+		// Like Poll, but waits up to timeout for the first change
+		std::vector<FileChange> Wait(std::chrono::milliseconds timeout);
+
+		// False if the root could not be watched
+		bool IsWatching() const;
+		std::filesystem::path const& GetRoot() const { return m_root; }
+
+	private:
+		struct Impl;
+
+		std::filesystem::path m_root;
+		std::unique_ptr<Impl> m_impl;
+	};
+}
@@ -0,0 +1,69 @@
+#include "fixed_step.hpp"
+
+#include <algorithm>
+
+using namespace okami;
+
+okami::FixedStepClock::FixedStepClock(double step, uint32_t maxStepsPerFrame) :
+	m_step(step), m_maxStepsPerFrame(std::max<uint32_t>(maxStepsPerFrame, 1)) {
+	OKAMI_ASSERT(step > 0.0, "Fixed step must be positive");
+}
+
+uint32_t okami::FixedStepClock::Advance(double frameDelta) {
+	m_accumulated += std::max(frameDelta, 0.0);
+
+	// Frame deltas that are exact multiples of the step should not lose a
+	// step to rounding, so allow a tiny shortfall
+	double const epsilon = m_step * 1e-6;
+	auto steps = static_cast<uint64_t>((m_accumulated + epsilon) / m_step);
+
+	if (steps > m_maxStepsPerFrame) {
+		double const kept = m_maxStepsPerFrame * m_step;
+		m_droppedTime += m_accumulated - kept;
+		m_accumulated = kept;
+		steps = m_maxStepsPerFrame;
+	}
+	return static_cast<uint32_t>(steps);
+}
+
+Time okami::FixedStepClock::GetStepTime() const {
+	return Time{
+		.m_deltaTime = m_step,
+		.m_nextFrameTime = (m_nextStep + 1) * m_step,
+		.m_lastFrameTime = m_nextStep * m_step,
+		.m_nextFrame = m_nextStep
+	};
+}
+
+void okami::FixedStepClock::Step() {
+	++m_nextStep;
+	m_accumulated = std::max(m_accumulated - m_step, 0.0);
+}
+
+float okami::FixedStepClock::GetAlpha() const {
+	return static_cast<float>(std::clamp(m_accumulated / m_step, 0.0, 1.0));
+}
+
+void okami::SavePreviousTransforms(entt::registry& registry) {
+	for (auto [entity, transform] : registry.view<Transform>().each()) {
+		if (auto* previous = registry.try_get<PreviousTransform>(entity)) {
+			previous->m_transform = transform;
+		} else {
+			registry.emplace<PreviousTransform>(entity, transform);
+		}
+	}
+}
+
+void okami::InterpolateTransforms(entt::registry const& src, entt::registry& dst, float alpha) {
+	if (alpha >= 1.0f) {
+		return;
+	}
+	for (auto [entity, previous] : src.view<PreviousTransform>().each()) {
+		if (!dst.valid(entity)) {
+			continue;
+		}
+		if (auto* transform = dst.try_get<Transform>(entity)) {
+			*transform = Lerp(previous.m_transform, *transform, alpha);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "module.hpp"
+#include "transform.hpp"
+
+#include <cstdint>
+
+#include <entt/entity/registry.hpp>
+
+namespace okami {
+	// Splits rendered frame time into fixed simulation steps. Each rendered
+	// frame adds its duration with Advance() and then simulates the returned
+	// number of steps, which may be zero when rendering runs faster than the
+	// simulation. Time that would take more than maxStepsPerFrame steps to
+	// catch up on is dropped, so a frame that falls behind slows the
+	// simulation down rather than making the next frame slower still.
+	class FixedStepClock final {
+	public:
+		static constexpr uint32_t kDefaultMaxStepsPerFrame = 4;
+
+		explicit FixedStepClock(double step, uint32_t maxStepsPerFrame = kDefaultMaxStepsPerFrame);
+
+		// Adds frameDelta seconds and returns how many steps are due now
+		uint32_t Advance(double frameDelta);
+
+		// Time handed to the update graph for the next step
+		Time GetStepTime() const;
+		// Marks one due step as simulated
+		void Step();
+
+		// How far rendering is between the last two simulated steps, in [0, 1]
+		float GetAlpha() const;
+
+		inline double GetStep() const { return m_step; }
+		inline size_t GetStepCount() const { return m_nextStep; }
+		// Total seconds dropped by the catch-up limit
+		inline double GetDroppedTime() const { return m_droppedTime; }
+
+	private:
+		double m_step;
+		uint32_t m_maxStepsPerFrame;
+		double m_accumulated = 0.0;
+		double m_droppedTime = 0.0;
+		size_t m_nextStep = 0;
+	};
+
+	// Transform as of the previous simulation step. The engine keeps it up to
+	// date in fixed-step mode so renderers can be handed a Transform blended
+	// between the last two steps. Removing it makes the entity snap to its
+	// current Transform for a frame, e.g. after a teleport.
+	struct PreviousTransform {
+		Transform m_transform;
+	};
+
+	// Copies every Transform into its PreviousTransform; called before each step
+	void SavePreviousTransforms(entt::registry& registry);
+
+	// Overwrites the Transforms in dst, a render snapshot of src, with the
+	// blend from src's PreviousTransform (alpha = 0) to its Transform (alpha = 1).
+	void InterpolateTransforms(entt::registry const& src, entt::registry& dst, float alpha);
+}
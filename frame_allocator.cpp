@@ -0,0 +1,153 @@
+#include "frame_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+using namespace okami;
+
+okami::FrameArena::FrameArena(size_t blockSize) : m_blockSize(std::max<size_t>(blockSize, 256)) {
+}
+
+void okami::FrameArena::AddBlock(size_t minSize) {
+	Block block;
+	block.m_size = std::max(m_blockSize, minSize);
+	block.m_data = std::make_unique_for_overwrite<std::byte[]>(block.m_size);
+	m_blocks.emplace_back(std::move(block));
+}
+
+void* okami::FrameArena::do_allocate(size_t bytes, size_t alignment) {
+	bytes = std::max<size_t>(bytes, 1);
+
+	while (true) {
+		if (m_currentBlock < m_blocks.size()) {
+			auto& block = m_blocks[m_currentBlock];
+			auto base = reinterpret_cast<uintptr_t>(block.m_data.get());
+			auto aligned = (base + m_offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+			auto end = aligned - base + bytes;
+			if (end <= block.m_size) {
+				m_bytesUsed += end - m_offset;
+				m_offset = end;
+				return reinterpret_cast<void*>(aligned);
+			}
+			if (m_currentBlock + 1 < m_blocks.size()) {
+				++m_currentBlock;
+				m_offset = 0;
+				continue;
+			}
+		}
+
+		// Out of space; the padding keeps over-aligned requests in bounds
+		AddBlock(bytes + alignment);
+		m_currentBlock = m_blocks.size() - 1;
+		m_offset = 0;
+	}
+}
+
+void okami::FrameArena::Reset() {
+	m_peakBytesUsed = std::max(m_peakBytesUsed, m_bytesUsed);
+
+	if (m_blocks.size() > 1) {
+		auto capacity = GetCapacity();
+		m_blocks.clear();
+		AddBlock(capacity);
+	}
+
+	m_currentBlock = 0;
+	m_offset = 0;
+	m_bytesUsed = 0;
+}
+
+size_t okami::FrameArena::GetCapacity() const {
+	size_t capacity = 0;
+	for (auto const& block : m_blocks) {
+		capacity += block.m_size;
+	}
+	return capacity;
+}
+
+okami::SharedFrameArena::SharedFrameArena(size_t blockSize) : m_arena(blockSize) {
+}
+
+void* okami::SharedFrameArena::do_allocate(size_t bytes, size_t alignment) {
+	std::lock_guard lock(m_mutex);
+	return m_arena.allocate(bytes, alignment);
+}
+
+void okami::SharedFrameArena::Reset() {
+	std::lock_guard lock(m_mutex);
+	m_arena.Reset();
+}
+
+size_t okami::SharedFrameArena::GetBytesUsed() const {
+	std::lock_guard lock(m_mutex);
+	return m_arena.GetBytesUsed();
+}
+
+size_t okami::SharedFrameArena::GetPeakBytesUsed() const {
+	std::lock_guard lock(m_mutex);
+	return m_arena.GetPeakBytesUsed();
+}
+
+namespace {
+	std::atomic<uint64_t> g_frameAllocatorId{ 1 };
+
+	// Last arena handed out on this thread. Keyed by allocator id rather than
+	// address so a new allocator at a recycled address never sees a stale arena.
+	struct ThreadArenaCache {
+		uint64_t m_owner = 0;
+		FrameArena* m_arena = nullptr;
+	};
+	thread_local ThreadArenaCache t_arenaCache;
+}
+
+okami::FrameAllocator::FrameAllocator() : m_id(g_frameAllocatorId++) {
+}
+
+okami::FrameAllocator::~FrameAllocator() = default;
+
+FrameArena& okami::FrameAllocator::GetThreadArena() {
+	if (t_arenaCache.m_owner == m_id) {
+		return *t_arenaCache.m_arena;
+	}
+
+	std::lock_guard lock(m_mutex);
+	auto& entry = m_threadArenas[std::this_thread::get_id()];
+	if (!entry.m_arena) {
+		entry.m_arena = std::make_unique<FrameArena>();
+	}
+	t_arenaCache = { m_id, entry.m_arena.get() };
+	return *entry.m_arena;
+}
+
+void okami::FrameAllocator::Reset() {
+	std::lock_guard lock(m_mutex);
+	for (auto& [thread, entry] : m_threadArenas) {
+		if (!entry.b_claimed) {
+			entry.m_arena->Reset();
+		}
+	}
+	m_shared.Reset();
+}
+
+void okami::FrameAllocator::ClaimThreadArena() {
+	GetThreadArena();
+	std::lock_guard lock(m_mutex);
+	m_threadArenas[std::this_thread::get_id()].b_claimed = true;
+}
+
+void okami::FrameAllocator::ResetThreadArena() {
+	// Only the owning thread allocates from it, so no lock is needed here
+	GetThreadArena().Reset();
+}
+
+size_t okami::FrameAllocator::GetBytesUsed() const {
+	std::lock_guard lock(m_mutex);
+	size_t bytes = m_shared.GetBytesUsed();
+	for (auto const& [thread, entry] : m_threadArenas) {
+		if (!entry.b_claimed) {
+			bytes += entry.m_arena->GetBytesUsed();
+		}
+	}
+	return bytes;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace okami {
+	// Bump allocator for data that lives for at most one frame. Allocation is
+	// a pointer bump; deallocation is a no-op and everything is released at
+	// once by Reset(). Not thread safe: use one arena per thread (see
+	// FrameAllocator::GetThreadArena) or SharedFrameArena.
+	//
+	// Derives from std::pmr::memory_resource so existing containers can opt in
+	// by switching to their std::pmr:: alias and passing the arena in.
+	class FrameArena final : public std::pmr::memory_resource {
+	public:
+		static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+		explicit FrameArena(size_t blockSize = kDefaultBlockSize);
+
+		OKAMI_NO_COPY(FrameArena);
+		OKAMI_NO_MOVE(FrameArena);
+
+		// Invalidates every allocation made since the last reset. If the frame
+		// spilled into more than one block, the blocks are merged into one big
+		// enough for the whole frame so steady-state frames never hit the heap.
+		void Reset();
+
+		// Bytes handed out since the last reset, including alignment padding.
+		inline size_t GetBytesUsed() const { return m_bytesUsed; }
+		// Largest GetBytesUsed() seen at any reset.
+		inline size_t GetPeakBytesUsed() const { return m_peakBytesUsed; }
+		// Bytes currently reserved from the heap.
+		size_t GetCapacity() const;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		struct Block {
+			std::unique_ptr<std::byte[]> m_data;
+			size_t m_size = 0;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_blockSize;
+		size_t m_currentBlock = 0;
+		size_t m_offset = 0;
+		size_t m_bytesUsed = 0;
+		size_t m_peakBytesUsed = 0;
+
+		void AddBlock(size_t minSize);
+	};
+
+	// FrameArena behind a mutex, for storage written from several threads at
+	// once such as message ports.
+	class SharedFrameArena final : public std::pmr::memory_resource {
+	public:
+		explicit SharedFrameArena(size_t blockSize = FrameArena::kDefaultBlockSize);
+
+		void Reset();
+		size_t GetBytesUsed() const;
+		size_t GetPeakBytesUsed() const;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		mutable std::mutex m_mutex;
+		FrameArena m_arena;
+	};
+
+	// Owns the frame arenas: one per thread that asks for one, plus a shared
+	// arena. The engine owns one of these and resets it once every frame has
+	// finished with its messages, so nothing allocated from it may be kept
+	// past the end of the frame it was allocated in.
+	class FrameAllocator final {
+	public:
+		FrameAllocator();
+		~FrameAllocator();
+
+		OKAMI_NO_COPY(FrameAllocator);
+		OKAMI_NO_MOVE(FrameAllocator);
+
+		// The calling thread's arena. The first call on a thread takes a lock;
+		// later calls are a thread-local lookup.
+		FrameArena& GetThreadArena();
+
+		SharedFrameArena& GetSharedArena() { return m_shared; }
+
+		// Resets every arena not claimed with ClaimThreadArena(). Must not race
+		// with allocations, i.e. call it between frames.
+		void Reset();
+
+		// Takes the calling thread's arena out of Reset(); the thread resets it
+		// itself with ResetThreadArena(). For threads whose frames do not line
+		// up with the engine's, such as the render thread.
+		void ClaimThreadArena();
+		void ResetThreadArena();
+
+		// Bytes used this frame across the shared and unclaimed arenas.
+		size_t GetBytesUsed() const;
+
+	private:
+		uint64_t m_id;
+		mutable std::mutex m_mutex;
+		struct ThreadArena {
+			std::unique_ptr<FrameArena> m_arena;
+			bool b_claimed = false;
+		};
+		std::unordered_map<std::thread::id, ThreadArena> m_threadArenas;
+		SharedFrameArena m_shared;
+	};
+
+	// Resource for per-frame scratch data: the thread's frame arena when a
+	// frame allocator is available, otherwise the regular heap.
+	inline std::pmr::memory_resource* GetFrameResource(FrameAllocator* allocator) {
+		return allocator ? static_cast<std::pmr::memory_resource*>(&allocator->GetThreadArena())
+			: std::pmr::new_delete_resource();
+	}
+}
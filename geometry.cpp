@@ -1,4 +1,5 @@
 #include "geometry.hpp"
+#include "vfs.hpp"
 #include <tiny_gltf.h>
 #include <filesystem>
 #include <algorithm>
@@ -10,6 +11,7 @@
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
+#include <limits>
 #include <numeric>
 
 using namespace okami;
@@ -235,28 +237,40 @@ Attribute const* GeometryPrimitiveDesc::TryGetAttribute(AttributeType type) cons
 }
 
 Expected<Geometry> Geometry::LoadGLTF(std::filesystem::path const& path) {
-    Geometry result;
-
-    // Check if file exists and has correct extension
+    // Check if file exists
     OKAMI_UNEXPECTED_RETURN_IF(!std::filesystem::exists(path), 
         "File does not exist: " + path.string());
-    
+
+    auto data = ReadFileBytes(path);
+    OKAMI_UNEXPECTED_RETURN(data);
+    return LoadGLTF(*data, path);
+}
+
+Expected<Geometry> Geometry::LoadGLTF(std::span<uint8_t const> data, std::filesystem::path const& path) {
+    Geometry result;
+
+    // Check file has correct extension
     auto extension = path.extension().string();
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
     OKAMI_UNEXPECTED_RETURN_IF(extension != ".glb" && extension != ".gltf", 
         "Unsupported file format: " + extension);
+    OKAMI_UNEXPECTED_RETURN_IF(data.size() > std::numeric_limits<unsigned int>::max(),
+        "GLTF file is too large: " + path.string());
 
-    // Load GLTF model
+    // Load GLTF model. External buffers are resolved next to the path.
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
     std::string err;
     std::string warn;
+    auto baseDir = path.parent_path().string();
 
     bool ret;
     if (extension == ".glb") {
-        ret = loader.LoadBinaryFromFile(&model, &err, &warn, path.string());
+        ret = loader.LoadBinaryFromMemory(&model, &err, &warn,
+            data.data(), static_cast<unsigned int>(data.size()), baseDir);
     } else {
-        ret = loader.LoadASCIIFromFile(&model, &err, &warn, path.string());
+        ret = loader.LoadASCIIFromString(&model, &err, &warn,
+            reinterpret_cast<char const*>(data.data()), static_cast<unsigned int>(data.size()), baseDir);
     }
 
     if (!warn.empty()) {
@@ -8,6 +8,7 @@
 
 #include "common.hpp"
 #include "aabb.hpp"
+#include "load_scheduler.hpp"
 
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
@@ -323,6 +324,9 @@ namespace okami {
 		}
 
 		static Expected<Geometry> LoadGLTF(std::filesystem::path const& path);
+		// Parse a GLTF/GLB file already in memory; the path gives its format
+		// and where external buffers are found
+		static Expected<Geometry> LoadGLTF(std::span<uint8_t const> data, std::filesystem::path const& path);
 
 		using Desc = GeometryDesc;
         using LoadParams = GeometryLoadParams;
@@ -345,7 +349,8 @@ namespace okami {
         virtual GeometryHandle LoadGeometry(
             std::filesystem::path const& path,
             GeometryLoadParams           params,
-            InterfaceCollection&         ic) = 0;
+            InterfaceCollection&         ic,
+            LoadPriority                 priority = {}) = 0;
         virtual GeometryHandle CreateGeometry(Geometry data) = 0;
     };
 }
\ No newline at end of file
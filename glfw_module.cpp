@@ -20,6 +20,7 @@
 #endif
 #include <GLFW/glfw3native.h>
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <optional>
@@ -189,6 +190,18 @@ private:
     std::optional<HeadlessGLParams> m_headless;  // set → headless capture mode
     size_t m_frameIndex = 0;
 
+    // glfwGetFramebufferSize is main-thread only; the renderer may run on
+    // its own thread, so it reads this copy instead.
+    std::atomic<int> m_framebufferWidth{ 0 };
+    std::atomic<int> m_framebufferHeight{ 0 };
+
+    void SampleFramebufferSize() {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(m_window, &width, &height);
+        m_framebufferWidth.store(width, std::memory_order_relaxed);
+        m_framebufferHeight.store(height, std::memory_order_relaxed);
+    }
+
     KeyboardState m_keyboardState;
     MouseState m_mouseState;
 
@@ -222,9 +235,10 @@ public:
     }
 
     glm::ivec2 GetFramebufferSize() const override {
-        int width, height;
-        glfwGetFramebufferSize(m_window, &width, &height);
-        return { width, height };
+        return {
+            m_framebufferWidth.load(std::memory_order_relaxed),
+            m_framebufferHeight.load(std::memory_order_relaxed)
+        };
     }
 
 protected:
@@ -267,6 +281,7 @@ protected:
             OKAMI_ERROR_RETURN_IF(!m_window, "Failed to create headless GLFW window");
 
             glfwMakeContextCurrent(m_window);
+            SampleFramebufferSize();
             return {};
         }
 
@@ -337,6 +352,8 @@ protected:
         m_cursors[static_cast<int>(CursorType::ResizeNWSE)] = glfwCreateStandardCursor(GLFW_RESIZE_NWSE_CURSOR);
         m_cursors[static_cast<int>(CursorType::NotAllowed)] = glfwCreateStandardCursor(GLFW_NOT_ALLOWED_CURSOR);
 
+        SampleFramebufferSize();
+
         return {};
     }
 
@@ -359,6 +376,7 @@ protected:
     // This will potentially run on a different thread
     Error MessagePump(InterfaceCollection& interfaces) override {
         glfwPollEvents();
+        SampleFramebufferSize();
 
         if (!m_headless && glfwWindowShouldClose(m_window)) {
             interfaces.SendSignal(SignalExit{});
@@ -527,6 +545,10 @@ public:
     void SetSwapInterval(int interval) override {
         glfwSwapInterval(interval);
     }
+
+    void MakeContextCurrent(bool current) override {
+        glfwMakeContextCurrent(current ? m_window : nullptr);
+    }
 };
 
 std::unique_ptr<EngineModule> GLFWModuleFactory::operator()() {
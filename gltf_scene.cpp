@@ -1,6 +1,7 @@
 #include "gltf_scene.hpp"
 
 #include "material.hpp"   // LambertMaterial, DefaultMaterial
+#include "vfs.hpp"
 
 #include <tiny_gltf.h>
 
@@ -15,7 +16,10 @@
 #include <glog/logging.h>
 
 #include <filesystem>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <tuple>
 
 namespace okami {
 
@@ -203,6 +207,28 @@ static Transform NodeTransform(tinygltf::Node const& node) {
     return Transform(pos, rot, scaleM);
 }
 
+// (mesh index, primitive index, skinned) -> index into GltfSceneDesc::m_geometries
+using GeometryCache = std::map<std::tuple<int, size_t, bool>, int>;
+
+// Returns the index of the geometry for one mesh primitive, extracting it the
+// first time any node references it.
+static int GetPrimitiveGeometry(
+    tinygltf::Model const& model,
+    int                    meshIndex,
+    size_t                 primIndex,
+    bool                   isSkinned,
+    GeometryCache&         cache,
+    GltfSceneDesc&         out)
+{
+    auto [it, inserted] = cache.try_emplace({meshIndex, primIndex, isSkinned}, 0);
+    if (inserted) {
+        it->second = static_cast<int>(out.m_geometries.size());
+        out.m_geometries.push_back(BuildPrimitiveGeometry(
+            model, model.meshes[meshIndex].primitives[primIndex], isSkinned));
+    }
+    return it->second;
+}
+
 // Recursively walks the GLTF node tree and appends mesh instances per primitive.
 // Skinned nodes (node.skin >= 0) go into out.m_skinnedMeshInstances; others into
 // out.m_meshInstances.
@@ -210,6 +236,7 @@ static void BuildNodes(
     tinygltf::Model        const& model,
     std::vector<int>       const& nodeIndices,
     Transform              const& parentWorld,
+    GeometryCache&                cache,
     GltfSceneDesc&                out)
 {
     for (int ni : nodeIndices) {
@@ -218,36 +245,64 @@ static void BuildNodes(
 
         if (node.mesh >= 0) {
             bool isSkinned = (node.skin >= 0);
-            for (auto const& prim : model.meshes[node.mesh].primitives) {
+            auto const& primitives = model.meshes[node.mesh].primitives;
+            for (size_t pi = 0; pi < primitives.size(); ++pi) {
+                int geometryIndex = GetPrimitiveGeometry(model, node.mesh, pi, isSkinned, cache, out);
                 if (isSkinned) {
                     GltfSkinnedMeshInstance inst;
                     inst.m_worldTransform = world;
-                    inst.m_geometry       = BuildPrimitiveGeometry(model, prim, /*isSkinned=*/true);
-                    inst.m_materialIndex  = prim.material;
+                    inst.m_geometryIndex  = geometryIndex;
+                    inst.m_materialIndex  = primitives[pi].material;
                     inst.m_skinIndex      = node.skin;
                     out.m_skinnedMeshInstances.push_back(std::move(inst));
                 } else {
                     GltfSceneMeshInstance inst;
                     inst.m_worldTransform = world;
-                    inst.m_geometry       = BuildPrimitiveGeometry(model, prim, /*isSkinned=*/false);
-                    inst.m_materialIndex  = prim.material;
+                    inst.m_geometryIndex  = geometryIndex;
+                    inst.m_materialIndex  = primitives[pi].material;
                     out.m_meshInstances.push_back(std::move(inst));
                 }
             }
         }
 
-        BuildNodes(model, node.children, world, out);
+        BuildNodes(model, node.children, world, cache, out);
     }
 }
 
+// Wraps a file read for an ozz archive; null if the read failed
+static std::unique_ptr<ozz::io::MemoryStream> OpenOzzStream(Expected<FileData> file) {
+    if (!file)
+        return nullptr;
+    auto stream = std::make_unique<ozz::io::MemoryStream>();
+    auto bytes  = file->GetBytes();
+    if (stream->Write(bytes.data(), bytes.size()) != bytes.size())
+        return nullptr;
+    stream->Seek(0, ozz::io::Stream::kSet);
+    return stream;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // GltfScene::FromFile
 // ─────────────────────────────────────────────────────────────────────────────
 
 Expected<GltfScene> GltfScene::FromFile(
-    std::filesystem::path const& path,
-    GltfSceneLoadParams   const& params)
+    std::filesystem::path    const& path,
+    GltfSceneLoadParams      const& params,
+    VirtualFileSystem        const* fileSystem)
 {
+    // Reads through the virtual file system when there is one, so the scene
+    // and its ozz archives may come from an asset pack.
+    auto readFile = [fileSystem](std::filesystem::path const& p) -> Expected<FileData> {
+        if (fileSystem)
+            return fileSystem->Read(p);
+        auto bytes = ReadFileBytes(p);
+        OKAMI_UNEXPECTED_RETURN(bytes);
+        return FileData(std::move(*bytes));
+    };
+    auto fileExists = [fileSystem](std::filesystem::path const& p) {
+        return fileSystem ? fileSystem->Exists(p) : std::filesystem::exists(p);
+    };
+
     // Suppress tinygltf's built-in image decoder; textures are loaded separately.
     static constexpr auto kNoopImageLoader = [](
         tinygltf::Image*, const int, std::string*, std::string*,
@@ -261,12 +316,25 @@ Expected<GltfScene> GltfScene::FromFile(
     tinygltf::Model model;
     std::string     err, warn;
 
-    auto ext = path.extension().string();
-    bool ok  = false;
+    auto file = readFile(path);
+    if (!file) {
+        LOG(ERROR) << "[GltfScene] Failed to read " << path << " – " << file.error();
+        return std::unexpected(file.error());
+    }
+    auto bytes = file->GetBytes();
+    OKAMI_UNEXPECTED_RETURN_IF(bytes.size() > std::numeric_limits<unsigned int>::max(),
+        "GLTF file is too large: " + path.string());
+
+    // External buffers of a .gltf are resolved next to the path
+    auto ext     = path.extension().string();
+    auto baseDir = path.parent_path().string();
+    bool ok      = false;
     if (ext == ".glb" || ext == ".GLB")
-        ok = loader.LoadBinaryFromFile(&model, &err, &warn, path.string());
+        ok = loader.LoadBinaryFromMemory(&model, &err, &warn,
+            bytes.data(), static_cast<unsigned int>(bytes.size()), baseDir);
     else
-        ok = loader.LoadASCIIFromFile(&model, &err, &warn, path.string());
+        ok = loader.LoadASCIIFromString(&model, &err, &warn,
+            reinterpret_cast<char const*>(bytes.data()), static_cast<unsigned int>(bytes.size()), baseDir);
 
     if (!warn.empty()) {
         // TinyGLTF emits "File not found" / "Failed to load external 'uri' for
@@ -334,8 +402,10 @@ Expected<GltfScene> GltfScene::FromFile(
 
     // ── Scene graph ────────────────────────────────────────────────────────
     int sceneIdx = model.defaultScene >= 0 ? model.defaultScene : 0;
-    if (sceneIdx < static_cast<int>(model.scenes.size()))
-        BuildNodes(model, model.scenes[sceneIdx].nodes, Transform::Identity(), desc);
+    if (sceneIdx < static_cast<int>(model.scenes.size())) {
+        GeometryCache geometryCache;
+        BuildNodes(model, model.scenes[sceneIdx].nodes, Transform::Identity(), geometryCache, desc);
+    }
 
     // ── Skins ──────────────────────────────────────────────────────────────
     for (auto const& skin : model.skins) {
@@ -381,10 +451,10 @@ Expected<GltfScene> GltfScene::FromFile(
 
         // Skeleton
         auto skelPath = std::filesystem::path(stem + ".skeleton.ozz");
-        if (std::filesystem::exists(skelPath)) {
-            ozz::io::File file(skelPath.string().c_str(), "rb");
-            if (file.opened()) {
-                ozz::io::IArchive archive(&file);
+        if (fileExists(skelPath)) {
+            auto stream = OpenOzzStream(readFile(skelPath));
+            if (stream) {
+                ozz::io::IArchive archive(stream.get());
                 if (archive.TestTag<ozz::animation::Skeleton>()) {
                     auto skel = std::make_shared<ozz::animation::Skeleton>();
                     archive >> *skel;
@@ -403,14 +473,14 @@ Expected<GltfScene> GltfScene::FromFile(
                     if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-')
                         c = '_';
                 auto animPath = std::filesystem::path(stem + "." + safeName + ".animation.ozz");
-                if (!std::filesystem::exists(animPath)) {
+                if (!fileExists(animPath)) {
                     LOG(WARNING) << "[GltfScene] Animation archive not found: " << animPath;
                     continue;
                 }
-                ozz::io::File file(animPath.string().c_str(), "rb");
-                if (!file.opened()) continue;
+                auto stream = OpenOzzStream(readFile(animPath));
+                if (!stream) continue;
 
-                ozz::io::IArchive archive(&file);
+                ozz::io::IArchive archive(stream.get());
                 if (archive.TestTag<ozz::animation::Animation>()) {
                     auto clip = std::make_shared<ozz::animation::Animation>();
                     archive >> *clip;
@@ -433,6 +503,13 @@ void SpawnGltfScene(Engine& en, GltfSceneDesc&& proto, Transform const& root, st
     // Create the root entity that all scene nodes will be children of.
     entity_t rootEntity = en.CreateEntity(kNullEntity, name);
     en.AddComponent(rootEntity, root);
+    // Texture paths are checked through the file system so assets in packs
+    // resolve without touching the disk
+    auto* fileSystem = en.QueryInterface<VirtualFileSystem>();
+    auto textureExists = [fileSystem](std::filesystem::path const& path) {
+        return !path.empty() &&
+            (fileSystem ? fileSystem->Exists(path) : std::filesystem::exists(path));
+    };
     // Build one material handle per GLTF material.
     // Materials with a resolvable texture path use LambertMaterial;
     // those without fall back to DefaultMaterial.
@@ -441,20 +518,18 @@ void SpawnGltfScene(Engine& en, GltfSceneDesc&& proto, Transform const& root, st
     for (auto const& matDef : proto.m_materials) {
         // Pre-load the normal map (linear) first so it is cached with the
         // correct sRGB=false flag before anything else touches it.
-        if (!matDef.m_normalTexturePath.empty() &&
-            std::filesystem::exists(matDef.m_normalTexturePath)) {
+        bool hasNormal = textureExists(matDef.m_normalTexturePath);
+        if (hasNormal) {
             en.LoadTexture(matDef.m_normalTexturePath, TextureLoadParams{ .m_srgb = false });
         }
 
-        if (!matDef.m_colorTexturePath.empty() &&
-            std::filesystem::exists(matDef.m_colorTexturePath)) {
+        if (textureExists(matDef.m_colorTexturePath)) {
             LambertMaterial bm;
             // Albedo textures are sRGB – pass the flag so mips are built correctly.
             bm.m_colorTexture = en.LoadTexture(matDef.m_colorTexturePath,
                                                TextureLoadParams{ .m_srgb = true });
             // Normal map is linear.
-            if (!matDef.m_normalTexturePath.empty() &&
-                std::filesystem::exists(matDef.m_normalTexturePath)) {
+            if (hasNormal) {
                 bm.m_normalTexture = en.LoadTexture(matDef.m_normalTexturePath,
                                                     TextureLoadParams{ .m_srgb = false });
             }
@@ -465,20 +540,41 @@ void SpawnGltfScene(Engine& en, GltfSceneDesc&& proto, Transform const& root, st
         }
     }
 
-    // Spawn one entity per static mesh instance.
-    for (auto& inst : proto.m_meshInstances) {
-        auto geoH = en.CreateGeometry(std::move(inst.m_geometry));
+    // Upload each distinct geometry once; instances share the handle.
+    size_t geometryBytes = 0;
+    std::vector<GeometryHandle> geometries;
+    geometries.reserve(proto.m_geometries.size());
+    for (auto& geometry : proto.m_geometries) {
+        for (auto const& buffer : geometry.GetBuffers())
+            geometryBytes += buffer.size();
+        geometries.push_back(en.CreateGeometry(std::move(geometry)));
+    }
+    auto getGeometry = [&](int index) {
+        return index >= 0 && index < static_cast<int>(geometries.size())
+            ? geometries[index] : GeometryHandle{};
+    };
+
+    size_t instanceCount = proto.m_meshInstances.size() + proto.m_skinnedMeshInstances.size();
+    LOG(INFO) << "[GltfScene] " << name << ": " << instanceCount << " mesh instances share "
+              << geometries.size() << " geometries (" << geometryBytes / 1024 << " KiB)";
+
+    // Spawn one entity per static mesh instance, as a single batch.
+    auto meshBatch = en.CreateEntityBatch(proto.m_meshInstances.size(), rootEntity);
+    meshBatch.Reserve<StaticMeshComponent>(meshBatch.GetSize());
+    meshBatch.Reserve<Transform>(meshBatch.GetSize());
+    for (size_t i = 0; i < proto.m_meshInstances.size(); ++i) {
+        auto const& inst = proto.m_meshInstances[i];
+        auto geoH = getGeometry(inst.m_geometryIndex);
 
         MaterialHandle matH;
         if (inst.m_materialIndex >= 0 &&
             inst.m_materialIndex < static_cast<int>(materials.size()))
             matH = materials[inst.m_materialIndex];
 
-        auto world  = root * inst.m_worldTransform;
-        auto entity = en.CreateEntity(rootEntity);
-        en.AddComponent(entity, StaticMeshComponent{geoH, matH});
-        en.AddComponent(entity, world);
+        meshBatch.Add(i, StaticMeshComponent{geoH, matH});
+        meshBatch.Add(i, root * inst.m_worldTransform);
     }
+    en.SpawnBatch(meshBatch);
 
     // ── Skeleton entity ─────────────────────────────────────────────────────
     // One entity carries SkeletonComponent (read-only data + params) and
@@ -497,8 +593,6 @@ void SpawnGltfScene(Engine& en, GltfSceneDesc&& proto, Transform const& root, st
         // output spans for SamplingJob / LocalToModelJob.
         SkeletonStateComponent ssc;
         if (!proto.m_animations.empty()) {
-            ssc.m_localTransforms.resize(
-                static_cast<size_t>(proto.m_skeleton->num_soa_joints()));
             ssc.m_modelMatrices.resize(
                 static_cast<size_t>(proto.m_skeleton->num_joints()));
             ssc.m_time = 0.0f;
@@ -532,7 +626,7 @@ void SpawnGltfScene(Engine& en, GltfSceneDesc&& proto, Transform const& root, st
     }
 
     for (auto& inst : proto.m_skinnedMeshInstances) {
-        auto geoH = en.CreateGeometry(std::move(inst.m_geometry));
+        auto geoH = getGeometry(inst.m_geometryIndex);
 
         MaterialHandle matH;
         if (inst.m_materialIndex >= 0 &&
@@ -15,6 +15,7 @@
 #include <glm/vec4.hpp>
 
 namespace okami {
+    class VirtualFileSystem;
 
     // ─────────────────────────────────────────────────────────────────────────
     // Parameters
@@ -39,11 +40,11 @@ namespace okami {
         std::filesystem::path m_normalTexturePath;
     };
 
-    // One flattened renderable primitive: world transform + raw geometry + material index.
-    // Geometry is move-only; this struct is therefore non-copyable.
+    // One flattened renderable primitive: world transform + geometry index + material index.
+    // Every node that references the same GLTF (mesh, primitive) shares one geometry.
     struct GltfSceneMeshInstance {
         Transform m_worldTransform;
-        Geometry  m_geometry;
+        int       m_geometryIndex = -1;  // index into GltfSceneDesc::m_geometries
         int       m_materialIndex = -1;  // index into GltfSceneDesc::m_materials; -1 = none
     };
 
@@ -56,7 +57,7 @@ namespace okami {
     // One skinned mesh primitive: like GltfSceneMeshInstance but with a skin reference.
     struct GltfSkinnedMeshInstance {
         Transform m_worldTransform;
-        Geometry  m_geometry;
+        int       m_geometryIndex = -1;
         int       m_materialIndex = -1;
         int       m_skinIndex     = -1; // index into GltfSceneDesc::m_skins
     };
@@ -64,6 +65,9 @@ namespace okami {
     // The complete scene prototype.  Produced by GltfScene::FromFile() and
     // consumed (moved) by SpawnGltfScene().
     struct GltfSceneDesc {
+        // One entry per distinct (mesh, primitive, skinned) in the GLTF.
+        // Geometry is move-only; this struct is therefore non-copyable.
+        std::vector<Geometry>                 m_geometries;
         std::vector<GltfSceneMeshInstance>    m_meshInstances;
         std::vector<GltfSkinnedMeshInstance>  m_skinnedMeshInstances;
         std::vector<GltfSceneMaterialDef>     m_materials;
@@ -95,9 +99,13 @@ namespace okami {
         // Synchronously load and parse a GLTF/GLB file, building the scene
         // prototype.  The returned GltfScene owns all the parsed Geometry data.
         // On failure an error is returned and nothing is loaded.
+        //
+        // With a file system, the file and its ozz archives are read through
+        // it (and so may come from an asset pack); otherwise from disk.
         static Expected<GltfScene> FromFile(
             std::filesystem::path const& path,
-            GltfSceneLoadParams   const& params = {});
+            GltfSceneLoadParams   const& params     = {},
+            VirtualFileSystem     const* fileSystem = nullptr);
     };
 
     // ─────────────────────────────────────────────────────────────────────────
@@ -106,7 +114,9 @@ namespace okami {
 
     // Instantiate all mesh primitives described by the prototype as entities in
     // the engine world.  Each entity receives a StaticMeshComponent (with a
-    // freshly uploaded GeometryHandle and a MaterialHandle) and a Transform.
+    // GeometryHandle and a MaterialHandle) and a Transform.  Each geometry is
+    // uploaded once and its handle shared by every instance, so repeated props
+    // cost one set of GPU buffers and can be drawn instanced.
     //
     // The prototype is consumed (moved): geometry data is transferred to the GPU
     // and can no longer be accessed through the desc after this call.
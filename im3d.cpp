@@ -4,8 +4,6 @@ using namespace okami;
 
 class Im3dModule final : public EngineModule, public IIm3dProvider {
 protected:
-    Im3dContext m_contextToRender;
-
     Error RegisterImpl(InterfaceCollection& interfaces) override {
         interfaces.Register<IIm3dProvider>(this);
         return {};
@@ -30,9 +28,9 @@ protected:
 
     Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override {
         // This context now becomes the one to render
-        bus.HandlePipe<Im3dContext>([this](Im3dContext& context) {
+        bus.HandlePipe<Im3dContext>([&params](Im3dContext& context) {
             context->endFrame();
-            m_contextToRender = std::move(context);
+            params.m_registry.ctx().insert_or_assign(Im3dDrawCtx{ std::move(context.m_context) });
         });
 
         return {};
@@ -42,10 +40,6 @@ public:
     std::string GetName() const override {
         return "Im3d Provider Module";
     }
-
-    Im3dContext const& GetIm3dContext() const override {
-        return m_contextToRender;
-    }
 };
 
 std::unique_ptr<EngineModule> Im3dModuleFactory::operator()() {
@@ -33,9 +33,15 @@ namespace okami {
         }
     };
 
+    // The last finished Im3d frame. Kept in the registry context, which lets
+    // it travel with render snapshots.
+    struct Im3dDrawCtx {
+        std::shared_ptr<Im3d::Context const> m_context;
+    };
+
+    // Registered by the Im3d module; it publishes Im3dDrawCtx each frame
     class IIm3dProvider {
     public:
-        // Thread-safe
-        virtual Im3dContext const& GetIm3dContext() const = 0;
+        virtual ~IIm3dProvider() = default;
     };
 }
\ No newline at end of file
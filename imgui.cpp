@@ -2,6 +2,9 @@
 
 #include "input.hpp"
 
+#include <atomic>
+#include <semaphore>
+
 using namespace okami;
 
 ImGuiKey OkamiKeyToImGuiKey(Key key) {
@@ -78,17 +81,20 @@ class ImguiModule final :
     public EngineModule, 
     public IImguiProvider {
 protected:
-    ImDrawData m_drawDataToRender;
     ImGuiContext* m_context = nullptr;
 
     float m_lastScaleFactor = 1.0f;
 
-    void ClearDrawData() {
-        // Clear previous frame data to avoid memory leaks
-        for (int i = 0; i < m_drawDataToRender.CmdLists.Size; i++) {
-            delete m_drawDataToRender.CmdLists[i];
+    // Taken by the frame's first node and given back in ReceiveMessages,
+    // which need not run on the same thread, hence not a mutex
+    std::binary_semaphore m_contextLock{ 1 };
+    std::atomic<bool> b_holdingContext = false;
+
+    static void DeleteDrawData(ImDrawData* drawData) {
+        for (int i = 0; i < drawData->CmdLists.Size; i++) {
+            delete drawData->CmdLists[i];
         }
-        m_drawDataToRender.CmdLists.resize(0);
+        delete drawData;
     }
 
     Error RegisterImpl(InterfaceCollection& a) {
@@ -117,7 +123,7 @@ protected:
 
     Error BuildGraphImpl(JobGraph& graph, BuildGraphParams const& params) {
         // Node to start a new ImGui frame
-        graph.AddMessageNode([id = GetId(), &lastScaleFactor = m_lastScaleFactor](JobContext& jobContext,
+        graph.AddMessageNode([this, id = GetId(), &lastScaleFactor = m_lastScaleFactor](JobContext& jobContext,
             In<Time> time,
             In<DisplayState> display,
             Pipe<IOState, kImGuiInputPriority> io,
@@ -129,6 +135,9 @@ protected:
             Out<SetCursorMessage> outSetCursor,
             Pipe<ImGuiContextObject, kPipePriorityFirst>) -> Error {
 
+            LockContext();
+            b_holdingContext.store(true, std::memory_order_relaxed);
+
             // Update ImGui IO state
             ImGuiIO& imgui_io = ImGui::GetIO();
             imgui_io.DeltaTime = (float)time->m_deltaTime;
@@ -279,18 +288,20 @@ protected:
         return {};
     }
 
-    Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const&) override {
+    Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override {
         // This context now becomes the one to render
-        bus.HandlePipe<ImGuiContextObject>([this](ImGuiContextObject& context) {
+        bus.HandlePipe<ImGuiContextObject>([&params](ImGuiContextObject& context) {
             auto drawData = ImGui::GetDrawData();
-            
-            ClearDrawData();
+
+            // The renderer may still be drawing an earlier frame's copy, so
+            // each frame gets a fresh one.
+            std::shared_ptr<ImDrawData> drawDataToRender(new ImDrawData(), &DeleteDrawData);
 
             if (drawData && drawData->Valid) {
                 // Shallow copy the main structure properties
-                m_drawDataToRender = *drawData;
+                *drawDataToRender = *drawData;
                 // Clear the pointers copied from source (which we don't own)
-                m_drawDataToRender.CmdLists.resize(0);
+                drawDataToRender->CmdLists.resize(0);
 
                 // Deep copy each command list
                 for (int i = 0; i < drawData->CmdLists.Size; i++) {
@@ -304,17 +315,28 @@ protected:
                     dst_list->VtxBuffer = src_list->VtxBuffer;
                     dst_list->Flags = src_list->Flags;
                     
-                    m_drawDataToRender.CmdLists.push_back(dst_list);
+                    drawDataToRender->CmdLists.push_back(dst_list);
                 }
             }
+
+            params.m_registry.ctx().insert_or_assign(ImGuiDrawDataCtx{ std::move(drawDataToRender) });
         });
 
+        // Done with the context until the next frame starts
+        if (b_holdingContext.exchange(false, std::memory_order_relaxed)) {
+            UnlockContext();
+        }
+
         return {};
     }
 
 public:
-    ImDrawData& GetDrawData() override {
-        return m_drawDataToRender;
+    void LockContext() override {
+        m_contextLock.acquire();
+    }
+
+    void UnlockContext() override {
+        m_contextLock.release();
     }
 
     std::string GetName() const override {
@@ -322,7 +344,6 @@ public:
     }
 
     ~ImguiModule() {
-        ClearDrawData();
         ImGui::SetCurrentContext(nullptr);
         ImGui::DestroyContext(m_context);
     }
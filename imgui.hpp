@@ -4,6 +4,8 @@
 
 #include <imgui.h>
 
+#include <memory>
+
 namespace okami {
     constexpr int kImGuiInputPriority = 100;
 
@@ -22,9 +24,23 @@ namespace okami {
         }
     };
 
+    // The last finished ImGui frame, deep-copied out of the ImGui context so
+    // the next frame can be built while it waits to be drawn. Kept in the
+    // registry context, which lets it travel with render snapshots.
+    struct ImGuiDrawDataCtx {
+        std::shared_ptr<ImDrawData const> m_drawData;
+    };
+
+    // Registered by the ImGui module; it publishes ImGuiDrawDataCtx each frame.
+    //
+    // The ImGui context is global and not thread safe, and renderer backends
+    // still read it while drawing. The module holds it from the start of each
+    // frame until the frame's draw data is copied out; a renderer drawing on
+    // another thread locks it around its backend calls.
     class IImguiProvider {
     public:
-        virtual ImDrawData& GetDrawData() = 0;
+        virtual void LockContext() = 0;
+        virtual void UnlockContext() = 0;
 
         virtual ~IImguiProvider() = default;
     };
@@ -0,0 +1,350 @@
+#include "input_recording.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace okami;
+
+namespace {
+	constexpr uint32_t kInputLogMagic = 0x4e494b4f; // "OKIN"
+	constexpr uint32_t kInputLogVersion = 1;
+
+	struct InputLogHeader {
+		uint32_t m_magic = kInputLogMagic;
+		uint32_t m_version = kInputLogVersion;
+		uint64_t m_frameCount = 0;
+	};
+
+	// Per-frame flags saying which optional sections follow the delta time
+	enum InputFrameFlags : uint8_t {
+		kFrameKeyboard = 1 << 0,     // Key state bitset
+		kFrameMouseButtons = 1 << 1, // Mouse button bitmask
+		kFrameCursor = 1 << 2,       // Cursor position
+		kFrameMouseDelta = 1 << 3,   // Cursor delta that is not the position difference
+		kFrameEvents = 1 << 4,       // Event counts and arrays
+	};
+
+	constexpr size_t kKeyboardBytes = (kKeyCount + 7) / 8;
+	constexpr size_t kMouseButtonCount = static_cast<size_t>(MouseButton::Button8) + 1;
+
+	// Values are stored in host byte order; logs are meant to be replayed on
+	// the machine class they were recorded on.
+	class LogWriter {
+	public:
+		explicit LogWriter(std::vector<std::byte>& data) : m_data(data) {}
+
+		template <typename T>
+		void Write(T const& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			auto offset = m_data.size();
+			m_data.resize(offset + sizeof(T));
+			std::memcpy(m_data.data() + offset, &value, sizeof(T));
+		}
+
+	private:
+		std::vector<std::byte>& m_data;
+	};
+
+	class LogReader {
+	public:
+		explicit LogReader(std::span<std::byte const> data) : m_data(data) {}
+
+		template <typename T>
+		bool Read(T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (m_data.size() - m_offset < sizeof(T)) {
+				return false;
+			}
+			std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+			m_offset += sizeof(T);
+			return true;
+		}
+
+		inline bool AtEnd() const { return m_offset == m_data.size(); }
+
+	private:
+		std::span<std::byte const> m_data;
+		size_t m_offset = 0;
+	};
+
+	template <typename T>
+	std::span<T const> GetMessages(MessageBus const& bus) {
+		if (auto* port = bus.GetPort<T>()) {
+			return port->m_messages;
+		}
+		return {};
+	}
+
+	uint16_t PackMouseButtons(MouseState const& mouse) {
+		uint16_t mask = 0;
+		for (auto const& [button, pressed] : mouse.m_buttonStates) {
+			auto index = static_cast<size_t>(button);
+			if (pressed && index < kMouseButtonCount) {
+				mask |= uint16_t(1u << index);
+			}
+		}
+		return mask;
+	}
+
+	template <typename T>
+	void ReplaceMessages(MessageBus& bus, std::vector<T> const& messages) {
+		auto* port = bus.EnsurePort<T>();
+		port->Clear();
+		for (auto const& message : messages) {
+			port->Send(message);
+		}
+	}
+}
+
+void okami::InputRecorder::Capture(MessageBus const& bus) {
+	IOState io;
+	if (auto states = GetMessages<IOState>(bus); !states.empty()) {
+		io = states.front();
+	}
+	double deltaTime = 0.0;
+	if (auto times = GetMessages<Time>(bus); !times.empty()) {
+		deltaTime = times.front().m_deltaTime;
+	}
+
+	auto keys = GetMessages<KeyMessage>(bus);
+	auto mouseButtons = GetMessages<MouseButtonMessage>(bus);
+	auto mousePositions = GetMessages<MousePosMessage>(bus);
+	auto scrolls = GetMessages<ScrollMessage>(bus);
+	auto chars = GetMessages<CharMessage>(bus);
+
+	auto const buttons = PackMouseButtons(io.m_mouse);
+	auto const& mouse = io.m_mouse;
+
+	uint8_t flags = 0;
+	if (io.m_keyboard.m_keyStates != m_keyboard.m_keyStates) {
+		flags |= kFrameKeyboard;
+	}
+	if (buttons != m_mouseButtons) {
+		flags |= kFrameMouseButtons;
+	}
+	if (mouse.m_cursorX != m_cursorX || mouse.m_cursorY != m_cursorY) {
+		flags |= kFrameCursor;
+	}
+	if (mouse.m_deltaX != mouse.m_cursorX - m_cursorX || mouse.m_deltaY != mouse.m_cursorY - m_cursorY) {
+		flags |= kFrameMouseDelta;
+	}
+	if (!keys.empty() || !mouseButtons.empty() || !mousePositions.empty() || !scrolls.empty() || !chars.empty()) {
+		flags |= kFrameEvents;
+	}
+
+	LogWriter writer(m_data);
+	writer.Write(flags);
+	writer.Write(deltaTime);
+
+	if (flags & kFrameKeyboard) {
+		std::array<uint8_t, kKeyboardBytes> bits{};
+		for (size_t i = 0; i < kKeyCount; ++i) {
+			if (io.m_keyboard.m_keyStates[i]) {
+				bits[i / 8] |= uint8_t(1u << (i % 8));
+			}
+		}
+		writer.Write(bits);
+	}
+	if (flags & kFrameMouseButtons) {
+		writer.Write(buttons);
+	}
+	if (flags & kFrameCursor) {
+		writer.Write(mouse.m_cursorX);
+		writer.Write(mouse.m_cursorY);
+	}
+	if (flags & kFrameMouseDelta) {
+		writer.Write(mouse.m_deltaX);
+		writer.Write(mouse.m_deltaY);
+	}
+	if (flags & kFrameEvents) {
+		writer.Write(static_cast<uint32_t>(keys.size()));
+		writer.Write(static_cast<uint32_t>(mouseButtons.size()));
+		writer.Write(static_cast<uint32_t>(mousePositions.size()));
+		writer.Write(static_cast<uint32_t>(scrolls.size()));
+		writer.Write(static_cast<uint32_t>(chars.size()));
+		for (auto const& msg : keys) {
+			writer.Write(static_cast<uint16_t>(msg.m_key));
+			writer.Write(static_cast<uint8_t>(msg.m_action));
+		}
+		for (auto const& msg : mouseButtons) {
+			writer.Write(static_cast<uint8_t>(msg.m_button));
+			writer.Write(static_cast<uint8_t>(msg.m_action));
+		}
+		for (auto const& msg : mousePositions) {
+			writer.Write(msg.m_x);
+			writer.Write(msg.m_y);
+		}
+		for (auto const& msg : scrolls) {
+			writer.Write(msg.m_xOffset);
+			writer.Write(msg.m_yOffset);
+		}
+		for (auto const& msg : chars) {
+			writer.Write(msg.m_char);
+		}
+	}
+
+	m_keyboard = io.m_keyboard;
+	m_mouseButtons = buttons;
+	m_cursorX = mouse.m_cursorX;
+	m_cursorY = mouse.m_cursorY;
+	++m_frameCount;
+}
+
+std::vector<std::byte> okami::InputRecorder::Serialize() const {
+	std::vector<std::byte> data;
+	data.reserve(sizeof(InputLogHeader) + m_data.size());
+	LogWriter(data).Write(InputLogHeader{ .m_frameCount = m_frameCount });
+	data.insert(data.end(), m_data.begin(), m_data.end());
+	return data;
+}
+
+Error okami::InputRecorder::Save(std::filesystem::path const& path) const {
+	auto data = Serialize();
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	OKAMI_ERROR_RETURN_IF(!file, "Failed to open input log " + path.string());
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	OKAMI_ERROR_RETURN_IF(!file, "Failed to write input log " + path.string());
+	return {};
+}
+
+Expected<InputReplay> okami::InputReplay::Load(std::filesystem::path const& path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	OKAMI_UNEXPECTED_RETURN_IF(!file, "Failed to open input log " + path.string());
+
+	std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	OKAMI_UNEXPECTED_RETURN_IF(!file, "Failed to read input log " + path.string());
+
+	return Deserialize(data);
+}
+
+Expected<InputReplay> okami::InputReplay::Deserialize(std::span<std::byte const> data) {
+	LogReader reader(data);
+
+	InputLogHeader header;
+	OKAMI_UNEXPECTED_RETURN_IF(!reader.Read(header) || header.m_magic != kInputLogMagic,
+		"Not an input log");
+	OKAMI_UNEXPECTED_RETURN_IF(header.m_version != kInputLogVersion,
+		"Unsupported input log version " + std::to_string(header.m_version));
+
+	InputReplay replay;
+	// Every frame takes at least its flags and delta time, which bounds the
+	// reservation for a corrupt frame count
+	replay.m_frames.reserve(std::min<uint64_t>(header.m_frameCount, data.size() / 9));
+
+	InputFrame previous;
+	for (uint64_t i = 0; i < header.m_frameCount; ++i) {
+		InputFrame frame;
+		frame.m_ioState.m_keyboard = previous.m_ioState.m_keyboard;
+		frame.m_ioState.m_mouse.m_buttonStates = previous.m_ioState.m_mouse.m_buttonStates;
+		auto const lastX = previous.m_ioState.m_mouse.m_cursorX;
+		auto const lastY = previous.m_ioState.m_mouse.m_cursorY;
+		auto& mouse = frame.m_ioState.m_mouse;
+		mouse.m_cursorX = lastX;
+		mouse.m_cursorY = lastY;
+
+		bool ok = true;
+		uint8_t flags = 0;
+		ok = ok && reader.Read(flags);
+		ok = ok && reader.Read(frame.m_deltaTime);
+
+		if (ok && (flags & kFrameKeyboard)) {
+			std::array<uint8_t, kKeyboardBytes> bits{};
+			ok = reader.Read(bits);
+			for (size_t key = 0; key < kKeyCount; ++key) {
+				frame.m_ioState.m_keyboard.m_keyStates[key] = (bits[key / 8] >> (key % 8)) & 1u;
+			}
+		}
+		if (ok && (flags & kFrameMouseButtons)) {
+			uint16_t buttons = 0;
+			ok = reader.Read(buttons);
+			mouse.m_buttonStates.clear();
+			for (size_t button = 0; button < kMouseButtonCount; ++button) {
+				if (buttons & (1u << button)) {
+					mouse.m_buttonStates[static_cast<MouseButton>(button)] = true;
+				}
+			}
+		}
+		if (ok && (flags & kFrameCursor)) {
+			ok = reader.Read(mouse.m_cursorX) && reader.Read(mouse.m_cursorY);
+		}
+		mouse.m_deltaX = mouse.m_cursorX - lastX;
+		mouse.m_deltaY = mouse.m_cursorY - lastY;
+		if (ok && (flags & kFrameMouseDelta)) {
+			ok = reader.Read(mouse.m_deltaX) && reader.Read(mouse.m_deltaY);
+		}
+		if (ok && (flags & kFrameEvents)) {
+			std::array<uint32_t, 5> counts{};
+			ok = reader.Read(counts);
+			for (uint32_t j = 0; ok && j < counts[0]; ++j) {
+				uint16_t key = 0;
+				uint8_t action = 0;
+				ok = reader.Read(key) && reader.Read(action) && key < kKeyCount;
+				frame.m_keys.push_back(KeyMessage{ static_cast<Key>(key), static_cast<Action>(action) });
+			}
+			for (uint32_t j = 0; ok && j < counts[1]; ++j) {
+				uint8_t button = 0;
+				uint8_t action = 0;
+				ok = reader.Read(button) && reader.Read(action);
+				frame.m_mouseButtons.push_back(MouseButtonMessage{ static_cast<MouseButton>(button), static_cast<Action>(action) });
+			}
+			for (uint32_t j = 0; ok && j < counts[2]; ++j) {
+				MousePosMessage msg{};
+				ok = reader.Read(msg.m_x) && reader.Read(msg.m_y);
+				frame.m_mousePositions.push_back(msg);
+			}
+			for (uint32_t j = 0; ok && j < counts[3]; ++j) {
+				ScrollMessage msg{};
+				ok = reader.Read(msg.m_xOffset) && reader.Read(msg.m_yOffset);
+				frame.m_scrolls.push_back(msg);
+			}
+			for (uint32_t j = 0; ok && j < counts[4]; ++j) {
+				CharMessage msg{};
+				ok = reader.Read(msg.m_char);
+				frame.m_chars.push_back(msg);
+			}
+		}
+
+		OKAMI_UNEXPECTED_RETURN_IF(!ok, "Input log is truncated or corrupt at frame " + std::to_string(i));
+
+		previous = frame;
+		replay.m_frames.push_back(std::move(frame));
+	}
+	OKAMI_UNEXPECTED_RETURN_IF(!reader.AtEnd(), "Input log has trailing data");
+
+	return replay;
+}
+
+bool okami::InputReplay::Apply(MessageBus& bus) {
+	if (IsFinished()) {
+		return false;
+	}
+	auto const& frame = m_frames[m_nextFrame];
+
+	auto* timePort = bus.EnsurePort<Time>();
+	timePort->Clear();
+	timePort->Send(Time{
+		.m_deltaTime = frame.m_deltaTime,
+		.m_nextFrameTime = m_time + frame.m_deltaTime,
+		.m_lastFrameTime = m_time,
+		.m_nextFrame = m_nextFrame
+	});
+
+	auto* ioPort = bus.EnsurePort<IOState>();
+	ioPort->Clear();
+	ioPort->Send(frame.m_ioState);
+
+	ReplaceMessages(bus, frame.m_keys);
+	ReplaceMessages(bus, frame.m_mouseButtons);
+	ReplaceMessages(bus, frame.m_mousePositions);
+	ReplaceMessages(bus, frame.m_scrolls);
+	ReplaceMessages(bus, frame.m_chars);
+
+	m_time += frame.m_deltaTime;
+	++m_nextFrame;
+	return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common.hpp"
+#include "jobs.hpp"
+#include "module.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "input.hpp"
+
+namespace okami {
+	// Everything the platform layer put on the bus for one run of the update
+	// graph, plus the step's delta time.
+	struct InputFrame {
+		double m_deltaTime = 0.0;
+		IOState m_ioState;
+		std::vector<KeyMessage> m_keys;
+		std::vector<MouseButtonMessage> m_mouseButtons;
+		std::vector<MousePosMessage> m_mousePositions;
+		std::vector<ScrollMessage> m_scrolls;
+		std::vector<CharMessage> m_chars;
+	};
+
+	// Records the input messages of every update graph run into a compact
+	// binary log: frames only store the parts of IOState that changed, and
+	// event arrays are only written for frames that have events. Hand it to
+	// the engine with RunParams::inputRecorder.
+	//
+	// Only platform input and time are recorded. Everything else on the bus
+	// is produced by the simulation itself, so replaying the same scene with
+	// the same input and time reproduces it.
+	class InputRecorder final {
+	public:
+		// Appends the input currently on the bus as the next frame. Call after
+		// SendMessages and before the graph executes, since pipes may mark
+		// messages as captured.
+		void Capture(MessageBus const& bus);
+
+		inline size_t GetFrameCount() const { return m_frameCount; }
+
+		// The log as written by Save
+		std::vector<std::byte> Serialize() const;
+		Error Save(std::filesystem::path const& path) const;
+
+	private:
+		std::vector<std::byte> m_data;
+		size_t m_frameCount = 0;
+
+		// Previous frame's state, for delta encoding
+		KeyboardState m_keyboard;
+		uint16_t m_mouseButtons = 0;
+		double m_cursorX = 0.0;
+		double m_cursorY = 0.0;
+	};
+
+	// Plays an InputRecorder log back into a running engine. Each update graph
+	// run consumes one frame: the recorded messages replace whatever the
+	// platform layer sent (e.g. the empty IOState of a headless window), and
+	// the recorded delta time replaces the estimator's, so the simulation
+	// sees exactly the recorded session. Hand it to the engine with
+	// RunParams::inputReplay; the engine exits once it runs out of frames.
+	class InputReplay final {
+	public:
+		static Expected<InputReplay> Load(std::filesystem::path const& path);
+		static Expected<InputReplay> Deserialize(std::span<std::byte const> data);
+
+		// Replaces the input on the bus with the next frame. Returns false,
+		// leaving the bus untouched, once every frame has been played.
+		bool Apply(MessageBus& bus);
+
+		inline bool IsFinished() const { return m_nextFrame >= m_frames.size(); }
+		inline void Rewind() { m_nextFrame = 0; m_time = 0.0; }
+
+		inline size_t GetFrameCount() const { return m_frames.size(); }
+		inline std::span<InputFrame const> GetFrames() const { return m_frames; }
+
+	private:
+		std::vector<InputFrame> m_frames;
+		size_t m_nextFrame = 0;
+		double m_time = 0.0;
+	};
+}
@@ -11,14 +11,21 @@ namespace okami {
     protected:
         OnResourceLoadedEvent<Texture> LoadResource(LoadResourceSignal<Texture>&& msg) override {
             auto ext = msg.m_path.extension().string();
-            if (ext == ".ktx2" || ext == ".KTX2") {
-                return { Texture::FromKTX2(GetAssetPath(msg.m_path), msg.m_params), msg.m_id };
-            } else if (ext == ".png" || ext == ".PNG") {
-                return { Texture::FromPNG(GetAssetPath(msg.m_path), msg.m_params), msg.m_id };
-            } else {
+            bool ktx2 = ext == ".ktx2" || ext == ".KTX2";
+            if (!ktx2 && ext != ".png" && ext != ".PNG") {
                 LOG(ERROR) << "Unsupported texture format for file: " << msg.m_path;
                 return { OKAMI_UNEXPECTED("Unsupported texture format: " + ext), msg.m_id };
             }
+
+            auto file = ReadAsset(msg.m_path);
+            if (!file) {
+                return { std::unexpected(file.error()), msg.m_id };
+            }
+            return {
+                ktx2 ? Texture::FromKTX2(file->GetBytes(), msg.m_params)
+                     : Texture::FromPNG(file->GetBytes(), msg.m_params),
+                msg.m_id
+            };
         }
     };
 
@@ -27,7 +34,12 @@ namespace okami {
         OnResourceLoadedEvent<Geometry> LoadResource(LoadResourceSignal<Geometry>&& msg) override {
             auto ext = msg.m_path.extension().string();
             if (ext == ".glb" || ext == ".GLB" || ext == ".gltf" || ext == ".GLTF") {
-                return { Geometry::LoadGLTF(GetAssetPath(msg.m_path)), msg.m_id };
+                auto file = ReadAsset(msg.m_path);
+                if (!file) {
+                    return { std::unexpected(file.error()), msg.m_id };
+                }
+                auto loosePath = m_fileSystem ? m_fileSystem->GetLoosePath(msg.m_path) : GetAssetPath(msg.m_path);
+                return { Geometry::LoadGLTF(file->GetBytes(), loosePath), msg.m_id };
             } else {
                 LOG(ERROR) << "Unsupported geometry format for file: " << msg.m_path;
                 return { OKAMI_UNEXPECTED("Unsupported geometry format: " + ext), msg.m_id };
@@ -46,7 +58,7 @@ namespace okami {
     class GltfSceneIOModule : public IOModule<GltfScene> {
     protected:
         OnResourceLoadedEvent<GltfScene> LoadResource(LoadResourceSignal<GltfScene>&& msg) override {
-            return { GltfScene::FromFile(msg.m_path, msg.m_params), msg.m_id };
+            return { GltfScene::FromFile(msg.m_path, msg.m_params, m_fileSystem), msg.m_id };
         }
     };
 
@@ -2,6 +2,8 @@
 
 #include "content.hpp"
 #include "module.hpp"
+#include "paths.hpp"
+#include "vfs.hpp"
 
 namespace okami {
     template <ResourceType T> 
@@ -10,8 +12,21 @@ namespace okami {
         DefaultSignalHandler<LoadResourceSignal<T>> m_load_handler;
 
     protected:
+        // Null if the engine has none; loaders then read loose files
+        VirtualFileSystem const* m_fileSystem = nullptr;
+
         virtual OnResourceLoadedEvent<T> LoadResource(LoadResourceSignal<T>&& msg) = 0;
 
+        // Reads an asset from the mounted packs or the asset directory
+        Expected<FileData> ReadAsset(std::filesystem::path const& path) const {
+            if (m_fileSystem) {
+                return m_fileSystem->Read(path);
+            }
+            auto bytes = ReadFileBytes(GetAssetPath(path));
+            OKAMI_UNEXPECTED_RETURN(bytes);
+            return FileData(std::move(*bytes));
+        }
+
         Error RegisterImpl(InterfaceCollection& interfaces) override {
             interfaces.RegisterSignalHandler<LoadResourceSignal<T>>(&m_load_handler);
             interfaces.Register<IIOModule>(this);
@@ -19,10 +34,38 @@ namespace okami {
             return {};
         }
 
+        Error StartupImpl(InitContext const& context) override {
+            m_fileSystem = context.m_interfaces.Query<VirtualFileSystem>();
+            return {};
+        }
+
         Error IOProcess(InterfaceCollection& interfaces) override {
-            m_load_handler.Handle([this, &interfaces](LoadResourceSignal<T> const& msg) {
-                auto result = LoadResource(LoadResourceSignal<T>{msg});
-                interfaces.SendSignal(std::move(result));
+            auto* scheduler = interfaces.Query<ILoadScheduler>();
+
+            m_load_handler.Handle([this, &interfaces, scheduler](LoadResourceSignal<T> const& msg) {
+                if (!scheduler) {
+                    if (msg.m_cancelled && msg.m_cancelled->load(std::memory_order_acquire)) {
+                        return;
+                    }
+                    interfaces.SendSignal(LoadResource(LoadResourceSignal<T>{msg}));
+                    return;
+                }
+
+                // The scheduler decides when (and whether) the load runs
+                auto* ic = &interfaces;
+                scheduler->Enqueue(LoadRequest{
+                    .m_priority = msg.m_priority,
+                    .m_cancelled = msg.m_cancelled,
+                    .m_run = [this, ic, msg]() mutable {
+                        ic->SendSignal(LoadResource(std::move(msg)));
+                    },
+                    .m_reject = [ic, id = msg.m_id]() {
+                        ic->SendSignal(OnResourceLoadedEvent<T>{
+                            .m_data = OKAMI_UNEXPECTED("Load queue is full"),
+                            .m_id = id,
+                        });
+                    },
+                });
             });
 
             return {};
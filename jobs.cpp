@@ -1,4 +1,5 @@
 #include "jobs.hpp"
+#include "profiler.hpp"
 
 #include <unordered_set>
 #include <queue>
@@ -30,7 +31,7 @@ Error ExecuteSerial(
 Error okami::DefaultJobGraphExecutor::Execute(JobGraph& graph, MessageBus& bus) {
     graph.Finalize();
 
-    JobContext context{ .m_messageBus = bus };
+    JobContext context{ .m_messageBus = bus, .m_frameAllocator = m_frameAllocator };
     Error err;
 
     // Initialize pending dependencies count
@@ -60,6 +61,7 @@ Error okami::DefaultJobGraphExecutor::Execute(JobGraph& graph, MessageBus& bus)
         // Execute the job
         Error jobErr = {};
         if (node->m_task) {
+            OKAMI_PROFILE_SCOPE(node->m_name ? node->m_name : "Job");
             jobErr = node->m_task(context);
         }
 
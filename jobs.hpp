@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "frame_allocator.hpp"
 
 #include <atomic>
 #include <span>
@@ -8,6 +9,7 @@
 #include <any>
 #include <shared_mutex>
 #include <functional>
+#include <memory_resource>
 
 namespace okami {
     // Message type trait
@@ -69,6 +71,9 @@ namespace okami {
     class IMessagePort {    
     public:
         virtual void Clear() = 0;
+        // Like Clear(), but also frees the storage. Required before the
+        // memory resource backing the port is reset.
+        virtual void Release() = 0;
         virtual std::type_index GetMessageType() const = 0;
 
         virtual ~IMessagePort() = default;
@@ -78,7 +83,10 @@ namespace okami {
     class MessagePort final : public IMessagePort {
     public:
         std::shared_mutex m_mutex;
-        std::vector<T> m_messages;
+        std::pmr::vector<T> m_messages;
+
+        explicit MessagePort(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_messages(resource) {}
 
         void Send(T message) {
             std::unique_lock lock(m_mutex);
@@ -136,6 +144,11 @@ namespace okami {
             std::unique_lock lock(m_mutex);
             m_messages.clear();
         }
+
+        void Release() override {
+            std::unique_lock lock(m_mutex);
+            std::pmr::vector<T>(m_messages.get_allocator()).swap(m_messages);
+        }
     };
 
     template <MessageConcept T>
@@ -266,15 +279,21 @@ namespace okami {
     class MessageBus {
     private:
         std::unordered_map<std::type_index, std::unique_ptr<IMessagePort>> m_ports;
+        std::pmr::memory_resource* m_resource;
 
     public:
+        // Port storage is allocated from the given resource. It must be thread
+        // safe (jobs send concurrently) and outlive the bus; the engine passes
+        // its shared frame arena and calls Release() before resetting it.
+        explicit MessageBus(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_resource(resource) {}
         virtual ~MessageBus() = default;
 
         template <MessageConcept T>
         MessagePort<T>* EnsurePort() {
             std::type_index typeIdx = typeid(T);
             if (m_ports.find(typeIdx) == m_ports.end()) {
-                auto ptr = std::make_unique<MessagePort<T>>();
+                auto ptr = std::make_unique<MessagePort<T>>(m_resource);
                 MessagePort<T>* rawPtr = ptr.get();
                 m_ports[typeIdx] = std::move(ptr);
                 return rawPtr;
@@ -362,15 +381,29 @@ namespace okami {
                 port->Clear();
             }
         }
+
+        void Release() {
+            for (auto& [typeIdx, port] : m_ports) {
+                port->Release();
+            }
+        }
     };
 
     struct JobContext {
         MessageBus& m_messageBus;
+        FrameAllocator* m_frameAllocator = nullptr;
         // Context data for jobs can be added here
+
+        // Scratch memory that is valid until the end of the frame.
+        inline std::pmr::memory_resource* GetFrameResource() const {
+            return okami::GetFrameResource(m_frameAllocator);
+        }
     };
     
     struct JobGraphNode {
         int m_id = -1;
+        // Label used by the profiler; must outlive the graph (see InternProfileName).
+        const char* m_name = nullptr;
         std::vector<std::shared_ptr<JobGraphNode>> m_dependencies;
         std::vector<std::shared_ptr<JobGraphNode>> m_dependents;
         std::function<Error(JobContext&)> m_task = nullptr;
@@ -509,6 +542,13 @@ namespace okami {
             AddEdgeInternal(m_nodes[from], m_nodes[to]);
         }
 
+        void SetNodeName(int id, const char* name) {
+            if (id < 0 || id >= static_cast<int>(m_nodes.size())) {
+                throw std::out_of_range("Invalid node ID: " + std::to_string(id));
+            }
+            m_nodes[id]->m_name = name;
+        }
+
         // New AddMessageNode method
         template <typename Callable>
         int AddMessageNode(Callable task, std::span<int const> dependencies = {}) {
@@ -551,7 +591,13 @@ namespace okami {
     };
 
     class DefaultJobGraphExecutor : public IJobGraphExecutor {
+    private:
+        FrameAllocator* m_frameAllocator;
+
     public:
+        explicit DefaultJobGraphExecutor(FrameAllocator* frameAllocator = nullptr)
+            : m_frameAllocator(frameAllocator) {}
+
         Error Execute(JobGraph& graph, MessageBus& bus) override;
     };
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "load_scheduler.hpp"
+
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+using namespace okami;
+
+namespace {
+	bool IsCancelled(LoadRequest const& request) {
+		return request.m_cancelled && request.m_cancelled->load(std::memory_order_acquire);
+	}
+}
+
+okami::LoadScheduler::LoadScheduler(size_t maxQueueDepth) :
+	m_maxQueueDepth(std::max<size_t>(maxQueueDepth, 1)) {
+}
+
+bool okami::LoadScheduler::Before(Entry const& a, Entry const& b) const {
+	auto const& pa = a.m_request.m_priority;
+	auto const& pb = b.m_request.m_priority;
+	if (pa.m_urgency != pb.m_urgency) {
+		return pa.m_urgency > pb.m_urgency;
+	}
+
+	auto distanceSquared = [this](LoadPriority const& p) {
+		if (!p.m_position) {
+			return 0.0f;
+		}
+		auto d = *p.m_position - m_viewPosition;
+		return glm::dot(d, d);
+	};
+	float da = distanceSquared(pa);
+	float db = distanceSquared(pb);
+	if (da != db) {
+		return da < db;
+	}
+	return a.m_sequence < b.m_sequence;
+}
+
+void okami::LoadScheduler::DropCancelled() {
+	auto removed = std::erase_if(m_queue, [](Entry const& entry) {
+		return IsCancelled(entry.m_request);
+	});
+	m_cancelledCount.fetch_add(removed, std::memory_order_relaxed);
+}
+
+void okami::LoadScheduler::Enqueue(LoadRequest request) {
+	if (IsCancelled(request)) {
+		m_cancelledCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	std::function<void()> reject;
+	{
+		std::lock_guard lock(m_mutex);
+		Entry entry{ std::move(request), m_nextSequence++ };
+
+		if (m_queue.size() >= m_maxQueueDepth) {
+			DropCancelled();
+		}
+		if (m_queue.size() >= m_maxQueueDepth) {
+			auto last = std::max_element(m_queue.begin(), m_queue.end(),
+				[this](Entry const& a, Entry const& b) { return Before(a, b); });
+			if (Before(entry, *last)) {
+				reject = std::move(last->m_request.m_reject);
+				*last = std::move(entry);
+			}
+			else {
+				reject = std::move(entry.m_request.m_reject);
+			}
+			m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			m_queue.push_back(std::move(entry));
+		}
+	}
+
+	// Outside the lock, as it may send signals
+	if (reject) {
+		reject();
+	}
+}
+
+void okami::LoadScheduler::SetViewPosition(glm::vec3 const& position) {
+	std::lock_guard lock(m_mutex);
+	m_viewPosition = position;
+}
+
+void okami::LoadScheduler::SetMaxLoadsPerFrame(uint32_t count) {
+	std::lock_guard lock(m_mutex);
+	m_maxLoadsPerFrame = count;
+}
+
+size_t okami::LoadScheduler::GetQueueDepth() const {
+	std::lock_guard lock(m_mutex);
+	return m_queue.size();
+}
+
+size_t okami::LoadScheduler::Process() {
+	std::vector<Entry> ready;
+	{
+		std::lock_guard lock(m_mutex);
+		DropCancelled();
+
+		// Ranked here rather than on insertion since the view moves
+		size_t count = m_maxLoadsPerFrame == 0
+			? m_queue.size()
+			: std::min<size_t>(m_maxLoadsPerFrame, m_queue.size());
+		auto before = [this](Entry const& a, Entry const& b) { return Before(a, b); };
+		if (count < m_queue.size()) {
+			std::partial_sort(m_queue.begin(), m_queue.begin() + count, m_queue.end(), before);
+		}
+		else {
+			std::sort(m_queue.begin(), m_queue.end(), before);
+		}
+
+		ready.reserve(count);
+		std::move(m_queue.begin(), m_queue.begin() + count, std::back_inserter(ready));
+		m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+	}
+
+	// Loads run outside the lock so they can queue follow-up requests
+	size_t ran = 0;
+	for (auto& entry : ready) {
+		// A load may have been cancelled by an earlier one in this batch
+		if (IsCancelled(entry.m_request)) {
+			m_cancelledCount.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		entry.m_request.m_run();
+		++ran;
+	}
+	return ran;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace okami {
+	// Requester hints for ordering resource loads. Loads are started by
+	// descending urgency, then by distance from the view (loads without a
+	// position count as being at the view), then in request order.
+	struct LoadPriority {
+		float m_urgency = 0.0f;
+		// Where the resource will be seen, e.g. the spawn position of the
+		// entity that needs it
+		std::optional<glm::vec3> m_position;
+
+		static constexpr float kUrgent = 100.0f;
+		static constexpr float kBackground = -100.0f;
+	};
+
+	// Set by a requester once nobody wants the result of a queued load
+	using LoadCancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+	inline LoadCancelFlag MakeLoadCancelFlag() {
+		return std::make_shared<std::atomic<bool>>(false);
+	}
+
+	struct LoadRequest {
+		LoadPriority m_priority;
+		// Null if the load can't be cancelled
+		std::shared_ptr<std::atomic<bool> const> m_cancelled;
+		// Does the load and reports the result to the requester
+		std::function<void()> m_run;
+		// Reports failure to the requester when the request is pushed out of
+		// a full queue
+		std::function<void()> m_reject;
+	};
+
+	class ILoadScheduler {
+	public:
+		virtual ~ILoadScheduler() = default;
+
+		// Thread safe
+		virtual void Enqueue(LoadRequest request) = 0;
+		virtual void SetViewPosition(glm::vec3 const& position) = 0;
+		// 0 runs every queued load each frame
+		virtual void SetMaxLoadsPerFrame(uint32_t count) = 0;
+		virtual size_t GetQueueDepth() const = 0;
+	};
+
+	// Orders the loads requested by all IO modules. The engine runs Process()
+	// once per frame after the IO modules have queued that frame's requests;
+	// with a per-frame limit, the rest wait for later frames and are
+	// re-ranked against the view each time, so the most important assets for
+	// the current view arrive first. Cancelled requests are dropped without
+	// being run. The queue holds at most maxQueueDepth requests; past that,
+	// the least important one is rejected.
+	class LoadScheduler final : public ILoadScheduler {
+	public:
+		static constexpr size_t kDefaultMaxQueueDepth = 4096;
+
+		explicit LoadScheduler(size_t maxQueueDepth = kDefaultMaxQueueDepth);
+
+		void Enqueue(LoadRequest request) override;
+		void SetViewPosition(glm::vec3 const& position) override;
+		void SetMaxLoadsPerFrame(uint32_t count) override;
+		size_t GetQueueDepth() const override;
+
+		// Runs queued loads, most important first, up to the per-frame limit.
+		// Returns how many ran.
+		size_t Process();
+
+		inline size_t GetCancelledCount() const { return m_cancelledCount.load(std::memory_order_relaxed); }
+		inline size_t GetRejectedCount() const { return m_rejectedCount.load(std::memory_order_relaxed); }
+
+	private:
+		struct Entry {
+			LoadRequest m_request;
+			uint64_t m_sequence = 0;
+		};
+
+		// True if a should run before b
+		bool Before(Entry const& a, Entry const& b) const;
+		// Removes cancelled requests; caller holds the lock
+		void DropCancelled();
+
+		mutable std::mutex m_mutex;
+		std::vector<Entry> m_queue;
+		size_t m_maxQueueDepth;
+		uint32_t m_maxLoadsPerFrame = 0;
+		uint64_t m_nextSequence = 0;
+		glm::vec3 m_viewPosition{ 0.0f, 0.0f, 0.0f };
+
+		std::atomic<size_t> m_cancelledCount{ 0 };
+		std::atomic<size_t> m_rejectedCount{ 0 };
+	};
+}
@@ -12,6 +12,7 @@
 #include "entity_manager.hpp"
 #include "entity_tree_view.hpp"
 #include "animation.hpp"
+#include "tilemap.hpp"
 #include "editor.hpp"
 
 using namespace okami;
@@ -29,6 +30,11 @@ protected:
             auto& registry = params.m_registry;
 
             if (meta.m_componentMetaData->b_defaultAddHandler) {
+                // Entity batches can add many components at once; grow the storage once
+                if (auto* added = bus.GetPort<AddComponentSignal<ComponentT>>()) {
+                    auto& storage = registry.storage<ComponentT>();
+                    storage.reserve(storage.size() + added->m_messages.size());
+                }
                 bus.Handle<AddComponentSignal<ComponentT>>([&](AddComponentSignal<ComponentT> const& signal) {
                     registry.emplace<ComponentT>(signal.m_entity, signal.m_component);
                 });
@@ -429,6 +435,12 @@ protected:
             }
         });
 
+        RegisterComponent<TileMapComponent>("TileMap"_hs, MetaData{
+            .m_componentMetaData = ComponentMetaData{
+                .m_displayName = "Tile Map",
+            }
+        });
+
         RegisterComponent<DummyTriangleComponent>("DummyTriangle"_hs, MetaData{
             .m_componentMetaData = ComponentMetaData{
                 .m_displayName = "Dummy Triangle",
@@ -1,4 +1,5 @@
 #include "module.hpp"
+#include "profiler.hpp"
 
 #include <glog/logging.h>
 
@@ -64,10 +65,8 @@ Error EngineModule::Startup(InitContext const& a) {
     OKAMI_ERROR_RETURN(e);
 
     if (b_children_process_startup) {
-        for (auto& mod : m_submodules) {
-            e += mod->Startup(a);
-            OKAMI_ERROR_RETURN(e);
-        }
+        e += StartupChildren(a);
+        OKAMI_ERROR_RETURN(e);
     }
 
     b_started = true;
@@ -75,10 +74,42 @@ Error EngineModule::Startup(InitContext const& a) {
     return {};
 }
 
+Error EngineModule::StartupChildren(InitContext const& a) {
+    for (auto& mod : m_submodules) {
+        Error e = mod->Startup(a);
+        OKAMI_ERROR_RETURN(e);
+    }
+    return {};
+}
+
+const char* EngineModule::GetProfileName() {
+    if (!m_profileName) {
+        m_profileName = InternProfileName(GetName());
+    }
+    return m_profileName;
+}
+
 Error EngineModule::BuildGraph(JobGraph& a, BuildGraphParams const& b) {
     OKAMI_ASSERT(b_started, "Module must be started before processing frames");
 
-    Error e = BuildGraphImpl(a, b);
+    Error e;
+    if (IsProfilerEnabled()) {
+        // Label the nodes this module adds so executed jobs show up under
+        // the module's name in traces.
+        auto const firstNode = a.GetNodes().size();
+        {
+            OKAMI_PROFILE_SCOPE(GetProfileName());
+            e = BuildGraphImpl(a, b);
+        }
+        auto const& nodes = a.GetNodes();
+        for (auto i = firstNode; i < nodes.size(); ++i) {
+            if (!nodes[i]->m_name) {
+                nodes[i]->m_name = GetProfileName();
+            }
+        }
+    } else {
+        e = BuildGraphImpl(a, b);
+    }
     OKAMI_ERROR_RETURN(e);
 
     if (!b_children_build_update_graph) {
@@ -95,7 +126,11 @@ Error EngineModule::BuildGraph(JobGraph& a, BuildGraphParams const& b) {
 Error EngineModule::SendMessages(MessageBus& a) {
     OKAMI_ASSERT(b_started, "Module must be started before processing frames");
 
-    Error e = SendMessagesImpl(a);
+    Error e;
+    {
+        OKAMI_PROFILE_SCOPE(IsProfilerEnabled() ? GetProfileName() : nullptr);
+        e = SendMessagesImpl(a);
+    }
     OKAMI_ERROR_RETURN(e);
 
     for (auto& mod : m_submodules) {
@@ -108,7 +143,11 @@ Error EngineModule::SendMessages(MessageBus& a) {
 Error EngineModule::ReceiveMessages(MessageBus& a, RecieveMessagesParams const& b) {
     OKAMI_ASSERT(b_started, "Module must be started before processing frames");
 
-    Error e = ReceiveMessagesImpl(a, b);
+    Error e;
+    {
+        OKAMI_PROFILE_SCOPE(IsProfilerEnabled() ? GetProfileName() : nullptr);
+        e = ReceiveMessagesImpl(a, b);
+    }
     OKAMI_ERROR_RETURN(e);
 
     for (auto& mod : m_submodules) {
@@ -173,6 +173,11 @@ namespace okami {
         bool b_children_build_update_graph = true;
         bool b_children_process_startup = true;
 
+        // Interned GetName(), resolved the first time a profiled frame needs it
+        const char* m_profileName = nullptr;
+
+        const char* GetProfileName();
+
     protected:
         inline void SetChildrenProcessFrame(bool enable) {
             b_children_build_update_graph = enable;
@@ -182,6 +187,10 @@ namespace okami {
             b_children_process_startup = enable;
         }
 
+        // Starts the children; for modules that turned off automatic child
+        // startup to run code after it
+        Error StartupChildren(InitContext const&);
+
         virtual Error RegisterImpl(InterfaceCollection&) { return {}; }
 
         virtual Error StartupImpl(InitContext const&) { return {}; }
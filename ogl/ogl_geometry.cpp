@@ -4,15 +4,148 @@
 #include "shaders/static_mesh.glsl"
 #include "shaders/skinned_mesh.glsl"
 
+#include "../config.hpp"
+#include "../renderer.hpp"
+
 #include <glog/logging.h>
+#include <numeric>
+#include <utility>
 
 using namespace okami;
 
+// Initial mega-buffer sizes; both grow by doubling on demand.
+static constexpr uint32_t kInitialMegaVertices = 1u << 16;
+static constexpr uint32_t kInitialMegaIndices  = 1u << 18;
+
+// ---------------------------------------------------------------------------
+// OGLMegaBuffer
+// ---------------------------------------------------------------------------
+
+static Error AllocateGLBuffer(GLBuffer& buffer, size_t byteSize) {
+    glGenBuffers(1, buffer.ptr());
+    OKAMI_ERROR_RETURN_IF(!buffer, "Failed to create mega buffer");
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.get());
+    OKAMI_DEFER(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    glBufferData(GL_COPY_WRITE_BUFFER, byteSize, nullptr, GL_STATIC_DRAW);
+    return GET_GL_ERROR();
+}
+
+Expected<std::shared_ptr<OGLMegaBuffer>> OGLMegaBuffer::Create(
+    uint32_t vertexStride,
+    uint32_t vertexCapacity,
+    uint32_t indexCapacity) {
+    auto result = std::make_shared<OGLMegaBuffer>();
+    result->m_vertexStride = vertexStride;
+
+    auto err = AllocateGLBuffer(result->m_vertexBuffer, size_t{vertexCapacity} * vertexStride);
+    OKAMI_UNEXPECTED_RETURN(err);
+    err = AllocateGLBuffer(result->m_indexBuffer, size_t{indexCapacity} * sizeof(uint32_t));
+    OKAMI_UNEXPECTED_RETURN(err);
+
+    result->m_vertexAlloc.Grow(vertexCapacity);
+    result->m_indexAlloc.Grow(indexCapacity);
+    return result;
+}
+
+Error OGLMegaBuffer::Grow(GLBuffer& buffer, RangeAllocator& alloc, uint32_t elementSize, uint32_t minExtra) {
+    const uint32_t oldCapacity = alloc.GetCapacity();
+    const uint32_t newCapacity = std::max(oldCapacity * 2, oldCapacity + minExtra);
+
+    GLBuffer newBuffer;
+    auto err = AllocateGLBuffer(newBuffer, size_t{newCapacity} * elementSize);
+    OKAMI_ERROR_RETURN(err);
+
+    // Copy the live contents across; GL keeps the old storage alive until any
+    // in-flight draws that reference it have completed.
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer.get());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer.get());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size_t{oldCapacity} * elementSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    err = GET_GL_ERROR();
+    OKAMI_ERROR_RETURN(err);
+
+    buffer = std::move(newBuffer);
+    alloc.Grow(newCapacity);
+    ++m_generation;
+
+    LOG(INFO) << "OGLMegaBuffer: grew buffer to " << newCapacity << " elements";
+    return {};
+}
+
+Expected<OGLMegaBuffer::Allocation> OGLMegaBuffer::Upload(
+    std::span<uint8_t const>  vertexData,
+    std::span<uint32_t const> indices) {
+    OKAMI_UNEXPECTED_RETURN_IF(vertexData.size() % m_vertexStride != 0,
+        "Vertex data size is not a multiple of the mega buffer vertex stride");
+
+    const auto vertexCount = static_cast<uint32_t>(vertexData.size() / m_vertexStride);
+    const auto indexCount  = static_cast<uint32_t>(indices.size());
+
+    std::lock_guard lock(m_mtx);
+
+    auto baseVertex = m_vertexAlloc.Allocate(vertexCount);
+    if (!baseVertex) {
+        auto err = Grow(m_vertexBuffer, m_vertexAlloc, m_vertexStride, vertexCount);
+        OKAMI_UNEXPECTED_RETURN(err);
+        baseVertex = m_vertexAlloc.Allocate(vertexCount);
+    }
+    OKAMI_UNEXPECTED_RETURN_IF(!baseVertex, "Failed to allocate vertices from mega buffer");
+
+    auto firstIndex = m_indexAlloc.Allocate(indexCount);
+    if (!firstIndex) {
+        auto err = Grow(m_indexBuffer, m_indexAlloc, sizeof(uint32_t), indexCount);
+        if (err.IsError()) {
+            m_vertexAlloc.Free(*baseVertex, vertexCount);
+            return std::unexpected(std::move(err));
+        }
+        firstIndex = m_indexAlloc.Allocate(indexCount);
+    }
+    if (!firstIndex) {
+        m_vertexAlloc.Free(*baseVertex, vertexCount);
+        return OKAMI_UNEXPECTED("Failed to allocate indices from mega buffer");
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer.get());
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+        size_t{*baseVertex} * m_vertexStride, vertexData.size(), vertexData.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer.get());
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+        size_t{*firstIndex} * sizeof(uint32_t), indices.size_bytes(), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    auto err = GET_GL_ERROR();
+    OKAMI_UNEXPECTED_RETURN(err);
+
+    return Allocation{
+        .m_baseVertex  = *baseVertex,
+        .m_vertexCount = vertexCount,
+        .m_firstIndex  = *firstIndex,
+        .m_indexCount  = indexCount,
+    };
+}
+
+void OGLMegaBuffer::Free(Allocation const& allocation) {
+    std::lock_guard lock(m_mtx);
+    m_vertexAlloc.Free(allocation.m_baseVertex, allocation.m_vertexCount);
+    m_indexAlloc.Free(allocation.m_firstIndex, allocation.m_indexCount);
+}
+
 // ---------------------------------------------------------------------------
 // OGLGeometry destructor – defers GL deletions to the GL thread
 // ---------------------------------------------------------------------------
 
 OGLGeometry::~OGLGeometry() {
+    if (m_load_cancelled) {
+        m_load_cancelled->store(true, std::memory_order_release);
+    }
+    if (m_megaBuffer) {
+        for (auto const& prim : m_meshes) {
+            if (prim.m_megaAllocation) {
+                m_megaBuffer->Free(*prim.m_megaAllocation);
+            }
+        }
+    }
     if (m_deletion_queue) {
         for (auto& prim : m_meshes) {
             if (GLuint id = prim.m_vao.release(); id != 0) {
@@ -31,10 +164,53 @@ OGLGeometry::~OGLGeometry() {
 // Helper: build GL buffers/VAOs from CPU-side Geometry (GL thread only)
 // ---------------------------------------------------------------------------
 
-static Error UploadToGL(OGLGeometry& out, Geometry&& data) {
+// Widens the primitive's indices to uint32, or generates a trivial index list
+// for non-indexed primitives, so that every mega-buffer draw is indexed.
+static std::vector<uint32_t> GetWidenedIndices(Geometry const& data, GeometryPrimitiveDesc const& primitive) {
+    std::vector<uint32_t> result;
+    if (!primitive.m_indices) {
+        result.resize(primitive.m_vertexCount);
+        std::iota(result.begin(), result.end(), 0u);
+        return result;
+    }
+
+    auto const& info = *primitive.m_indices;
+    auto src = data.GetBuffers()[info.m_buffer].data() + info.m_offset;
+    result.resize(info.m_count);
+    for (size_t i = 0; i < info.m_count; ++i) {
+        switch (info.m_type) {
+            case AccessorComponentType::UByte:
+                result[i] = src[i];
+                break;
+            case AccessorComponentType::UShort: {
+                uint16_t v;
+                std::memcpy(&v, src + i * sizeof(uint16_t), sizeof(v));
+                result[i] = v;
+                break;
+            }
+            default:
+                std::memcpy(&result[i], src + i * sizeof(uint32_t), sizeof(uint32_t));
+                break;
+        }
+    }
+    return result;
+}
+
+static Error UploadToGL(OGLGeometry& out, Geometry&& data, std::shared_ptr<OGLMegaBuffer> const& megaBuffer) {
     std::vector<GLBuffer>     oglBuffers;
     std::vector<PrimitiveImpl> primitivesImpl;
     GeometryDesc newDesc;
+    size_t gpuBytes = 0;
+
+    // Mega-buffer ranges are otherwise only freed through a geometry's
+    // m_meshes, so give back the ones taken here if a later step fails
+    ScopeGuard freeMegaAllocations([&]() {
+        for (auto const& prim : primitivesImpl) {
+            if (prim.m_megaAllocation) {
+                megaBuffer->Free(*prim.m_megaAllocation);
+            }
+        }
+    });
 
     for (auto const& primitive : data.GetPrimitives()) {
         auto vsInputInfo = [&]() -> glsl::VertexShaderInputInfo {
@@ -69,6 +245,36 @@ static Error UploadToGL(OGLGeometry& out, Geometry&& data) {
             }
         }
 
+        // Static primitives are suballocated from the shared mega buffer when
+        // multi-draw indirect is available.
+        if (megaBuffer && primitive.m_type == MeshType::Static) {
+            auto indices    = GetWidenedIndices(data, primitive);
+            auto allocation = megaBuffer->Upload(bufferData, indices);
+            OKAMI_ERROR_RETURN(allocation);
+
+            // Where the primitive sits in the mega buffers is only kept in
+            // its PrimitiveImpl, so the desc doesn't change when evicted
+            // geometry is uploaded again elsewhere.
+            GeometryPrimitiveDesc newPrim = primitive;
+            for (auto& [_, attr] : newPrim.m_attributes) {
+                attr.m_buffer = -1;
+                attr.m_offset = 0;
+                attr.m_stride = vsInputInfo.m_totalStride;
+            }
+            newPrim.m_indices = IndexInfo{
+                .m_type   = AccessorComponentType::UInt,
+                .m_buffer = -1,
+                .m_count  = allocation->m_indexCount,
+                .m_offset = 0,
+            };
+            newDesc.m_primitives.push_back(std::move(newPrim));
+            gpuBytes += bufferData.size() + indices.size() * sizeof(uint32_t);
+
+            primitivesImpl.emplace_back(PrimitiveImpl{.m_megaAllocation = *allocation});
+            out.m_megaBuffer = megaBuffer;
+            continue;
+        }
+
         // Vertex buffer
         GLBuffer vertexBuffer;
         glGenBuffers(1, vertexBuffer.ptr());
@@ -78,6 +284,7 @@ static Error UploadToGL(OGLGeometry& out, Geometry&& data) {
         glBufferData(GL_ARRAY_BUFFER, totalSize, bufferData.data(), GL_STATIC_DRAW);
         int vertexBufferIndex = static_cast<int>(oglBuffers.size());
         oglBuffers.push_back(std::move(vertexBuffer));
+        gpuBytes += totalSize;
 
         // Index buffer (optional)
         std::optional<int> indexBufferIndex;
@@ -94,6 +301,7 @@ static Error UploadToGL(OGLGeometry& out, Geometry&& data) {
                 GL_STATIC_DRAW);
             indexBufferIndex = static_cast<int>(oglBuffers.size());
             oglBuffers.push_back(std::move(indexBuffer));
+            gpuBytes += primitive.m_indices->GetTotalSize();
         }
 
         // VAO
@@ -122,34 +330,151 @@ static Error UploadToGL(OGLGeometry& out, Geometry&& data) {
         newDesc.m_primitives.push_back(std::move(newPrim));
     }
 
-    out.m_meshes  = std::move(primitivesImpl);
-    out.m_buffers = std::move(oglBuffers);
-    out.m_desc    = std::move(newDesc);
+    freeMegaAllocations.Dismiss();
+    out.m_meshes   = std::move(primitivesImpl);
+    out.m_buffers  = std::move(oglBuffers);
+    out.m_desc     = std::move(newDesc);
+    out.m_gpuBytes = gpuBytes;
+    out.b_resident = true;
     out.m_loaded.store(true, std::memory_order_release);
     return {};
 }
 
+// True if two uploaded descs agree in every field, as two uploads of the
+// same file do
+static bool HasSameLayout(GeometryDesc const& a, GeometryDesc const& b) {
+    if (a.m_primitives.size() != b.m_primitives.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.m_primitives.size(); ++i) {
+        auto const& pa = a.m_primitives[i];
+        auto const& pb = b.m_primitives[i];
+        if (pa.m_type != pb.m_type ||
+            pa.m_vertexCount != pb.m_vertexCount ||
+            pa.m_indices.has_value() != pb.m_indices.has_value() ||
+            pa.m_attributes.size() != pb.m_attributes.size() ||
+            pa.m_aabb.m_min != pb.m_aabb.m_min ||
+            pa.m_aabb.m_max != pb.m_aabb.m_max) {
+            return false;
+        }
+        if (pa.m_indices && (
+            pa.m_indices->m_type   != pb.m_indices->m_type ||
+            pa.m_indices->m_buffer != pb.m_indices->m_buffer ||
+            pa.m_indices->m_count  != pb.m_indices->m_count ||
+            pa.m_indices->m_offset != pb.m_indices->m_offset)) {
+            return false;
+        }
+        for (auto const& [type, attr] : pa.m_attributes) {
+            auto const* other = pb.TryGetAttribute(type);
+            if (!other ||
+                other->m_buffer != attr.m_buffer ||
+                other->m_offset != attr.m_offset ||
+                other->m_stride != attr.m_stride) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Uploads reloaded data beside the live geometry and swaps it in, so a
+// failed upload leaves the old data; the old buffers and mega-buffer ranges
+// go out with the staging geometry. The desc is read by other threads
+// without a lock (e.g. scene queries), so it never changes once loaded:
+// new vertex data with the same layout and bounds is taken, anything else
+// is refused until the next start.
+static Error ApplyReload(
+    OGLGeometry&                             geometry,
+    Geometry&&                               data,
+    std::shared_ptr<OGLMegaBuffer> const&    megaBuffer,
+    std::shared_ptr<OGLDeletionQueue> const& deletionQueue) {
+    OGLGeometry staging;
+    staging.m_deletion_queue = deletionQueue;
+    OKAMI_ERROR_RETURN(UploadToGL(staging, std::move(data), megaBuffer));
+    OKAMI_ERROR_RETURN_IF(!HasSameLayout(geometry.m_desc, staging.m_desc),
+        "Reloaded geometry changed its layout or bounds; restart to pick it up");
+
+    std::swap(geometry.m_meshes,     staging.m_meshes);
+    std::swap(geometry.m_buffers,    staging.m_buffers);
+    std::swap(geometry.m_megaBuffer, staging.m_megaBuffer);
+    std::swap(geometry.m_gpuBytes,   staging.m_gpuBytes);
+    geometry.b_resident = true;
+    return {};
+}
+
+// Uploads the data of evicted geometry again. Other threads may be reading
+// its desc, which is left alone: buffer locations in it don't depend on
+// where the data lands, so an unchanged file gives the same desc. As with
+// reloads, a file whose layout changed is refused.
+static Error RestoreResident(
+    OGLGeometry&                             geometry,
+    Geometry&&                               data,
+    std::shared_ptr<OGLMegaBuffer> const&    megaBuffer,
+    std::shared_ptr<OGLDeletionQueue> const& deletionQueue) {
+    OGLGeometry staging;
+    staging.m_deletion_queue = deletionQueue;
+    OKAMI_ERROR_RETURN(UploadToGL(staging, std::move(data), megaBuffer));
+    OKAMI_ERROR_RETURN_IF(!HasSameLayout(geometry.m_desc, staging.m_desc),
+        "Geometry changed its layout on disk while evicted; restart to pick it up");
+
+    std::swap(geometry.m_meshes,     staging.m_meshes);
+    std::swap(geometry.m_buffers,    staging.m_buffers);
+    std::swap(geometry.m_megaBuffer, staging.m_megaBuffer);
+    geometry.m_gpuBytes = staging.m_gpuBytes;
+    geometry.b_resident = true;
+    return {};
+}
+
 // ---------------------------------------------------------------------------
 // OGLGeometryManager
 // ---------------------------------------------------------------------------
 
 Error OGLGeometryManager::RegisterImpl(InterfaceCollection& ic) {
     ic.Register<IGeometryManager>(this);
+    ic.Register<IAssetReloader>(this);
     ic.RegisterSignalHandler<OnResourceLoadedEvent<Geometry>>(&m_loaded_handler);
+    m_interfaces = &ic;
+    return {};
+}
+
+Error OGLGeometryManager::StartupImpl(InitContext const& context) {
+    auto config = ReadConfig<RendererConfig>(context.m_interfaces, LOG_WRAP(WARNING));
+    if (!config.multiDrawIndirect) {
+        LOG(INFO) << "OGLGeometryManager: multi-draw indirect disabled by config";
+        return {};
+    }
+
+    auto* glProvider = context.m_interfaces.Query<IGLProvider>();
+    OKAMI_ERROR_RETURN_IF(!glProvider, "IGLProvider interface not available for OGLGeometryManager");
+
+    if (!LoadMultiDrawIndirect(reinterpret_cast<GLADloadfunc>(glProvider->GetGLLoaderFunction()))) {
+        LOG(INFO) << "OGLGeometryManager: multi-draw indirect not supported, using per-geometry buffers";
+        return {};
+    }
+
+    auto megaBuffer = OGLMegaBuffer::Create(
+        glsl::__get_vs_input_infoStaticMeshVertex().m_totalStride,
+        kInitialMegaVertices,
+        kInitialMegaIndices);
+    OKAMI_ERROR_RETURN(megaBuffer);
+    m_megaBuffer = std::move(*megaBuffer);
+
+    LOG(INFO) << "OGLGeometryManager: static meshes use a shared mega buffer with multi-draw indirect";
     return {};
 }
 
 GeometryHandle OGLGeometryManager::LoadGeometry(
     std::filesystem::path const& path,
     GeometryLoadParams            params,
-    InterfaceCollection&          ic) {
+    InterfaceCollection&          ic,
+    LoadPriority                  priority) {
 
     // Dedup: return existing handle if still alive.
     {
         std::lock_guard lock(m_mtx);
         auto it = m_path_cache.find(path);
         if (it != m_path_cache.end()) {
-            if (auto existing = it->second.lock()) {
+            if (auto existing = it->second.m_geometry.lock()) {
                 return existing;
             }
             m_path_cache.erase(it);
@@ -157,39 +482,85 @@ GeometryHandle OGLGeometryManager::LoadGeometry(
     }
 
     auto id      = m_next_id.fetch_add(1, std::memory_order_relaxed);
-    auto pending = std::make_unique<PendingLoad>();
-    pending->m_geometry                   = std::make_shared<OGLGeometry>();
-    pending->m_geometry->m_deletion_queue = m_deletion_queue;
-
-    GeometryHandle handle = pending->m_geometry;
+    auto geometry = std::make_shared<OGLGeometry>();
+    geometry->m_deletion_queue = m_deletion_queue;
+    geometry->m_load_cancelled = MakeLoadCancelFlag();
 
     {
         std::lock_guard lock(m_mtx);
-        m_path_cache[path] = pending->m_geometry;
-        m_pending[id]      = std::move(pending);
+        m_path_cache[path] = CachedGeometry{ geometry, params };
+        m_pending[id]      = std::make_unique<PendingLoad>(PendingLoad{
+            .m_geometry = geometry,
+            .m_path     = path,
+            .m_params   = params,
+        });
     }
 
     ic.SendSignal(LoadResourceSignal<Geometry>{
-        .m_path   = path,
-        .m_params = params,
-        .m_id     = id,
+        .m_path      = path,
+        .m_params    = params,
+        .m_id        = id,
+        .m_priority  = priority,
+        .m_cancelled = geometry->m_load_cancelled,
     });
 
-    return handle;
+    return geometry;
+}
+
+size_t OGLGeometryManager::ReloadAsset(
+    std::string_view         key,
+    VirtualFileSystem const& fs,
+    InterfaceCollection&     ic) {
+
+    std::vector<LoadResourceSignal<Geometry>> loads;
+    {
+        std::lock_guard lock(m_mtx);
+        for (auto const& [path, cached] : m_path_cache) {
+            auto geometry = cached.m_geometry.lock();
+            // A first load still in flight reads the new file anyway
+            if (!geometry || !geometry->IsLoaded() || fs.GetAssetKey(path) != key) {
+                continue;
+            }
+
+            auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+            m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{
+                .m_geometry = geometry,
+                .b_reload   = true,
+            });
+            loads.push_back(LoadResourceSignal<Geometry>{
+                .m_path      = path,
+                .m_params    = cached.m_params,
+                .m_id        = id,
+                .m_priority  = LoadPriority{ .m_urgency = LoadPriority::kUrgent },
+                .m_cancelled = geometry->m_load_cancelled,
+            });
+        }
+    }
+
+    for (auto& load : loads) {
+        ic.SendSignal(std::move(load));
+    }
+    return loads.size();
 }
 
 GeometryHandle OGLGeometryManager::CreateGeometry(Geometry data) {
     auto geo = std::make_shared<OGLGeometry>();
     geo->m_deletion_queue = m_deletion_queue;
-    auto err = UploadToGL(*geo, std::move(data));
-    if (err.IsError()) {
-        LOG(WARNING) << "OGLGeometryManager::CreateGeometry: GL upload failed: " << err;
+
+    // Queued like a finished load: the caller may not be on the GL thread
+    auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(m_mtx);
+        m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{ .m_geometry = geo });
     }
-    return geo;
+    m_loaded_handler.Send(OnResourceLoadedEvent<Geometry>{
+        .m_data = std::move(data),
+        .m_id   = id,
+    });
+    return geo; // IsLoaded() = false; becomes true after ProcessUploads
 }
 
-Error OGLGeometryManager::ReceiveMessagesImpl(
-    MessageBus& /*bus*/, RecieveMessagesParams const& /*params*/) {
+Error OGLGeometryManager::ProcessUploads() {
 
     // Drain GL deletions deferred from non-GL threads.
     m_deletion_queue->Drain();
@@ -197,29 +568,143 @@ Error OGLGeometryManager::ReceiveMessagesImpl(
     Error err;
 
     m_loaded_handler.Handle([&](OnResourceLoadedEvent<Geometry> msg) {
+        std::shared_ptr<OGLGeometry> geo;
+        bool isReload = false;
+        bool isRestore = false;
+        std::filesystem::path path;
+        GeometryLoadParams params;
+        {
+            std::lock_guard lock(m_mtx);
+            auto it = m_pending.find(msg.m_id);
+            if (it == m_pending.end()) {
+                return;
+            }
+            geo = it->second->m_geometry.lock();
+            isReload = it->second->b_reload;
+            isRestore = it->second->b_restore;
+            path = std::move(it->second->m_path);
+            params = it->second->m_params;
+            m_pending.erase(it);
+        }
+
         if (!msg.m_data) {
             err += msg.m_data.error();
             LOG(ERROR) << "OGLGeometryManager: geometry load failed: " << msg.m_data.error();
             return;
         }
+        if (!geo) {
+            return; // handle was released before load completed
+        }
 
-        auto id = msg.m_id;
-
-        std::shared_ptr<OGLGeometry> geo;
-        {
-            std::lock_guard lock(m_mtx);
-            auto it = m_pending.find(id);
-            if (it == m_pending.end()) {
-                return; // handle was released before load completed
+        if (isReload) {
+            err += ApplyReload(*geo, std::move(*msg.m_data), m_megaBuffer, m_deletion_queue);
+            return;
+        }
+        if (isRestore) {
+            // A reload may have brought it back already
+            if (geo->b_resident) {
+                return;
             }
-            geo = it->second->m_geometry;
-            m_pending.erase(it);
+            if (auto restoreErr = RestoreResident(*geo, std::move(*msg.m_data), m_megaBuffer, m_deletion_queue);
+                restoreErr.IsError()) {
+                err += restoreErr;
+                return;
+            }
+            ++m_restores;
+            return;
         }
 
-        err += UploadToGL(*geo, std::move(*msg.m_data));
+        if (auto uploadErr = UploadToGL(*geo, std::move(*msg.m_data), m_megaBuffer); uploadErr.IsError()) {
+            err += uploadErr;
+            return;
+        }
+        m_residents.push_back(ResidentGeometry{ .m_geometry = geo, .m_path = std::move(path), .m_params = params });
     });
 
+    // Loads cancelled by releasing the geometry never report back
+    {
+        std::lock_guard lock(m_mtx);
+        std::erase_if(m_pending, [](auto const& entry) {
+            return entry.second->m_geometry.expired();
+        });
+    }
+
     return err;
 }
 
 
+
+void OGLGeometryManager::UpdateResidency(uint64_t frame, std::vector<ResidentResource>& out) {
+    std::erase_if(m_residents, [](auto const& resident) { return resident.m_geometry.expired(); });
+
+    for (auto& resident : m_residents) {
+        auto geometry = resident.m_geometry.lock();
+        if (!geometry) {
+            out.push_back(ResidentResource{ .m_kind = ResidencyKind::Geometry });
+            continue; // released since, but keeps the indices in step
+        }
+
+        const bool used = std::exchange(geometry->b_used, false);
+        if (used || resident.m_lastUsedFrame == 0) {
+            resident.m_lastUsedFrame = frame;
+        }
+        if (geometry->b_resident) {
+            resident.b_restoring = false; // restored, or brought back by a reload
+        }
+
+        // Drawn while evicted: load it again. A failed load is not retried
+        // until the file is reloaded.
+        if (used && !geometry->b_resident && !resident.b_restoring) {
+            auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard lock(m_mtx);
+                m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{
+                    .m_geometry = geometry,
+                    .b_restore  = true,
+                });
+            }
+            resident.b_restoring = true;
+            m_interfaces->SendSignal(LoadResourceSignal<Geometry>{
+                .m_path      = resident.m_path,
+                .m_params    = resident.m_params,
+                .m_id        = id,
+                .m_priority  = LoadPriority{ .m_urgency = LoadPriority::kUrgent },
+                .m_cancelled = geometry->m_load_cancelled,
+            });
+        }
+
+        const size_t bytes = geometry->b_resident ? geometry->m_gpuBytes : 0;
+        out.push_back(ResidentResource{
+            .m_kind           = ResidencyKind::Geometry,
+            .m_bytes          = bytes,
+            .m_evictableBytes = resident.m_path.empty() ? 0 : bytes,
+            .m_lastUsedFrame  = resident.m_lastUsedFrame,
+        });
+    }
+}
+
+size_t OGLGeometryManager::EvictResident(size_t index) {
+    auto const& resident = m_residents.at(index);
+    auto geometry = resident.m_geometry.lock();
+    if (!geometry || resident.m_path.empty() || !geometry->b_resident) {
+        return 0;
+    }
+
+    // On the GL thread, so the VAOs and buffers are deleted right away
+    if (geometry->m_megaBuffer) {
+        for (auto const& prim : geometry->m_meshes) {
+            if (prim.m_megaAllocation) {
+                geometry->m_megaBuffer->Free(*prim.m_megaAllocation);
+            }
+        }
+    }
+    geometry->m_meshes.clear();
+    geometry->m_buffers.clear();
+    geometry->m_megaBuffer.reset();
+    geometry->b_resident = false;
+    return std::exchange(geometry->m_gpuBytes, 0);
+}
+
+uint64_t OGLGeometryManager::TakeRestoreCount() {
+    return std::exchange(m_restores, 0);
+}
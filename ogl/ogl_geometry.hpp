@@ -4,14 +4,70 @@
 
 #include "../geometry.hpp"
 #include "../content.hpp"
+#include "../range_allocator.hpp"
+#include "../residency.hpp"
 
 #include <atomic>
 #include <mutex>
+#include <span>
 #include <unordered_map>
 
 namespace okami {
+    // Suballocates static mesh vertex and index data from one large vertex
+    // buffer and one large index buffer, so that every static primitive can be
+    // drawn through a single VAO with glMultiDrawElementsIndirect.
+    //
+    // Vertices are stored interleaved as glsl::StaticMeshVertex and indices are
+    // widened to GL_UNSIGNED_INT. Buffers grow by doubling; GetGeneration()
+    // changes whenever a buffer object is replaced so users can rebuild VAOs.
+    class OGLMegaBuffer {
+    public:
+        struct Allocation {
+            uint32_t m_baseVertex  = 0;
+            uint32_t m_vertexCount = 0;
+            uint32_t m_firstIndex  = 0;
+            uint32_t m_indexCount  = 0;
+        };
+
+    private:
+        // Guards the allocators; Free() may be called from any thread when the
+        // last GeometryHandle is dropped.
+        std::mutex     m_mtx;
+        RangeAllocator m_vertexAlloc;
+        RangeAllocator m_indexAlloc;
+        GLBuffer       m_vertexBuffer;
+        GLBuffer       m_indexBuffer;
+        uint32_t       m_vertexStride = 0;
+        uint32_t       m_generation   = 0;
+
+        Error Grow(GLBuffer& buffer, RangeAllocator& alloc, uint32_t elementSize, uint32_t minExtra);
+
+    public:
+        static Expected<std::shared_ptr<OGLMegaBuffer>> Create(
+            uint32_t vertexStride,
+            uint32_t vertexCapacity,
+            uint32_t indexCapacity);
+
+        // GL thread only. Indices are relative to the first uploaded vertex.
+        Expected<Allocation> Upload(
+            std::span<uint8_t const>  vertexData,
+            std::span<uint32_t const> indices);
+
+        // Any thread.
+        void Free(Allocation const& allocation);
+
+        GLuint   GetVertexBuffer() const { return m_vertexBuffer.get(); }
+        GLuint   GetIndexBuffer()  const { return m_indexBuffer.get(); }
+        uint32_t GetVertexStride() const { return m_vertexStride; }
+        uint32_t GetGeneration()   const { return m_generation; }
+    };
+
     struct PrimitiveImpl {
         GLVertexArray m_vao;
+
+        // Set when the primitive lives in the geometry manager's mega buffer
+        // instead of owning its own VAO.
+        std::optional<OGLMegaBuffer::Allocation> m_megaAllocation;
     };
 
     // Concrete OpenGL geometry.  Heap-allocated and ref-counted via GeometryHandle.
@@ -23,6 +79,16 @@ namespace okami {
         GeometryDesc                      m_desc{};
         std::atomic<bool>                 m_loaded{false};
         std::shared_ptr<OGLDeletionQueue> m_deletion_queue;
+        std::shared_ptr<OGLMegaBuffer>    m_megaBuffer;
+        // Raised on destruction so a still-queued file load is skipped
+        LoadCancelFlag                    m_load_cancelled;
+        // GPU memory held by the uploaded vertices and indices
+        size_t                            m_gpuBytes = 0;
+        // Cleared while the residency manager has evicted the GL data. The
+        // desc stays valid, so evicted geometry still counts as loaded.
+        bool                              b_resident = true;
+        // Raised by draws using the geometry, for the residency manager
+        mutable bool                      b_used = false;
 
         OGLGeometry() = default;
         OKAMI_NO_COPY(OGLGeometry);
@@ -32,6 +98,15 @@ namespace okami {
         bool                IsLoaded() const override {
             return m_loaded.load(std::memory_order_acquire);
         }
+
+        // GL thread only. Draws mark geometry used before checking that it
+        // is resident, so that evicted geometry loads again.
+        void MarkUsed() const {
+            b_used = true;
+        }
+        bool IsResident() const {
+            return IsLoaded() && b_resident;
+        }
     };
 
     // The single OGL geometry manager.
@@ -41,40 +116,93 @@ namespace okami {
     // the existing IO-thread signal machinery.
     class OGLGeometryManager final :
         public EngineModule,
-        public IGeometryManager {
+        public IGeometryManager,
+        public IAssetReloader {
     private:
         struct PendingLoad {
-            std::shared_ptr<OGLGeometry> m_geometry; // pre-created handle
+            std::weak_ptr<OGLGeometry> m_geometry; // pre-created handle
+            bool b_reload  = false; // new data for already loaded geometry
+            bool b_restore = false; // data for evicted geometry
+            // Where a first load came from, so it can be evicted
+            std::filesystem::path m_path;
+            GeometryLoadParams    m_params;
+        };
+
+        // Every uploaded geometry, for the residency manager
+        struct ResidentGeometry {
+            std::weak_ptr<OGLGeometry> m_geometry;
+            // Empty for created geometry, which is never evicted
+            std::filesystem::path      m_path;
+            GeometryLoadParams         m_params;
+            uint64_t                   m_lastUsedFrame = 0;
+            bool                       b_restoring = false;
+        };
+
+        struct CachedGeometry {
+            std::weak_ptr<OGLGeometry> m_geometry;
+            GeometryLoadParams         m_params; // to load it again on reload
         };
 
         std::shared_ptr<OGLDeletionQueue> m_deletion_queue =
             std::make_shared<OGLDeletionQueue>();
 
+        // Null unless multi-draw indirect is available and enabled in the
+        // renderer config, in which case static primitives are uploaded here.
+        std::shared_ptr<OGLMegaBuffer> m_megaBuffer;
+
         std::mutex m_mtx;
-        std::unordered_map<std::filesystem::path, std::weak_ptr<OGLGeometry>, PathHash>
+        std::unordered_map<std::filesystem::path, CachedGeometry, PathHash>
             m_path_cache;
         std::unordered_map<uint32_t, std::unique_ptr<PendingLoad>>
             m_pending;
         std::atomic<uint32_t> m_next_id{1};
 
         DefaultSignalHandler<OnResourceLoadedEvent<Geometry>> m_loaded_handler;
+        InterfaceCollection* m_interfaces = nullptr;
+
+        // Residency; GL thread only
+        std::vector<ResidentGeometry> m_residents;
+        uint64_t                      m_restores = 0;
 
         Error RegisterImpl(InterfaceCollection& ic) override;
-        Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override;
+        Error StartupImpl(InitContext const& context) override;
 
     public:
+        // Uploads finished loads and created geometry, and deletes released
+        // geometry. Called by the renderer once per frame on the GL thread.
+        Error ProcessUploads();
+
+        // Residency, GL thread only (see OGLResidencyManager). Appends every
+        // uploaded geometry, and requests evicted geometry that was drawn
+        // again.
+        void UpdateResidency(uint64_t frame, std::vector<ResidentResource>& out);
+        // Frees the GL data of geometry loaded from a file. Index as appended
+        // by the last UpdateResidency. Returns the bytes freed.
+        size_t EvictResident(size_t index);
+        // Evicted geometry loaded again since the last call
+        uint64_t TakeRestoreCount();
+
         // IGeometryManager
         GeometryHandle LoadGeometry(
             std::filesystem::path const& path,
             GeometryLoadParams           params,
-            InterfaceCollection&         ic) override;
+            InterfaceCollection&         ic,
+            LoadPriority                 priority = {}) override;
         GeometryHandle CreateGeometry(Geometry data) override;
 
+        // IAssetReloader
+        size_t ReloadAsset(
+            std::string_view         key,
+            VirtualFileSystem const& fs,
+            InterfaceCollection&     ic) override;
+
         // Convenience downcast – valid for any GeometryHandle produced by this manager.
         static OGLGeometry* GetOGLGeometry(GeometryHandle const& handle) {
             return static_cast<OGLGeometry*>(handle.get());
         }
 
+        OGLMegaBuffer* GetMegaBuffer() const { return m_megaBuffer.get(); }
+
         std::string GetName() const override { return "OGL Geometry Manager"; }
     };
 }
@@ -18,36 +18,36 @@ Error OGLIm3DRenderer::StartupImpl(InitContext const& context) {
     m_sceneGlobalsProvider = context.m_interfaces.Query<IOGLSceneGlobalsProvider>();
     OKAMI_ERROR_RETURN_IF(!m_sceneGlobalsProvider, "IOGLSceneGlobalsProvider interface not available for OGLIm3DRenderer");
 
-    // Load shaders directly — no cache, these are the preprocessed im3d2 variants.
-    auto pointsProgram = CreateProgram(ProgramShaderPaths{
+    auto* cache = context.m_interfaces.Query<IGLShaderCache>();
+    OKAMI_ERROR_RETURN_IF(!cache, "IGLShaderCache interface not available for OGLIm3DRenderer");
+
+    // The preprocessed im3d2 variants; each stage is unique to its program.
+    auto deferProgram = [&](GLProgram& target, ProgramShaderPaths const& paths) {
+        cache->DeferProgram(paths, [&target](GLProgram&& program) -> Error {
+            target = std::move(program);
+            glUseProgram(target.get());
+            Error err = GET_GL_ERROR();
+            err += AssignBufferBindingPoint(target, "SceneGlobalsBlock", BufferBindingPoints::SceneGlobals);
+            return err;
+        });
+    };
+
+    deferProgram(m_programPoints, ProgramShaderPaths{
         .m_vertex   = GetGLSLShaderPath("im3d.points.vs.glsl"),
         .m_fragment = GetGLSLShaderPath("im3d.points.fs.glsl"),
         .m_geometry = GetGLSLShaderPath("im3d.points.gs.glsl")
     });
-    OKAMI_ERROR_RETURN(pointsProgram);
-    m_programPoints = std::move(*pointsProgram);
-
-    auto linesProgram = CreateProgram(ProgramShaderPaths{
+    deferProgram(m_programLines, ProgramShaderPaths{
         .m_vertex   = GetGLSLShaderPath("im3d.lines.vs.glsl"),
         .m_fragment = GetGLSLShaderPath("im3d.lines.fs.glsl"),
         .m_geometry = GetGLSLShaderPath("im3d.lines.gs.glsl")
     });
-    OKAMI_ERROR_RETURN(linesProgram);
-    m_programLines = std::move(*linesProgram);
-
-    auto trianglesProgram = CreateProgram(ProgramShaderPaths{
+    deferProgram(m_programTriangles, ProgramShaderPaths{
         .m_vertex   = GetGLSLShaderPath("im3d.triangles.vs.glsl"),
         .m_fragment = GetGLSLShaderPath("im3d.triangles.fs.glsl")
     });
-    OKAMI_ERROR_RETURN(trianglesProgram);
-    m_programTriangles = std::move(*trianglesProgram);
 
     Error err;
-    for (GLProgram* prog : {&m_programPoints, &m_programLines, &m_programTriangles}) {
-        glUseProgram(prog->get());
-        err += GET_GL_ERROR();
-        err += AssignBufferBindingPoint(*prog, "SceneGlobalsBlock", BufferBindingPoints::SceneGlobals);
-    }
 
     auto buffer = UploadVertexBuffer<glsl::Im3dVertex>::Create(
         glsl::__get_vs_input_infoIm3dVertex());
@@ -76,10 +76,11 @@ Error OGLIm3DRenderer::Pass(entt::registry const& registry, OGLPass const& pass)
         return {};
     }
 
-    auto const& im3dData = m_dataProvider->GetIm3dContext();
-    if (!im3dData.m_context) {
+    auto const* im3dCtx = registry.ctx().find<Im3dDrawCtx>();
+    if (!im3dCtx || !im3dCtx->m_context) {
         return {};
     }
+    auto const& im3dData = im3dCtx->m_context;
 
     size_t vertexCount = 0;
     for (uint32_t i = 0; i < im3dData->getDrawListCount(); ++i) {
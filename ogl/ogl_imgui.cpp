@@ -32,8 +32,19 @@ Error OGLImguiRenderer::Pass(entt::registry const& registry, OGLPass const& pass
         return {};
     }
 
+    auto const* drawData = registry.ctx().find<ImGuiDrawDataCtx>();
+    if (!drawData || !drawData->m_drawData) {
+        return {};
+    }
+
+    // The backend looks up its state through the ImGui context, which the
+    // main thread may be building the next frame in
+    m_imguiProvider->LockContext();
+    OKAMI_DEFER(m_imguiProvider->UnlockContext());
+
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplOpenGL3_RenderDrawData(&m_imguiProvider->GetDrawData());
+    // The backend takes a mutable pointer but only reads the draw data
+    ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(drawData->m_drawData.get()));
 
     return {};
 }
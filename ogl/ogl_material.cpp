@@ -10,22 +10,45 @@ using namespace okami;
 // ---------------------------------------------------------------------------
 
 void OGLMaterial::Bind() const {
-    if (m_program) {
-        glUseProgram(m_program->get());
-    }
-    for (auto const& setter : m_uniformSetters) {
-        setter();
+    GLuint program = m_program ? m_program->m_program.get() : 0;
+    if (program) {
+        glUseProgram(program);
+        SetUniforms(program);
     }
     for (auto& tb : m_textureBindings) {
-        // Lazily resolve the GL handle once the texture finishes loading.
-        if (tb.m_texture == 0 && tb.m_handle && tb.m_handle->IsLoaded()) {
-            tb.m_texture = static_cast<OGLTexture*>(tb.m_handle.get())->m_texture.get();
+        // Resolved on every bind: the texture may finish loading after the
+        // material is made, and a hot reload swaps in a new GL object.
+        if (tb.m_handle && tb.m_handle->IsLoaded()) {
+            auto const* texture = static_cast<OGLTexture const*>(tb.m_handle.get());
+            tb.m_texture = texture->m_texture.get();
+            texture->MarkUsed();
         }
         glActiveTexture(GL_TEXTURE0 + tb.m_unit);
         glBindTexture(GL_TEXTURE_2D, tb.m_texture);
     }
 }
 
+void OGLMaterial::SetUniforms(GLuint program) const {
+    // Locations are looked up here rather than when the material is made:
+    // materials are made on the main thread, which has no GL context while
+    // frames are pipelined, and a reloaded program may place them anew.
+    const uint32_t generation = m_program ? m_program->m_generation : 0;
+    if (program != m_uniformProgram || generation != m_uniformGeneration ||
+        m_uniformLocations.size() != m_uniformSetters.size()) {
+        m_uniformLocations.clear();
+        for (auto const& setter : m_uniformSetters) {
+            m_uniformLocations.push_back(glGetUniformLocation(program, setter.m_name.c_str()));
+        }
+        m_uniformProgram    = program;
+        m_uniformGeneration = generation;
+    }
+    for (size_t i = 0; i < m_uniformSetters.size(); ++i) {
+        if (m_uniformLocations[i] != -1) {
+            m_uniformSetters[i].m_set(m_uniformLocations[i]);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 // OGLMaterialManager
 // ---------------------------------------------------------------------------
@@ -103,12 +126,28 @@ Error OGLMaterialManager::StartupImpl(InitContext const& context) {
         },
     };
 
+    // Submit every program before resolving any, so the driver can compile
+    // them concurrently. Other modules create materials from their own
+    // StartupImpl, so these cannot be deferred to the renderer.
+    std::vector<ProgramShaderPaths> paths;
+    std::vector<GLPendingProgram> pending;
     for (auto const& desc : descs) {
-        ProgramShaderPaths paths;
-        paths.m_vertex   = desc.m_vertexShader;
-        paths.m_fragment = desc.m_fragmentShader;
+        paths.push_back(ProgramShaderPaths{
+            .m_vertex   = desc.m_vertexShader,
+            .m_fragment = desc.m_fragmentShader,
+        });
+        pending.push_back(CreateProgram(paths.back(), *cache));
+    }
+
+    for (size_t i = 0; i < descs.size(); ++i) {
+        auto const& desc = descs[i];
 
-        auto program = CreateProgram(paths, *cache);
+        // Every type gets an entry, even if its program failed to compile,
+        // so materials made now pick up the program once it is fixed
+        auto& entry = m_programs.emplace(desc.m_type,
+            OGLProgramEntry{ .m_renderer = desc.m_renderer }).first->second;
+
+        auto program = pending[i].Resolve();
         if (!program) {
             LOG(ERROR) << "OGLMaterialManager: Failed to compile program for "
                        << desc.m_type.name() << ": " << program.error();
@@ -123,8 +162,27 @@ Error OGLMaterialManager::StartupImpl(InitContext const& context) {
             err += desc.m_onCreated(*program);
         }
 
-        m_programs.emplace(desc.m_type,
-            ProgramEntry{ .m_program = std::move(*program), .m_renderer = desc.m_renderer });
+        entry.m_program = std::move(*program);
+        ++entry.m_generation;
+    }
+
+    // Watched only once the map is complete; reloads run on the GL thread
+    // and replace the program in its existing entry
+    for (size_t i = 0; i < descs.size(); ++i) {
+        auto const& desc = descs[i];
+        auto* entry = &m_programs.at(desc.m_type);
+        cache->WatchProgram(paths[i], [entry, desc](GLProgram&& program) -> Error {
+            glUseProgram(program.get());
+            Error err = GET_GL_ERROR();
+            if (desc.m_onCreated) {
+                err += desc.m_onCreated(program);
+            }
+            glUseProgram(0);
+
+            entry->m_program = std::move(program);
+            ++entry->m_generation;
+            return err;
+        });
     }
 
     glUseProgram(0);
@@ -147,7 +205,7 @@ Error OGLMaterialManager::StartupImpl(InitContext const& context) {
     return err;
 }
 
-OGLMaterialManager::ProgramEntry const*
+OGLProgramEntry const*
 OGLMaterialManager::GetProgramEntry(std::type_index type) const {
     auto it = m_programs.find(type);
     return it != m_programs.end() ? &it->second : nullptr;
@@ -158,7 +216,7 @@ MaterialHandle OGLMaterialManager::CreateMaterial(DefaultMaterial /*material*/)
     return std::make_shared<OGLMaterial>(
         OGLRendererType::StaticMesh,
         typeid(DefaultMaterial),
-        entry ? &entry->m_program : nullptr);
+        entry);
 }
 
 MaterialHandle OGLMaterialManager::CreateMaterial(LambertMaterial material) {
@@ -166,7 +224,7 @@ MaterialHandle OGLMaterialManager::CreateMaterial(LambertMaterial material) {
     auto mat = std::make_shared<OGLMaterial>(
         OGLRendererType::StaticMesh,
         typeid(LambertMaterial),
-        entry ? &entry->m_program : nullptr);
+        entry);
 
     // Unit 0: diffuse/albedo
     if (material.m_colorTexture) {
@@ -194,7 +252,7 @@ MaterialHandle OGLMaterialManager::CreateMaterial(SkyDefaultMaterial /*material*
     return std::make_shared<OGLMaterial>(
         OGLRendererType::Sky,
         typeid(SkyDefaultMaterial),
-        entry ? &entry->m_program : nullptr);
+        entry);
 }
 
 MaterialHandle OGLMaterialManager::CreateMaterial(SkyAtmosphereMaterial material) {
@@ -202,39 +260,31 @@ MaterialHandle OGLMaterialManager::CreateMaterial(SkyAtmosphereMaterial material
     auto mat = std::make_shared<OGLMaterial>(
         OGLRendererType::Sky,
         typeid(SkyAtmosphereMaterial),
-        entry ? &entry->m_program : nullptr);
-
-    if (entry) {
-        GLuint prog = entry->m_program.get();
-
-        auto add1f = [&](const char* name, float value) {
-            GLint loc = glGetUniformLocation(prog, name);
-            if (loc != -1)
-                mat->m_uniformSetters.push_back([loc, value]() { glUniform1f(loc, value); });
-        };
-        auto add3f = [&](const char* name, glm::vec3 value) {
-            GLint loc = glGetUniformLocation(prog, name);
-            if (loc != -1)
-                mat->m_uniformSetters.push_back([loc, value]() { glUniform3f(loc, value.x, value.y, value.z); });
-        };
-
-        add1f("depolarizationFactor",        material.depolarizationFactor);
-        add1f("mieCoefficient",              material.mieCoefficient);
-        add1f("mieDirectionalG",             material.mieDirectionalG);
-        add3f("mieKCoefficient",             material.mieKCoefficient);
-        add1f("mieV",                        material.mieV);
-        add1f("mieZenithLength",             material.mieZenithLength);
-        add1f("numMolecules",                material.numMolecules);
-        add3f("primaries",                   material.primaries);
-        add1f("rayleigh",                    material.rayleigh);
-        add1f("rayleighZenithLength",        material.rayleighZenithLength);
-        add1f("refractiveIndex",             material.refractiveIndex);
-        add1f("sunAngularDiameterDegrees",   material.sunAngularDiameterDegrees);
-        add1f("sunIntensityFactor",          material.sunIntensityFactor);
-        add1f("sunIntensityFalloffSteepness",material.sunIntensityFalloffSteepness);
-        add3f("sunPosition",                 material.sunPosition);
-        add1f("turbidity",                   material.turbidity);
-    }
+        entry);
+
+    auto add1f = [&](const char* name, float value) {
+        mat->m_uniformSetters.push_back({ name, [value](GLint loc) { glUniform1f(loc, value); } });
+    };
+    auto add3f = [&](const char* name, glm::vec3 value) {
+        mat->m_uniformSetters.push_back({ name, [value](GLint loc) { glUniform3f(loc, value.x, value.y, value.z); } });
+    };
+
+    add1f("depolarizationFactor",        material.depolarizationFactor);
+    add1f("mieCoefficient",              material.mieCoefficient);
+    add1f("mieDirectionalG",             material.mieDirectionalG);
+    add3f("mieKCoefficient",             material.mieKCoefficient);
+    add1f("mieV",                        material.mieV);
+    add1f("mieZenithLength",             material.mieZenithLength);
+    add1f("numMolecules",                material.numMolecules);
+    add3f("primaries",                   material.primaries);
+    add1f("rayleigh",                    material.rayleigh);
+    add1f("rayleighZenithLength",        material.rayleighZenithLength);
+    add1f("refractiveIndex",             material.refractiveIndex);
+    add1f("sunAngularDiameterDegrees",   material.sunAngularDiameterDegrees);
+    add1f("sunIntensityFactor",          material.sunIntensityFactor);
+    add1f("sunIntensityFalloffSteepness",material.sunIntensityFalloffSteepness);
+    add3f("sunPosition",                 material.sunPosition);
+    add1f("turbidity",                   material.turbidity);
 
     return mat;
 }
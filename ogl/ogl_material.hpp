@@ -7,6 +7,7 @@
 #include "../sky.hpp"
 
 #include <functional>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -27,23 +28,39 @@ namespace okami {
         TextureHandle m_handle;           // owns the ref-count
     };
 
+    // The GL program shared by every material of one type.  Entries are
+    // made for every type at startup and never removed, so materials can
+    // hold on to them; a hot reload replaces m_program in place.
+    struct OGLProgramEntry {
+        GLProgram       m_program;        // empty while the shaders fail to compile
+        OGLRendererType m_renderer;
+        uint32_t        m_generation = 0; // bumped each time m_program is relinked
+    };
+
+    // A per-instance uniform, set by name so its location can be looked up
+    // in whichever program is bound.
+    struct OGLUniformSetter {
+        std::string                m_name;
+        std::function<void(GLint)> m_set;
+    };
+
     // The single concrete OpenGL material implementation.
     //
-    // Each instance holds a (non-owning) pointer to the shared GL program
-    // compiled for its material type plus the per-instance texture bindings.
+    // Each instance holds a (non-owning) pointer to the shared program entry
+    // for its material type plus the per-instance texture bindings.
     // Calling Bind() activates the program and sets up all texture units.
     class OGLMaterial : public IMaterial {
     public:
         OGLRendererType              m_rendererType;
         std::type_index              m_type;
-        GLProgram const*             m_program = nullptr; // non-owning – owned by OGLMaterialManager
+        OGLProgramEntry const*       m_program = nullptr; // non-owning – owned by OGLMaterialManager
         mutable std::vector<OGLTextureBinding>      m_textureBindings;
         // Per-instance scalar/vector uniforms written every Bind() call.
-        std::vector<std::function<void()>>          m_uniformSetters;
+        std::vector<OGLUniformSetter>               m_uniformSetters;
 
-        OGLMaterial(OGLRendererType rendererType,
-                    std::type_index  type,
-                    GLProgram const* program)
+        OGLMaterial(OGLRendererType        rendererType,
+                    std::type_index        type,
+                    OGLProgramEntry const* program)
             : m_rendererType(rendererType)
             , m_type(type)
             , m_program(program) {}
@@ -52,6 +69,16 @@ namespace okami {
 
         // Activates the GL program and binds all texture units.
         void Bind() const;
+
+        // Writes m_uniformSetters into the bound program. GL thread only.
+        void SetUniforms(GLuint program) const;
+
+    private:
+        // Locations of m_uniformSetters in the program they were last
+        // looked up in
+        mutable std::vector<GLint> m_uniformLocations;
+        mutable GLuint             m_uniformProgram = 0;
+        mutable uint32_t           m_uniformGeneration = 0;
     };
 
     // The single OpenGL material manager.
@@ -67,15 +94,13 @@ namespace okami {
         public IMaterialManager<SkyDefaultMaterial>,
         public IMaterialManager<SkyAtmosphereMaterial> {
     private:
-        struct ProgramEntry {
-            GLProgram       m_program;
-            OGLRendererType m_renderer;
-        };
-
-        std::unordered_map<std::type_index, ProgramEntry> m_programs;
+        // Filled in StartupImpl before any program is watched and not
+        // changed in shape afterwards, so lookups from the main thread need
+        // no lock while reloads write the entries on the GL thread.
+        std::unordered_map<std::type_index, OGLProgramEntry> m_programs;
         GLTexture m_flatNormalTexture; // 1x1 (0.5,0.5,1.0) fallback for materials without a normal map
 
-        ProgramEntry const* GetProgramEntry(std::type_index type) const;
+        OGLProgramEntry const* GetProgramEntry(std::type_index type) const;
 
     public:
         explicit OGLMaterialManager();
@@ -0,0 +1,131 @@
+#include "ogl_program_cache.hpp"
+
+#include <glog/logging.h>
+#include <format>
+#include <fstream>
+
+using namespace okami;
+
+namespace {
+    constexpr uint32_t kBinaryMagic = 0x42504b4f; // "OKPB"
+    constexpr uint32_t kBinaryVersion = 1;
+
+    struct BinaryHeader {
+        uint32_t m_magic = kBinaryMagic;
+        uint32_t m_version = kBinaryVersion;
+        uint64_t m_key = 0;
+        uint32_t m_format = 0;
+        uint32_t m_length = 0;
+    };
+
+    std::string GetGLString(GLenum name) {
+        auto const* str = reinterpret_cast<const char*>(glGetString(name));
+        return str ? str : "";
+    }
+}
+
+Expected<OGLProgramBinaryCache> OGLProgramBinaryCache::Create(std::filesystem::path directory) {
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    OKAMI_UNEXPECTED_RETURN_IF(formatCount <= 0, "Driver exposes no program binary formats");
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    OKAMI_UNEXPECTED_RETURN_IF(ec, "Failed to create program cache directory " + directory.string() + ": " + ec.message());
+
+    OGLProgramBinaryCache result;
+    result.m_directory = std::move(directory);
+    result.m_driverId = GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" +
+        GetGLString(GL_VERSION) + "|" + GetGLString(GL_SHADING_LANGUAGE_VERSION);
+    return result;
+}
+
+uint64_t OGLProgramBinaryCache::ComputeKey(std::span<ProgramStageSource const> stages) const {
+    uint64_t hash = HashFnv1a(m_driverId);
+    for (auto const& stage : stages) {
+        const uint64_t header[2] = { stage.m_type, stage.m_source.size() };
+        hash = HashFnv1a(std::string_view(reinterpret_cast<const char*>(header), sizeof(header)), hash);
+        hash = HashFnv1a(stage.m_source, hash);
+    }
+    return hash;
+}
+
+std::filesystem::path OGLProgramBinaryCache::GetEntryPath(ProgramShaderPaths const& paths) const {
+    uint64_t hash = HashFnv1a(paths.m_vertex.generic_string());
+    for (auto const* path : { &paths.m_fragment, &paths.m_geometry, &paths.m_tessControl, &paths.m_tessEval }) {
+        hash = HashFnv1a("|", hash);
+        if (*path) {
+            hash = HashFnv1a((*path)->generic_string(), hash);
+        }
+    }
+    return m_directory / std::format("{:016x}.bin", hash);
+}
+
+std::optional<GLProgram> OGLProgramBinaryCache::Load(std::filesystem::path const& entry, uint64_t key) const {
+    std::ifstream file(entry, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    BinaryHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.m_magic != kBinaryMagic || header.m_version != kBinaryVersion || header.m_key != key) {
+        return std::nullopt;
+    }
+
+    std::vector<char> binary(header.m_length);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file) {
+        return std::nullopt;
+    }
+
+    GLProgram program(glCreateProgram());
+    if (!program) {
+        return std::nullopt;
+    }
+    glProgramBinary(program.get(), header.m_format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Drivers may refuse binaries from older builds even when the version
+    // string is unchanged; fall back to compiling from source.
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program.get(), GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        VLOG(1) << "Program binary rejected by driver: " << entry;
+        return std::nullopt;
+    }
+    return program;
+}
+
+Error OGLProgramBinaryCache::Store(std::filesystem::path const& entry, uint64_t key, GLProgram const& program) const {
+    GLint length = 0;
+    glGetProgramiv(program.get(), GL_PROGRAM_BINARY_LENGTH, &length);
+    OKAMI_ERROR_RETURN_IF(length <= 0, "Program binary is not retrievable");
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program.get(), length, &written, &format, binary.data());
+    OKAMI_ERROR_RETURN(GET_GL_ERROR());
+
+    BinaryHeader header{
+        .m_key = key,
+        .m_format = format,
+        .m_length = static_cast<uint32_t>(written),
+    };
+
+    // Write to a temporary and rename so a crash never leaves a torn entry.
+    auto tempPath = entry;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        OKAMI_ERROR_RETURN_IF(!file, "Failed to open program cache entry " + tempPath.string());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        OKAMI_ERROR_RETURN_IF(!file, "Failed to write program cache entry " + tempPath.string());
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, entry, ec);
+    OKAMI_ERROR_RETURN_IF(ec, "Failed to move program cache entry into place: " + ec.message());
+    return {};
+}
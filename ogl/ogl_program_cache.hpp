@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ogl_utils.hpp"
+
+#include <span>
+#include <string>
+
+namespace okami {
+    // One shader stage as fed to the program binary cache.
+    struct ProgramStageSource {
+        GLenum           m_type;
+        std::string_view m_source;
+    };
+
+    // On-disk cache of linked program binaries (glGetProgramBinary /
+    // glProgramBinary), used to skip GLSL compilation on later runs.
+    //
+    // Each program gets one file, named after its shader paths. The file
+    // records a key hashed from the driver (vendor, renderer, version) and the
+    // preprocessed source of every stage; a key mismatch is a miss and the
+    // file is overwritten once the program has been rebuilt, so editing a
+    // shader or updating the driver invalidates entries automatically. A
+    // binary the driver rejects is treated the same way.
+    class OGLProgramBinaryCache {
+    private:
+        std::filesystem::path m_directory;
+        std::string           m_driverId;
+
+    public:
+        // Fails if the context exposes no program binary formats.
+        static Expected<OGLProgramBinaryCache> Create(std::filesystem::path directory);
+
+        uint64_t ComputeKey(std::span<ProgramStageSource const> stages) const;
+        std::filesystem::path GetEntryPath(ProgramShaderPaths const& paths) const;
+
+        // Returns the cached program, or nullopt on a miss.
+        std::optional<GLProgram> Load(std::filesystem::path const& entry, uint64_t key) const;
+
+        // The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+        Error Store(std::filesystem::path const& entry, uint64_t key, GLProgram const& program) const;
+
+        std::filesystem::path const& GetDirectory() const { return m_directory; }
+    };
+
+    // 64-bit FNV-1a, chainable through `seed`.
+    constexpr uint64_t kFnv1aOffset = 0xcbf29ce484222325ull;
+    inline uint64_t HashFnv1a(std::string_view data, uint64_t seed = kFnv1aOffset) {
+        uint64_t hash = seed;
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
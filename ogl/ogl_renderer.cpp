@@ -3,7 +3,9 @@
 #include "ogl_triangle.hpp"
 #include "ogl_texture.hpp"
 #include "ogl_sprite.hpp"
+#include "ogl_tilemap.hpp"
 #include "ogl_geometry.hpp"
+#include "ogl_residency.hpp"
 #include "ogl_static_mesh.hpp"
 #include "ogl_skinned_mesh.hpp"
 #include "ogl_depth_pass.hpp"
@@ -15,9 +17,13 @@
 #include "ogl_scene.hpp"
 
 #include "../config.hpp"
+#include "../file_watcher.hpp"
+#include "../paths.hpp"
 #include "../camera.hpp"
 #include "../transform.hpp"
 #include "../light.hpp"
+#include "../frame_allocator.hpp"
+#include "../render_snapshot.hpp"
 
 #include <glog/logging.h>
 #include <cmath>
@@ -36,12 +42,16 @@ private:
 
     IGLProvider* m_glProvider = nullptr;
     std::unique_ptr<IGLShaderCache> m_shaderCache;
+    // Only while shaders are hot reloaded; the cache is kept alive for it
+    std::optional<FileWatcher> m_shaderWatcher;
 
     OGLGeometryManager* m_geometryManager = nullptr;
+    OGLResidencyManager* m_residencyManager = nullptr;
 
     OGLTriangleRenderer* m_triangleRenderer = nullptr;
     OGLTextureManager* m_textureManager = nullptr;
     OGLSpriteRenderer* m_spriteRenderer = nullptr;
+    OGLTileMapRenderer* m_tileMapRenderer = nullptr;
 
     OGLStaticMeshRenderer* m_staticMeshRenderer = nullptr;
     OGLSkinnedMeshRenderer* m_skinnedMeshRenderer = nullptr;
@@ -56,6 +66,8 @@ private:
     OGLMaterialManager* m_materialManager = nullptr;
 
     OGLSceneModule* m_sceneModule = nullptr;
+
+    FrameAllocator* m_frameAllocator = nullptr;
     
 protected:
     Error RegisterImpl(InterfaceCollection& interfaces) override {
@@ -68,6 +80,28 @@ protected:
 
         m_glProvider->NotifyNeedGLContext();
 
+        // Everything the passes below read, so pipelined frames can render a
+        // copy of it while the next frame simulates.
+        if (auto* schema = interfaces.Query<RenderSnapshotSchema>()) {
+            schema->AddComponent<Transform>();
+            schema->AddComponent<Camera>();
+            schema->AddComponent<StaticMeshComponent>();
+            schema->AddComponent<SkinnedMeshComponent>();
+            schema->AddComponent<SkeletonStateComponent>();
+            schema->AddComponent<SpriteComponent>();
+            schema->AddComponent<TileMapComponent>();
+            schema->AddComponent<DummyTriangleComponent>();
+            schema->AddComponent<AmbientLightComponent>();
+            schema->AddComponent<DirectionalLightComponent>();
+            schema->AddComponent<PointLightComponent>();
+            schema->AddComponent<SkyComponent>();
+            schema->AddComponent<PostProcessComponent>();
+            schema->AddContext<ShadowConfig>();
+            schema->AddContext<RenderDebugConfig>();
+            schema->AddContext<ImGuiDrawDataCtx>();
+            schema->AddContext<Im3dDrawCtx>();
+        }
+
         return {};
     }
 
@@ -78,7 +112,42 @@ protected:
 
         m_glProvider->SetSwapInterval(1);
 
+        if (LoadParallelShaderCompile(m_glProvider->GetGLLoaderFunction())) {
+            LOG(INFO) << "Parallel shader compilation enabled";
+        }
+
         m_config = ReadConfig<RendererConfig>(context.m_interfaces, LOG_WRAP(WARNING));
+        m_frameAllocator = context.m_interfaces.Query<FrameAllocator>();
+
+        // Child modules create their programs after this, so they all go
+        // through the binary cache.
+        if (m_config.programBinaryCache) {
+            auto err = m_shaderCache->EnableProgramBinaryCache(
+                GetExecutableRelativePath(m_config.programBinaryCacheDir));
+            if (err.IsError()) {
+                LOG(WARNING) << "Program binary cache disabled: " << err;
+            }
+        }
+
+        OKAMI_ERROR_RETURN(StartupChildren(context));
+
+        // Child modules submitted their programs during startup; collect
+        // them all here, so the driver compiles them together and a broken
+        // shader fails startup.
+        auto err = m_shaderCache->ResolvePending();
+        auto stats = m_shaderCache->GetProgramStats();
+        LOG(INFO) << "Shader programs ready in " << stats.m_milliseconds << " ms ("
+            << stats.m_binaryHits << " from binary cache, " << stats.m_compiled << " compiled)";
+        OKAMI_ERROR_RETURN(err);
+
+        if (m_config.hotReloadShaders) {
+            m_shaderWatcher.emplace(GetGLSLShadersPath());
+            if (!m_shaderWatcher->IsWatching()) {
+                LOG(WARNING) << "Shader hot reload disabled: cannot watch "
+                    << m_shaderWatcher->GetRoot();
+                m_shaderWatcher.reset();
+            }
+        }
 
         return {};
     }
@@ -86,8 +155,45 @@ protected:
     void ShutdownImpl(InitContext const& context) override {
     }
 
+    // Marks programs using changed shader files and swaps in the ones that
+    // have finished compiling; programs that fail keep their old version
+    void ReloadChangedShaders() {
+        size_t marked = 0;
+        for (auto const& change : m_shaderWatcher->Poll()) {
+            if (change.m_type == FileChangeType::Removed) {
+                continue;
+            }
+            marked += m_shaderCache->ReloadShader(m_shaderWatcher->GetRoot() / change.m_path);
+        }
+        if (marked > 0) {
+            LOG(INFO) << "Recompiling " << marked << " shader program(s)";
+        }
+
+        auto err = m_shaderCache->ProcessReloads();
+        if (err.IsError()) {
+            LOG(ERROR) << "Shader reload failed, keeping the old programs: " << err;
+        }
+    }
+
     Error Render(entt::registry const& registry) override {
-        m_shaderCache.reset();
+        if (m_shaderWatcher) {
+            ReloadChangedShaders();
+        }
+
+        // Resource uploads and deletions wait for the GL thread, which is
+        // this one even when frames are pipelined.
+        {
+            Error err;
+            err += m_textureManager->ProcessUploads();
+            err += m_geometryManager->ProcessUploads();
+            if (err.IsError()) {
+                LOG(ERROR) << "Resource upload failed: " << err;
+            }
+        }
+        m_residencyManager->Update();
+
+        m_staticMeshRenderer->ResetDrawStats();
+        m_tileMapRenderer->ResetDrawStats();
 
         const entity_t activeCam = m_activeCamera.load(std::memory_order_relaxed);
 
@@ -147,7 +253,10 @@ protected:
 
                     m_depthPass->BeginDepthPass(cascadesBlock, cascadeSplits);
 
-                    OGLPass shadowPass{ .m_type = OGLPassType::Shadow };
+                    OGLPass shadowPass{
+                        .m_type = OGLPassType::Shadow,
+                        .m_frameResource = GetFrameResource(m_frameAllocator),
+                    };
                     m_staticMeshRenderer->Pass(registry, shadowPass);
                     m_skinnedMeshRenderer->Pass(registry, shadowPass);
 
@@ -161,19 +270,26 @@ protected:
         glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        OGLPass pass{};
+        OGLPass pass{ .m_frameResource = GetFrameResource(m_frameAllocator) };
 
         m_sceneModule->UpdateSceneGlobals(registry, activeCam);
 
         m_staticMeshRenderer->Pass(registry, pass);
         m_skinnedMeshRenderer->Pass(registry, pass);
         m_triangleRenderer->Pass(registry, pass);
+        m_tileMapRenderer->Pass(registry, pass);
         m_spriteRenderer->Pass(registry, pass);
         m_im3dRenderer->Pass(registry, pass);
         m_skyRenderer->Pass(registry, pass);
         m_imguiRenderer->Pass(registry, pass);
         m_glProvider->SwapBuffers();
 
+        auto const& meshStats = m_staticMeshRenderer->GetDrawStats();
+        VLOG(1) << "Static mesh draw calls: " << meshStats.m_drawCalls
+            << " (" << meshStats.m_multiDrawCalls << " multi-draw) for "
+            << meshStats.m_instances << " instances";
+        VLOG(1) << "Tile map draw calls: " << m_tileMapRenderer->GetDrawStats().m_drawCalls;
+
         return {};
     }
 
@@ -182,15 +298,19 @@ public:
         m_params(params), 
         m_shaderCache(CreateGLShaderCache()) {
         SetChildrenProcessFrame(false);
+        // Programs the children submit are resolved once they have all started
+        SetChildrenProcessStartup(false);
 
         m_sceneModule = CreateChild<OGLSceneModule>();
 
         m_textureManager = CreateChild<OGLTextureManager>();
         m_materialManager = CreateChild<OGLMaterialManager>();
         m_geometryManager = CreateChild<OGLGeometryManager>();
+        m_residencyManager = CreateChild<OGLResidencyManager>(m_textureManager, m_geometryManager);
 
         m_triangleRenderer = CreateChild<OGLTriangleRenderer>();
         m_spriteRenderer = CreateChild<OGLSpriteRenderer>();
+        m_tileMapRenderer = CreateChild<OGLTileMapRenderer>();
         m_staticMeshRenderer = CreateChild<OGLStaticMeshRenderer>(m_geometryManager);
         m_skinnedMeshRenderer = CreateChild<OGLSkinnedMeshRenderer>(m_geometryManager);
         m_im3dRenderer = CreateChild<OGLIm3DRenderer>();
@@ -213,6 +333,14 @@ public:
     entity_t GetActiveCamera() const override {
         return m_activeCamera.load(std::memory_order_relaxed);
     }
+
+    void AttachRenderThread() override {
+        m_glProvider->MakeContextCurrent(true);
+    }
+
+    void DetachRenderThread() override {
+        m_glProvider->MakeContextCurrent(false);
+    }
 };
 
 std::unique_ptr<EngineModule> OGLRendererFactory::operator()(RendererParams const& params) {
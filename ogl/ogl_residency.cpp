@@ -0,0 +1,81 @@
+#include "ogl_residency.hpp"
+#include "ogl_texture.hpp"
+#include "ogl_geometry.hpp"
+
+#include "../config.hpp"
+#include "../renderer.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+using namespace okami;
+
+OGLResidencyManager::OGLResidencyManager(
+    OGLTextureManager*  textureManager,
+    OGLGeometryManager* geometryManager) :
+    m_textureManager(textureManager),
+    m_geometryManager(geometryManager) {
+}
+
+Error OGLResidencyManager::RegisterImpl(InterfaceCollection& ic) {
+    ic.Register<IGPUResidency>(this);
+    RegisterConfig<ResidencyConfig>(ic, LOG_WRAP(WARNING));
+    return {};
+}
+
+Error OGLResidencyManager::StartupImpl(InitContext const& context) {
+    auto config = ReadConfig<ResidencyConfig>(context.m_interfaces, LOG_WRAP(WARNING));
+    m_budgetBytes = static_cast<size_t>(std::max(config.budgetMB, 0)) << 20;
+    m_idleFrames  = static_cast<uint64_t>(std::max(config.evictAfterFrames, 1));
+    m_stats.m_budgetBytes = m_budgetBytes;
+    if (m_budgetBytes > 0) {
+        LOG(INFO) << "OGLResidencyManager: budget " << config.budgetMB << " MiB, evicting after "
+                  << m_idleFrames << " unused frames";
+    }
+    return {};
+}
+
+void OGLResidencyManager::Update() {
+    ++m_frame;
+
+    // Textures first, then geometry; eviction indices follow the same order
+    m_resources.clear();
+    m_textureManager->UpdateResidency(m_frame, m_resources);
+    const size_t textureCount = m_resources.size();
+    m_geometryManager->UpdateResidency(m_frame, m_resources);
+
+    uint64_t evictions = 0;
+    uint64_t evictedBytes = 0;
+    for (size_t index : SelectEvictions(m_resources, m_budgetBytes, m_frame, m_idleFrames)) {
+        size_t freed = index < textureCount
+            ? m_textureManager->EvictResident(index)
+            : m_geometryManager->EvictResident(index - textureCount);
+        if (freed > 0) {
+            auto& resource = m_resources[index];
+            resource.m_bytes -= std::min(freed, resource.m_bytes);
+            ++evictions;
+            evictedBytes += freed;
+        }
+    }
+    const uint64_t restores = m_textureManager->TakeRestoreCount() + m_geometryManager->TakeRestoreCount();
+
+    std::lock_guard lock(m_statsMtx);
+    AccountResidency(m_resources, m_stats);
+    if (m_budgetBytes > 0) {
+        const size_t resident = m_stats.GetResidentBytes();
+        m_textureManager->SetResidencyHeadroom(m_budgetBytes - std::min(m_budgetBytes, resident));
+    }
+    m_stats.m_evictions    += evictions;
+    m_stats.m_evictedBytes += evictedBytes;
+    m_stats.m_restores     += restores;
+    if (evictions > 0) {
+        VLOG(1) << "OGLResidencyManager: evicted " << evictions << " resources (" << (evictedBytes >> 10)
+                << " KiB), " << (m_stats.GetResidentBytes() >> 20) << " MiB resident";
+    }
+}
+
+GPUResidencyStats OGLResidencyManager::GetResidencyStats() const {
+    std::lock_guard lock(m_statsMtx);
+    return m_stats;
+}
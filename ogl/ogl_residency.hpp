@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../module.hpp"
+#include "../residency.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace okami {
+    class OGLTextureManager;
+    class OGLGeometryManager;
+
+    // Accounts for the GPU memory of every texture and geometry and keeps
+    // it within the budget in ResidencyConfig. Past the budget, resources
+    // no draw has used for a while are evicted, textures down to their
+    // streaming tail (or their coarsest level, if loaded whole) and geometry
+    // entirely; they load again from their files once drawn. Textures and
+    // geometry created from memory are counted but never evicted.
+    //
+    // Texture streaming keeps its own, smaller budget for streamed levels
+    // (TextureStreamingConfig) and is told the room left under this one,
+    // so it never streams in levels this would only evict again.
+    class OGLResidencyManager final :
+        public EngineModule,
+        public IGPUResidency {
+    private:
+        OGLTextureManager*  m_textureManager;
+        OGLGeometryManager* m_geometryManager;
+
+        size_t   m_budgetBytes = 0;
+        uint64_t m_idleFrames  = 0;
+        uint64_t m_frame       = 0;
+        std::vector<ResidentResource> m_resources;
+
+        mutable std::mutex m_statsMtx;
+        GPUResidencyStats  m_stats;
+
+        Error RegisterImpl(InterfaceCollection& ic) override;
+        Error StartupImpl(InitContext const& context) override;
+
+    public:
+        OGLResidencyManager(OGLTextureManager* textureManager, OGLGeometryManager* geometryManager);
+
+        // Applies the last frame's usage and evicts what is over budget.
+        // Called by the renderer once per frame on the GL thread, after the
+        // managers have processed their uploads.
+        void Update();
+
+        // IGPUResidency
+        GPUResidencyStats GetResidencyStats() const override;
+
+        std::string GetName() const override { return "OGL Residency Manager"; }
+    };
+}
@@ -129,12 +129,12 @@ namespace okami {
         };
     }
 
-    Error OGLSceneModule::ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) {
-        m_frameIndex++;
-        return {};
+    glsl::SceneGlobals const& OGLSceneModule::GetCurrentSceneGlobals() const {
+        return m_currentGlobals;
     }
 
     void OGLSceneModule::SetSceneGlobals(glsl::SceneGlobals const& globals) {
+        m_currentGlobals = globals;
         m_sceneUBO.Write(globals);
     }
 } // namespace okami
@@ -13,6 +13,7 @@ namespace okami {
         public IOGLSceneGlobalsProvider {
     private:
         UniformBuffer<glsl::SceneGlobals> m_sceneUBO;
+        glsl::SceneGlobals       m_currentGlobals{};
         IGLProvider*             m_glProvider        = nullptr;
         IOGLDepthPassProvider*   m_depthPassProvider = nullptr;
         uint32_t m_frameIndex = 0;
@@ -22,14 +23,15 @@ namespace okami {
         Error StartupImpl(InitContext const& context) override;
 
     public:
-        Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override;
-
         UniformBuffer<glsl::SceneGlobals> const& GetSceneGlobalsBuffer() const override;
+        glsl::SceneGlobals const& GetCurrentSceneGlobals() const override;
 
         glsl::SceneGlobals GetSceneGlobals(entt::registry const& registry, entity_t activeCamera);
         void SetSceneGlobals(glsl::SceneGlobals const& globals);
 
+        // Called once per rendered frame, which also advances the frame index
         inline void UpdateSceneGlobals(entt::registry const& registry, entity_t activeCamera) {
+            m_frameIndex++;
             SetSceneGlobals(GetSceneGlobals(registry, activeCamera));
         }
 
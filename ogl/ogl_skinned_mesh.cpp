@@ -78,23 +78,20 @@ Error OGLSkinnedMeshRenderer::StartupImpl(InitContext const& context) {
         ProgramShaderPaths paths;
         paths.m_vertex   = GetGLSLShaderPath("skinned_mesh.vs");
         paths.m_fragment = GetGLSLShaderPath("lambert.fs");
-        auto prog = CreateProgram(paths, *cache);
-        if (!prog) {
-            LOG(ERROR) << "OGLSkinnedMeshRenderer: Failed to compile forward program: "
-                       << prog.error();
-            return prog.error();
-        }
-        m_skinnedForwardProgram = std::move(*prog);
-        glUseProgram(m_skinnedForwardProgram.get());
-        err += AssignBufferBindingPoint(m_skinnedForwardProgram, "SceneGlobalsBlock",
-                                        static_cast<GLint>(ForwardBindPoints::SceneGlobals));
-        err += AssignBufferBindingPoint(m_skinnedForwardProgram, "JointMatricesBlock",
-                                        static_cast<GLint>(ForwardBindPoints::JointMatrices));
-        err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_diffuseMap", 0);
-        err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_normalMap",  1);
-        err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_shadowMap",  kShadowMapUnit);
-        glUseProgram(0);
-        OKAMI_ERROR_RETURN(err);
+        cache->DeferProgram(paths, [this](GLProgram&& prog) -> Error {
+            Error err;
+            m_skinnedForwardProgram = std::move(prog);
+            glUseProgram(m_skinnedForwardProgram.get());
+            err += AssignBufferBindingPoint(m_skinnedForwardProgram, "SceneGlobalsBlock",
+                                            static_cast<GLint>(ForwardBindPoints::SceneGlobals));
+            err += AssignBufferBindingPoint(m_skinnedForwardProgram, "JointMatricesBlock",
+                                            static_cast<GLint>(ForwardBindPoints::JointMatrices));
+            err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_diffuseMap", 0);
+            err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_normalMap",  1);
+            err += AssignTextureBindingPoint(m_skinnedForwardProgram, "u_shadowMap",  kShadowMapUnit);
+            glUseProgram(0);
+            return err;
+        });
     }
 
     // Depth program: skinned_mesh_depth.vs + static_mesh_depth.gs + static_mesh_depth.fs
@@ -103,20 +100,17 @@ Error OGLSkinnedMeshRenderer::StartupImpl(InitContext const& context) {
         paths.m_vertex   = GetGLSLShaderPath("skinned_mesh_depth.vs");
         paths.m_geometry = GetGLSLShaderPath("static_mesh_depth.gs");
         paths.m_fragment = GetGLSLShaderPath("static_mesh_depth.fs");
-        auto prog = CreateProgram(paths, *cache);
-        if (!prog) {
-            LOG(ERROR) << "OGLSkinnedMeshRenderer: Failed to compile depth program: "
-                       << prog.error();
-            return prog.error();
-        }
-        m_depthProgram = std::move(*prog);
-        glUseProgram(m_depthProgram.get());
-        err += AssignBufferBindingPoint(m_depthProgram, "JointMatricesBlock",
-                                        static_cast<GLint>(DepthBindPoints::JointMatrices));
-        err += AssignBufferBindingPoint(m_depthProgram, "CascadeBlock",
-                                        static_cast<GLint>(DepthBindPoints::Cascades));
-        glUseProgram(0);
-        OKAMI_ERROR_RETURN(err);
+        cache->DeferProgram(paths, [this](GLProgram&& prog) -> Error {
+            Error err;
+            m_depthProgram = std::move(prog);
+            glUseProgram(m_depthProgram.get());
+            err += AssignBufferBindingPoint(m_depthProgram, "JointMatricesBlock",
+                                            static_cast<GLint>(DepthBindPoints::JointMatrices));
+            err += AssignBufferBindingPoint(m_depthProgram, "CascadeBlock",
+                                            static_cast<GLint>(DepthBindPoints::Cascades));
+            glUseProgram(0);
+            return err;
+        });
     }
 
     m_pipelineState.depthTestEnabled = true;
@@ -221,10 +215,12 @@ Error OGLSkinnedMeshRenderer::Pass(entt::registry const& registry, OGLPass const
                   SkinnedMeshComponent const& mesh,
                   Transform const& transform)
     {
-        if (!mesh.m_geometry || !mesh.m_geometry->IsLoaded()) return;
+        if (!mesh.m_geometry) return;
 
+        // Marked before the check, so evicted geometry loads again
         auto* oglGeo = OGLGeometryManager::GetOGLGeometry(mesh.m_geometry);
-        if (!oglGeo || oglGeo->m_meshes.empty()) return;
+        oglGeo->MarkUsed();
+        if (!oglGeo->IsResident() || oglGeo->m_meshes.empty()) return;
 
         // Upload joint matrices; skip entity if not ready.
         if (!UploadJointMatrices(registry, mesh)) return;
@@ -288,13 +284,15 @@ Error OGLSkinnedMeshRenderer::Pass(entt::registry const& registry, OGLPass const
             glUseProgram(m_skinnedForwardProgram.get());
             // Still apply material texture bindings (diffuse, normal).
             for (auto& tb : mat->m_textureBindings) {
-                if (tb.m_texture == 0 && tb.m_handle && tb.m_handle->IsLoaded()) {
+                if (tb.m_handle && tb.m_handle->IsLoaded()) {
                     tb.m_texture = static_cast<OGLTexture*>(tb.m_handle.get())->m_texture.get();
+                    // No screen-space estimate here, so ask for full detail
+                    static_cast<OGLTexture const*>(tb.m_handle.get())->RequestMip(0);
                 }
                 glActiveTexture(GL_TEXTURE0 + tb.m_unit);
                 glBindTexture(GL_TEXTURE_2D, tb.m_texture);
             }
-            for (auto const& setter : mat->m_uniformSetters) setter();
+            mat->SetUniforms(m_skinnedForwardProgram.get());
             err += m_sceneGlobalsProvider->GetSceneGlobalsBuffer().Bind(
                 static_cast<GLint>(ForwardBindPoints::SceneGlobals));
         }
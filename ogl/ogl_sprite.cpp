@@ -1,5 +1,6 @@
 #include "ogl_sprite.hpp"
 #include "../paths.hpp"
+#include "../radix_sort.hpp"
 
 #include <glog/logging.h>
 #include <glad/gl.h>
@@ -19,14 +20,20 @@ Error OGLSpriteRenderer::StartupImpl(InitContext const& context) {
     OKAMI_ERROR_RETURN_IF(!m_sceneGlobalsProvider, "IOGLSceneGlobalsProvider interface not available for OGLSpriteRenderer");
 
     // Create shader program with vertex, geometry, and fragment shaders
-    auto program = CreateProgram(ProgramShaderPaths{
+    cache->DeferProgram(ProgramShaderPaths{
         .m_vertex = GetGLSLShaderPath("sprite.vs"),
         .m_fragment = GetGLSLShaderPath("sprite.fs"),
         .m_geometry = GetGLSLShaderPath("sprite.gs"),
-    }, *cache);
-    OKAMI_ERROR_RETURN(program);
-
-    m_program = std::move(*program);
+    }, [this](GLProgram&& program) -> Error {
+        m_program = std::move(program);
+
+        Error err;
+        glUseProgram(m_program.get());
+        err += GET_GL_ERROR();
+        err += AssignTextureBindingPoint(m_program, "u_texture", TextureBindingPoints::SpriteTexture);
+        err += AssignTextureBindingPoint(m_program, "u_atlas", TextureBindingPoints::SpriteAtlas);
+        return err;
+    });
     
     // Create instance VBO for sprite data
     auto buffer = UploadVertexBuffer<glsl::SpriteInstance>::Create(
@@ -34,11 +41,12 @@ Error OGLSpriteRenderer::StartupImpl(InitContext const& context) {
     OKAMI_ERROR_RETURN(buffer);
     m_instanceBuffer = std::move(*buffer);
 
-    Error err;
-    glUseProgram(m_program.get());
-    err += GET_GL_ERROR();
-    err += AssignTextureBindingPoint(m_program, "u_texture", TextureBindingPoints::SpriteTexture);
-    OKAMI_ERROR_RETURN(err);
+    auto atlas = OGLSpriteAtlas::Create(kAtlasPageSize, kAtlasMaxLayers);
+    if (atlas) {
+        m_atlas = std::move(*atlas);
+    } else {
+        LOG(WARNING) << "OGLSpriteRenderer: sprite atlas unavailable, batching per texture: " << atlas.error();
+    }
 
     LOG(INFO) << "OGL Sprite Renderer initialized successfully";
     return {};
@@ -51,44 +59,90 @@ void OGLSpriteRenderer::ShutdownImpl(InitContext const& context) {
 Error OGLSpriteRenderer::Pass(entt::registry const& registry, OGLPass const& pass) {
     Error err;
 
-    // Collect all sprites and their transforms
-    std::vector<std::pair<TextureHandle, glsl::SpriteInstance>> spriteInstances;
-    
+    if (m_atlas && ++m_passCount % kAtlasCollectInterval == 0) {
+        m_atlas->CollectGarbage();
+    }
+
+    m_instances.clear();
+    m_sortItems.clear();
+    m_batchTextures.clear();
+    m_batchLookup.clear();
+
+    // Sprites that share a texture tend to be adjacent in the view, so the
+    // atlas/batch lookup is cached across consecutive sprites.
+    OGLTexture const*            lastTexture = nullptr;
+    OGLSpriteAtlas::Entry const* lastEntry   = nullptr;
+    uint32_t                     lastBatch   = 0;
+
     registry.view<SpriteComponent, Transform>().each([&](entity_t entity, const SpriteComponent& sprite, const Transform& transform) {
         if (!sprite.m_texture || !sprite.m_texture->IsLoaded()) {
             return;
         }
-        
-        spriteInstances.emplace_back(std::make_pair(sprite.m_texture, CreateSpriteInstance(sprite, transform)));
-    });
 
-    // Sort sprites back-to-front for proper alpha blending
-    std::sort(spriteInstances.begin(), spriteInstances.end(),
-        [this](const auto& a, const auto& b) {
-            if (a.second.a_position.z == b.second.a_position.z) {
-                return a.first.get() < b.first.get(); // Break ties by texture pointer
+        auto const* texture = static_cast<OGLTexture const*>(sprite.m_texture.get());
+        if (texture != lastTexture) {
+            lastTexture = texture;
+            // The atlas copies level 0, so streamed textures wait until it is resident
+            texture->RequestMip(0);
+            lastEntry   = m_atlas && texture->IsFullyResident()
+                ? m_atlas->FindOrInsert(sprite.m_texture) : nullptr;
+            if (lastEntry) {
+                lastBatch = 0;
+            } else {
+                auto [it, inserted] = m_batchLookup.try_emplace(
+                    texture, static_cast<uint32_t>(m_batchTextures.size() + 1));
+                if (inserted) {
+                    m_batchTextures.push_back(texture);
+                }
+                lastBatch = it->second;
             }
-            return a.second.a_position.z > b.second.a_position.z;
+        }
+
+        auto instance = CreateSpriteInstance(sprite, transform);
+        if (lastEntry) {
+            // Remap the sprite's source rect into the texture's atlas region.
+            auto const& region = lastEntry->m_uvRect;
+            instance.a_spriteRect = glm::vec4(
+                glm::vec2(region.x, region.y) + glm::vec2(instance.a_spriteRect.x, instance.a_spriteRect.y) * glm::vec2(region.z, region.w),
+                glm::vec2(instance.a_spriteRect.z, instance.a_spriteRect.w) * glm::vec2(region.z, region.w));
+            instance.a_layer = static_cast<float>(lastEntry->m_layer);
+        }
+
+        // Back-to-front: larger z draws first, so invert the ascending depth
+        // bits. Equal depths fall back to grouping by batch.
+        const uint32_t depthKey = ~FloatToSortableBits(instance.a_position.z);
+        m_sortItems.push_back(SortItem{
+            .m_key   = (uint64_t{depthKey} << 32) | lastBatch,
+            .m_index = static_cast<uint32_t>(m_instances.size()),
         });
+        m_instances.push_back(instance);
+    });
 
-    // Resize if necessary
-    m_instanceBuffer.Reserve(spriteInstances.size());
+    if (m_sortItems.empty()) {
+        return {};
+    }
 
-    // Set up rendering state
-    glUseProgram(m_program.get()); 
-    err += GET_GL_ERROR();
+    RadixSort(m_sortItems, m_sortScratch, [](SortItem const& item) { return item.m_key; });
 
-    glBindVertexArray(m_instanceBuffer.GetVertexArray()); 
-    err += GET_GL_ERROR();
+    // Resize if necessary
+    err += m_instanceBuffer.Reserve(m_sortItems.size());
+    OKAMI_ERROR_RETURN(err);
 
     {
         auto map = m_instanceBuffer.Map();
         OKAMI_ERROR_RETURN_IF(!map, "Failed to map instance buffer for sprite rendering");
-        for (size_t i = 0; i < spriteInstances.size(); ++i) {
-            (*map)[i] = spriteInstances[i].second;
+        for (size_t i = 0; i < m_sortItems.size(); ++i) {
+            (*map)[i] = m_instances[m_sortItems[i].m_index];
         }
     }
 
+    // Set up rendering state
+    glUseProgram(m_program.get()); 
+    err += GET_GL_ERROR();
+
+    glBindVertexArray(m_instanceBuffer.GetVertexArray()); 
+    err += GET_GL_ERROR();
+
     // Set uniforms
     err += m_sceneGlobalsProvider->GetSceneGlobalsBuffer().Bind(BufferBindingPoints::SceneGlobals);
 
@@ -98,40 +152,42 @@ Error OGLSpriteRenderer::Pass(entt::registry const& registry, OGLPass const& pas
     glEnable(GL_BLEND);
     glDepthMask(GL_TRUE);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // Group sprites by texture to minimize texture binding
-    TextureHandle currentTexture;
-    uint32_t batchStart = 0;
 
-    if (spriteInstances.empty()) {
-        return {};
+    if (m_atlas) {
+        m_atlas->UpdateMips();
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(TextureBindingPoints::SpriteAtlas));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_atlas->GetTexture());
+        err += GET_GL_ERROR();
     }
-    
-    for (uint32_t i = 0; i <= spriteInstances.size(); ++i) {
-        TextureHandle spriteTexture = spriteInstances[i < spriteInstances.size() ? i : 0].first;
-        
-        // Check if we need to flush the current batch
-        if (i == spriteInstances.size() || spriteTexture.get() != currentTexture.get()) {
-            if (currentTexture && currentTexture->IsLoaded() && i > batchStart) {
-                if (currentTexture->IsLoaded()) {
-                    auto* ogl = static_cast<OGLTexture*>(currentTexture.get());
-                    glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(TextureBindingPoints::SpriteTexture));
-                    glBindTexture(GL_TEXTURE_2D, ogl->m_texture.get());
-                    err += GET_GL_ERROR();
-                }
 
-                uint32_t instanceCount = i - batchStart;
-                // Draw points, geometry shader will expand them to quads
-                glDrawArrays(GL_POINTS, batchStart, instanceCount);
-                err += GET_GL_ERROR();
-            }
-            
-            currentTexture = spriteTexture;
-            batchStart = i;
+    // One draw per run of sprites sharing a batch. Atlased sprites share batch
+    // 0 regardless of their texture, so only unpacked textures split runs.
+    auto batchOf = [&](size_t i) {
+        return static_cast<uint32_t>(m_sortItems[i].m_key & 0xFFFFFFFFu);
+    };
+
+    const size_t spriteCount = m_sortItems.size();
+    size_t batchStart = 0;
+    for (size_t i = 1; i <= spriteCount; ++i) {
+        if (i < spriteCount && batchOf(i) == batchOf(batchStart)) {
+            continue;
+        }
+
+        if (auto batch = batchOf(batchStart); batch != 0) {
+            glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(TextureBindingPoints::SpriteTexture));
+            glBindTexture(GL_TEXTURE_2D, m_batchTextures[batch - 1]->m_texture.get());
+            err += GET_GL_ERROR();
         }
+
+        // Draw points, geometry shader will expand them to quads
+        glDrawArrays(GL_POINTS, static_cast<GLint>(batchStart), static_cast<GLsizei>(i - batchStart));
+        err += GET_GL_ERROR();
+
+        batchStart = i;
     }
-    
-    return {};
+
+    glBindVertexArray(0);
+    return err;
 }
 
 std::string OGLSpriteRenderer::GetName() const {
@@ -172,5 +228,8 @@ glsl::SpriteInstance OGLSpriteRenderer::CreateSpriteInstance(const SpriteCompone
     // Set color
     instance.a_color = sprite.m_color;
 
+    // Not atlased unless the caller assigns a layer
+    instance.a_layer = -1.0f;
+
     return instance;
 }
@@ -10,6 +10,9 @@
 #include "shaders/scene.glsl"
 
 #include "ogl_texture.hpp"
+#include "ogl_sprite_atlas.hpp"
+
+#include <unordered_map>
 
 namespace okami {
     class OGLSpriteRenderer final :
@@ -28,9 +31,33 @@ namespace okami {
 
         enum class TextureBindingPoints : GLint {
             SpriteTexture,
+            SpriteAtlas,
             Count,
         };
 
+        static constexpr GLsizei  kAtlasPageSize        = 2048;
+        static constexpr GLsizei  kAtlasMaxLayers       = 8;
+        static constexpr uint32_t kAtlasCollectInterval = 120; // passes between atlas sweeps
+
+        // Small RGBA8 sprite textures are packed here so that sprites with
+        // different textures share a batch. Empty if the atlas could not be created.
+        std::optional<OGLSpriteAtlas> m_atlas;
+        uint32_t m_passCount = 0;
+
+        // The sort key is (inverted depth << 32 | batch), where batch 0 is the
+        // atlas and batch n > 0 draws from m_batchTextures[n - 1].
+        struct SortItem {
+            uint64_t m_key;
+            uint32_t m_index;
+        };
+
+        // Per-pass scratch storage, kept to avoid reallocating every frame.
+        std::vector<glsl::SpriteInstance> m_instances;
+        std::vector<SortItem>             m_sortItems;
+        std::vector<SortItem>             m_sortScratch;
+        std::vector<OGLTexture const*>    m_batchTextures;
+        std::unordered_map<OGLTexture const*, uint32_t> m_batchLookup;
+
         // Component storage and views
         IOGLSceneGlobalsProvider* m_sceneGlobalsProvider = nullptr;
         
@@ -48,8 +75,5 @@ namespace okami {
     private:
         // Helper method to convert SpriteComponent + Transform to SpriteInstance
         glsl::SpriteInstance CreateSpriteInstance(const SpriteComponent& sprite, const Transform& transform) const;
-        
-        // Helper method to sort sprites back-to-front based on Z position
-        void SortSpritesBackToFront(std::vector<std::pair<entity_t, glsl::SpriteInstance>>& sprites) const;
     };
 }
\ No newline at end of file
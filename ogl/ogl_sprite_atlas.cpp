@@ -0,0 +1,309 @@
+#include "ogl_sprite_atlas.hpp"
+
+#include <glog/logging.h>
+
+using namespace okami;
+
+namespace {
+    // Restores the framebuffer bindings and scissor state touched while
+    // copying into / clearing the atlas.
+    struct FramebufferBindingGuard {
+        GLint m_read = 0;
+        GLint m_draw = 0;
+        GLboolean m_scissor = GL_FALSE;
+
+        FramebufferBindingGuard() {
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_read);
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_draw);
+            m_scissor = glIsEnabled(GL_SCISSOR_TEST);
+        }
+
+        ~FramebufferBindingGuard() {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(m_read));
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_draw));
+            if (m_scissor) {
+                glEnable(GL_SCISSOR_TEST);
+            }
+        }
+    };
+
+    void ClearLayer(GLuint framebuffer, GLuint texture, GLint layer) {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer);
+        glDisable(GL_SCISSOR_TEST);
+        const GLfloat transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 0, transparent);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+    }
+}
+
+Expected<OGLSpriteAtlas> OGLSpriteAtlas::Create(GLsizei pageSize, GLsizei maxLayers) {
+    OGLSpriteAtlas result;
+
+    GLint maxArrayLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayLayers);
+    result.m_pageSize  = pageSize;
+    result.m_maxLayers = std::max<GLsizei>(1, std::min<GLsizei>(maxLayers, maxArrayLayers));
+
+    glGenFramebuffers(1, result.m_readFramebuffer.ptr());
+    OKAMI_UNEXPECTED_RETURN_IF(!result.m_readFramebuffer, "Failed to create sprite atlas framebuffer");
+
+    auto err = result.Grow();
+    OKAMI_UNEXPECTED_RETURN(err);
+
+    return result;
+}
+
+Error OGLSpriteAtlas::Grow() {
+    const auto oldLayers = static_cast<GLsizei>(m_layers.size());
+    const auto newLayers = oldLayers == 0 ? 1 : std::min(oldLayers * 2, m_maxLayers);
+    OKAMI_ERROR_RETURN_IF(newLayers <= oldLayers, "Sprite atlas is at its layer limit");
+
+    GLTexture newTexture;
+    glGenTextures(1, newTexture.ptr());
+    OKAMI_ERROR_RETURN_IF(!newTexture, "Failed to create sprite atlas texture");
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, newTexture.get());
+    for (GLint level = 0; level < kMipLevels; ++level) {
+        const auto size = std::max<GLsizei>(1, m_pageSize >> level);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8,
+            size, size, newLayers, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, kMipLevels - 1);
+    OKAMI_ERROR_RETURN(GET_GL_ERROR());
+
+    {
+        FramebufferBindingGuard guard;
+
+        // Carry existing layers over to the new array.
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer.get());
+        for (GLsizei layer = 0; layer < oldLayers; ++layer) {
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_texture.get(), 0, layer);
+            glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 0, 0, m_pageSize, m_pageSize);
+        }
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+
+        // Fresh layers must be transparent so packing padding never bleeds.
+        for (GLsizei layer = oldLayers; layer < newLayers; ++layer) {
+            ClearLayer(m_readFramebuffer.get(), newTexture.get(), layer);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    OKAMI_ERROR_RETURN(GET_GL_ERROR());
+
+    m_texture = std::move(newTexture);
+    m_layers.resize(newLayers);
+    b_mipsDirty = true;
+
+    LOG(INFO) << "OGLSpriteAtlas: grew to " << newLayers << " layers of " << m_pageSize << "x" << m_pageSize;
+    return {};
+}
+
+std::optional<std::pair<GLsizei, GLsizei>> OGLSpriteAtlas::Place(Layer& layer, GLsizei width, GLsizei height) {
+    // Best-fit shelf by height.
+    Shelf* best = nullptr;
+    for (auto& shelf : layer.m_shelves) {
+        if (height <= shelf.m_height && shelf.m_cursorX + width <= m_pageSize &&
+            (!best || shelf.m_height < best->m_height)) {
+            best = &shelf;
+        }
+    }
+    if (best) {
+        auto x = best->m_cursorX;
+        best->m_cursorX += width;
+        return std::make_pair(x, best->m_y);
+    }
+
+    if (layer.m_nextShelfY + height > m_pageSize) {
+        return std::nullopt;
+    }
+    layer.m_shelves.push_back(Shelf{
+        .m_y = layer.m_nextShelfY,
+        .m_height = height,
+        .m_cursorX = width,
+    });
+    layer.m_nextShelfY += height;
+    return std::make_pair(GLsizei{0}, layer.m_shelves.back().m_y);
+}
+
+Error OGLSpriteAtlas::CopyIntoLayer(OGLTexture const& source, int32_t layer, GLsizei x, GLsizei y) {
+    auto const& desc = source.GetDesc();
+
+    FramebufferBindingGuard guard;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer.get());
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source.m_texture.get(), 0);
+    OKAMI_DEFER(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+
+    OKAMI_ERROR_RETURN_IF(glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE,
+        "Sprite texture cannot be attached for atlas copy");
+
+    const auto w = static_cast<GLsizei>(desc.width);
+    const auto h = static_cast<GLsizei>(desc.height);
+    auto copy = [&](GLint srcX, GLint srcY, GLsizei width, GLsizei height, GLint dstX, GLint dstY) {
+        glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, dstX, dstY, layer, srcX, srcY, width, height);
+    };
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture.get());
+    copy(0, 0, w, h, x, y);
+
+    // Repeat the edge texels into the gutter, so linear filtering at the
+    // entry's border blends with its own edge rather than a neighbour.
+    for (GLsizei i = 1; i <= m_padding; ++i) {
+        copy(0,     0,     1, h, x - i,         y);
+        copy(w - 1, 0,     1, h, x + w - 1 + i, y);
+        copy(0,     0,     w, 1, x,             y - i);
+        copy(0,     h - 1, w, 1, x,             y + h - 1 + i);
+        for (GLsizei j = 1; j <= m_padding; ++j) {
+            copy(0,     0,     1, 1, x - i,         y - j);
+            copy(w - 1, 0,     1, 1, x + w - 1 + i, y - j);
+            copy(0,     h - 1, 1, 1, x - i,         y + h - 1 + j);
+            copy(w - 1, h - 1, 1, 1, x + w - 1 + i, y + h - 1 + j);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    b_mipsDirty = true;
+    return GET_GL_ERROR();
+}
+
+OGLSpriteAtlas::Entry const* OGLSpriteAtlas::FindOrInsert(TextureHandle const& texture) {
+    auto const* key = texture.get();
+    auto const& source = *static_cast<OGLTexture const*>(key);
+
+    if (auto it = m_slots.find(key); it != m_slots.end()) {
+        auto& slot = it->second;
+        if (slot.m_version == source.m_version) {
+            return &slot.m_entry;
+        }
+
+        // Reloaded since it was copied. The same size fits back in its own
+        // region; otherwise the region is abandoned and the texture packed
+        // again below.
+        auto const& desc = source.GetDesc();
+        if (desc.type == TextureType::TEXTURE_2D && desc.format == TextureFormat::RGBA8 &&
+            static_cast<GLsizei>(desc.width) == slot.m_width &&
+            static_cast<GLsizei>(desc.height) == slot.m_height) {
+            auto err = CopyIntoLayer(source, slot.m_entry.m_layer, slot.m_x, slot.m_y);
+            if (err.IsError()) {
+                LOG(WARNING) << "OGLSpriteAtlas: failed to refresh reloaded texture: " << err;
+            }
+            slot.m_version = source.m_version;
+            return &slot.m_entry;
+        }
+
+        const auto layer = slot.m_entry.m_layer;
+        m_slots.erase(it);
+        if (--m_layers[layer].m_liveEntries == 0) {
+            RecycleLayer(layer);
+        }
+    }
+    if (m_rejected.contains(key)) {
+        return nullptr;
+    }
+
+    auto reject = [&]() -> Entry const* {
+        m_rejected.emplace(key, texture);
+        return nullptr;
+    };
+
+    // Rounded up so every entry starts on a texel of the coarsest mip
+    auto const& desc = texture->GetDesc();
+    auto align = [&](GLsizei size) {
+        return (size + m_padding - 1) / m_padding * m_padding;
+    };
+    const auto width  = align(static_cast<GLsizei>(desc.width)  + 2 * m_padding);
+    const auto height = align(static_cast<GLsizei>(desc.height) + 2 * m_padding);
+    if (desc.type != TextureType::TEXTURE_2D ||
+        desc.format != TextureFormat::RGBA8 ||
+        width > m_pageSize || height > m_pageSize) {
+        return reject();
+    }
+
+    std::optional<std::pair<GLsizei, GLsizei>> position;
+    int32_t layerIndex = 0;
+    for (; layerIndex < static_cast<int32_t>(m_layers.size()); ++layerIndex) {
+        if ((position = Place(m_layers[layerIndex], width, height))) {
+            break;
+        }
+    }
+    if (!position) {
+        if (Grow().IsError()) {
+            return reject();
+        }
+        position = Place(m_layers[layerIndex], width, height);
+        if (!position) {
+            return reject();
+        }
+    }
+
+    const GLsizei x = position->first + m_padding;
+    const GLsizei y = position->second + m_padding;
+    auto err = CopyIntoLayer(source, layerIndex, x, y);
+    if (err.IsError()) {
+        LOG(WARNING) << "OGLSpriteAtlas: failed to pack texture: " << err;
+        return reject();
+    }
+
+    const float invPage = 1.0f / static_cast<float>(m_pageSize);
+    auto [it, inserted] = m_slots.emplace(key, Slot{
+        .m_texture = texture,
+        .m_entry = Entry{
+            .m_layer  = layerIndex,
+            .m_uvRect = glm::vec4(
+                static_cast<float>(x) * invPage,
+                static_cast<float>(y) * invPage,
+                static_cast<float>(desc.width) * invPage,
+                static_cast<float>(desc.height) * invPage),
+        },
+        .m_x = x,
+        .m_y = y,
+        .m_width = static_cast<GLsizei>(desc.width),
+        .m_height = static_cast<GLsizei>(desc.height),
+        .m_version = source.m_version,
+    });
+    ++m_layers[layerIndex].m_liveEntries;
+    return &it->second.m_entry;
+}
+
+void OGLSpriteAtlas::CollectGarbage() {
+    std::vector<int32_t> emptied;
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        if (it->second.m_texture.expired()) {
+            auto& layer = m_layers[it->second.m_entry.m_layer];
+            if (--layer.m_liveEntries == 0) {
+                emptied.push_back(it->second.m_entry.m_layer);
+            }
+            it = m_slots.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Let previously rejected textures retry, e.g. after a layer was freed.
+    m_rejected.clear();
+
+    for (auto layer : emptied) {
+        RecycleLayer(layer);
+    }
+}
+
+void OGLSpriteAtlas::RecycleLayer(int32_t layer) {
+    FramebufferBindingGuard guard;
+    m_layers[layer] = Layer{};
+    ClearLayer(m_readFramebuffer.get(), m_texture.get(), layer);
+    b_mipsDirty = true;
+}
+
+void OGLSpriteAtlas::UpdateMips() {
+    if (!b_mipsDirty) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture.get());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    b_mipsDirty = false;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ogl_utils.hpp"
+#include "ogl_texture.hpp"
+
+#include <unordered_map>
+
+namespace okami {
+    // Runtime atlas that packs small RGBA8 sprite textures into the layers of a
+    // GL_TEXTURE_2D_ARRAY, so sprites using different textures can share one
+    // draw call. Texels are copied GPU-side from the source texture's top mip,
+    // and each entry is ringed by a gutter repeating its edge texels so
+    // linear filtering never reaches into a neighbouring entry.
+    //
+    // The atlas keeps kMipLevels mips, regenerated from the top level by
+    // UpdateMips(), so minified sprites filter instead of aliasing. Entries
+    // are aligned to the coarsest mip's texel and the gutter is one of its
+    // texels wide, so no mip blends neighbouring entries. Sprites minified
+    // past the coarsest mip alias again.
+    //
+    // Layers are filled with a shelf packer. A layer is recycled once every
+    // texture packed into it has been destroyed; regions within a live layer
+    // are not reused. Textures that are too large, use another format, or do
+    // not fit once the atlas is at its layer limit are left unpacked and
+    // drawn from their own texture. A reloaded texture is copied again in
+    // place, or packed anew if its size changed.
+    class OGLSpriteAtlas {
+    public:
+        static constexpr GLsizei kMipLevels = 4;
+
+        struct Entry {
+            int32_t   m_layer = -1;
+            glm::vec4 m_uvRect{0.0f}; // xy = offset, zw = scale in atlas UV space
+        };
+
+    private:
+        struct Shelf {
+            GLsizei m_y = 0;
+            GLsizei m_height = 0;
+            GLsizei m_cursorX = 0;
+        };
+
+        struct Layer {
+            std::vector<Shelf> m_shelves;
+            GLsizei            m_nextShelfY = 0;
+            size_t             m_liveEntries = 0;
+        };
+
+        struct Slot {
+            std::weak_ptr<ITexture> m_texture; // also pins the address against reuse
+            Entry                   m_entry;
+            GLsizei                 m_x = 0; // texel region of the entry in its layer
+            GLsizei                 m_y = 0;
+            GLsizei                 m_width = 0;
+            GLsizei                 m_height = 0;
+            uint32_t                m_version = 0; // of the texture when copied
+        };
+
+        GLTexture     m_texture;
+        GLFramebuffer m_readFramebuffer;
+        GLsizei       m_pageSize = 0;
+        GLsizei       m_maxLayers = 0;
+        GLsizei       m_padding = 1 << (kMipLevels - 1); // gutter texels around each entry, also their alignment
+        bool          b_mipsDirty = false;
+        std::vector<Layer> m_layers;
+
+        std::unordered_map<ITexture const*, Slot> m_slots;
+        // Textures that cannot be packed, so the lookup is not retried each frame.
+        std::unordered_map<ITexture const*, std::weak_ptr<ITexture>> m_rejected;
+
+        Error Grow();
+        std::optional<std::pair<GLsizei, GLsizei>> Place(Layer& layer, GLsizei width, GLsizei height);
+        Error CopyIntoLayer(OGLTexture const& source, int32_t layer, GLsizei x, GLsizei y);
+        void RecycleLayer(int32_t layer);
+
+    public:
+        static Expected<OGLSpriteAtlas> Create(GLsizei pageSize, GLsizei maxLayers);
+
+        // Returns the atlas entry for the texture, packing it on first use, or
+        // nullptr if the texture is not atlased. GL thread only.
+        Entry const* FindOrInsert(TextureHandle const& texture);
+
+        // Drops entries whose textures have been destroyed and recycles empty layers.
+        void CollectGarbage();
+
+        // Regenerates the mips if entries changed since the last call. Call
+        // after packing a pass's sprites and before drawing from the atlas.
+        void UpdateMips();
+
+        GLuint GetTexture() const { return m_texture.get(); }
+        size_t GetLayerCount() const { return m_layers.size(); }
+        size_t GetEntryCount() const { return m_slots.size(); }
+    };
+}
@@ -3,6 +3,8 @@
 #include "../paths.hpp"
 #include <glog/logging.h>
 
+#include <algorithm>
+
 using namespace okami;
 
 Error OGLStaticMeshRenderer::RegisterImpl(InterfaceCollection& interfaces) {
@@ -31,6 +33,13 @@ Error OGLStaticMeshRenderer::StartupImpl(InitContext const& context) {
     OKAMI_ERROR_RETURN(instanceVBO);
     m_instanceVBO = std::move(*instanceVBO);
 
+    if (m_geometryManager->GetMegaBuffer()) {
+        glGenVertexArrays(1, m_megaVAO.ptr());
+        OKAMI_ERROR_RETURN_IF(!m_megaVAO, "Failed to create mega buffer VAO");
+        glGenBuffers(1, m_indirectBuffer.ptr());
+        OKAMI_ERROR_RETURN_IF(!m_indirectBuffer, "Failed to create indirect draw buffer");
+    }
+
     m_pipelineState.depthTestEnabled = true;
     m_pipelineState.blendEnabled     = false;
     m_pipelineState.cullFaceEnabled  = true;
@@ -44,17 +53,13 @@ Error OGLStaticMeshRenderer::StartupImpl(InitContext const& context) {
         depthPaths.m_vertex   = GetGLSLShaderPath("static_mesh_depth.vs");
         depthPaths.m_geometry = GetGLSLShaderPath("static_mesh_depth.gs");
         depthPaths.m_fragment = GetGLSLShaderPath("static_mesh_depth.fs");
-        auto depthProg = CreateProgram(depthPaths, *cache);
-        if (!depthProg) {
-            LOG(ERROR) << "OGLStaticMeshRenderer: Failed to compile depth program: " << depthProg.error();
-            err += depthProg.error();
-        } else {
-            m_depthProgram = std::move(*depthProg);
+        cache->DeferProgram(depthPaths, [this](GLProgram&& program) -> Error {
+            m_depthProgram = std::move(program);
             glUseProgram(m_depthProgram.get());
-            err += AssignBufferBindingPoint(m_depthProgram, "CascadeBlock", 0);
+            Error err = AssignBufferBindingPoint(m_depthProgram, "CascadeBlock", 0);
             glUseProgram(0);
-        }
-        OKAMI_ERROR_RETURN(err);
+            return err;
+        });
     }
 
     LOG(INFO) << "OGL Static Mesh Renderer initialized successfully";
@@ -71,11 +76,17 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
         glsl::StaticMeshInstance         m_glslData;
     };
 
-    std::vector<InstanceData> instances;
+    std::pmr::vector<InstanceData> instances(pass.m_frameResource);
 
     registry.view<StaticMeshComponent, Transform>().each(
         [&](auto entity, StaticMeshComponent const& mesh, Transform const& transform) {
-            if (!mesh.m_geometry || !mesh.m_geometry->IsLoaded()) {
+            if (!mesh.m_geometry) {
+                return;
+            }
+            // Marked before the check, so evicted geometry loads again
+            auto const* geometry = OGLGeometryManager::GetOGLGeometry(mesh.m_geometry);
+            geometry->MarkUsed();
+            if (!geometry->IsResident()) {
                 return;
             }
             auto matrix       = transform.AsMatrix();
@@ -102,13 +113,14 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
 
     Error err;
 
-    // Sort by (geometry entity, material pointer) to minimise state changes.
+    // Sort by (material pointer, geometry) so that each material's draws are
+    // contiguous; the multi-draw path issues one call per material run.
     std::sort(instances.begin(), instances.end(),
         [](InstanceData const& a, InstanceData const& b) {
-            if (a.m_geometry == b.m_geometry) {
-                return a.m_material.get() < b.m_material.get();
+            if (a.m_material == b.m_material) {
+                return a.m_geometry.get() < b.m_geometry.get();
             }
-            return a.m_geometry.get() < b.m_geometry.get();
+            return a.m_material.get() < b.m_material.get();
         });
 
     // Upload all per-instance data to the instance VBO, resizing if needed.
@@ -135,7 +147,76 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
         err += GET_GL_ERROR();
     }
 
-    // Draw one instanced call per (geometry, material) group.
+    auto bindProgram = [&](OGLMaterial* mat) {
+        if (pass.m_type == OGLPassType::Shadow) {
+            glUseProgram(m_depthProgram.get());
+            err += m_depthPassProvider->GetCascadesBuffer().Bind(0);
+        } else {
+            mat->Bind();
+            err += GET_GL_ERROR();
+            err += m_sceneGlobalsProvider->GetSceneGlobalsBuffer().Bind(BufferBindingPoints::SceneGlobals);
+        }
+    };
+
+    // Usage feedback for streamed textures: each texture asks for the mip
+    // matching the largest on-screen size among the instances drawing it
+    auto const& camera = m_sceneGlobalsProvider->GetCurrentSceneGlobals().u_camera;
+    auto requestTextureMips = [&](OGLMaterial const& mat, size_t first, size_t last) {
+        auto streamed = [](OGLTextureBinding const& tb) {
+            return tb.m_handle && tb.m_handle->IsLoaded() &&
+                static_cast<OGLTexture const*>(tb.m_handle.get())->IsStreaming();
+        };
+        if (std::none_of(mat.m_textureBindings.begin(), mat.m_textureBindings.end(), streamed)) {
+            return;
+        }
+
+        auto const& bounds = instances[first].m_geometry->GetDesc().m_primitives[0].m_aabb;
+        const glm::vec3 center = 0.5f * (bounds.m_min + bounds.m_max);
+        const float radius = 0.5f * glm::length(bounds.m_max - bounds.m_min);
+        const bool perspective = camera.u_proj[3][3] == 0.0f;
+        const float pixelsPerUnit = 0.5f * camera.u_viewport.y * camera.u_proj[1][1];
+
+        float screenSize = 0.0f;
+        for (size_t i = first; i < last; ++i) {
+            auto const& data = instances[i].m_glslData;
+            const float scale = std::max({
+                glm::length(glm::vec3(data.a_instanceModel_col0)),
+                glm::length(glm::vec3(data.a_instanceModel_col1)),
+                glm::length(glm::vec3(data.a_instanceModel_col2)) });
+            float size = 2.0f * radius * scale * pixelsPerUnit;
+            if (perspective) {
+                const glm::vec3 worldCenter = glm::vec3(data.a_instanceModel_col0) * center.x +
+                    glm::vec3(data.a_instanceModel_col1) * center.y +
+                    glm::vec3(data.a_instanceModel_col2) * center.z +
+                    glm::vec3(data.a_instanceModel_col3);
+                const float distance = glm::length(worldCenter - glm::vec3(camera.u_cameraPosition)) - radius * scale;
+                size /= std::max(distance, 1e-3f);
+            }
+            screenSize = std::max(screenSize, size);
+        }
+
+        // Twice the size so the chosen level is never smaller than the screen area
+        const auto texels = static_cast<uint32_t>(std::min(2.0f * screenSize, 65536.0f));
+        for (auto const& tb : mat.m_textureBindings) {
+            if (streamed(tb)) {
+                auto const* texture = static_cast<OGLTexture const*>(tb.m_handle.get());
+                texture->RequestMip(GetMipLevelForSize(texture->GetDesc(), texels));
+            }
+        }
+    };
+
+    // Mega-buffer draws are collected into runs that share a program/material
+    // and submitted after the loop with one glMultiDrawElementsIndirect each.
+    // The depth program is material-independent, so shadow passes form one run.
+    struct IndirectRun {
+        OGLMaterial* m_material;
+        size_t       m_firstCommand;
+        size_t       m_commandCount;
+    };
+    std::pmr::vector<IndirectRun> indirectRuns(pass.m_frameResource);
+    m_indirectCommands.clear();
+
+    // One instanced draw per (material, geometry) group.
     size_t groupStart = 0;
     while (groupStart < instanceCount) {
         // Find end of this group.
@@ -157,6 +238,35 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
             continue;
         }
 
+        m_stats.m_instances += groupSize;
+
+        if (pass.m_type != OGLPassType::Shadow) {
+            requestTextureMips(*mat, groupStart, groupEnd);
+        }
+
+        if (meshImpl->m_megaAllocation) {
+            auto const& alloc = *meshImpl->m_megaAllocation;
+            bool newRun = indirectRuns.empty() ||
+                (pass.m_type != OGLPassType::Shadow && indirectRuns.back().m_material != mat);
+            if (newRun) {
+                indirectRuns.push_back(IndirectRun{
+                    .m_material     = mat,
+                    .m_firstCommand = m_indirectCommands.size(),
+                    .m_commandCount = 0,
+                });
+            }
+            m_indirectCommands.push_back(DrawElementsIndirectCommand{
+                .m_count         = alloc.m_indexCount,
+                .m_instanceCount = static_cast<GLuint>(groupSize),
+                .m_firstIndex    = alloc.m_firstIndex,
+                .m_baseVertex    = static_cast<GLint>(alloc.m_baseVertex),
+                .m_baseInstance  = static_cast<GLuint>(groupStart),
+            });
+            ++indirectRuns.back().m_commandCount;
+            groupStart = groupEnd;
+            continue;
+        }
+
         // Bind geometry VAO then attach the per-instance attributes from the instance VBO.
         glBindVertexArray(meshImpl->m_vao.get());
         err += GET_GL_ERROR();
@@ -181,14 +291,7 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         err += GET_GL_ERROR();
 
-        if (pass.m_type == OGLPassType::Shadow) {
-            glUseProgram(m_depthProgram.get());
-            err += m_depthPassProvider->GetCascadesBuffer().Bind(0);
-        } else {
-            mat->Bind();
-            err += GET_GL_ERROR();
-            err += m_sceneGlobalsProvider->GetSceneGlobalsBuffer().Bind(BufferBindingPoints::SceneGlobals);
-        }
+        bindProgram(mat);
 
         auto const& desc = inst0.m_geometry->GetDesc();
         auto const& prim = desc.m_primitives[0];
@@ -206,14 +309,66 @@ Error OGLStaticMeshRenderer::Pass(entt::registry const& registry, OGLPass const&
                 static_cast<GLsizei>(groupSize));
         }
         err += GET_GL_ERROR();
+        ++m_stats.m_drawCalls;
 
         groupStart = groupEnd;
     }
 
+    if (!indirectRuns.empty()) {
+        auto* megaBuffer = m_geometryManager->GetMegaBuffer();
+        OKAMI_ERROR_RETURN_IF(!megaBuffer, "Mega buffer draws recorded without a mega buffer");
+
+        err += EnsureMegaVAO(*megaBuffer);
+        OKAMI_ERROR_RETURN(err);
+
+        glBindVertexArray(m_megaVAO.get());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer.get());
+        glBufferData(GL_DRAW_INDIRECT_BUFFER,
+            m_indirectCommands.size() * sizeof(DrawElementsIndirectCommand),
+            m_indirectCommands.data(),
+            GL_STREAM_DRAW);
+        err += GET_GL_ERROR();
+
+        for (auto const& run : indirectRuns) {
+            bindProgram(run.m_material);
+            glMultiDrawElementsIndirect(
+                GL_TRIANGLES,
+                GL_UNSIGNED_INT,
+                reinterpret_cast<void*>(run.m_firstCommand * sizeof(DrawElementsIndirectCommand)),
+                static_cast<GLsizei>(run.m_commandCount),
+                0);
+            err += GET_GL_ERROR();
+            ++m_stats.m_drawCalls;
+            ++m_stats.m_multiDrawCalls;
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
     glBindVertexArray(0);
     return err;
 }
 
+Error OGLStaticMeshRenderer::EnsureMegaVAO(OGLMegaBuffer const& megaBuffer) {
+    // The VAO captures buffer names, so it must be rebuilt whenever the mega
+    // buffer grows or the instance VBO is reallocated.
+    if (m_megaVAO &&
+        m_megaVAOGeneration == megaBuffer.GetGeneration() &&
+        m_megaVAOInstanceBuffer == m_instanceVBO.GetBuffer()) {
+        return {};
+    }
+
+    SetupVertexArray(m_megaVAO, glsl::__get_vs_input_infoStaticMeshVertex(),
+        megaBuffer.GetVertexBuffer(), megaBuffer.GetIndexBuffer());
+    SetupVertexArray(m_megaVAO, glsl::__get_vs_input_infoStaticMeshInstance(),
+        m_instanceVBO.GetBuffer(), std::nullopt);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_megaVAOGeneration     = megaBuffer.GetGeneration();
+    m_megaVAOInstanceBuffer = m_instanceVBO.GetBuffer();
+    return GET_GL_ERROR();
+}
+
 std::string OGLStaticMeshRenderer::GetName() const {
     return "OGL Static Mesh Renderer";
 }
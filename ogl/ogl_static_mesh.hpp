@@ -33,6 +33,18 @@ namespace okami {
         // Depth-only program compiled from static_mesh_depth.vs/fs.
         GLProgram m_depthProgram;
 
+        // Multi-draw indirect path, used for primitives that live in the
+        // geometry manager's mega buffer. The VAO sources vertices/indices from
+        // the mega buffer and per-instance data from m_instanceVBO, selected by
+        // each command's baseInstance.
+        GLVertexArray m_megaVAO;
+        GLBuffer      m_indirectBuffer;
+        uint32_t      m_megaVAOGeneration     = ~0u;
+        GLuint        m_megaVAOInstanceBuffer = 0;
+        std::vector<DrawElementsIndirectCommand> m_indirectCommands;
+
+        OGLDrawStats  m_stats;
+
         OGLGeometryManager*          m_geometryManager      = nullptr;
         IOGLSceneGlobalsProvider*    m_sceneGlobalsProvider = nullptr;
         IOGLDepthPassProvider*       m_depthPassProvider    = nullptr;
@@ -40,11 +52,17 @@ namespace okami {
         Error RegisterImpl(InterfaceCollection& interfaces) override;
         Error StartupImpl(InitContext const& context) override;
 
+        Error EnsureMegaVAO(OGLMegaBuffer const& megaBuffer);
+
     public:
         OGLStaticMeshRenderer(OGLGeometryManager* geometryManager);
 
         Error Pass(entt::registry const& registry, OGLPass const& pass) override;
 
+        // Counters accumulated over every Pass() since the last reset.
+        OGLDrawStats const& GetDrawStats() const { return m_stats; }
+        void ResetDrawStats() { m_stats = {}; }
+
         std::string GetName() const override;
     };
 }
@@ -1,9 +1,14 @@
 #include "ogl_texture.hpp"
+#include "../config.hpp"
 #include "../paths.hpp"
+#include "../renderer.hpp"
 
 #include <glog/logging.h>
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <utility>
+
 using namespace okami;
 
 // ---------------------------------------------------------------------------
@@ -61,6 +66,9 @@ GLenum okami::ToGlType(TextureFormat format) {
 // ---------------------------------------------------------------------------
 
 OGLTexture::~OGLTexture() {
+    if (m_load_cancelled) {
+        m_load_cancelled->store(true, std::memory_order_release);
+    }
     if (m_deletion_queue) {
         if (GLuint id = m_texture.release(); id != 0) {
             m_deletion_queue->PushTexture(id);
@@ -74,17 +82,24 @@ OGLTexture::~OGLTexture() {
 // Helper: upload a Texture to an OGLTexture on the GL thread
 // ---------------------------------------------------------------------------
 
+// Uploads the levels held by data, which may be only part of the source
+// mip chain; the texture then samples from the finest uploaded level.
 static Error UploadToGL(OGLTexture& out, Texture const& data) {
     auto const& desc = data.GetDesc();
+    auto const& sourceDesc = data.GetSourceDesc();
+    const GLint firstMip = static_cast<GLint>(data.GetFirstMip());
+    const bool created = out.m_texture.get() == 0;
 
-    glGenTextures(1, out.m_texture.ptr());
+    if (created) {
+        glGenTextures(1, out.m_texture.ptr());
+    }
     glBindTexture(GL_TEXTURE_2D, out.m_texture);
 
     for (int mip = 0; mip < static_cast<int>(desc.mipLevels); ++mip) {
         GLsizei w = static_cast<GLsizei>(std::max(1u, desc.width  >> mip));
         GLsizei h = static_cast<GLsizei>(std::max(1u, desc.height >> mip));
 
-        glTexImage2D(GL_TEXTURE_2D, mip,
+        glTexImage2D(GL_TEXTURE_2D, firstMip + mip,
             ToGlInternalFormat(desc.format),
             w, h, 0,
             ToGlFormat(desc.format),
@@ -92,40 +107,89 @@ static Error UploadToGL(OGLTexture& out, Texture const& data) {
             data.GetData(mip).data());
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-        desc.mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (created) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+            sourceDesc.mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+            static_cast<GLint>(sourceDesc.mipLevels) - 1);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstMip);
 
     OKAMI_ERROR_RETURN(GET_GL_ERROR());
 
-    out.m_desc = desc;
+    out.m_desc = sourceDesc;
     out.m_loaded.store(true, std::memory_order_release);
     return {};
 }
 
+// Drops every level finer than mip, freeing its storage
+static void DropFinerMips(OGLTexture& texture, uint32_t mip) {
+    auto& stream = *texture.m_stream;
+    auto const& desc = texture.m_desc;
+
+    glBindTexture(GL_TEXTURE_2D, texture.m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(mip));
+    for (uint32_t level = stream.m_residentMip; level < mip; ++level) {
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level),
+            ToGlInternalFormat(desc.format), 0, 0, 0,
+            ToGlFormat(desc.format), ToGlType(desc.format), nullptr);
+    }
+    stream.m_residentMip = mip;
+}
+
+// The last level, which eviction never drops so the texture stays complete
+static uint32_t GetCoarsestMip(TextureDesc const& desc) {
+    return std::max(desc.mipLevels, 1u) - 1;
+}
+
+// GPU memory held by levels [firstMip, endMip)
+static size_t GetMipRangeSize(TextureDesc const& desc, uint32_t firstMip, uint32_t endMip) {
+    size_t size = 0;
+    for (uint32_t mip = firstMip; mip < endMip; ++mip) {
+        size += GetMipSize(desc, mip);
+    }
+    return size;
+}
+
 // ---------------------------------------------------------------------------
 // OGLTextureManager
 // ---------------------------------------------------------------------------
 
 Error OGLTextureManager::RegisterImpl(InterfaceCollection& ic) {
     ic.Register<ITextureManager>(this);
+    ic.Register<IAssetReloader>(this);
     ic.RegisterSignalHandler<OnResourceLoadedEvent<Texture>>(&m_loaded_handler);
+    RegisterConfig<TextureStreamingConfig>(ic, LOG_WRAP(WARNING));
+    m_interfaces = &ic;
+    return {};
+}
+
+Error OGLTextureManager::StartupImpl(InitContext const& context) {
+    auto config = ReadConfig<TextureStreamingConfig>(context.m_interfaces, LOG_WRAP(WARNING));
+    m_streamTailSize = static_cast<uint32_t>(std::max(config.tailSize, 0));
+    m_streamBudget   = static_cast<size_t>(std::max(config.budgetMB, 0)) << 20;
+    if (m_streamTailSize > 0) {
+        LOG(INFO) << "OGLTextureManager: streaming mips finer than " << m_streamTailSize
+                  << " texels, budget " << config.budgetMB << " MiB";
+    }
     return {};
 }
 
 TextureHandle OGLTextureManager::LoadTexture(
     std::filesystem::path const& path,
     TextureLoadParams             params,
-    InterfaceCollection&          ic) {
+    InterfaceCollection&          ic,
+    LoadPriority                  priority) {
 
     // --- Dedup: return existing handle if still alive ---
     {
         std::lock_guard lock(m_mtx);
         auto it = m_path_cache.find(path);
         if (it != m_path_cache.end()) {
-            if (auto existing = it->second.lock()) {
+            if (auto existing = it->second.m_texture.lock()) {
                 return existing; // already loading or loaded
             }
             m_path_cache.erase(it); // expired, fall through to create new
@@ -134,39 +198,96 @@ TextureHandle OGLTextureManager::LoadTexture(
 
     // --- Pre-create OGLTexture (IsLoaded() = false until upload) ---
     auto id  = m_next_id.fetch_add(1, std::memory_order_relaxed);
-    auto pending = std::make_unique<PendingLoad>();
-    pending->m_texture            = std::make_shared<OGLTexture>();
-
-    pending->m_texture->m_deletion_queue = m_deletion_queue;
-    TextureHandle handle = pending->m_texture; // keep a copy before moving
+    auto texture = std::make_shared<OGLTexture>();
+    texture->m_deletion_queue = m_deletion_queue;
+    texture->m_load_cancelled = MakeLoadCancelFlag();
+
+    // Unless the caller asked for specific mips, only the tail loads now
+    const bool wholeChain = params.m_firstMip == 0 && params.m_mipCount == 0 && params.m_maxSize == 0;
+    const auto requested = params;
+    if (m_streamTailSize > 0 && wholeChain) {
+        texture->m_stream = OGLTextureStreamState{ .m_path = path, .m_params = params };
+        params.m_maxSize = m_streamTailSize;
+    }
 
     {
         std::lock_guard lock(m_mtx);
-        m_path_cache[path] = pending->m_texture; // weak_ptr for dedup
-        m_pending[id]      = std::move(pending);
+        m_path_cache[path] = CachedTexture{ texture, params, texture->m_stream }; // weak_ptr for dedup
+        m_pending[id]      = std::make_unique<PendingLoad>(PendingLoad{
+            .m_texture = texture,
+            .m_path    = wholeChain ? path : std::filesystem::path{},
+            .m_params  = requested,
+        });
     }
 
     ic.SendSignal(LoadResourceSignal<Texture>{
-        .m_path   = path,
-        .m_params = params,
-        .m_id     = id,
+        .m_path      = path,
+        .m_params    = params,
+        .m_id        = id,
+        .m_priority  = priority,
+        .m_cancelled = texture->m_load_cancelled,
     });
 
-    return handle; // IsLoaded() = false; becomes true after ReceiveMessagesImpl
+    TextureHandle handle = std::move(texture);
+
+    return handle; // IsLoaded() = false; becomes true after ProcessUploads
+}
+
+size_t OGLTextureManager::ReloadAsset(
+    std::string_view         key,
+    VirtualFileSystem const& fs,
+    InterfaceCollection&     ic) {
+
+    std::vector<LoadResourceSignal<Texture>> loads;
+    {
+        std::lock_guard lock(m_mtx);
+        for (auto const& [path, cached] : m_path_cache) {
+            auto texture = cached.m_texture.lock();
+            // A first load still in flight reads the new file anyway
+            if (!texture || !texture->IsLoaded() || fs.GetAssetKey(path) != key) {
+                continue;
+            }
+
+            auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+            m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{
+                .m_texture      = texture,
+                .b_reload       = true,
+                .m_reloadStream = cached.m_stream,
+            });
+            loads.push_back(LoadResourceSignal<Texture>{
+                .m_path      = path,
+                .m_params    = cached.m_params,
+                .m_id        = id,
+                .m_priority  = LoadPriority{ .m_urgency = LoadPriority::kUrgent },
+                .m_cancelled = texture->m_load_cancelled,
+            });
+        }
+    }
+
+    for (auto& load : loads) {
+        ic.SendSignal(std::move(load));
+    }
+    return loads.size();
 }
 
 TextureHandle OGLTextureManager::CreateTexture(Texture data) {
     auto tex = std::make_shared<OGLTexture>();
     tex->m_deletion_queue = m_deletion_queue;
-    auto err = UploadToGL(*tex, data);
-    if (err.IsError()) {
-        LOG(ERROR) << "OGLTextureManager::CreateTexture: GL upload failed: " << err;
+
+    // Queued like a finished load: the caller may not be on the GL thread
+    auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(m_mtx);
+        m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{ .m_texture = tex });
     }
-    return tex;
+    m_loaded_handler.Send(OnResourceLoadedEvent<Texture>{
+        .m_data = std::move(data),
+        .m_id   = id,
+    });
+    return tex; // IsLoaded() = false; becomes true after ProcessUploads
 }
 
-Error OGLTextureManager::ReceiveMessagesImpl(
-    MessageBus& /*bus*/, RecieveMessagesParams const& /*params*/) {
+Error OGLTextureManager::ProcessUploads() {
 
     // Drain GL deletions deferred from non-GL threads.
     m_deletion_queue->Drain();
@@ -174,31 +295,299 @@ Error OGLTextureManager::ReceiveMessagesImpl(
     Error err;
 
     m_loaded_handler.Handle([&](OnResourceLoadedEvent<Texture> msg) {
+        std::shared_ptr<OGLTexture> tex;
+        bool isStream = false;
+        bool isReload = false;
+        std::optional<OGLTextureStreamState> reloadStream;
+        std::filesystem::path path;
+        TextureLoadParams params;
+        {
+            std::lock_guard lock(m_mtx);
+            auto it = m_pending.find(msg.m_id);
+            if (it == m_pending.end()) {
+                return;
+            }
+            tex = it->second->m_texture.lock();
+            isStream = it->second->b_stream;
+            isReload = it->second->b_reload;
+            reloadStream = std::move(it->second->m_reloadStream);
+            path = std::move(it->second->m_path);
+            params = it->second->m_params;
+            m_pending.erase(it); // no longer pending
+        }
+        if (tex && isStream) {
+            tex->m_stream->b_loadInFlight = false;
+        }
+
         if (!msg.m_data) {
             err += msg.m_data.error();
             LOG(ERROR) << "OGLTextureManager: texture load failed: " << msg.m_data.error();
             return;
         }
+        if (!tex) {
+            return; // handle was released before load completed
+        }
 
-        auto id = msg.m_id;
-
-        std::shared_ptr<OGLTexture> tex;
-        {
-            std::lock_guard lock(m_mtx);
-            auto it = m_pending.find(id);
-            if (it == m_pending.end()) {
-                return; // handle was released before load completed
+        auto const& data = *msg.m_data;
+        if (isReload) {
+            err += ApplyReload(tex, data, reloadStream);
+            return;
+        }
+        if (isStream) {
+            // Levels are never dropped while a load is in flight, so these
+            // join up with the resident ones
+            if (data.GetFirstMip() + data.GetDesc().mipLevels != tex->m_stream->m_residentMip) {
+                return;
             }
-            tex = it->second->m_texture;
-            m_pending.erase(it); // no longer pending
+            err += UploadToGL(*tex, data);
+            tex->m_stream->m_residentMip = data.GetFirstMip();
+            return;
         }
 
-        err += UploadToGL(*tex, *msg.m_data);
+        if (auto uploadErr = UploadToGL(*tex, data); uploadErr.IsError()) {
+            err += uploadErr;
+            return;
+        }
+        m_residents.push_back(ResidentTexture{ .m_texture = tex, .m_path = std::move(path), .m_params = params });
+        if (tex->m_stream && data.GetFirstMip() > 0) {
+            tex->m_stream->m_residentMip = data.GetFirstMip();
+            tex->m_stream->m_tailMip     = data.GetFirstMip();
+            tex->m_stream->m_wantedMip   = data.GetFirstMip();
+            m_streamed.push_back(tex);
+        } else {
+            tex->m_stream.reset(); // Small enough to have loaded whole
+        }
     });
 
+    // Loads cancelled by releasing the texture never report back
+    {
+        std::lock_guard lock(m_mtx);
+        std::erase_if(m_pending, [](auto const& entry) {
+            return entry.second->m_texture.expired();
+        });
+    }
+
+    if (!m_streamed.empty()) {
+        UpdateStreaming();
+    }
+
     return err;
 }
 
+Error OGLTextureManager::ApplyReload(
+    std::shared_ptr<OGLTexture> const&          texture,
+    Texture const&                              data,
+    std::optional<OGLTextureStreamState> const& stream) {
+
+    // Uploaded beside the live texture and swapped in, so a failed upload
+    // leaves the old data; the old storage goes out with the staging texture
+    OGLTexture staging;
+    staging.m_deletion_queue = m_deletion_queue;
+    OKAMI_ERROR_RETURN(UploadToGL(staging, data));
+    std::swap(texture->m_texture, staging.m_texture);
+    texture->m_desc = staging.m_desc;
+    ++texture->m_version;
+
+    // Finer levels of the old file can't join up with the new ones
+    {
+        std::lock_guard lock(m_mtx);
+        std::erase_if(m_pending, [&texture](auto const& entry) {
+            return entry.second->b_stream && entry.second->m_texture.lock() == texture;
+        });
+    }
+
+    // Streaming restarts from the new tail. A texture that used to fit in
+    // its tail may not any more, and one that was only streaming since it
+    // was evicted is whole again.
+    if (texture->m_stream && !stream) {
+        texture->m_stream.reset();
+        std::erase_if(m_streamed, [&texture](auto const& weak) { return weak.lock() == texture; });
+    }
+    if (!texture->m_stream && stream && data.GetFirstMip() > 0) {
+        texture->m_stream = *stream;
+        m_streamed.push_back(texture);
+    }
+    if (texture->m_stream) {
+        auto& state = *texture->m_stream;
+        state.m_residentMip  = data.GetFirstMip();
+        state.m_tailMip      = data.GetFirstMip();
+        state.m_wantedMip    = data.GetFirstMip();
+        state.b_loadInFlight = false;
+    }
+    return {};
+}
+
+void OGLTextureManager::UpdateStreaming() {
+    ++m_frame;
+    std::erase_if(m_streamed, [](auto const& texture) { return texture.expired(); });
+
+    std::vector<std::shared_ptr<OGLTexture>> textures;
+    textures.reserve(m_streamed.size());
+    size_t residentBytes = 0;
+    for (auto const& weak : m_streamed) {
+        auto texture = weak.lock();
+        auto& stream = *texture->m_stream;
+        if (stream.m_requestedMip != OGLTextureStreamState::kNoRequest) {
+            stream.m_wantedMip     = std::min(stream.m_requestedMip, stream.m_tailMip);
+            stream.m_lastUsedFrame = m_frame;
+            stream.m_requestedMip  = OGLTextureStreamState::kNoRequest;
+        }
+        residentBytes += GetMipRangeSize(texture->m_desc, stream.m_residentMip, stream.m_tailMip);
+        textures.push_back(std::move(texture));
+    }
+
+    auto isUsed = [this](OGLTexture const& texture) {
+        return texture.m_stream->m_lastUsedFrame == m_frame;
+    };
+
+    // Over budget: textures not drawn this frame go back to their tail,
+    // least recently used first, then drawn ones lose levels finer than
+    // their draws need
+    if (m_streamBudget > 0 && residentBytes > m_streamBudget) {
+        std::sort(textures.begin(), textures.end(), [](auto const& a, auto const& b) {
+            return a->m_stream->m_lastUsedFrame < b->m_stream->m_lastUsedFrame;
+        });
+        for (bool used : { false, true }) {
+            for (auto const& texture : textures) {
+                if (residentBytes <= m_streamBudget) {
+                    break;
+                }
+                auto& stream = *texture->m_stream;
+                uint32_t target = used ? stream.m_wantedMip : stream.m_tailMip;
+                if (isUsed(*texture) != used || stream.b_loadInFlight || stream.m_residentMip >= target) {
+                    continue;
+                }
+                residentBytes -= GetMipRangeSize(texture->m_desc, stream.m_residentMip, target);
+                DropFinerMips(*texture, target);
+            }
+        }
+    }
+
+    // Stream in finer levels for drawn textures, those missing the most
+    // detail first, as long as they fit in the budget. They must also fit
+    // under the residency budget, or the residency manager would evict
+    // them again once idle; only evicted textures drawn again may go past
+    // it, as they would without streaming.
+    size_t plannedBytes = residentBytes;
+    size_t headroom     = m_residencyHeadroom;
+    for (auto const& texture : textures) {
+        auto const& stream = *texture->m_stream;
+        if (stream.b_loadInFlight) {
+            size_t bytes = GetMipRangeSize(texture->m_desc, stream.m_wantedMip, stream.m_residentMip);
+            plannedBytes += bytes;
+            headroom     -= std::min(headroom, bytes);
+        }
+    }
+    std::sort(textures.begin(), textures.end(), [](auto const& a, auto const& b) {
+        auto const& sa = *a->m_stream;
+        auto const& sb = *b->m_stream;
+        return sa.m_residentMip - std::min(sa.m_wantedMip, sa.m_residentMip) >
+               sb.m_residentMip - std::min(sb.m_wantedMip, sb.m_residentMip);
+    });
+    for (auto const& texture : textures) {
+        auto& stream = *texture->m_stream;
+        if (!isUsed(*texture) || stream.b_loadInFlight || stream.m_wantedMip >= stream.m_residentMip) {
+            continue;
+        }
+        size_t bytes = GetMipRangeSize(texture->m_desc, stream.m_wantedMip, stream.m_residentMip);
+        if (m_streamBudget > 0 && plannedBytes + bytes > m_streamBudget) {
+            continue;
+        }
+        if (!stream.b_evicted && bytes > headroom) {
+            continue;
+        }
+        plannedBytes += bytes;
+        headroom     -= std::min(headroom, bytes);
+
+        auto id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(m_mtx);
+            m_pending[id] = std::make_unique<PendingLoad>(PendingLoad{ .m_texture = texture, .b_stream = true });
+        }
+        stream.b_loadInFlight = true;
+        if (stream.b_evicted) {
+            stream.b_evicted = false;
+            ++m_restores;
+        }
+
+        auto params = stream.m_params;
+        params.m_firstMip = stream.m_wantedMip;
+        params.m_mipCount = stream.m_residentMip - stream.m_wantedMip;
+        m_interfaces->SendSignal(LoadResourceSignal<Texture>{
+            .m_path      = stream.m_path,
+            .m_params    = params,
+            .m_id        = id,
+            .m_priority  = LoadPriority{ .m_urgency = static_cast<float>(params.m_mipCount) },
+            .m_cancelled = texture->m_load_cancelled,
+        });
+    }
+}
+
+void OGLTextureManager::UpdateResidency(uint64_t frame, std::vector<ResidentResource>& out) {
+    std::erase_if(m_residents, [](auto const& resident) { return resident.m_texture.expired(); });
+
+    for (auto& resident : m_residents) {
+        auto texture = resident.m_texture.lock();
+        if (!texture) {
+            out.push_back(ResidentResource{ .m_kind = ResidencyKind::Texture });
+            continue; // released since, but keeps the indices in step
+        }
+        if (texture->b_used || resident.m_lastUsedFrame == 0) {
+            resident.m_lastUsedFrame = frame;
+            texture->b_used = false;
+        }
+
+        auto const& desc = texture->m_desc;
+        auto const* stream = texture->m_stream ? &*texture->m_stream : nullptr;
+        const uint32_t residentMip = stream ? stream->m_residentMip : 0;
+        ResidentResource entry{
+            .m_kind          = ResidencyKind::Texture,
+            .m_bytes         = GetMipRangeSize(desc, residentMip, desc.mipLevels),
+            .m_lastUsedFrame = resident.m_lastUsedFrame,
+        };
+        // Levels are never dropped while finer ones are loading
+        if (!resident.m_path.empty() && !(stream && stream->b_loadInFlight)) {
+            const uint32_t floor = stream ? stream->m_tailMip : GetCoarsestMip(desc);
+            entry.m_evictableBytes = GetMipRangeSize(desc, residentMip, std::max(residentMip, floor));
+        }
+        out.push_back(entry);
+    }
+}
+
+size_t OGLTextureManager::EvictResident(size_t index) {
+    auto const& resident = m_residents.at(index);
+    auto texture = resident.m_texture.lock();
+    if (!texture || resident.m_path.empty()) {
+        return 0;
+    }
+
+    // A texture loaded whole keeps only its coarsest level as a tail, so it
+    // stays complete for sampling and streams the rest back in on use
+    auto const& desc = texture->m_desc;
+    if (!texture->m_stream) {
+        texture->m_stream = OGLTextureStreamState{
+            .m_path      = resident.m_path,
+            .m_params    = resident.m_params,
+            .m_tailMip   = GetCoarsestMip(desc),
+            .m_wantedMip = GetCoarsestMip(desc),
+        };
+        m_streamed.push_back(texture);
+    }
+
+    auto& stream = *texture->m_stream;
+    if (stream.b_loadInFlight || stream.m_residentMip >= stream.m_tailMip) {
+        return 0;
+    }
+    const size_t bytes = GetMipRangeSize(desc, stream.m_residentMip, stream.m_tailMip);
+    DropFinerMips(*texture, stream.m_tailMip);
+    stream.m_wantedMip = stream.m_tailMip;
+    stream.b_evicted   = true;
+    return bytes;
+}
+
+uint64_t OGLTextureManager::TakeRestoreCount() {
+    return std::exchange(m_restores, 0);
+}
 
 // ---------------------------------------------------------------------------
 // FetchTextureFromGL (unchanged)
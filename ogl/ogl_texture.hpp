@@ -3,6 +3,7 @@
 #include "../common.hpp"
 #include "../texture.hpp"
 #include "../content.hpp"
+#include "../residency.hpp"
 
 #include "ogl_utils.hpp"
 
@@ -11,6 +12,25 @@ namespace okami {
     GLenum ToGlFormat(TextureFormat format);
     GLenum ToGlType(TextureFormat format);
 
+    // Mip streaming state of a texture whose file has levels larger than the
+    // streaming tail size, or of one the residency manager evicted, whose
+    // tail is then empty. Only touched on the GL thread once the texture has
+    // loaded.
+    struct OGLTextureStreamState {
+        static constexpr uint32_t kNoRequest = ~0u;
+
+        std::filesystem::path m_path;
+        TextureLoadParams     m_params;
+        uint32_t m_residentMip   = 0; // finest level uploaded
+        uint32_t m_tailMip       = 0; // levels from here on are never dropped
+        uint32_t m_wantedMip     = 0; // finest level asked for when last used
+        uint64_t m_lastUsedFrame = 0;
+        bool     b_loadInFlight  = false;
+        bool     b_evicted       = false; // by the residency manager, until streamed in again
+        // Finest level asked for by this frame's draws
+        mutable uint32_t m_requestedMip = kNoRequest;
+    };
+
     // Concrete OpenGL texture.  Heap-allocated and ref-counted via TextureHandle.
     // IsLoaded() is false until the async GPU upload completes.
     class OGLTexture final : public ITexture {
@@ -20,6 +40,15 @@ namespace okami {
         std::atomic<bool> m_loaded{false};
         // Set by OGLTextureManager at construction; may be null for unit tests.
         std::shared_ptr<OGLDeletionQueue> m_deletion_queue;
+        // Raised on destruction so a still-queued file load is skipped
+        LoadCancelFlag    m_load_cancelled;
+        // Set while only part of the mip chain is resident
+        std::optional<OGLTextureStreamState> m_stream;
+        // Raised by draws using the texture, for the residency manager
+        mutable bool      b_used = false;
+        // Moves on each time a reload swaps in new storage, so copies of
+        // the texels (the sprite atlas) know to refresh. GL thread only.
+        uint32_t          m_version = 0;
 
         OGLTexture() = default;
         OKAMI_NO_COPY(OGLTexture);
@@ -29,6 +58,24 @@ namespace okami {
         bool               IsLoaded() const override {
             return m_loaded.load(std::memory_order_acquire);
         }
+
+        // Usage feedback from draws: mip is the finest level the draw can
+        // resolve. GL thread only, once loaded.
+        void MarkUsed() const {
+            b_used = true;
+        }
+        void RequestMip(uint32_t mip) const {
+            MarkUsed();
+            if (m_stream) {
+                m_stream->m_requestedMip = std::min(m_stream->m_requestedMip, mip);
+            }
+        }
+        bool IsStreaming() const {
+            return m_stream.has_value();
+        }
+        bool IsFullyResident() const {
+            return IsLoaded() && (!m_stream || m_stream->m_residentMip == 0);
+        }
     };
 
     // The single OGL texture manager.
@@ -38,36 +85,105 @@ namespace okami {
     // the existing IO-thread signal machinery.
     class OGLTextureManager final :
         public EngineModule,
-        public ITextureManager {
+        public ITextureManager,
+        public IAssetReloader {
     private:
         // Tracks a single in-flight async load.
         struct PendingLoad {
-            std::shared_ptr<OGLTexture> m_texture; // pre-created handle
+            std::weak_ptr<OGLTexture> m_texture; // pre-created handle
+            bool b_stream = false; // finer mips for an already loaded texture
+            bool b_reload = false; // new data for an already loaded texture
+            // Streaming state for a reload that comes back larger than the tail
+            std::optional<OGLTextureStreamState> m_reloadStream;
+            // Where a first load came from, so it can be evicted
+            std::filesystem::path m_path;
+            TextureLoadParams     m_params;
+        };
+
+        // Every uploaded texture, for the residency manager
+        struct ResidentTexture {
+            std::weak_ptr<OGLTexture> m_texture;
+            // Empty for textures that can't be loaded again whole, such as
+            // created ones, which are never evicted
+            std::filesystem::path m_path;
+            TextureLoadParams     m_params;
+            uint64_t              m_lastUsedFrame = 0;
+        };
+
+        struct CachedTexture {
+            std::weak_ptr<OGLTexture> m_texture;
+            // As first sent, so a reload loads the same levels
+            TextureLoadParams m_params;
+            std::optional<OGLTextureStreamState> m_stream;
         };
 
         std::shared_ptr<OGLDeletionQueue> m_deletion_queue =
             std::make_shared<OGLDeletionQueue>();
 
         std::mutex m_mtx;
-        std::unordered_map<std::filesystem::path, std::weak_ptr<OGLTexture>, PathHash>
-            m_path_cache;  // for path dedup
+        std::unordered_map<std::filesystem::path, CachedTexture, PathHash>
+            m_path_cache;  // for path dedup and reloads
         std::unordered_map<uint32_t, std::unique_ptr<PendingLoad>>
             m_pending;     // in-flight loads
         std::atomic<uint32_t> m_next_id{1};
 
         DefaultSignalHandler<OnResourceLoadedEvent<Texture>> m_loaded_handler;
 
+        // Mip streaming; m_streamed is only touched on the GL thread
+        uint32_t              m_streamTailSize   = 0;
+        size_t                m_streamBudget     = 0; // bytes, 0 = unlimited
+        // Bytes left under the residency budget, set by OGLResidencyManager
+        size_t                m_residencyHeadroom = SIZE_MAX;
+        InterfaceCollection*  m_interfaces       = nullptr;
+        std::vector<std::weak_ptr<OGLTexture>> m_streamed;
+        uint64_t              m_frame            = 0;
+
+        // Residency; GL thread only
+        std::vector<ResidentTexture> m_residents;
+        uint64_t                     m_restores = 0;
+
         Error RegisterImpl(InterfaceCollection& ic) override;
-        Error ReceiveMessagesImpl(MessageBus& bus, RecieveMessagesParams const& params) override;
+        Error StartupImpl(InitContext const& context) override;
+
+        // Applies this frame's usage feedback: drops levels to stay within
+        // the budget, then requests finer levels where they are wanted
+        void UpdateStreaming();
+        // Swaps reloaded data into a live texture, keeping its handles
+        Error ApplyReload(std::shared_ptr<OGLTexture> const& texture, Texture const& data,
+            std::optional<OGLTextureStreamState> const& stream);
 
     public:
+        // Uploads finished loads and created textures, and deletes released
+        // ones. Called by the renderer once per frame on the GL thread.
+        Error ProcessUploads();
+
+        // Residency, GL thread only (see OGLResidencyManager). Appends every
+        // uploaded texture, with how much of it can be evicted.
+        void UpdateResidency(uint64_t frame, std::vector<ResidentResource>& out);
+        // Drops the texture to its streaming tail, or to its coarsest level
+        // if it was loaded whole; it streams back in when next drawn. Index
+        // as appended by the last UpdateResidency. Returns the bytes freed.
+        size_t EvictResident(size_t index);
+        // Evicted textures streamed in again since the last call
+        uint64_t TakeRestoreCount();
+        // Room left under the residency budget as of the last frame, which
+        // streaming won't request finer levels past. SIZE_MAX is unlimited.
+        void SetResidencyHeadroom(size_t bytes) { m_residencyHeadroom = bytes; }
+
         // ITextureManager
         TextureHandle LoadTexture(
             std::filesystem::path const& path,
             TextureLoadParams            params,
-            InterfaceCollection&         ic) override;
+            InterfaceCollection&         ic,
+            LoadPriority                 priority = {}) override;
         TextureHandle CreateTexture(Texture data) override;
 
+        // IAssetReloader
+        size_t ReloadAsset(
+            std::string_view         key,
+            VirtualFileSystem const& fs,
+            InterfaceCollection&     ic) override;
+
         // Convenience downcast – valid for any TextureHandle produced by this manager.
         static OGLTexture* GetOGLTexture(TextureHandle const& handle) {
             return static_cast<OGLTexture*>(handle.get());
@@ -0,0 +1,328 @@
+#include "ogl_tilemap.hpp"
+#include "ogl_texture.hpp"
+#include "../paths.hpp"
+
+#include <glog/logging.h>
+#include <glad/gl.h>
+#include <algorithm>
+#include <array>
+
+using namespace okami;
+
+namespace {
+    // Maps a quad corner (s right, t down, both in [0, 1]) to the corner of the
+    // tile image it samples. TMX applies the diagonal flip before the
+    // horizontal and vertical flips, so the inverse runs in reverse order.
+    glm::vec2 FlipCorner(glm::vec2 corner, uint32_t tile) {
+        if (tile & kTileFlipHorizontal) {
+            corner.x = 1.0f - corner.x;
+        }
+        if (tile & kTileFlipVertical) {
+            corner.y = 1.0f - corner.y;
+        }
+        if (tile & kTileFlipDiagonal) {
+            std::swap(corner.x, corner.y);
+        }
+        return corner;
+    }
+
+    // True if every corner lies outside the same clip plane.
+    bool IsOutsideClip(std::array<glm::vec4, 4> const& corners) {
+        for (int axis = 0; axis < 3; ++axis) {
+            bool allBelow = true;
+            bool allAbove = true;
+            for (auto const& c : corners) {
+                allBelow &= c[axis] < -c.w;
+                allAbove &= c[axis] > c.w;
+            }
+            if (allBelow || allAbove) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+Error OGLTileMapRenderer::RegisterImpl(InterfaceCollection& interfaces) {
+    return {};
+}
+
+Error OGLTileMapRenderer::StartupImpl(InitContext const& context) {
+    auto* cache = context.m_interfaces.Query<IGLShaderCache>();
+    OKAMI_ERROR_RETURN_IF(!cache, "IGLShaderCache interface not available for OGLTileMapRenderer");
+
+    m_sceneGlobalsProvider = context.m_interfaces.Query<IOGLSceneGlobalsProvider>();
+    OKAMI_ERROR_RETURN_IF(!m_sceneGlobalsProvider, "IOGLSceneGlobalsProvider interface not available for OGLTileMapRenderer");
+
+    cache->DeferProgram(ProgramShaderPaths{
+        .m_vertex = GetGLSLShaderPath("tilemap.vs"),
+        .m_fragment = GetGLSLShaderPath("tilemap.fs"),
+    }, [this](GLProgram&& program) -> Error {
+        m_program = std::move(program);
+
+        Error err;
+        glUseProgram(m_program.get());
+        err += GET_GL_ERROR();
+        err += AssignBufferBindingPoint(m_program, "SceneGlobalsBlock", BufferBindingPoints::SceneGlobals);
+        err += AssignTextureBindingPoint(m_program, "u_texture", TextureBindingPoints::TileSet);
+        m_modelLocation = GetUniformLocation(m_program, "u_model", err);
+        m_opacityLocation = GetUniformLocation(m_program, "u_opacity", err);
+        return err;
+    });
+
+    LOG(INFO) << "OGL Tile Map Renderer initialized successfully";
+    return {};
+}
+
+void OGLTileMapRenderer::ShutdownImpl(InitContext const& context) {
+    m_cache.clear();
+}
+
+Error OGLTileMapRenderer::BuildChunk(
+    ChunkCache& chunk,
+    TileMapDesc const& map,
+    TileLayerData const& layer,
+    glm::uvec2 chunkCoord) {
+    m_buildScratch.resize(map.m_tileSets.size());
+    for (auto& bucket : m_buildScratch) {
+        bucket.clear();
+    }
+
+    const glm::uvec2 begin = chunkCoord * TileLayerData::kChunkSize;
+    const glm::uvec2 end = glm::min(begin + glm::uvec2(TileLayerData::kChunkSize), layer.m_size);
+    const glm::vec2 cell = glm::vec2(map.m_tileSize);
+
+    for (uint32_t y = begin.y; y < end.y; ++y) {
+        for (uint32_t x = begin.x; x < end.x; ++x) {
+            const uint32_t tile = layer.GetTile(x, y);
+            const uint32_t gid = tile & kTileGidMask;
+            if (gid == 0) {
+                continue;
+            }
+            const int tileSetIndex = map.FindTileSet(gid);
+            if (tileSetIndex < 0) {
+                continue;
+            }
+            auto const& ts = map.m_tileSets[tileSetIndex];
+            if (ts.m_imageSize.x == 0 || ts.m_imageSize.y == 0) {
+                continue;
+            }
+
+            // Tiles taller or wider than the grid are anchored to the
+            // bottom-left of their cell, as in Tiled.
+            const glm::vec2 size = glm::vec2(ts.m_tileSize);
+            const glm::vec2 gridPos = glm::vec2(glm::ivec2(x, y) + layer.m_origin);
+            const float left = gridPos.x * cell.x + layer.m_offset.x;
+            const float bottom = -((gridPos.y + 1.0f) * cell.y + layer.m_offset.y);
+
+            const uint32_t localId = gid - ts.m_firstGid;
+            const glm::vec2 texel = glm::vec2(
+                ts.m_margin + (localId % ts.m_columns) * (ts.m_tileSize.x + ts.m_spacing),
+                ts.m_margin + (localId / ts.m_columns) * (ts.m_tileSize.y + ts.m_spacing));
+            const glm::vec2 invImage = 1.0f / glm::vec2(ts.m_imageSize);
+
+            auto vertex = [&](glm::vec2 corner) {
+                const glm::vec2 uv = FlipCorner(corner, tile);
+                return glsl::TileVertex{
+                    .a_position = glm::vec2(left + corner.x * size.x, bottom + (1.0f - corner.y) * size.y),
+                    .a_uv = (texel + uv * size) * invImage,
+                };
+            };
+
+            const auto topLeft = vertex({0.0f, 0.0f});
+            const auto topRight = vertex({1.0f, 0.0f});
+            const auto bottomLeft = vertex({0.0f, 1.0f});
+            const auto bottomRight = vertex({1.0f, 1.0f});
+
+            auto& bucket = m_buildScratch[tileSetIndex];
+            bucket.insert(bucket.end(), {
+                bottomLeft, bottomRight, topRight,
+                bottomLeft, topRight, topLeft,
+            });
+        }
+    }
+
+    m_uploadScratch.clear();
+    chunk.m_ranges.clear();
+    for (uint32_t i = 0; i < m_buildScratch.size(); ++i) {
+        auto const& bucket = m_buildScratch[i];
+        if (bucket.empty()) {
+            continue;
+        }
+        chunk.m_ranges.push_back(DrawRange{
+            .m_tileSet = i,
+            .m_first = static_cast<GLint>(m_uploadScratch.size()),
+            .m_count = static_cast<GLsizei>(bucket.size()),
+        });
+        m_uploadScratch.insert(m_uploadScratch.end(), bucket.begin(), bucket.end());
+    }
+
+    chunk.b_built = true;
+    chunk.m_revision = layer.GetChunkRevision(chunkCoord.x, chunkCoord.y);
+
+    if (m_uploadScratch.empty()) {
+        return {};
+    }
+
+    if (!chunk.m_vertexBuffer) {
+        glGenBuffers(1, chunk.m_vertexBuffer.ptr());
+        glGenVertexArrays(1, chunk.m_vertexArray.ptr());
+        OKAMI_ERROR_RETURN_IF(!chunk.m_vertexBuffer || !chunk.m_vertexArray,
+            "Failed to create tile map chunk buffers");
+        SetupVertexArray(chunk.m_vertexArray, glsl::__get_vs_input_infoTileVertex(),
+            chunk.m_vertexBuffer.get(), std::nullopt);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.m_vertexBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER,
+        static_cast<GLsizeiptr>(m_uploadScratch.size() * sizeof(glsl::TileVertex)),
+        m_uploadScratch.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return GET_GL_ERROR();
+}
+
+Error OGLTileMapRenderer::Pass(entt::registry const& registry, OGLPass const& pass) {
+    if (pass.m_type != OGLPassType::Forward) {
+        return {};
+    }
+
+    Error err;
+    ++m_passIndex;
+
+    const glm::mat4 viewProj = m_sceneGlobalsProvider->GetCurrentSceneGlobals().u_camera.u_viewProj;
+    bool stateBound = false;
+
+    registry.view<TileMapComponent, Transform>().each([&](entity_t entity, TileMapComponent const& component, Transform const& transform) {
+        if (!component.m_map) {
+            return;
+        }
+        auto const& map = *component.m_map;
+
+        // Compared by owner, never locked: the map may already be gone
+        // from the simulation, and a copy made by EditMap() keeps the
+        // chunks of the map it was copied from.
+        auto const sameMap = [](auto const& a, auto const& b) {
+            return !a.owner_before(b) && !b.owner_before(a);
+        };
+        auto& cache = m_cache[entity];
+        if (!sameMap(cache.m_map, component.m_map)) {
+            if (!sameMap(cache.m_map, component.m_editedFrom)) {
+                cache = MapCache{};
+            }
+            cache.m_map = component.m_map;
+        }
+        cache.m_lastPass = m_passIndex;
+        cache.m_layers.resize(map.m_layers.size());
+
+        // Tiles from tilesets with a larger tile size overhang their cell.
+        glm::vec2 overhang(0.0f);
+        for (auto const& ts : map.m_tileSets) {
+            overhang = glm::max(overhang, glm::vec2(ts.m_tileSize) - glm::vec2(map.m_tileSize));
+        }
+
+        const glm::mat4 model = transform.AsMatrix();
+        const glm::mat4 modelViewProj = viewProj * model;
+        const glm::vec2 cell = glm::vec2(map.m_tileSize);
+
+        for (size_t layerIndex = 0; layerIndex < map.m_layers.size(); ++layerIndex) {
+            auto const& layer = map.m_layers[layerIndex];
+            if (!layer.b_visible || layer.m_opacity <= 0.0f) {
+                continue;
+            }
+
+            auto& layerCache = cache.m_layers[layerIndex];
+            const glm::uvec2 chunkCount = layer.GetChunkCount();
+            layerCache.m_chunks.resize(static_cast<size_t>(chunkCount.x) * chunkCount.y);
+
+            bool layerBound = false;
+            for (uint32_t cy = 0; cy < chunkCount.y; ++cy) {
+                for (uint32_t cx = 0; cx < chunkCount.x; ++cx) {
+                    // Chunk bounds in map-local space (y up).
+                    const glm::uvec2 begin = glm::uvec2(cx, cy) * TileLayerData::kChunkSize;
+                    const glm::uvec2 end = glm::min(begin + glm::uvec2(TileLayerData::kChunkSize), layer.m_size);
+                    const glm::vec2 lo = glm::vec2(glm::ivec2(begin) + layer.m_origin) * cell + layer.m_offset;
+                    const glm::vec2 hi = glm::vec2(glm::ivec2(end) + layer.m_origin) * cell + layer.m_offset;
+                    const float left = lo.x;
+                    const float right = hi.x + overhang.x;
+                    const float top = -(lo.y - overhang.y);
+                    const float bottom = -hi.y;
+
+                    const std::array<glm::vec4, 4> corners = {
+                        modelViewProj * glm::vec4(left, bottom, 0.0f, 1.0f),
+                        modelViewProj * glm::vec4(right, bottom, 0.0f, 1.0f),
+                        modelViewProj * glm::vec4(left, top, 0.0f, 1.0f),
+                        modelViewProj * glm::vec4(right, top, 0.0f, 1.0f),
+                    };
+                    if (IsOutsideClip(corners)) {
+                        continue;
+                    }
+
+                    auto& chunk = layerCache.m_chunks[cy * chunkCount.x + cx];
+                    if (!chunk.b_built || chunk.m_revision != layer.GetChunkRevision(cx, cy)) {
+                        err += BuildChunk(chunk, map, layer, glm::uvec2(cx, cy));
+                    }
+                    if (chunk.m_ranges.empty()) {
+                        continue;
+                    }
+
+                    if (!stateBound) {
+                        glUseProgram(m_program.get());
+                        err += m_sceneGlobalsProvider->GetSceneGlobalsBuffer().Bind(BufferBindingPoints::SceneGlobals);
+
+                        // Layers share a depth, so depth writes would reject
+                        // every layer above the first.
+                        glDisable(GL_CULL_FACE);
+                        glEnable(GL_DEPTH_TEST);
+                        glDepthMask(GL_FALSE);
+                        glEnable(GL_BLEND);
+                        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(TextureBindingPoints::TileSet));
+                        err += GET_GL_ERROR();
+                        stateBound = true;
+                    }
+                    if (!layerBound) {
+                        glUniformMatrix4fv(m_modelLocation, 1, GL_FALSE, &model[0][0]);
+                        glUniform1f(m_opacityLocation, layer.m_opacity);
+                        layerBound = true;
+                    }
+
+                    glBindVertexArray(chunk.m_vertexArray.get());
+                    for (auto const& range : chunk.m_ranges) {
+                        if (range.m_tileSet >= component.m_tileSetTextures.size()) {
+                            continue;
+                        }
+                        auto const& texture = component.m_tileSetTextures[range.m_tileSet];
+                        if (!texture || !texture->IsLoaded()) {
+                            continue;
+                        }
+                        auto const* oglTexture = static_cast<OGLTexture const*>(texture.get());
+                        oglTexture->RequestMip(0); // tiles are drawn at texel scale
+                        glBindTexture(GL_TEXTURE_2D, oglTexture->m_texture.get());
+                        glDrawArrays(GL_TRIANGLES, range.m_first, range.m_count);
+                        ++m_stats.m_drawCalls;
+                        ++m_stats.m_instances;
+                    }
+                    err += GET_GL_ERROR();
+                }
+            }
+        }
+    });
+
+    if (stateBound) {
+        glBindVertexArray(0);
+        glDepthMask(GL_TRUE);
+    }
+
+    // Drop GL resources for maps that are no longer in the scene.
+    std::erase_if(m_cache, [&](auto const& entry) {
+        return entry.second.m_lastPass != m_passIndex;
+    });
+
+    return err;
+}
+
+std::string OGLTileMapRenderer::GetName() const {
+    return "OpenGL Tile Map Renderer";
+}
+
+OGLTileMapRenderer::OGLTileMapRenderer() {}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../renderer.hpp"
+#include "../tilemap.hpp"
+
+#include "ogl_utils.hpp"
+
+#include "shaders/tilemap.glsl"
+
+#include <unordered_map>
+
+namespace okami {
+    // Draws TileMapComponents. Each layer is split into TileLayerData::kChunkSize²
+    // chunks; a chunk's vertex buffer is built the first time it is visible and
+    // rebuilt only when its revision changes. Chunks outside the view are culled
+    // on the CPU, and each visible chunk issues one draw per tileset it uses.
+    class OGLTileMapRenderer final :
+        public EngineModule,
+        public IOGLRenderModule {
+    protected:
+        GLProgram m_program;
+        GLint m_modelLocation = -1;
+        GLint m_opacityLocation = -1;
+
+        enum class BufferBindingPoints : GLint {
+            SceneGlobals,
+            Count
+        };
+
+        enum class TextureBindingPoints : GLint {
+            TileSet,
+            Count,
+        };
+
+        // Contiguous vertices in a chunk buffer that sample the same tileset.
+        struct DrawRange {
+            uint32_t m_tileSet = 0;
+            GLint    m_first = 0;
+            GLsizei  m_count = 0;
+        };
+
+        struct ChunkCache {
+            GLBuffer      m_vertexBuffer;
+            GLVertexArray m_vertexArray;
+            uint32_t      m_revision = ~0u;
+            bool          b_built = false;
+            std::vector<DrawRange> m_ranges;
+        };
+
+        struct LayerCache {
+            std::vector<ChunkCache> m_chunks; // row-major over the layer's chunks
+        };
+
+        struct MapCache {
+            std::weak_ptr<TileMapDesc const> m_map;
+            std::vector<LayerCache>    m_layers;
+            uint64_t                   m_lastPass = 0;
+        };
+
+        std::unordered_map<entity_t, MapCache> m_cache;
+        uint64_t m_passIndex = 0;
+
+        // Scratch storage reused across chunk rebuilds: one bucket per tileset,
+        // concatenated into m_uploadScratch before upload.
+        std::vector<std::vector<glsl::TileVertex>> m_buildScratch;
+        std::vector<glsl::TileVertex>              m_uploadScratch;
+
+        OGLDrawStats m_stats;
+
+        IOGLSceneGlobalsProvider* m_sceneGlobalsProvider = nullptr;
+
+        Error RegisterImpl(InterfaceCollection& interfaces) override;
+        Error StartupImpl(InitContext const& context) override;
+        void ShutdownImpl(InitContext const& context) override;
+
+        Error BuildChunk(
+            ChunkCache& chunk,
+            TileMapDesc const& map,
+            TileLayerData const& layer,
+            glm::uvec2 chunkCoord);
+
+    public:
+        OGLTileMapRenderer();
+
+        Error Pass(entt::registry const& registry, OGLPass const& pass) override;
+
+        OGLDrawStats const& GetDrawStats() const { return m_stats; }
+        void ResetDrawStats() { m_stats = {}; }
+
+        std::string GetName() const override;
+    };
+}
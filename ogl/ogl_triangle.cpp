@@ -13,18 +13,21 @@ Error OGLTriangleRenderer::StartupImpl(InitContext const& context) {
     m_sceneGlobalsProvider = context.m_interfaces.Query<IOGLSceneGlobalsProvider>();
     OKAMI_ERROR_RETURN_IF(!m_sceneGlobalsProvider, "IOGLSceneGlobalsProvider interface not available for OGLTriangleRenderer");
 
-    auto program = CreateProgram(ProgramShaderPaths{
+    cache->DeferProgram(ProgramShaderPaths{
         .m_vertex = GetGLSLShaderPath("triangle.vs"),
         .m_fragment = GetGLSLShaderPath("triangle.fs")
-    }, *cache);
-    OKAMI_ERROR_RETURN(program);
+    }, [this](GLProgram&& program) -> Error {
+        m_program = std::move(program);
 
-    m_program = std::move(*program);
+        Error err;
+        glUseProgram(m_program.get());
+        err += GET_GL_ERROR();
+        err += AssignBufferBindingPoint(m_program, "SceneGlobalsBlock", BufferBindingPoints::SceneGlobals);
+        u_world = GetUniformLocation(m_program, "u_world", err);
+        return err;
+    });
 
     Error err;
-    glUseProgram(m_program.get());
-    err += GET_GL_ERROR();
-    err += AssignBufferBindingPoint(m_program, "SceneGlobalsBlock", BufferBindingPoints::SceneGlobals);
 
     // Create and setup VAO (required for modern OpenGL)
     GLuint vaoId;
@@ -35,8 +38,6 @@ Error OGLTriangleRenderer::StartupImpl(InitContext const& context) {
     glBindVertexArray(m_vao.get());
     glBindVertexArray(0); // Unbind
 
-    u_world = GetUniformLocation(m_program, "u_world", err);
-
     m_pipelineState = OGLPipelineState{
         .depthTestEnabled = true,
     };
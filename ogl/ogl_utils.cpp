@@ -1,38 +1,364 @@
 #include "ogl_utils.hpp"
+#include "ogl_program_cache.hpp"
 #include "../paths.hpp"
 
 #include <glog/logging.h>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 
 using namespace okami;
 
+namespace {
+#ifndef GL_COMPLETION_STATUS_KHR
+    constexpr GLenum GL_COMPLETION_STATUS_KHR = 0x91B1;
+#endif
+    typedef void (GLAD_API_PTR *PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+    bool g_parallelShaderCompile = false;
+
+    double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    std::string GetShaderLog(GLuint shader) {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::string log;
+        if (logLength > 0) {
+            log.resize(logLength);
+            glGetShaderInfoLog(shader, logLength, nullptr, &log[0]);
+        }
+        return log;
+    }
+}
+
 class GLShaderCache : public IGLShaderCache {
 private:
+    std::unordered_map<std::filesystem::path, std::string, PathHash> m_sourceCache;
     std::unordered_map<std::filesystem::path, std::unique_ptr<GLShader>, PathHash> m_shaderCache;
+    std::optional<OGLProgramBinaryCache> m_binaryCache;
+    ProgramCacheStats m_stats;
+
+    struct DeferredProgram {
+        GLPendingProgram     m_program;
+        ProgramReadyCallback m_onReady;
+    };
+    std::vector<DeferredProgram> m_deferred;
+
+    struct WatchedProgram {
+        ProgramShaderPaths              m_paths;
+        ProgramReadyCallback            m_onReload;
+        bool                            b_stale = false;
+        std::optional<GLPendingProgram> m_reload; // submitted, not linked yet
+    };
+    std::vector<WatchedProgram> m_watched;
+
+    static bool UsesShader(ProgramShaderPaths const& paths, std::filesystem::path const& path) {
+        auto matches = [&path](std::optional<std::filesystem::path> const& stage) {
+            return stage && stage->lexically_normal() == path;
+        };
+        return paths.m_vertex.lexically_normal() == path ||
+            matches(paths.m_fragment) || matches(paths.m_geometry) ||
+            matches(paths.m_tessControl) || matches(paths.m_tessEval);
+    }
 
-public:
-    Expected<GLShader*> LoadShader(GLenum shaderType, const std::filesystem::path& path) override {
+    Expected<std::string const*> LoadSource(const std::filesystem::path& path) {
+        auto it = m_sourceCache.find(path);
+        if (it == m_sourceCache.end()) {
+            auto source = LoadShaderSource(path);
+            OKAMI_UNEXPECTED_RETURN(source);
+            it = m_sourceCache.emplace(path, std::move(*source)).first;
+        }
+        return &it->second;
+    }
+
+    // Compiles without querying the status; failures surface in the link log.
+    Expected<GLShader*> SubmitShader(GLenum shaderType, const std::filesystem::path& path) {
         auto it = m_shaderCache.find(path);
         if (it != m_shaderCache.end()) {
             return it->second.get();
-        } else {
-            auto shaderResult = okami::LoadShader(shaderType, path);
-            if (!shaderResult) {
-                return std::unexpected(shaderResult.error());
-            } else {
-                auto newIt = m_shaderCache.emplace_hint(it, path, std::make_unique<GLShader>(std::move(*shaderResult)));
-                return newIt->second.get();
+        }
+
+        auto source = LoadSource(path);
+        OKAMI_UNEXPECTED_RETURN(source);
+
+        GLShader shader(glCreateShader(shaderType));
+        OKAMI_UNEXPECTED_RETURN_IF(!shader, "Failed to create shader object");
+        const char* sourcePtr = (*source)->c_str();
+        glShaderSource(shader.get(), 1, &sourcePtr, nullptr);
+        glCompileShader(shader.get());
+
+        auto newIt = m_shaderCache.emplace_hint(it, path, std::make_unique<GLShader>(std::move(shader)));
+        return newIt->second.get();
+    }
+
+    GLPendingProgram SubmitFromSource(ProgramShaderPaths const& shaderPaths, std::optional<uint64_t> key, std::filesystem::path const& entry) {
+        std::pair<GLenum, std::optional<std::filesystem::path> const*> stages[] = {
+            { GL_FRAGMENT_SHADER, &shaderPaths.m_fragment },
+            { GL_GEOMETRY_SHADER, &shaderPaths.m_geometry },
+            { GL_TESS_CONTROL_SHADER, &shaderPaths.m_tessControl },
+            { GL_TESS_EVALUATION_SHADER, &shaderPaths.m_tessEval },
+        };
+
+        std::vector<GLuint> shaders;
+        auto vertex = SubmitShader(GL_VERTEX_SHADER, shaderPaths.m_vertex);
+        if (!vertex) {
+            return GLPendingProgram(vertex.error());
+        }
+        shaders.push_back((*vertex)->get());
+
+        for (auto const& [type, path] : stages) {
+            if (!*path) {
+                continue;
+            }
+            auto shader = SubmitShader(type, **path);
+            if (!shader) {
+                return GLPendingProgram(shader.error());
+            }
+            shaders.push_back((*shader)->get());
+        }
+
+        GLProgram program(glCreateProgram());
+        if (!program) {
+            return GLPendingProgram(OKAMI_ERROR("Failed to create program object"));
+        }
+        if (m_binaryCache) {
+            glProgramParameteri(program.get(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        for (auto shader : shaders) {
+            glAttachShader(program.get(), shader);
+        }
+        glLinkProgram(program.get());
+
+        auto onResolved = [this, key, entry, name = shaderPaths.m_vertex](GLProgram const& linked, double milliseconds) {
+            ++m_stats.m_compiled;
+            m_stats.m_milliseconds += milliseconds;
+            if (key) {
+                auto err = m_binaryCache->Store(entry, *key, linked);
+                if (err.IsError()) {
+                    LOG(WARNING) << "Failed to store program binary for " << name << ": " << err;
+                }
+            }
+        };
+        return GLPendingProgram(std::move(program), std::move(shaders),
+            shaderPaths.m_vertex.string(), std::move(onResolved));
+    }
+
+public:
+    Expected<GLShader*> LoadShader(GLenum shaderType, const std::filesystem::path& path) override {
+        auto shader = SubmitShader(shaderType, path);
+        OKAMI_UNEXPECTED_RETURN(shader);
+
+        GLint compileStatus = GL_FALSE;
+        glGetShaderiv((*shader)->get(), GL_COMPILE_STATUS, &compileStatus);
+        OKAMI_UNEXPECTED_RETURN_IF(compileStatus == GL_FALSE,
+            "Shader compilation failed for " + path.string() + ": " + GetShaderLog((*shader)->get()));
+        return shader;
+    }
+
+    GLPendingProgram SubmitProgram(ProgramShaderPaths const& shaderPaths) override {
+        auto start = std::chrono::high_resolution_clock::now();
+        OKAMI_DEFER(m_stats.m_milliseconds += MillisecondsSince(start));
+
+        std::optional<uint64_t> key;
+        std::filesystem::path entry;
+        if (m_binaryCache) {
+            std::vector<ProgramStageSource> stages;
+            auto addStage = [&](GLenum type, std::filesystem::path const& path) -> Error {
+                auto source = LoadSource(path);
+                OKAMI_ERROR_RETURN(source);
+                stages.push_back(ProgramStageSource{ .m_type = type, .m_source = **source });
+                return {};
+            };
+
+            Error err = addStage(GL_VERTEX_SHADER, shaderPaths.m_vertex);
+            if (shaderPaths.m_fragment) {
+                err += addStage(GL_FRAGMENT_SHADER, *shaderPaths.m_fragment);
+            }
+            if (shaderPaths.m_geometry) {
+                err += addStage(GL_GEOMETRY_SHADER, *shaderPaths.m_geometry);
+            }
+            if (shaderPaths.m_tessControl) {
+                err += addStage(GL_TESS_CONTROL_SHADER, *shaderPaths.m_tessControl);
+            }
+            if (shaderPaths.m_tessEval) {
+                err += addStage(GL_TESS_EVALUATION_SHADER, *shaderPaths.m_tessEval);
+            }
+            if (err.IsError()) {
+                return GLPendingProgram(std::move(err));
+            }
+
+            key = m_binaryCache->ComputeKey(stages);
+            entry = m_binaryCache->GetEntryPath(shaderPaths);
+            if (auto program = m_binaryCache->Load(entry, *key)) {
+                ++m_stats.m_binaryHits;
+                return GLPendingProgram(std::move(*program), {}, shaderPaths.m_vertex.string());
+            }
+        }
+
+        return SubmitFromSource(shaderPaths, key, entry);
+    }
+
+    void Defer(GLPendingProgram program, ProgramReadyCallback onReady) override {
+        m_deferred.push_back(DeferredProgram{
+            .m_program = std::move(program),
+            .m_onReady = std::move(onReady),
+        });
+    }
+
+    Error ResolvePending() override {
+        Error err;
+        auto deferred = std::move(m_deferred);
+        m_deferred.clear();
+        for (auto& item : deferred) {
+            auto program = item.m_program.Resolve();
+            if (!program) {
+                LOG(ERROR) << "Failed to create program: " << program.error();
+                err += program.error();
+                continue;
             }
+            err += item.m_onReady(std::move(*program));
         }
+        return err;
+    }
+
+    void WatchProgram(ProgramShaderPaths const& paths, ProgramReadyCallback onReload) override {
+        m_watched.push_back(WatchedProgram{
+            .m_paths    = paths,
+            .m_onReload = std::move(onReload),
+        });
+    }
+
+    size_t ReloadShader(std::filesystem::path const& path) override {
+        auto changed = path.lexically_normal();
+        auto isChanged = [&changed](auto const& entry) {
+            return entry.first.lexically_normal() == changed;
+        };
+        // Shaders still attached to an in-flight reload are only flagged for
+        // deletion by GL, so dropping them here is safe
+        std::erase_if(m_sourceCache, isChanged);
+        std::erase_if(m_shaderCache, isChanged);
+
+        size_t count = 0;
+        for (auto& program : m_watched) {
+            if (UsesShader(program.m_paths, changed)) {
+                program.b_stale = true;
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    Error ProcessReloads() override {
+        Error err;
+        for (auto& program : m_watched) {
+            // Stages that did not change come from the shader cache, so only
+            // the changed files compile again. A program changed again while
+            // its reload was in flight starts over.
+            if (program.b_stale) {
+                program.b_stale = false;
+                program.m_reload = SubmitProgram(program.m_paths);
+            }
+            if (!program.m_reload || !program.m_reload->IsReady()) {
+                continue;
+            }
+
+            auto linked = program.m_reload->Resolve();
+            program.m_reload.reset();
+            if (!linked) {
+                err += linked.error();
+                continue;
+            }
+            err += program.m_onReload(std::move(*linked));
+        }
+        return err;
+    }
+
+    Error EnableProgramBinaryCache(std::filesystem::path const& directory) override {
+        auto cache = OGLProgramBinaryCache::Create(directory);
+        OKAMI_ERROR_RETURN(cache);
+        m_binaryCache = std::move(*cache);
+        LOG(INFO) << "Program binary cache enabled at " << directory;
+        return {};
+    }
+
+    ProgramCacheStats GetProgramStats() const override {
+        return m_stats;
     }
 };
 
+GLPendingProgram::GLPendingProgram(
+    GLProgram program,
+    std::vector<GLuint> shaders,
+    std::string name,
+    ResolvedCallback onResolved) :
+    m_program(std::move(program)),
+    m_shaders(std::move(shaders)),
+    m_name(std::move(name)),
+    m_onResolved(std::move(onResolved)) {
+}
+
+bool GLPendingProgram::IsReady() const {
+    if (!g_parallelShaderCompile || !m_program) {
+        return true;
+    }
+    GLint complete = GL_TRUE;
+    glGetProgramiv(m_program.get(), GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+Expected<GLProgram> GLPendingProgram::Resolve() {
+    if (m_error.IsError()) {
+        return std::unexpected(std::move(m_error));
+    }
+    OKAMI_UNEXPECTED_RETURN_IF(!m_program, "Program was already resolved: " + m_name);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(m_program.get(), GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        // Compile errors are only reported by the shaders themselves.
+        std::string errorLog;
+        for (auto shader : m_shaders) {
+            GLint compileStatus = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+            if (compileStatus == GL_FALSE) {
+                errorLog += GetShaderLog(shader);
+            }
+        }
+
+        GLint logLength = 0;
+        glGetProgramiv(m_program.get(), GL_INFO_LOG_LENGTH, &logLength);
+        if (logLength > 0) {
+            std::string programLog(logLength, '\0');
+            glGetProgramInfoLog(m_program.get(), logLength, nullptr, &programLog[0]);
+            errorLog += programLog;
+        }
+
+        m_program.reset();
+        return OKAMI_UNEXPECTED("Program linking failed for " + m_name + ": " + errorLog);
+    }
+
+    for (auto shader : m_shaders) {
+        glDetachShader(m_program.get(), shader);
+    }
+    m_shaders.clear();
+
+    if (m_onResolved) {
+        m_onResolved(m_program, MillisecondsSince(start));
+    }
+    LOG(INFO) << "Successfully created and linked shader program " << m_name;
+    return std::move(m_program);
+}
+
 std::unique_ptr<IGLShaderCache> okami::CreateGLShaderCache() {
     return std::make_unique<GLShaderCache>();
 }
 
-Expected<GLShader> okami::LoadShader(GLenum shaderType, const std::filesystem::path& shaderPath) {
+Expected<std::string> okami::LoadShaderSource(const std::filesystem::path& shaderPath) {
     // Resolve shader path - check if it's absolute or relative to GLSL shaders directory
     std::filesystem::path fullShaderPath;
     if (shaderPath.is_absolute()) {
@@ -54,7 +380,10 @@ Expected<GLShader> okami::LoadShader(GLenum shaderType, const std::filesystem::p
     file.close();
     
     OKAMI_UNEXPECTED_RETURN_IF(shaderSource.empty(), "Shader file is empty: " + fullShaderPath.string());
+    return shaderSource;
+}
 
+Expected<GLShader> okami::CompileShader(GLenum shaderType, std::string const& shaderSource, std::string_view name) {
     // Create shader object
     GLuint shaderId = glCreateShader(shaderType);
     OKAMI_UNEXPECTED_RETURN_IF(shaderId == 0, "Failed to create shader object");    
@@ -80,13 +409,19 @@ Expected<GLShader> okami::LoadShader(GLenum shaderType, const std::filesystem::p
         }
         
         glDeleteShader(shaderId);
-        return OKAMI_UNEXPECTED("Shader compilation failed for " + fullShaderPath.string() + ": " + errorLog);
+        return OKAMI_UNEXPECTED("Shader compilation failed for " + std::string(name) + ": " + errorLog);
     }
     
-    LOG(INFO) << "Successfully compiled shader: " << fullShaderPath.string();
+    LOG(INFO) << "Successfully compiled shader: " << name;
     return GLShader(shaderId);
 }
 
+Expected<GLShader> okami::LoadShader(GLenum shaderType, const std::filesystem::path& shaderPath) {
+    auto source = LoadShaderSource(shaderPath);
+    OKAMI_UNEXPECTED_RETURN(source);
+    return CompileShader(shaderType, *source, shaderPath.string());
+}
+
 Expected<GLProgram> okami::CreateProgram(ProgramShaders const& shaders) {
     // Create program object
     GLuint programId = glCreateProgram();
@@ -196,64 +531,8 @@ Expected<GLProgram> okami::CreateProgram(ProgramShaderPaths const& shaderPaths)
     });
 }
 
-Expected<GLProgram> okami::CreateProgram(ProgramShaderPaths const& shaderPaths, IGLShaderCache& cache) {
-    GLShader* vertex = nullptr;
-    GLShader* fragment = nullptr;
-    GLShader* geometry = nullptr;
-    GLShader* tessControl = nullptr;
-    GLShader* tessEval = nullptr;
-    
-    // Load vertex shader if path is provided
-    auto vertexShader = cache.LoadShader(GL_VERTEX_SHADER, shaderPaths.m_vertex);
-    if (!vertexShader) {
-        return std::unexpected(vertexShader.error());
-    }
-    vertex = *vertexShader;
-
-    // Load fragment shader if path is provided
-    if (shaderPaths.m_fragment) {
-        auto fragmentShader = cache.LoadShader(GL_FRAGMENT_SHADER, *shaderPaths.m_fragment);
-        if (!fragmentShader) {
-            return std::unexpected(fragmentShader.error());
-        }
-        fragment = *fragmentShader;
-    }
-    
-    // Load geometry shader if path is provided
-    if (shaderPaths.m_geometry) {
-        auto geometryShader = cache.LoadShader(GL_GEOMETRY_SHADER, *shaderPaths.m_geometry);
-        if (!geometryShader) {
-            return std::unexpected(geometryShader.error());
-        }
-        geometry = *geometryShader;
-    }
-    
-    // Load tessellation control shader if path is provided
-    if (shaderPaths.m_tessControl) {
-        auto tessControlShader = cache.LoadShader(GL_TESS_CONTROL_SHADER, *shaderPaths.m_tessControl);
-        if (!tessControlShader) {
-            return std::unexpected(tessControlShader.error());
-        }
-        tessControl = *tessControlShader;
-    }
-    
-    // Load tessellation evaluation shader if path is provided
-    if (shaderPaths.m_tessEval) {
-        auto tessEvalShader = cache.LoadShader(GL_TESS_EVALUATION_SHADER, *shaderPaths.m_tessEval);
-        if (!tessEvalShader) {
-            return std::unexpected(tessEvalShader.error());
-        }
-        tessEval = *tessEvalShader;
-    }
-    
-    // Create program using the loaded shaders
-    return CreateProgram(ProgramShaders{
-        .m_vertex = *vertex, 
-        .m_fragment = fragment, 
-        .m_geometry = geometry,
-        .m_tessControl = tessControl,
-        .m_tessEval = tessEval
-    });
+GLPendingProgram okami::CreateProgram(ProgramShaderPaths const& shaderPaths, IGLShaderCache& cache) {
+    return cache.SubmitProgram(shaderPaths);
 }
 
 std::string GetGLErrorString(GLenum error) {
@@ -341,6 +620,61 @@ void okami::SetupVertexArray(
     }
 }
 
+bool okami::HasGLExtension(std::string_view name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        auto ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (ext && name == ext) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool okami::LoadMultiDrawIndirect(GLADloadfunc loader) {
+    if (GLAD_GL_VERSION_4_3) {
+        return glMultiDrawElementsIndirect != nullptr;
+    }
+
+    if (!HasGLExtension("GL_ARB_multi_draw_indirect")) {
+        return false;
+    }
+    if (!GLAD_GL_VERSION_4_2 && !HasGLExtension("GL_ARB_base_instance")) {
+        return false;
+    }
+
+    if (!glad_glMultiDrawElementsIndirect && loader) {
+        glad_glMultiDrawElementsIndirect = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>(
+            loader("glMultiDrawElementsIndirect"));
+    }
+    return glad_glMultiDrawElementsIndirect != nullptr;
+}
+
+bool okami::LoadParallelShaderCompile(GLADloadfunc loader) {
+    g_parallelShaderCompile = false;
+    if (!loader) {
+        return false;
+    }
+
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxThreads = nullptr;
+    if (HasGLExtension("GL_KHR_parallel_shader_compile")) {
+        maxThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            loader("glMaxShaderCompilerThreadsKHR"));
+    } else if (HasGLExtension("GL_ARB_parallel_shader_compile")) {
+        maxThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            loader("glMaxShaderCompilerThreadsARB"));
+    }
+    if (!maxThreads) {
+        return false;
+    }
+
+    // 0xFFFFFFFF lets the implementation choose the number of threads.
+    maxThreads(0xFFFFFFFFu);
+    g_parallelShaderCompile = true;
+    return true;
+}
+
 void OGLPipelineState::GetFromGL() {
     // Depth
     depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
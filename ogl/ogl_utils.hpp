@@ -6,6 +6,8 @@
 #include <glad/gl.h>
 
 #include <filesystem>
+#include <functional>
+#include <memory_resource>
 #include <mutex>
 #include <vector>
 
@@ -69,6 +71,8 @@ namespace okami {
     struct OGLPass {
         OGLPassType m_type = OGLPassType::Forward;
         std::vector<OGL2DPayload>* m_2DOutputs = nullptr;
+        // Scratch memory for the pass; valid until the end of the frame.
+        std::pmr::memory_resource* m_frameResource = std::pmr::new_delete_resource();
     };
 
     class IOGLRenderModule {
@@ -177,16 +181,10 @@ namespace okami {
     using GLFramebuffer = GLObject<FramebufferDeleter>;
     using GLVertexArray = GLObject<VertexArrayDeleter>;
 
+    Expected<std::string> LoadShaderSource(const std::filesystem::path& shaderPath);
+    Expected<GLShader> CompileShader(GLenum shaderType, std::string const& source, std::string_view name);
     Expected<GLShader> LoadShader(GLenum shaderType, const std::filesystem::path& shaderPath);
 
-    class IGLShaderCache {
-    public:
-        virtual ~IGLShaderCache() = default;
-        virtual Expected<GLShader*> LoadShader(GLenum shaderType, const std::filesystem::path& path) = 0;
-    };
-
-    std::unique_ptr<IGLShaderCache> CreateGLShaderCache();
-
     struct ProgramShaders {
         GLShader const& m_vertex; 
         GLShader const* m_fragment = nullptr; // Optional
@@ -203,8 +201,96 @@ namespace okami {
         std::optional<std::filesystem::path> m_tessEval; // Optional
     };
 
+    // Startup cost of the programs created through an IGLShaderCache.
+    struct ProgramCacheStats {
+        size_t m_binaryHits = 0; // programs restored from the program binary cache
+        size_t m_compiled = 0;   // programs compiled and linked from source
+        double m_milliseconds = 0.0; // time spent submitting and waiting on programs
+    };
+
+    // A program whose compile and link have been submitted to the driver but
+    // whose status has not been queried yet. Status queries block until the
+    // driver is done, so callers submit every program they need first and
+    // Resolve() them afterwards; with GL_KHR_parallel_shader_compile the
+    // driver compiles the submitted programs concurrently.
+    //
+    // Shaders attached to a pending program are owned by the IGLShaderCache
+    // that submitted it, so it must be resolved while that cache is alive.
+    class GLPendingProgram {
+    public:
+        using ResolvedCallback = std::function<void(GLProgram const& program, double milliseconds)>;
+
+    private:
+        GLProgram           m_program;
+        std::vector<GLuint> m_shaders;
+        std::string         m_name;
+        Error               m_error;
+        ResolvedCallback    m_onResolved;
+
+    public:
+        GLPendingProgram() = default;
+        explicit GLPendingProgram(Error error) : m_error(std::move(error)) {}
+        GLPendingProgram(
+            GLProgram program,
+            std::vector<GLuint> shaders,
+            std::string name,
+            ResolvedCallback onResolved = nullptr);
+
+        OKAMI_NO_COPY(GLPendingProgram);
+        OKAMI_MOVE(GLPendingProgram);
+
+        // Non-blocking completion check. Always true without
+        // GL_KHR_parallel_shader_compile, where Resolve() simply blocks.
+        bool IsReady() const;
+
+        // Waits for the link to finish and returns the program, or the
+        // compile/link log on failure.
+        Expected<GLProgram> Resolve();
+    };
+
+    using ProgramReadyCallback = std::function<Error(GLProgram&& program)>;
+
+    class IGLShaderCache {
+    public:
+        virtual ~IGLShaderCache() = default;
+        virtual Expected<GLShader*> LoadShader(GLenum shaderType, const std::filesystem::path& path) = 0;
+        virtual GLPendingProgram SubmitProgram(ProgramShaderPaths const& paths) = 0;
+
+        // Holds the program until ResolvePending(), which resolves every
+        // deferred program in submission order and hands it to onReady.
+        // Modules use this from StartupImpl so the programs of all modules
+        // compile together; the renderer resolves them before its first frame.
+        virtual void Defer(GLPendingProgram program, ProgramReadyCallback onReady) = 0;
+        virtual Error ResolvePending() = 0;
+
+        // Hot reload. A watched program is submitted again when one of its
+        // shader files changes and handed to onReload once it has linked,
+        // between frames; if the new sources fail, the old program stays.
+        virtual void WatchProgram(ProgramShaderPaths const& paths, ProgramReadyCallback onReload) = 0;
+        // Forgets the cached source and shader of a changed file and marks
+        // every watched program using it. Returns how many were marked.
+        virtual size_t ReloadShader(std::filesystem::path const& path) = 0;
+        // Submits marked programs and hands those that have finished
+        // linking to their callbacks. Never waits on the driver when
+        // GL_KHR_parallel_shader_compile is available.
+        virtual Error ProcessReloads() = 0;
+
+        // Submits, defers and watches the program
+        void DeferProgram(ProgramShaderPaths const& paths, ProgramReadyCallback onReady) {
+            Defer(SubmitProgram(paths), onReady);
+            WatchProgram(paths, std::move(onReady));
+        }
+
+        // Persist linked programs under the directory and reuse them on later
+        // runs. Requires a current GL context.
+        virtual Error EnableProgramBinaryCache(std::filesystem::path const& directory) = 0;
+        virtual ProgramCacheStats GetProgramStats() const = 0;
+    };
+
+    std::unique_ptr<IGLShaderCache> CreateGLShaderCache();
+
     Expected<GLProgram> CreateProgram(ProgramShaders const& shaders);
-    Expected<GLProgram> CreateProgram(ProgramShaderPaths const& shaderPaths, IGLShaderCache& cache);
+    GLPendingProgram CreateProgram(ProgramShaderPaths const& shaderPaths, IGLShaderCache& cache);
     Expected<GLProgram> CreateProgram(ProgramShaderPaths const& shaderPaths);
 
     GLint GetUniformLocation(GLProgram const& program, const char* name, Error& error);
@@ -216,6 +302,44 @@ namespace okami {
         GLuint vertexBuffer,
         std::optional<GLuint> indexBuffer);
 
+    // Returns true if the current context advertises the named extension.
+    bool HasGLExtension(std::string_view name);
+
+    // Layout mandated by GL for GL_DRAW_INDIRECT_BUFFER element draws.
+    struct DrawElementsIndirectCommand {
+        GLuint m_count = 0;
+        GLuint m_instanceCount = 0;
+        GLuint m_firstIndex = 0;
+        GLint  m_baseVertex = 0;
+        GLuint m_baseInstance = 0;
+    };
+    static_assert(sizeof(DrawElementsIndirectCommand) == 5 * sizeof(GLuint));
+
+    // True if glMultiDrawElementsIndirect with non-zero baseInstance is usable,
+    // either through core GL 4.3 or GL_ARB_multi_draw_indirect + base instance.
+    // Glad only resolves entry points for core versions the context reports, so
+    // the extension entry point is resolved through the loader when needed.
+    bool LoadMultiDrawIndirect(GLADloadfunc loader);
+
+    // Enables GL_KHR_parallel_shader_compile (or the ARB variant) if the
+    // context has it, letting the driver pick the compiler thread count.
+    // Returns whether GLPendingProgram::IsReady() can poll without blocking.
+    bool LoadParallelShaderCompile(GLADloadfunc loader);
+
+    // Per-frame draw submission counters reported by render modules.
+    struct OGLDrawStats {
+        size_t m_drawCalls = 0;
+        size_t m_multiDrawCalls = 0; // subset of m_drawCalls issued as multi-draw
+        size_t m_instances = 0;
+
+        OGLDrawStats& operator+=(OGLDrawStats const& other) {
+            m_drawCalls += other.m_drawCalls;
+            m_multiDrawCalls += other.m_multiDrawCalls;
+            m_instances += other.m_instances;
+            return *this;
+        }
+    };
+
     template <typename InstanceType>
 	class BufferWriteMap {
 	private:
@@ -542,6 +666,8 @@ namespace okami {
     public:
         virtual ~IOGLSceneGlobalsProvider() = default;
         virtual UniformBuffer<glsl::SceneGlobals> const& GetSceneGlobalsBuffer() const = 0;
+        // CPU copy of the globals last written to the buffer, e.g. for culling.
+        virtual glsl::SceneGlobals const& GetCurrentSceneGlobals() const = 0;
     };
 
     // Provides access to the depth pass resources: cascade UBO and shadow map array texture.
@@ -601,7 +727,7 @@ namespace okami {
 
     // Thread-safe queue for deferring GL object deletion to the GL thread.
     // Any thread may push IDs; the owning manager calls Drain() once per frame
-    // from ReceiveMessagesImpl (which runs on the GL thread).
+    // from ProcessUploads (which runs on the GL thread).
     struct OGLDeletionQueue {
         std::mutex           mtx;
         std::vector<GLuint>  texture_ids;
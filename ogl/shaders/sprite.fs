@@ -3,16 +3,25 @@
 // Input from geometry shader
 in vec2 v_texCoord;
 in vec4 v_color;
+flat in float v_layer;
 
 // Uniforms
 uniform sampler2D u_texture;
+uniform sampler2DArray u_atlas; // Shared sprite atlas, used when v_layer >= 0
 
 // Output
 layout(location = 0) out vec4 FragColor;
 
 void main() {
+    // Mip selection needs derivatives taken outside the branch, since
+    // neighbouring sprites in a quad may take different sides
+    vec2 dx = dFdx(v_texCoord);
+    vec2 dy = dFdy(v_texCoord);
+
     // Sample texture and apply tint color
-    vec4 texColor = texture(u_texture, v_texCoord);
+    vec4 texColor = v_layer >= 0.0
+        ? textureGrad(u_atlas, vec3(v_texCoord, v_layer), dx, dy)
+        : textureGrad(u_texture, v_texCoord, dx, dy);
     
     // Apply sprite color tint
     FragColor = texColor * v_color;
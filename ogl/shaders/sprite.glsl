@@ -11,6 +11,7 @@ BEGIN_INPUT_STRUCT(SpriteInstance, Frequency::PerVertex)
     IN_MEMBER(vec4, a_spriteRect, 2,    okami::AttributeType::Unknown)     // vec4 a_spriteRect;
     IN_MEMBER(vec4, a_color, 3,         okami::AttributeType::Unknown)          // vec4 a_color;
     IN_MEMBER(vec2, a_size, 4,          okami::AttributeType::Unknown)          // vec2 a_size;
+    IN_MEMBER(float, a_layer, 5,        okami::AttributeType::Unknown)          // float a_layer; atlas layer, < 0 = u_texture
 END_INPUT_STRUCT()
 
 VERTEX_ARRAY_DEF(SpriteInstance)
@@ -19,6 +20,7 @@ VERTEX_ARRAY_DEF(SpriteInstance)
     VERTEX_ARRAY_ITEM(a_spriteRect)
     VERTEX_ARRAY_ITEM(a_color)
     VERTEX_ARRAY_ITEM(a_size)
+    VERTEX_ARRAY_ITEM(a_layer)
 VERTEX_ARRAY_DEF_END()
 
 #ifdef __cplusplus
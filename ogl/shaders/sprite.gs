@@ -16,11 +16,13 @@ in VS_OUT {
     vec4 spriteRect;
     vec4 color;
     vec2 size;
+    float layer;
 } gs_in[];
 
 // Output to fragment shader
 out vec2 v_texCoord;
 out vec4 v_color;
+flat out float v_layer;
 
 void main() {
     // Get sprite data from the input point
@@ -68,6 +70,7 @@ void main() {
         
         // Calculate texture coordinate
         v_texCoord = spriteRect.xy + uvs[i] * spriteRect.zw;
+        v_layer = gs_in[0].layer;
         
         EmitVertex();
     }
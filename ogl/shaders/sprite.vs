@@ -9,6 +9,7 @@ out VS_OUT {
     vec4 spriteRect;
     vec4 color;
     vec2 size;
+    float layer;
 } vs_out;
 
 void main() {
@@ -18,6 +19,7 @@ void main() {
     vs_out.spriteRect = a_spriteRect;
     vs_out.color = a_color;
     vs_out.size = a_size;
+    vs_out.layer = a_layer;
     
     // Output the point at the sprite's center position
     gl_Position = vec4(a_position, 1.0);
@@ -0,0 +1,13 @@
+#version 410 core
+
+in vec2 v_texCoord;
+
+uniform sampler2D u_texture;
+uniform float u_opacity;
+
+layout(location = 0) out vec4 FragColor;
+
+void main() {
+    vec4 texColor = texture(u_texture, v_texCoord);
+    FragColor = vec4(texColor.rgb, texColor.a * u_opacity);
+}
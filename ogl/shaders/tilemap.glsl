@@ -0,0 +1,20 @@
+#pragma once
+#include "common.glsl"
+
+#ifdef __cplusplus
+namespace glsl {
+#endif
+
+BEGIN_INPUT_STRUCT(TileVertex, Frequency::PerVertex)
+    IN_MEMBER(vec2, a_position, 0,      okami::AttributeType::Position)       // vec2 a_position; map-local, y up
+    IN_MEMBER(vec2, a_uv, 1,            okami::AttributeType::TexCoord)       // vec2 a_uv;
+END_INPUT_STRUCT()
+
+VERTEX_ARRAY_DEF(TileVertex)
+    VERTEX_ARRAY_ITEM(a_position)
+    VERTEX_ARRAY_ITEM(a_uv)
+VERTEX_ARRAY_DEF_END()
+
+#ifdef __cplusplus
+} // namespace glsl
+#endif
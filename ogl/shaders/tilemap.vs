@@ -0,0 +1,17 @@
+#version 410 core
+
+#include "tilemap.glsl"
+#include "scene.glsl"
+
+layout(std140) uniform SceneGlobalsBlock {
+    SceneGlobals sceneGlobals;
+};
+
+uniform mat4 u_model;
+
+out vec2 v_texCoord;
+
+void main() {
+    v_texCoord = a_uv;
+    gl_Position = sceneGlobals.u_camera.u_viewProj * u_model * vec4(a_position, 0.0, 1.0);
+}
@@ -0,0 +1,487 @@
+#include "png_decoder.hpp"
+#include "lodepng.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef OKAMI_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OKAMI_PNG_SSE2
+#endif
+
+using namespace okami;
+
+namespace {
+	constexpr std::array<uint8_t, 8> kSignature = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	// Larger images go through lodepng, which has its own limits
+	constexpr uint64_t kMaxFastPixels = uint64_t(1) << 28;
+	// Slack after unfiltered rows that aren't written straight to the output
+	constexpr size_t kRowPadding = 16;
+
+	enum class RowFilter : uint8_t {
+		None    = 0,
+		Sub     = 1,
+		Up      = 2,
+		Average = 3,
+		Paeth   = 4,
+	};
+
+	constexpr uint32_t ChunkType(char const (&name)[5]) {
+		return (uint32_t(uint8_t(name[0])) << 24) | (uint32_t(uint8_t(name[1])) << 16) |
+			(uint32_t(uint8_t(name[2])) << 8) | uint32_t(uint8_t(name[3]));
+	}
+
+	uint32_t ReadBE32(uint8_t const* p) {
+		return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+	}
+
+	uint32_t GetChannelCount(PNGColorType type) {
+		switch (type) {
+		case PNGColorType::Gray:      return 1;
+		case PNGColorType::GrayAlpha: return 2;
+		case PNGColorType::RGB:       return 3;
+		case PNGColorType::RGBA:      return 4;
+		case PNGColorType::Palette:   return 1;
+		}
+		return 0;
+	}
+
+	struct Chunk {
+		uint32_t m_type = 0;
+		std::span<uint8_t const> m_data;
+	};
+
+	// Walks the chunks after the signature, stopping at the end of the data
+	// or at a chunk that runs past it
+	class ChunkReader {
+	public:
+		explicit ChunkReader(std::span<uint8_t const> data) : m_data(data), m_offset(kSignature.size()) {}
+
+		bool Next(Chunk& chunk) {
+			if (m_data.size() < m_offset || m_data.size() - m_offset < 12) {
+				return false;
+			}
+			uint32_t length = ReadBE32(&m_data[m_offset]);
+			if (m_data.size() - m_offset - 12 < length) {
+				b_truncated = true;
+				return false;
+			}
+			chunk.m_type = ReadBE32(&m_data[m_offset + 4]);
+			chunk.m_data = m_data.subspan(m_offset + 8, length);
+			m_offset += size_t(length) + 12;
+			return true;
+		}
+
+		bool IsTruncated() const { return b_truncated; }
+
+	private:
+		std::span<uint8_t const> m_data;
+		size_t m_offset = 0;
+		bool b_truncated = false;
+	};
+
+	struct FreeDeleter {
+		void operator()(void* ptr) const { std::free(ptr); }
+	};
+	using InflatedRows = std::unique_ptr<uint8_t[], FreeDeleter>;
+
+	// Inflates the zlib stream, which must hold exactly size bytes
+	Expected<InflatedRows> Inflate(std::span<uint8_t const> compressed, size_t size) {
+#ifdef OKAMI_LIBDEFLATE
+		using Decompressor = std::unique_ptr<libdeflate_decompressor, decltype(&libdeflate_free_decompressor)>;
+		// One per thread, since textures are decoded on the IO threads
+		thread_local Decompressor decompressor(libdeflate_alloc_decompressor(), &libdeflate_free_decompressor);
+		OKAMI_UNEXPECTED_RETURN_IF(!decompressor, "Failed to create a deflate decompressor");
+
+		InflatedRows rows(static_cast<uint8_t*>(std::malloc(size)));
+		OKAMI_UNEXPECTED_RETURN_IF(!rows, "Out of memory decoding PNG");
+		// Without an actual size to report, anything but exactly size bytes fails
+		auto result = libdeflate_zlib_decompress(decompressor.get(),
+			compressed.data(), compressed.size(), rows.get(), size, nullptr);
+		OKAMI_UNEXPECTED_RETURN_IF(result != LIBDEFLATE_SUCCESS, "Failed to inflate PNG image data");
+		return rows;
+#else
+		LodePNGDecompressSettings settings = lodepng_default_decompress_settings;
+		settings.max_output_size = size;
+		unsigned char* inflated = nullptr;
+		size_t inflatedSize = 0;
+		unsigned error = lodepng_zlib_decompress(&inflated, &inflatedSize, compressed.data(), compressed.size(), &settings);
+		InflatedRows rows(inflated);
+		OKAMI_UNEXPECTED_RETURN_IF(error, "Failed to inflate PNG image data: " + std::string(lodepng_error_text(error)));
+		OKAMI_UNEXPECTED_RETURN_IF(inflatedSize != size, "PNG image data has the wrong size");
+		return rows;
+#endif
+	}
+
+	uint8_t PaethPredictor(int a, int b, int c) {
+		int pa = std::abs(b - c);
+		int pb = std::abs(a - c);
+		int pc = std::abs(a + b - 2 * c);
+		if (pa <= pb && pa <= pc) {
+			return uint8_t(a);
+		}
+		return uint8_t(pb <= pc ? b : c);
+	}
+
+	// Reverses a row's filter; prev is the unfiltered row above
+	void UnfilterRowScalar(RowFilter filter, uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count, uint32_t bpp) {
+		switch (filter) {
+		case RowFilter::None:
+			std::memcpy(out, in, count);
+			break;
+		case RowFilter::Sub:
+			for (size_t i = 0; i < count; ++i) {
+				out[i] = uint8_t(in[i] + (i >= bpp ? out[i - bpp] : 0));
+			}
+			break;
+		case RowFilter::Up:
+			for (size_t i = 0; i < count; ++i) {
+				out[i] = uint8_t(in[i] + prev[i]);
+			}
+			break;
+		case RowFilter::Average:
+			for (size_t i = 0; i < count; ++i) {
+				int left = i >= bpp ? out[i - bpp] : 0;
+				out[i] = uint8_t(in[i] + ((left + prev[i]) >> 1));
+			}
+			break;
+		case RowFilter::Paeth:
+			for (size_t i = 0; i < count; ++i) {
+				int left = i >= bpp ? out[i - bpp] : 0;
+				int upLeft = i >= bpp ? prev[i - bpp] : 0;
+				out[i] = uint8_t(in[i] + PaethPredictor(left, prev[i], upLeft));
+			}
+			break;
+		}
+	}
+
+#ifdef OKAMI_PNG_SSE2
+	// Sub, Average and Paeth depend on the pixel to the left, so they go a
+	// pixel at a time with the channels in parallel, as libpng does. Three
+	// byte pixels are moved four bytes at a time; the extra byte is junk
+	// that the next pixel overwrites, so rows written this way need
+	// kRowPadding bytes of slack, and the last pixel is read exactly so
+	// nothing past the input row is touched.
+	template <uint32_t kBpp>
+	inline __m128i LoadPixel(uint8_t const* row, size_t i, size_t count) {
+		uint32_t value = 0;
+		if (kBpp == 4 || i + 4 <= count) {
+			std::memcpy(&value, row + i, 4);
+		} else {
+			std::memcpy(&value, row + i, 3);
+		}
+		return _mm_cvtsi32_si128(int(value));
+	}
+
+	inline void StorePixel(uint8_t* ptr, __m128i pixel) {
+		uint32_t value = uint32_t(_mm_cvtsi128_si32(pixel));
+		std::memcpy(ptr, &value, 4);
+	}
+
+	inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	inline __m128i Abs16(__m128i x) {
+		return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+	}
+
+	template <uint32_t kBpp>
+	void UnfilterSub(uint8_t const* in, uint8_t* out, size_t count) {
+		__m128i a = _mm_setzero_si128();
+		for (size_t i = 0; i < count; i += kBpp) {
+			a = _mm_add_epi8(a, LoadPixel<kBpp>(in, i, count));
+			StorePixel(out + i, a);
+		}
+	}
+
+	template <uint32_t kBpp>
+	void UnfilterAverage(uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count) {
+		__m128i const one = _mm_set1_epi8(1);
+		__m128i a = _mm_setzero_si128();
+		for (size_t i = 0; i < count; i += kBpp) {
+			__m128i b = LoadPixel<kBpp>(prev, i, count);
+			// avg_epu8 rounds up; the filter rounds down
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+			a = _mm_add_epi8(average, LoadPixel<kBpp>(in, i, count));
+			StorePixel(out + i, a);
+		}
+	}
+
+	template <uint32_t kBpp>
+	void UnfilterPaeth(uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count) {
+		__m128i const zero = _mm_setzero_si128();
+		__m128i a = zero;
+		__m128i c = zero;
+		for (size_t i = 0; i < count; i += kBpp) {
+			__m128i b = _mm_unpacklo_epi8(LoadPixel<kBpp>(prev, i, count), zero);
+			// With p = a + b - c: |p - a| = |b - c|, |p - b| = |a - c|
+			__m128i pa = _mm_sub_epi16(b, c);
+			__m128i pb = _mm_sub_epi16(a, c);
+			__m128i pc = Abs16(_mm_add_epi16(pa, pb));
+			pa = Abs16(pa);
+			pb = Abs16(pb);
+			__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+			__m128i predicted = Select(_mm_cmpeq_epi16(pa, smallest), a,
+				Select(_mm_cmpeq_epi16(pb, smallest), b, c));
+			__m128i pixel = _mm_add_epi8(LoadPixel<kBpp>(in, i, count), _mm_packus_epi16(predicted, predicted));
+			StorePixel(out + i, pixel);
+			a = _mm_unpacklo_epi8(pixel, zero);
+			c = b;
+		}
+	}
+
+	void UnfilterUp(uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count) {
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(prev + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(x, b));
+		}
+		for (; i < count; ++i) {
+			out[i] = uint8_t(in[i] + prev[i]);
+		}
+	}
+
+	template <uint32_t kBpp>
+	void UnfilterRowSSE2(RowFilter filter, uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count) {
+		switch (filter) {
+		case RowFilter::Sub:     UnfilterSub<kBpp>(in, out, count); break;
+		case RowFilter::Average: UnfilterAverage<kBpp>(in, out, prev, count); break;
+		case RowFilter::Paeth:   UnfilterPaeth<kBpp>(in, out, prev, count); break;
+		default:                 UnfilterRowScalar(filter, in, out, prev, count, kBpp); break;
+		}
+	}
+#endif
+
+	void UnfilterRow(RowFilter filter, uint8_t const* in, uint8_t* out, uint8_t const* prev, size_t count, uint32_t bpp) {
+#ifdef OKAMI_PNG_SSE2
+		if (filter == RowFilter::Up) {
+			UnfilterUp(in, out, prev, count);
+			return;
+		}
+		if (bpp == 4) {
+			UnfilterRowSSE2<4>(filter, in, out, prev, count);
+			return;
+		}
+		if (bpp == 3) {
+			UnfilterRowSSE2<3>(filter, in, out, prev, count);
+			return;
+		}
+#endif
+		UnfilterRowScalar(filter, in, out, prev, count, bpp);
+	}
+
+	// Everything ExpandRow needs to turn a row of any color type into RGBA8
+	struct ColorExpansion {
+		PNGColorType m_colorType = PNGColorType::RGBA;
+		// Gray and palette images: RGBA for each sample value
+		std::array<uint32_t, 256> m_lookup{};
+		// RGB images: the transparent color from tRNS, if any
+		std::array<uint16_t, 3> m_colorKey{};
+		bool b_hasColorKey = false;
+	};
+
+	void ExpandRow(ColorExpansion const& expansion, uint8_t const* in, uint8_t* out, uint32_t width) {
+		switch (expansion.m_colorType) {
+		case PNGColorType::Gray:
+		case PNGColorType::Palette:
+			for (uint32_t x = 0; x < width; ++x) {
+				std::memcpy(out + x * 4, &expansion.m_lookup[in[x]], 4);
+			}
+			break;
+		case PNGColorType::GrayAlpha:
+			for (uint32_t x = 0; x < width; ++x) {
+				uint8_t gray = in[x * 2];
+				out[x * 4 + 0] = gray;
+				out[x * 4 + 1] = gray;
+				out[x * 4 + 2] = gray;
+				out[x * 4 + 3] = in[x * 2 + 1];
+			}
+			break;
+		case PNGColorType::RGB:
+			for (uint32_t x = 0; x < width; ++x) {
+				uint8_t const* rgb = in + x * 3;
+				out[x * 4 + 0] = rgb[0];
+				out[x * 4 + 1] = rgb[1];
+				out[x * 4 + 2] = rgb[2];
+				out[x * 4 + 3] = 255;
+			}
+			if (expansion.b_hasColorKey) {
+				auto const& key = expansion.m_colorKey;
+				for (uint32_t x = 0; x < width; ++x) {
+					uint8_t const* rgb = in + x * 3;
+					if (rgb[0] == key[0] && rgb[1] == key[1] && rgb[2] == key[2]) {
+						out[x * 4 + 3] = 0;
+					}
+				}
+			}
+			break;
+		case PNGColorType::RGBA:
+			std::memcpy(out, in, size_t(width) * 4);
+			break;
+		}
+	}
+
+	Error SetupExpansion(ColorExpansion& expansion, PNGColorType colorType,
+		std::span<uint8_t const> palette, std::span<uint8_t const> transparency) {
+		expansion.m_colorType = colorType;
+		switch (colorType) {
+		case PNGColorType::Gray: {
+			uint16_t key = transparency.size() >= 2 ? uint16_t((transparency[0] << 8) | transparency[1]) : 0xFFFF;
+			bool hasKey = transparency.size() >= 2;
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint8_t rgba[4] = { uint8_t(i), uint8_t(i), uint8_t(i), uint8_t(hasKey && key == i ? 0 : 255) };
+				std::memcpy(&expansion.m_lookup[i], rgba, 4);
+			}
+			break;
+		}
+		case PNGColorType::Palette: {
+			OKAMI_ERROR_RETURN_IF(palette.empty() || palette.size() % 3 != 0 || palette.size() > 256 * 3,
+				"PNG has an invalid palette");
+			// Indices past the palette are opaque black, as lodepng makes them
+			uint8_t const black[4] = { 0, 0, 0, 255 };
+			for (uint32_t i = 0; i < 256; ++i) {
+				std::memcpy(&expansion.m_lookup[i], black, 4);
+			}
+			for (size_t i = 0; i < palette.size() / 3; ++i) {
+				uint8_t rgba[4] = { palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2],
+					i < transparency.size() ? transparency[i] : uint8_t(255) };
+				std::memcpy(&expansion.m_lookup[i], rgba, 4);
+			}
+			break;
+		}
+		case PNGColorType::RGB:
+			if (transparency.size() >= 6) {
+				for (size_t i = 0; i < 3; ++i) {
+					expansion.m_colorKey[i] = uint16_t((transparency[i * 2] << 8) | transparency[i * 2 + 1]);
+				}
+				expansion.b_hasColorKey = true;
+			}
+			break;
+		case PNGColorType::GrayAlpha:
+		case PNGColorType::RGBA:
+			break;
+		}
+		return {};
+	}
+}
+
+std::optional<PNGHeader> okami::ReadPNGHeader(std::span<uint8_t const> data) {
+	// Signature, then IHDR's length, type and 13 bytes of data
+	if (data.size() < 33 || !std::equal(kSignature.begin(), kSignature.end(), data.begin())) {
+		return std::nullopt;
+	}
+	uint8_t const* ihdr = data.data() + 8;
+	if (ReadBE32(ihdr) != 13 || ReadBE32(ihdr + 4) != ChunkType("IHDR")) {
+		return std::nullopt;
+	}
+
+	PNGHeader header;
+	header.m_width = ReadBE32(ihdr + 8);
+	header.m_height = ReadBE32(ihdr + 12);
+	header.m_bitDepth = ihdr[16];
+	header.m_colorType = PNGColorType(ihdr[17]);
+	header.b_interlaced = ihdr[20] != 0;
+	if (GetChannelCount(header.m_colorType) == 0 || ihdr[18] != 0 || ihdr[19] != 0 || ihdr[20] > 1) {
+		return std::nullopt;
+	}
+	return header;
+}
+
+bool okami::CanDecodePNGFast(PNGHeader const& header) {
+	return header.m_bitDepth == 8 && !header.b_interlaced &&
+		header.m_width > 0 && header.m_height > 0 &&
+		uint64_t(header.m_width) * header.m_height <= kMaxFastPixels;
+}
+
+Error okami::DecodePNGToRGBA8(std::span<uint8_t const> data, PNGHeader const& header, std::span<uint8_t> out) {
+	OKAMI_ERROR_RETURN_IF(!CanDecodePNGFast(header), "PNG needs the full decoder");
+	OKAMI_ERROR_RETURN_IF(out.size() != size_t(header.m_width) * header.m_height * 4,
+		"PNG output has the wrong size");
+
+	std::span<uint8_t const> palette;
+	std::span<uint8_t const> transparency;
+	std::span<uint8_t const> firstData;
+	std::vector<uint8_t> joinedData;
+	bool foundEnd = false;
+
+	ChunkReader reader(data);
+	Chunk chunk;
+	while (!foundEnd && reader.Next(chunk)) {
+		switch (chunk.m_type) {
+		case ChunkType("PLTE"):
+			palette = chunk.m_data;
+			break;
+		case ChunkType("tRNS"):
+			transparency = chunk.m_data;
+			break;
+		case ChunkType("IDAT"):
+			// Most encoders split the stream over many small chunks
+			if (firstData.empty()) {
+				firstData = chunk.m_data;
+			} else {
+				if (joinedData.empty()) {
+					joinedData.assign(firstData.begin(), firstData.end());
+				}
+				joinedData.insert(joinedData.end(), chunk.m_data.begin(), chunk.m_data.end());
+			}
+			break;
+		case ChunkType("IEND"):
+			foundEnd = true;
+			break;
+		default:
+			break;
+		}
+	}
+	OKAMI_ERROR_RETURN_IF(reader.IsTruncated(), "PNG is truncated");
+	OKAMI_ERROR_RETURN_IF(firstData.empty(), "PNG has no image data");
+
+	ColorExpansion expansion;
+	auto error = SetupExpansion(expansion, header.m_colorType, palette, transparency);
+	OKAMI_ERROR_RETURN(error);
+
+	uint32_t const bpp = GetChannelCount(header.m_colorType);
+	size_t const rowBytes = size_t(header.m_width) * bpp;
+	size_t const stride = rowBytes + 1; // each row starts with its filter type
+	auto compressed = joinedData.empty() ? firstData : std::span<uint8_t const>(joinedData);
+	auto rows = Inflate(compressed, stride * header.m_height);
+	OKAMI_ERROR_RETURN(rows);
+
+	size_t const outRowBytes = size_t(header.m_width) * 4;
+	if (header.m_colorType == PNGColorType::RGBA) {
+		// RGBA rows are already final, so they unfilter straight into the
+		// output, against the output row above
+		std::vector<uint8_t> zeroRow(rowBytes, 0);
+		for (uint32_t y = 0; y < header.m_height; ++y) {
+			uint8_t const* row = rows->get() + y * stride;
+			OKAMI_ERROR_RETURN_IF(row[0] > uint8_t(RowFilter::Paeth), "PNG has an invalid filter type");
+			uint8_t* outRow = out.data() + y * outRowBytes;
+			uint8_t const* prev = y > 0 ? outRow - outRowBytes : zeroRow.data();
+			UnfilterRow(RowFilter(row[0]), row + 1, outRow, prev, rowBytes, bpp);
+		}
+		return {};
+	}
+
+	// Everything else unfilters into two rows that stay in cache, taking
+	// turns as the row above, and is expanded to RGBA from there
+	size_t const paddedRowBytes = rowBytes + kRowPadding;
+	std::vector<uint8_t> unfiltered(paddedRowBytes * 2, 0);
+	for (uint32_t y = 0; y < header.m_height; ++y) {
+		uint8_t const* row = rows->get() + y * stride;
+		OKAMI_ERROR_RETURN_IF(row[0] > uint8_t(RowFilter::Paeth), "PNG has an invalid filter type");
+		uint8_t* current = unfiltered.data() + (y % 2) * paddedRowBytes;
+		uint8_t const* prev = unfiltered.data() + ((y + 1) % 2) * paddedRowBytes;
+		UnfilterRow(RowFilter(row[0]), row + 1, current, prev, rowBytes, bpp);
+		ExpandRow(expansion, current, out.data() + y * outRowBytes, header.m_width);
+	}
+	return {};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace okami {
+	enum class PNGColorType : uint8_t {
+		Gray      = 0,
+		RGB       = 2,
+		Palette   = 3,
+		GrayAlpha = 4,
+		RGBA      = 6,
+	};
+
+	struct PNGHeader {
+		uint32_t m_width     = 0;
+		uint32_t m_height    = 0;
+		uint8_t  m_bitDepth  = 0;
+		PNGColorType m_colorType = PNGColorType::RGBA;
+		bool     b_interlaced = false;
+	};
+
+	// The IHDR of a PNG file, or nothing if the data isn't a PNG
+	std::optional<PNGHeader> ReadPNGHeader(std::span<uint8_t const> data);
+
+	// True for the PNGs the fast decoder handles: non-interlaced, 8 bits per
+	// channel, any color type. Everything else goes through lodepng.
+	bool CanDecodePNGFast(PNGHeader const& header);
+
+	// Decodes to RGBA8 straight into out, which must hold width * height * 4
+	// bytes. IDAT is inflated into one buffer of filtered rows, with
+	// libdeflate when built with it (OKAMI_LIBDEFLATE) and lodepng's inflate
+	// otherwise, and unfiltered with SSE2 where available. Chunk CRCs are
+	// not checked; the zlib stream's Adler-32 is.
+	//
+	// Callers fall back to lodepng on any error, which also reports what
+	// is wrong with a damaged file.
+	Error DecodePNGToRGBA8(std::span<uint8_t const> data, PNGHeader const& header, std::span<uint8_t> out);
+}
@@ -0,0 +1,193 @@
+#include "profiler.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace okami;
+
+std::atomic<bool> okami::detail::g_profilerEnabled{ false };
+
+namespace {
+	struct ProfileEvent {
+		const char* m_name;
+		uint64_t    m_start;
+		uint64_t    m_end;
+		AllocationCounters m_allocations;
+	};
+
+	// Single-producer ring. Only the owning thread writes m_events and bumps
+	// m_written; exporters read m_written with acquire ordering.
+	struct ThreadBuffer {
+		static constexpr uint64_t kCapacity = 1 << 16;
+
+		std::unique_ptr<ProfileEvent[]> m_events = std::make_unique<ProfileEvent[]>(kCapacity);
+		std::atomic<uint64_t>           m_written{ 0 };
+		uint32_t                        m_threadId = 0;
+		std::string                     m_threadName; // guarded by ProfilerState::m_mutex
+	};
+
+	struct ProfilerState {
+		std::mutex                                 m_mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers; // never shrinks; buffers outlive their threads
+		std::unordered_set<std::string>            m_names;
+		std::atomic<uint64_t>                      m_clearedAt{ 0 };
+		const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+	};
+
+	ProfilerState& GetState() {
+		static ProfilerState state;
+		return state;
+	}
+
+	ThreadBuffer& GetThreadBuffer() {
+		thread_local ThreadBuffer* buffer = [] {
+			auto& state = GetState();
+			std::lock_guard lock(state.m_mutex);
+			auto& result = state.m_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+			result->m_threadId = static_cast<uint32_t>(state.m_buffers.size());
+			return result.get();
+		}();
+		return *buffer;
+	}
+
+	// Visits the events of one buffer recorded after `clearedAt`. When the
+	// ring has wrapped only the newest kCapacity events are still present.
+	template <typename Fn>
+	void ForEachEvent(ThreadBuffer const& buffer, uint64_t clearedAt, Fn&& fn) {
+		const uint64_t written = buffer.m_written.load(std::memory_order_acquire);
+		const uint64_t begin = written > ThreadBuffer::kCapacity ? written - ThreadBuffer::kCapacity : 0;
+		for (uint64_t i = begin; i < written; ++i) {
+			auto const& event = buffer.m_events[i % ThreadBuffer::kCapacity];
+			if (event.m_start >= clearedAt) {
+				fn(event);
+			}
+		}
+	}
+
+	void WriteJsonString(std::ostream& os, std::string_view str) {
+		os << '"';
+		for (char c : str) {
+			switch (c) {
+				case '"':  os << "\\\""; break;
+				case '\\': os << "\\\\"; break;
+				case '\n': os << "\\n"; break;
+				case '\t': os << "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						os << ' ';
+					} else {
+						os << c;
+					}
+			}
+		}
+		os << '"';
+	}
+}
+
+void okami::SetProfilerEnabled(bool enabled) {
+	detail::g_profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void okami::ClearProfile() {
+	// Events are filtered by timestamp at export, so recording threads are
+	// never touched.
+	GetState().m_clearedAt.store(GetProfilerTimestamp(), std::memory_order_relaxed);
+}
+
+void okami::SetProfilerThreadName(std::string_view name) {
+	auto& buffer = GetThreadBuffer();
+	std::lock_guard lock(GetState().m_mutex);
+	buffer.m_threadName = name;
+}
+
+const char* okami::InternProfileName(std::string_view name) {
+	auto& state = GetState();
+	std::lock_guard lock(state.m_mutex);
+	return state.m_names.emplace(name).first->c_str();
+}
+
+uint64_t okami::GetProfilerTimestamp() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - GetState().m_epoch).count());
+}
+
+void okami::RecordProfileEvent(const char* name, uint64_t startNs, uint64_t endNs, AllocationCounters allocations) {
+	auto& buffer = GetThreadBuffer();
+	const uint64_t index = buffer.m_written.load(std::memory_order_relaxed);
+	buffer.m_events[index % ThreadBuffer::kCapacity] = ProfileEvent{ name, startNs, endNs, allocations };
+	buffer.m_written.store(index + 1, std::memory_order_release);
+}
+
+std::vector<ProfileEventRecord> okami::CollectProfileEvents() {
+	auto& state = GetState();
+	const uint64_t clearedAt = state.m_clearedAt.load(std::memory_order_relaxed);
+
+	std::vector<ProfileEventRecord> result;
+	std::lock_guard lock(state.m_mutex);
+	for (auto const& buffer : state.m_buffers) {
+		ForEachEvent(*buffer, clearedAt, [&](ProfileEvent const& event) {
+			result.push_back(ProfileEventRecord{
+				.m_name = event.m_name,
+				.m_threadId = buffer->m_threadId,
+				.m_start = event.m_start,
+				.m_end = event.m_end,
+				.m_allocations = event.m_allocations,
+			});
+		});
+	}
+	return result;
+}
+
+Error okami::WriteChromeTrace(std::filesystem::path const& path) {
+	auto& state = GetState();
+	const uint64_t clearedAt = state.m_clearedAt.load(std::memory_order_relaxed);
+
+	if (path.has_parent_path()) {
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+	}
+	std::ofstream file(path);
+	OKAMI_ERROR_RETURN_IF(!file, "Failed to open trace output: " + path.string());
+
+	std::lock_guard lock(state.m_mutex);
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	auto separator = [&]() -> std::ostream& {
+		if (!first) {
+			file << ",\n";
+		}
+		first = false;
+		return file;
+	};
+
+	for (auto const& buffer : state.m_buffers) {
+		if (!buffer->m_threadName.empty()) {
+			separator() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->m_threadId
+				<< ",\"args\":{\"name\":";
+			WriteJsonString(file, buffer->m_threadName);
+			file << "}}";
+		}
+
+		ForEachEvent(*buffer, clearedAt, [&](ProfileEvent const& event) {
+			separator() << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->m_threadId << ",\"name\":";
+			WriteJsonString(file, event.m_name ? event.m_name : "?");
+			file << ",\"ts\":" << static_cast<double>(event.m_start) / 1000.0
+				<< ",\"dur\":" << static_cast<double>(event.m_end - event.m_start) / 1000.0;
+			if constexpr (kAllocationTrackingEnabled) {
+				file << ",\"args\":{\"allocations\":" << event.m_allocations.m_count
+					<< ",\"bytes\":" << event.m_allocations.m_bytes << "}";
+			}
+			file << "}";
+		});
+	}
+	file << "\n]}\n";
+
+	OKAMI_ERROR_RETURN_IF(!file, "Failed to write trace output: " + path.string());
+	return {};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "common.hpp"
+#include "allocation_tracker.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace okami {
+	// Frame profiler. Scopes record complete events into a per-thread ring
+	// buffer owned by the recording thread, so recording takes no locks; the
+	// only lock is taken once per thread, the first time it records.
+	//
+	// Event names are stored by pointer and must outlive the trace: use string
+	// literals or InternProfileName(). When profiling is disabled a scope costs
+	// one relaxed atomic load. With allocation tracking built in, each event
+	// also carries the allocations its thread made inside the scope.
+	namespace detail {
+		extern std::atomic<bool> g_profilerEnabled;
+	}
+
+	inline bool IsProfilerEnabled() {
+		return detail::g_profilerEnabled.load(std::memory_order_relaxed);
+	}
+
+	void SetProfilerEnabled(bool enabled);
+
+	// Drops every event recorded so far from future exports.
+	void ClearProfile();
+
+	// Names the calling thread in exported traces.
+	void SetProfilerThreadName(std::string_view name);
+
+	// Returns a pointer to a process-lifetime copy of the name. Takes a lock;
+	// cache the result rather than interning every frame.
+	const char* InternProfileName(std::string_view name);
+
+	// Nanoseconds on the profiler clock.
+	uint64_t GetProfilerTimestamp();
+
+	void RecordProfileEvent(const char* name, uint64_t startNs, uint64_t endNs,
+		AllocationCounters allocations = {});
+
+	struct ProfileEventRecord {
+		const char* m_name;
+		uint32_t    m_threadId;
+		uint64_t    m_start;
+		uint64_t    m_end;
+		AllocationCounters m_allocations;
+	};
+
+	// Copies the events recorded since the last ClearProfile(), grouped by
+	// thread and in recording order within a thread. Same caveat as
+	// WriteChromeTrace about threads that are still recording.
+	std::vector<ProfileEventRecord> CollectProfileEvents();
+
+	// Writes the recorded events in the Chrome trace event format, loadable in
+	// chrome://tracing and Perfetto. Call between frames: a thread that is
+	// still recording may overwrite the oldest events of its buffer.
+	Error WriteChromeTrace(std::filesystem::path const& path);
+
+	class ProfileScope {
+	private:
+		const char*        m_name = nullptr;
+		uint64_t           m_start = 0;
+		AllocationCounters m_startAllocations;
+
+	public:
+		inline explicit ProfileScope(const char* name) {
+			if (IsProfilerEnabled()) {
+				m_name = name;
+				m_startAllocations = GetThreadAllocations();
+				m_start = GetProfilerTimestamp();
+			}
+		}
+
+		inline ~ProfileScope() {
+			if (m_name) {
+				auto const end = GetProfilerTimestamp();
+				RecordProfileEvent(m_name, m_start, end, GetThreadAllocations() - m_startAllocations);
+			}
+		}
+
+		OKAMI_NO_COPY(ProfileScope);
+		OKAMI_NO_MOVE(ProfileScope);
+	};
+
+	// Records the next m_frameCount frames with the profiler and writes them
+	// to m_path as a Chrome trace. Handled by Engine::Run.
+	struct MessageCaptureTrace {
+		std::filesystem::path m_path = "frame_trace.json";
+		uint32_t m_frameCount = 1;
+	};
+
+	// Totals for the last completed frame, kept in the registry context by
+	// Engine::Run. Allocation fields stay zero unless allocation tracking is
+	// built in.
+	struct FrameStatsCtx {
+		double             m_frameMs = 0.0;
+		AllocationCounters m_allocations;
+		size_t             m_frame = 0;
+		// Frame arena usage (see FrameAllocator) before the end-of-frame reset
+		size_t             m_frameArenaBytes = 0;
+		// Update graph runs this frame; always 1 unless RunParams::fixedStep is set
+		uint32_t           m_simulationSteps = 1;
+	};
+}
+
+#define OKAMI_PROFILE_SCOPE(name) okami::ProfileScope OKAMI_CONCAT(okamiProfileScope_, __LINE__)(name)
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+namespace okami {
+	// Stable LSD radix sort on a 64-bit key, 8 bits per pass.
+	//
+	// Passes in which every key has the same digit are skipped, so keys that only
+	// use a few significant bytes sort in proportionally fewer passes. `scratch`
+	// is resized as needed and can be kept around between calls to avoid
+	// reallocating every frame.
+	template <typename T, typename KeyFn>
+	void RadixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFn&& key) {
+		constexpr int kPasses = 8;
+		constexpr int kBuckets = 256;
+
+		const size_t count = items.size();
+		if (count < 2) {
+			return;
+		}
+		scratch.resize(count);
+
+		std::array<std::array<uint32_t, kBuckets>, kPasses> histograms{};
+		for (auto const& item : items) {
+			uint64_t k = key(item);
+			for (int pass = 0; pass < kPasses; ++pass) {
+				++histograms[pass][(k >> (pass * 8)) & 0xFF];
+			}
+		}
+
+		std::vector<T>* src = &items;
+		std::vector<T>* dst = &scratch;
+
+		for (int pass = 0; pass < kPasses; ++pass) {
+			auto& histogram = histograms[pass];
+
+			// Every key shares this digit; the pass would be the identity.
+			if (histogram[(key((*src)[0]) >> (pass * 8)) & 0xFF] == count) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& bucket : histogram) {
+				uint32_t bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+
+			for (auto& item : *src) {
+				uint32_t digit = (key(item) >> (pass * 8)) & 0xFF;
+				(*dst)[histogram[digit]++] = std::move(item);
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != &items) {
+			items.swap(scratch);
+		}
+	}
+
+	// Maps a float onto an unsigned integer with the same ordering, so that
+	// floats can be used as radix sort keys.
+	inline uint32_t FloatToSortableBits(float value) {
+		uint32_t bits;
+		static_assert(sizeof(bits) == sizeof(value));
+		std::memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include "common.hpp"
+
+namespace okami {
+	// First-fit allocator over a linear range of elements [0, capacity).
+	// Used to suballocate GPU buffers; it never touches memory itself, it only
+	// hands out offsets. Adjacent free blocks are coalesced on Free().
+	class RangeAllocator final {
+	private:
+		std::map<uint32_t, uint32_t> m_freeBlocks; // offset -> size
+		uint32_t m_capacity = 0;
+		uint32_t m_freeCount = 0;
+
+		void InsertFree(uint32_t offset, uint32_t count) {
+			auto next = m_freeBlocks.lower_bound(offset);
+
+			// Merge with the following block
+			if (next != m_freeBlocks.end() && offset + count == next->first) {
+				count += next->second;
+				next = m_freeBlocks.erase(next);
+			}
+
+			// Merge with the preceding block
+			if (next != m_freeBlocks.begin()) {
+				auto prev = std::prev(next);
+				if (prev->first + prev->second == offset) {
+					prev->second += count;
+					return;
+				}
+			}
+
+			m_freeBlocks.emplace_hint(next, offset, count);
+		}
+
+	public:
+		RangeAllocator() = default;
+		explicit RangeAllocator(uint32_t capacity) {
+			Grow(capacity);
+		}
+
+		std::optional<uint32_t> Allocate(uint32_t count) {
+			if (count == 0) {
+				return std::nullopt;
+			}
+
+			for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it) {
+				if (it->second < count) {
+					continue;
+				}
+
+				uint32_t offset = it->first;
+				uint32_t remaining = it->second - count;
+				m_freeBlocks.erase(it);
+				if (remaining > 0) {
+					m_freeBlocks.emplace(offset + count, remaining);
+				}
+				m_freeCount -= count;
+				return offset;
+			}
+			return std::nullopt;
+		}
+
+		void Free(uint32_t offset, uint32_t count) {
+			OKAMI_ASSERT(offset + count <= m_capacity, "Freed range is out of bounds");
+			if (count == 0) {
+				return;
+			}
+			InsertFree(offset, count);
+			m_freeCount += count;
+		}
+
+		// Extends the range; the new tail [oldCapacity, newCapacity) becomes free.
+		void Grow(uint32_t newCapacity) {
+			if (newCapacity <= m_capacity) {
+				return;
+			}
+			uint32_t added = newCapacity - m_capacity;
+			InsertFree(m_capacity, added);
+			m_freeCount += added;
+			m_capacity = newCapacity;
+		}
+
+		void Clear() {
+			m_freeBlocks.clear();
+			m_freeCount = 0;
+			uint32_t capacity = m_capacity;
+			m_capacity = 0;
+			Grow(capacity);
+		}
+
+		uint32_t GetCapacity() const {
+			return m_capacity;
+		}
+
+		uint32_t GetFreeCount() const {
+			return m_freeCount;
+		}
+
+		size_t GetFreeBlockCount() const {
+			return m_freeBlocks.size();
+		}
+	};
+}
@@ -0,0 +1,27 @@
+#include "render_snapshot.hpp"
+
+#include <algorithm>
+
+using namespace okami;
+
+bool okami::RenderSnapshotSchema::TryAddType(std::type_index type) {
+	if (std::find(m_types.begin(), m_types.end(), type) != m_types.end()) {
+		return false;
+	}
+	m_types.push_back(type);
+	return true;
+}
+
+void okami::RenderSnapshotSchema::Extract(entt::registry const& src, entt::registry& dst) const {
+	// Dropping every entity and recreating the live ones by id is simpler
+	// than diffing and keeps destroyed entities out of the snapshot. The
+	// storages keep their capacity from frame to frame.
+	dst.clear();
+
+	for (auto const& copy : m_copyComponents) {
+		copy(src, dst);
+	}
+	for (auto const& copy : m_copyContexts) {
+		copy(src, dst);
+	}
+}
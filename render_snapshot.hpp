@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common.hpp"
+
+#include <functional>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+namespace okami {
+	// Describes the registry state a renderer reads, so a pipelined engine can
+	// copy it out of the simulation registry once per frame and render the
+	// copy on another thread. The engine registers an instance in the
+	// InterfaceCollection; render modules add their types during Register.
+	//
+	// Component types are copied per entity with their entity ids preserved,
+	// so entity handles held elsewhere (e.g. the active camera) stay valid in
+	// the snapshot. Context types are copied whole. Copies must be safe to
+	// read on another thread while the simulation keeps running, so shared
+	// resources should be held by handle rather than by pointer into state
+	// the simulation mutates.
+	class RenderSnapshotSchema final {
+	public:
+		template <typename T>
+		void AddComponent() {
+			if (!TryAddType(typeid(T))) {
+				return;
+			}
+			m_copyComponents.emplace_back([](entt::registry const& src, entt::registry& dst) {
+				for (auto entity : src.view<T>()) {
+					if (!dst.valid(entity)) {
+						dst.create(entity);
+					}
+					if constexpr (std::is_empty_v<T>) {
+						dst.emplace<T>(entity);
+					} else {
+						dst.emplace<T>(entity, src.get<T>(entity));
+					}
+				}
+			});
+		}
+
+		template <typename T>
+		void AddContext() {
+			if (!TryAddType(typeid(T))) {
+				return;
+			}
+			m_copyContexts.emplace_back([](entt::registry const& src, entt::registry& dst) {
+				if (auto const* value = src.ctx().find<T>()) {
+					dst.ctx().insert_or_assign(*value);
+				} else {
+					dst.ctx().erase<T>();
+				}
+			});
+		}
+
+		// Replaces the contents of dst with the registered state of src.
+		void Extract(entt::registry const& src, entt::registry& dst) const;
+
+		inline size_t GetTypeCount() const { return m_types.size(); }
+
+	private:
+		using CopyFunc = std::function<void(entt::registry const&, entt::registry&)>;
+
+		std::vector<std::type_index> m_types;
+		std::vector<CopyFunc> m_copyComponents;
+		std::vector<CopyFunc> m_copyContexts;
+
+		bool TryAddType(std::type_index type);
+	};
+}
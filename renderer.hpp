@@ -57,7 +57,10 @@ namespace okami {
 		virtual void NotifyNeedGLContext() = 0;
 		virtual void SwapBuffers() = 0;
 		virtual void SetSwapInterval(int interval) = 0;
+		// Thread safe; the size is sampled on the main thread once per frame
 		virtual glm::ivec2 GetFramebufferSize() const = 0;
+		// Makes the context current on the calling thread, or releases it
+		virtual void MakeContextCurrent(bool current) = 0;
 		virtual ~IGLProvider() = default;
 	};
 
@@ -117,10 +120,51 @@ namespace okami {
 	struct RendererConfig {
 		int bufferCount = 2;
 		int syncInterval = 1; // VSync enabled
+		bool multiDrawIndirect = true; // Used only if the GL context supports it
+		bool programBinaryCache = true;
+		std::string programBinaryCacheDir = "shader_cache"; // relative to the executable
+		// Recompile shader programs when their GLSL files change
+		bool hotReloadShaders = false;
 
 		OKAMI_CONFIG(renderer) {
 			OKAMI_CONFIG_FIELD(bufferCount);
 			OKAMI_CONFIG_FIELD(syncInterval);
+			OKAMI_CONFIG_FIELD(multiDrawIndirect);
+			OKAMI_CONFIG_FIELD(programBinaryCache);
+			OKAMI_CONFIG_FIELD(programBinaryCacheDir);
+			OKAMI_CONFIG_FIELD(hotReloadShaders);
+		}
+	};
+
+	struct TextureStreamingConfig {
+		// Textures load their mip levels up to this size first, and finer
+		// levels stream in as the renderer finds them needed. 0 loads every
+		// texture whole.
+		int tailSize = 0;
+		// GPU memory for streamed mip levels in MiB, past which the finest
+		// levels of the least recently used textures are dropped. 0 is unlimited.
+		// Counts only levels finer than the tail, and acts within
+		// residency.budgetMB: levels are not streamed in past either.
+		int budgetMB = 0;
+
+		OKAMI_CONFIG(textureStreaming) {
+			OKAMI_CONFIG_FIELD(tailSize);
+			OKAMI_CONFIG_FIELD(budgetMB);
+		}
+	};
+
+	struct ResidencyConfig {
+		// GPU memory for textures and geometry in MiB. Past it, resources no
+		// draw has used for evictAfterFrames frames are evicted, least
+		// recently used first, and load again when next drawn. 0 is unlimited.
+		// Covers everything, streamed texture levels included; see
+		// textureStreaming.budgetMB for how the two interact.
+		int budgetMB = 0;
+		int evictAfterFrames = 120;
+
+		OKAMI_CONFIG(residency) {
+			OKAMI_CONFIG_FIELD(budgetMB);
+			OKAMI_CONFIG_FIELD(evictAfterFrames);
 		}
 	};
 
@@ -183,5 +227,11 @@ namespace okami {
 		virtual void SetActiveCamera(entity_t e) = 0;
 		virtual entity_t GetActiveCamera() const = 0;
         virtual Error Render(entt::registry const& registry) = 0;
+
+		// With pipelined frames (RunParams::frameLatency) Render is called on a
+		// dedicated thread. These move thread-affine API state, such as a GL
+		// context, onto and off the calling thread, and are called in pairs.
+		virtual void AttachRenderThread() {}
+		virtual void DetachRenderThread() {}
 	};
 }
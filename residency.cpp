@@ -0,0 +1,63 @@
+#include "residency.hpp"
+
+#include <algorithm>
+
+using namespace okami;
+
+std::vector<size_t> okami::SelectEvictions(
+	std::span<ResidentResource const> resources,
+	size_t   budgetBytes,
+	uint64_t frame,
+	uint64_t idleFrames) {
+
+	size_t residentBytes = 0;
+	for (auto const& resource : resources) {
+		residentBytes += resource.m_bytes;
+	}
+	if (budgetBytes == 0 || residentBytes <= budgetBytes) {
+		return {};
+	}
+
+	std::vector<size_t> candidates;
+	for (size_t i = 0; i < resources.size(); ++i) {
+		auto const& resource = resources[i];
+		bool idle = resource.m_lastUsedFrame + idleFrames <= frame;
+		if (idle && resource.m_evictableBytes > 0) {
+			candidates.push_back(i);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+		auto const& ra = resources[a];
+		auto const& rb = resources[b];
+		if (ra.m_lastUsedFrame != rb.m_lastUsedFrame) {
+			return ra.m_lastUsedFrame < rb.m_lastUsedFrame;
+		}
+		return ra.m_evictableBytes > rb.m_evictableBytes;
+	});
+
+	std::vector<size_t> result;
+	for (size_t index : candidates) {
+		if (residentBytes <= budgetBytes) {
+			break;
+		}
+		result.push_back(index);
+		residentBytes -= std::min(resources[index].m_evictableBytes, residentBytes);
+	}
+	return result;
+}
+
+void okami::AccountResidency(std::span<ResidentResource const> resources, GPUResidencyStats& stats) {
+	stats.m_textureBytes  = 0;
+	stats.m_geometryBytes = 0;
+	stats.m_textureCount  = 0;
+	stats.m_geometryCount = 0;
+	for (auto const& resource : resources) {
+		if (resource.m_kind == ResidencyKind::Texture) {
+			stats.m_textureBytes += resource.m_bytes;
+			++stats.m_textureCount;
+		} else {
+			stats.m_geometryBytes += resource.m_bytes;
+			++stats.m_geometryCount;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace okami {
+	enum class ResidencyKind {
+		Texture,
+		Geometry,
+	};
+
+	// A GPU resource as the residency budget sees it
+	struct ResidentResource {
+		ResidencyKind m_kind = ResidencyKind::Texture;
+		size_t   m_bytes          = 0; // GPU memory held now
+		size_t   m_evictableBytes = 0; // freed by evicting it; 0 if it can't be
+		uint64_t m_lastUsedFrame  = 0; // last frame a draw used it
+	};
+
+	// GPU memory held by textures and geometry as of the last rendered frame
+	struct GPUResidencyStats {
+		size_t   m_budgetBytes   = 0; // 0 is unlimited
+		size_t   m_textureBytes  = 0;
+		size_t   m_geometryBytes = 0;
+		// Resources tracked, evicted ones included
+		uint32_t m_textureCount  = 0;
+		uint32_t m_geometryCount = 0;
+		// Totals since startup
+		uint64_t m_evictions    = 0;
+		uint64_t m_evictedBytes = 0;
+		uint64_t m_restores     = 0; // evicted resources loaded again
+
+		inline size_t GetResidentBytes() const {
+			return m_textureBytes + m_geometryBytes;
+		}
+		inline bool IsOverBudget() const {
+			return m_budgetBytes > 0 && GetResidentBytes() > m_budgetBytes;
+		}
+	};
+
+	// Picks the resources to evict once together they hold more than the
+	// budget: only those no draw has used for at least idleFrames frames,
+	// least recently used first, larger ones first among equals. Resources
+	// in use are never picked, so a scene that needs more than the budget
+	// runs over it rather than reloading every frame.
+	//
+	// Returns indices into resources in eviction order.
+	std::vector<size_t> SelectEvictions(
+		std::span<ResidentResource const> resources,
+		size_t   budgetBytes,
+		uint64_t frame,
+		uint64_t idleFrames);
+
+	// Replaces the byte and resource counts in stats, keeping the totals
+	void AccountResidency(std::span<ResidentResource const> resources, GPUResidencyStats& stats);
+
+	// Implemented by the renderer
+	class IGPUResidency {
+	public:
+		virtual ~IGPUResidency() = default;
+
+		// Thread safe
+		virtual GPUResidencyStats GetResidencyStats() const = 0;
+	};
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "common.hpp"
+#include "paths.hpp"
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace okami {
+	// Names a slot in a ResourceTable. As with entt entities, the low 20
+	// bits are the slot index and the high 12 bits its generation, which
+	// moves on each time the slot is freed so stale IDs stop resolving.
+	using ResourceId = uint32_t;
+	constexpr ResourceId kNullResource = ~ResourceId(0);
+
+	// Slots that hold their value in place and never move, so pointers to
+	// live values stay valid while other threads add more.
+	//
+	// Get is lock-free and may be called from any thread. Emplace and Erase
+	// take a lock against each other. Get only tells whether an ID is still
+	// live; a value erased while another thread reads it is gone, so
+	// readers must keep the value alive by other means (ResHandle does,
+	// with its reference count).
+	template <typename T>
+	class ResourceTable {
+	public:
+		static constexpr uint32_t kIndexBits = 20;
+		static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+		static constexpr uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+		// The last index is left out so no ID is kNullResource
+		static constexpr uint32_t kMaxSlots = kIndexMask;
+
+		ResourceTable() = default;
+		OKAMI_NO_COPY(ResourceTable);
+		OKAMI_NO_MOVE(ResourceTable);
+
+		~ResourceTable() {
+			for (auto& page : m_pages) {
+				delete[] page.load(std::memory_order_relaxed);
+			}
+		}
+
+		static inline uint32_t GetIndex(ResourceId id) {
+			return id & kIndexMask;
+		}
+		static inline uint32_t GetGeneration(ResourceId id) {
+			return id >> kIndexBits;
+		}
+
+		// Constructs a value in a free slot. Returns kNullResource and null
+		// once all kMaxSlots are in use.
+		template <typename... TArgs>
+		std::pair<ResourceId, T*> Emplace(TArgs&&... args) {
+			std::lock_guard<std::mutex> lock(m_writeMutex);
+
+			uint32_t index;
+			if (!m_freeIndices.empty()) {
+				index = m_freeIndices.back();
+				m_freeIndices.pop_back();
+			} else {
+				if (m_slotCount == kMaxSlots) {
+					return { kNullResource, nullptr };
+				}
+				index = m_slotCount++;
+				auto& page = m_pages[index >> kPageBits];
+				if (!page.load(std::memory_order_relaxed)) {
+					page.store(new Slot[kPageSize], std::memory_order_release);
+				}
+			}
+
+			auto& slot = GetSlot(index);
+			auto& value = slot.m_value.emplace(std::forward<TArgs>(args)...);
+			ResourceId id = (slot.m_generation << kIndexBits) | index;
+			// Publishes the value to Get
+			slot.m_id.store(id, std::memory_order_release);
+			m_liveCount.fetch_add(1, std::memory_order_relaxed);
+			return { id, &value };
+		}
+
+		// The live value for id, or null if it was erased or never existed
+		T* Get(ResourceId id) const {
+			uint32_t index = GetIndex(id);
+			if (id == kNullResource || index >= kMaxSlots) {
+				return nullptr;
+			}
+			Slot* page = m_pages[index >> kPageBits].load(std::memory_order_acquire);
+			if (!page) {
+				return nullptr;
+			}
+			Slot& slot = page[index & (kPageSize - 1)];
+			if (slot.m_id.load(std::memory_order_acquire) != id) {
+				return nullptr;
+			}
+			return &*slot.m_value;
+		}
+
+		// Destroys the value and frees the slot for reuse under a new
+		// generation. False if id wasn't live.
+		bool Erase(ResourceId id) {
+			std::lock_guard<std::mutex> lock(m_writeMutex);
+			if (!Get(id)) {
+				return false;
+			}
+
+			uint32_t index = GetIndex(id);
+			auto& slot = GetSlot(index);
+			slot.m_id.store(kNullResource, std::memory_order_release);
+			slot.m_value.reset();
+			slot.m_generation = (slot.m_generation + 1) & kGenerationMask;
+			m_freeIndices.push_back(index);
+			m_liveCount.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		size_t GetLiveCount() const {
+			return m_liveCount.load(std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr uint32_t kPageBits = 10;
+		static constexpr uint32_t kPageSize = 1u << kPageBits;
+		static constexpr uint32_t kPageCount = (kMaxSlots + kPageSize - 1) / kPageSize;
+
+		struct Slot {
+			std::atomic<ResourceId> m_id{ kNullResource }; // kNullResource while free
+			uint32_t m_generation = 0; // of the next value; guarded by m_writeMutex
+			std::optional<T> m_value;
+		};
+
+		// Caller holds m_writeMutex, and the page exists
+		Slot& GetSlot(uint32_t index) {
+			return m_pages[index >> kPageBits].load(std::memory_order_relaxed)[index & (kPageSize - 1)];
+		}
+
+		// Pages are allocated as slots are first used and only freed with
+		// the table
+		std::array<std::atomic<Slot*>, kPageCount> m_pages{};
+		std::atomic<size_t> m_liveCount{ 0 };
+
+		std::mutex m_writeMutex;
+		uint32_t m_slotCount = 0;
+		std::vector<uint32_t> m_freeIndices;
+	};
+
+	// Maps asset paths to values for many threads at once. Paths are spread
+	// over shards with a reader-writer lock each, so lookups share their
+	// shard and inserts of different paths rarely meet.
+	template <typename V>
+	class ResourcePathMap {
+	public:
+		static constexpr uint32_t kShardBits = 5;
+		static constexpr size_t kShardCount = size_t(1) << kShardBits;
+
+		struct Shard {
+			mutable std::shared_mutex m_mutex;
+			std::unordered_map<std::filesystem::path, V, PathHash> m_map;
+		};
+
+		Shard& GetShard(std::filesystem::path const& path) {
+			return m_shards[GetShardIndex(path)];
+		}
+		Shard const& GetShard(std::filesystem::path const& path) const {
+			return m_shards[GetShardIndex(path)];
+		}
+
+		// Calls fn(path, value) for every entry, one shard at a time under
+		// its shared lock
+		template <typename F>
+		void ForEach(F&& fn) const {
+			for (auto const& shard : m_shards) {
+				std::shared_lock<std::shared_mutex> lock(shard.m_mutex);
+				for (auto const& [path, value] : shard.m_map) {
+					fn(path, value);
+				}
+			}
+		}
+
+		void Clear() {
+			for (auto& shard : m_shards) {
+				std::unique_lock<std::shared_mutex> lock(shard.m_mutex);
+				shard.m_map.clear();
+			}
+		}
+
+	private:
+		static size_t GetShardIndex(std::filesystem::path const& path) {
+			// Shards take the top bits of the mixed hash; the maps bucket by
+			// the low ones
+			uint64_t hash = uint64_t(PathHash{}(path)) * 0x9E3779B97F4A7C15ull;
+			return size_t(hash >> (64 - kShardBits));
+		}
+
+		std::array<Shard, kShardCount> m_shards;
+	};
+}
@@ -1,6 +1,6 @@
 #include "scene.hpp"
 
-int main() {
-    return okami::RunSample<sample_zoo::ZooSample>();
+int main(int argc, char* argv[]) {
+    return okami::RunSample<sample_zoo::ZooSample>(argc, argv);
 }
 
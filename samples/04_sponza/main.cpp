@@ -1,5 +1,5 @@
 #include "scene.hpp"
 
-int main() {
-    return okami::RunSample<sample_sponza::SponzaSample>();
+int main(int argc, char* argv[]) {
+    return okami::RunSample<sample_sponza::SponzaSample>(argc, argv);
 }
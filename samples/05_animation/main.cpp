@@ -1,5 +1,5 @@
 #include "scene.hpp"
 
-int main() {
-    return okami::RunSample<sample_drone::DroneSample>();
+int main(int argc, char* argv[]) {
+    return okami::RunSample<sample_drone::DroneSample>(argc, argv);
 }
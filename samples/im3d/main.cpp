@@ -1,6 +1,6 @@
 #include "scene.hpp"
 
-int main() {
-    return okami::RunSample<sample_im3d::Im3dSample>();
+int main(int argc, char* argv[]) {
+    return okami::RunSample<sample_im3d::Im3dSample>(argc, argv);
 }
 
@@ -1,6 +1,6 @@
 #include "scene.hpp"
 
-int main() {
-    return okami::RunSample<sample_imgui::ImGuiSample>();
+int main(int argc, char* argv[]) {
+    return okami::RunSample<sample_imgui::ImGuiSample>(argc, argv);
 }
 
@@ -5,8 +5,22 @@
 #include "input.hpp"
 #include "entity_manager.hpp"
 
+#include <cstring>
+
 namespace okami {
 
+SampleOptions ParseSampleOptions(int argc, char* argv[]) {
+    SampleOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.m_recordPath = argv[++i];
+        } else {
+            std::cerr << "Ignoring unknown argument " << argv[i] << std::endl;
+        }
+    }
+    return options;
+}
+
 void InstallEditorModules(Engine& en) {
     en.CreateModule<ImGuiModuleFactory>();
     en.CreateModule<EditorModuleFactory>({}, EditorPropertiesCtx{ .b_showEditor = false });
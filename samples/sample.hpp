@@ -3,6 +3,7 @@
 #include "engine.hpp"
 #include "glfw_module.hpp"
 
+#include <filesystem>
 #include <iostream>
 #include <optional>
 
@@ -30,13 +31,26 @@ public:
 // Implemented in sample.cpp (compiled into every sample executable).
 void InstallEditorModules(Engine& en);
 
+// Parses the options shared by every sample executable:
+//
+//   --record FILE   save the session's input to FILE on exit, for replay
+//                   with EngineBenchmarks --replay FILE
+//
+// Implemented in sample.cpp.
+struct SampleOptions {
+    std::optional<std::filesystem::path> m_recordPath;
+};
+SampleOptions ParseSampleOptions(int argc, char* argv[]);
+
 // ---------------------------------------------------------------------------
 // Driver function used by each sample's main.cpp.
 //
-//   int main() { return okami::RunSample<MySample>(); }
+//   int main(int argc, char* argv[]) { return okami::RunSample<MySample>(argc, argv); }
 // ---------------------------------------------------------------------------
 template <typename TSample>
-int RunSample() {
+int RunSample(int argc = 0, char* argv[] = nullptr) {
+    auto options = ParseSampleOptions(argc, argv);
+
     TSample sample;
     Engine en;
 
@@ -50,8 +64,22 @@ int RunSample() {
     }
 
     sample.SetupScene(en);
-    en.Run();
+
+    InputRecorder recorder;
+    RunParams params;
+    if (options.m_recordPath) {
+        params.inputRecorder = &recorder;
+    }
+    en.Run(params);
     en.Shutdown();
+
+    if (options.m_recordPath) {
+        if (auto err = recorder.Save(*options.m_recordPath); err.IsError()) {
+            std::cerr << "Failed to save input recording: " << err << std::endl;
+            return 1;
+        }
+        std::cout << "Recorded " << recorder.GetFrameCount() << " frames to " << options.m_recordPath->string() << std::endl;
+    }
     return 0;
 }
 
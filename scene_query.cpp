@@ -0,0 +1,273 @@
+#include "scene_query.hpp"
+
+#include "aabb_tree.hpp"
+#include "animation.hpp"
+#include "renderer.hpp"
+#include "transform.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace okami;
+
+namespace {
+    using SceneTree = WideAABBTree<entity_t>;
+
+    std::optional<AABB> GetGeometryBounds(GeometryHandle const& geometry) {
+        if (!geometry || !geometry->IsLoaded() || geometry->GetDesc().m_primitives.empty()) {
+            return std::nullopt;
+        }
+        auto const& primitives = geometry->GetDesc().m_primitives;
+        AABB bounds = primitives.front().m_aabb;
+        for (auto const& primitive : primitives) {
+            bounds = Union(bounds, primitive.m_aabb);
+        }
+        return bounds;
+    }
+
+    // World box around a transformed local box (Arvo's method)
+    AABB TransformBounds(AABB const& local, Transform const& transform) {
+        glm::mat4 m = transform.AsMatrix();
+        AABB world{ glm::vec3(m[3]), glm::vec3(m[3]) };
+        for (int col = 0; col < 3; ++col) {
+            for (int row = 0; row < 3; ++row) {
+                float a = m[col][row] * local.m_min[col];
+                float b = m[col][row] * local.m_max[col];
+                world.m_min[row] += std::min(a, b);
+                world.m_max[row] += std::max(a, b);
+            }
+        }
+        return world;
+    }
+}
+
+class SceneQueryModule final : public EngineModule, public ISceneQuery {
+private:
+    entt::registry* m_registry = nullptr;
+
+    // World bounds of every queryable entity. The published tree is rebuilt
+    // from these whenever they change: a binned SAH build gives tighter trees
+    // than inserting leaf by leaf, and the 4-wide copy tests a node's
+    // children together. Queries far outnumber updates.
+    std::unordered_map<entity_t, AABB> m_bounds;
+    // Entities whose bounds may have changed since the last update, plus
+    // meshes still waiting on their geometry
+    std::unordered_set<entity_t> m_dirty;
+
+    mutable std::mutex m_snapshotMutex;
+    std::shared_ptr<SceneTree const> m_snapshot = std::make_shared<SceneTree>();
+
+    template <typename T>
+    void Watch(entt::registry& registry) {
+        registry.on_construct<T>().template connect<&SceneQueryModule::OnChanged>(*this);
+        registry.on_update<T>().template connect<&SceneQueryModule::OnChanged>(*this);
+        registry.on_destroy<T>().template connect<&SceneQueryModule::OnChanged>(*this);
+    }
+
+    template <typename T>
+    void Unwatch(entt::registry& registry) {
+        registry.on_construct<T>().disconnect(*this);
+        registry.on_update<T>().disconnect(*this);
+        registry.on_destroy<T>().disconnect(*this);
+    }
+
+    void OnChanged(entt::registry&, entt::entity entity) {
+        m_dirty.insert(entity);
+    }
+
+    // nullopt with pending set means the entity has a mesh whose geometry
+    // has not loaded yet
+    std::optional<AABB> ComputeBounds(entt::registry const& registry, entity_t entity, bool& pending) const {
+        pending = false;
+        if (!registry.valid(entity)) {
+            return std::nullopt;
+        }
+        auto const* transform = registry.try_get<Transform>(entity);
+        if (!transform) {
+            return std::nullopt;
+        }
+
+        std::optional<AABB> local;
+        if (auto const* bounds = registry.try_get<SceneBoundsComponent>(entity)) {
+            local = bounds->m_local;
+        } else if (auto const* mesh = registry.try_get<StaticMeshComponent>(entity)) {
+            local = GetGeometryBounds(mesh->m_geometry);
+            pending = !local && mesh->m_geometry;
+        } else if (auto const* skinned = registry.try_get<SkinnedMeshComponent>(entity)) {
+            local = GetGeometryBounds(skinned->m_geometry);
+            pending = !local && skinned->m_geometry;
+        }
+
+        if (!local) {
+            return std::nullopt;
+        }
+        return TransformBounds(*local, *transform);
+    }
+
+    std::shared_ptr<SceneTree const> GetSnapshot() const {
+        std::lock_guard lock(m_snapshotMutex);
+        return m_snapshot;
+    }
+
+    static void BeginOverlap(size_t queryCount, std::vector<entity_t>& entities, std::vector<uint32_t>& offsets) {
+        entities.clear();
+        offsets.clear();
+        offsets.reserve(queryCount + 1);
+        offsets.push_back(0);
+    }
+
+protected:
+    Error RegisterImpl(InterfaceCollection& interfaces) override {
+        interfaces.Register<ISceneQuery>(this);
+        return {};
+    }
+
+    Error StartupImpl(InitContext const& context) override {
+        m_registry = &context.m_registry;
+        Watch<Transform>(*m_registry);
+        Watch<SceneBoundsComponent>(*m_registry);
+        Watch<StaticMeshComponent>(*m_registry);
+        Watch<SkinnedMeshComponent>(*m_registry);
+
+        for (auto entity : m_registry->view<Transform>()) {
+            m_dirty.insert(entity);
+        }
+        return {};
+    }
+
+    void ShutdownImpl(InitContext const&) override {
+        if (m_registry) {
+            Unwatch<Transform>(*m_registry);
+            Unwatch<SceneBoundsComponent>(*m_registry);
+            Unwatch<StaticMeshComponent>(*m_registry);
+            Unwatch<SkinnedMeshComponent>(*m_registry);
+            m_registry = nullptr;
+        }
+    }
+
+    // Runs after the entity manager has committed this frame's changes, and
+    // never concurrently with graph execution
+    Error ReceiveMessagesImpl(MessageBus&, RecieveMessagesParams const& params) override {
+        if (m_dirty.empty()) {
+            return {};
+        }
+
+        bool changed = false;
+        std::unordered_set<entity_t> stillPending;
+        for (auto entity : m_dirty) {
+            bool pending = false;
+            auto bounds = ComputeBounds(params.m_registry, entity, pending);
+
+            if (bounds) {
+                m_bounds[entity] = *bounds;
+                changed = true;
+            } else if (m_bounds.erase(entity)) {
+                changed = true;
+            }
+            if (pending) {
+                stillPending.insert(entity);
+            }
+        }
+        m_dirty = std::move(stillPending);
+
+        if (changed) {
+            std::vector<AABB> boxes;
+            std::vector<entity_t> entities;
+            boxes.reserve(m_bounds.size());
+            entities.reserve(m_bounds.size());
+            for (auto const& [entity, box] : m_bounds) {
+                boxes.push_back(box);
+                entities.push_back(entity);
+            }
+            auto snapshot = std::make_shared<SceneTree const>(
+                AABBTree<entity_t>::Build(boxes, entities).Collapse());
+            std::lock_guard lock(m_snapshotMutex);
+            m_snapshot = std::move(snapshot);
+        }
+        return {};
+    }
+
+public:
+    void Raycast(std::span<Ray const> rays, std::span<SceneRayHit> hits, float maxDistance) const override {
+        OKAMI_ASSERT(hits.size() >= rays.size(), "Not enough room for ray hits");
+        auto tree = GetSnapshot();
+
+        for (size_t i = 0; i < rays.size(); ++i) {
+            auto const& ray = rays[i];
+            auto const invDirection = 1.0f / ray.m_direction;
+            SceneRayHit best{ .m_distance = maxDistance };
+            tree->Raycast(ray.m_origin, invDirection, maxDistance, [&](entity_t entity, float t) {
+                if (best.m_entity == kNullEntity || t < best.m_distance) {
+                    best = SceneRayHit{ entity, t };
+                }
+                return best.m_distance;
+            });
+            hits[i] = best.m_entity == kNullEntity ? SceneRayHit{} : best;
+        }
+    }
+
+    void Overlap(std::span<AABB const> boxes, std::vector<entity_t>& entities, std::vector<uint32_t>& offsets) const override {
+        auto tree = GetSnapshot();
+        BeginOverlap(boxes.size(), entities, offsets);
+        for (auto const& box : boxes) {
+            tree->Query(box, [&](entity_t entity) { entities.push_back(entity); });
+            offsets.push_back(static_cast<uint32_t>(entities.size()));
+        }
+    }
+
+    void Overlap(std::span<Frustum const> frusta, std::vector<entity_t>& entities, std::vector<uint32_t>& offsets) const override {
+        auto tree = GetSnapshot();
+        BeginOverlap(frusta.size(), entities, offsets);
+        for (auto const& frustum : frusta) {
+            tree->Traverse(
+                [&](AABB const& box) { return Intersects(frustum, box); },
+                [&](entity_t entity, AABB const&) { entities.push_back(entity); });
+            offsets.push_back(static_cast<uint32_t>(entities.size()));
+        }
+    }
+
+    void Nearest(std::span<glm::vec3 const> points, size_t k, std::span<SceneNearestHit> hits) const override {
+        OKAMI_ASSERT(hits.size() >= points.size() * k, "Not enough room for nearest hits");
+        if (k == 0) {
+            return;
+        }
+        auto tree = GetSnapshot();
+
+        for (size_t i = 0; i < points.size(); ++i) {
+            auto const point = points[i];
+            auto best = hits.subspan(i * k, k);
+            std::fill(best.begin(), best.end(), SceneNearestHit{});
+
+            // best stays sorted, so its last entry is the one to beat
+            tree->Traverse(
+                [&](AABB const& box) { return DistanceSquared(box, point) < best.back().m_distanceSquared; },
+                [&](entity_t entity, AABB const& box) {
+                    SceneNearestHit hit{ entity, DistanceSquared(box, point) };
+                    if (hit.m_distanceSquared >= best.back().m_distanceSquared) {
+                        return;
+                    }
+                    auto it = std::upper_bound(best.begin(), best.end(), hit,
+                        [](SceneNearestHit const& a, SceneNearestHit const& b) {
+                            return a.m_distanceSquared < b.m_distanceSquared;
+                        });
+                    std::move_backward(it, best.end() - 1, best.end());
+                    *it = hit;
+                });
+        }
+    }
+
+    size_t GetEntityCount() const override {
+        return GetSnapshot()->GetLeaves().size();
+    }
+
+    std::string GetName() const override {
+        return "Scene Query";
+    }
+};
+
+std::unique_ptr<EngineModule> SceneQueryModuleFactory::operator()() const {
+    return std::make_unique<SceneQueryModule>();
+}
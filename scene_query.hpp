@@ -0,0 +1,78 @@
+#pragma once
+
+#include "aabb.hpp"
+#include "entity_manager.hpp"
+#include "module.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace okami {
+    // Local-space bounds for entities the scene query service should know
+    // about. Overrides the geometry bounds of mesh entities; entities without
+    // a mesh (sprites, triggers, ...) are only queryable with one.
+    struct SceneBoundsComponent {
+        AABB m_local;
+    };
+
+    struct SceneRayHit {
+        entity_t m_entity = kNullEntity;
+        // Along the ray, in multiples of its direction
+        float m_distance = std::numeric_limits<float>::infinity();
+    };
+
+    struct SceneNearestHit {
+        entity_t m_entity = kNullEntity;
+        float m_distanceSquared = std::numeric_limits<float>::infinity();
+    };
+
+    // Spatial queries against the world-space bounds of every entity with a
+    // Transform and either a SceneBoundsComponent, a static mesh or a skinned
+    // mesh (bind pose). Queries test bounds only, not triangles.
+    //
+    // Results reflect the scene as committed by the last ReceiveMessages. All
+    // methods are const and thread safe, so jobs may call them concurrently
+    // during graph execution. Every call takes a batch: result i answers
+    // query i, and the whole batch sees the same version of the scene.
+    class ISceneQuery {
+    public:
+        virtual ~ISceneQuery() = default;
+
+        // Closest hit per ray; misses keep kNullEntity
+        virtual void Raycast(
+            std::span<Ray const> rays,
+            std::span<SceneRayHit> hits,
+            float maxDistance = std::numeric_limits<float>::infinity()) const = 0;
+
+        // Entities overlapping each box: query i's results are
+        // entities[offsets[i]] up to entities[offsets[i + 1]]. Both vectors
+        // are overwritten; offsets ends up with boxes.size() + 1 entries.
+        virtual void Overlap(
+            std::span<AABB const> boxes,
+            std::vector<entity_t>& entities,
+            std::vector<uint32_t>& offsets) const = 0;
+
+        // As above for frusta (see Frustum::FromMatrix)
+        virtual void Overlap(
+            std::span<Frustum const> frusta,
+            std::vector<entity_t>& entities,
+            std::vector<uint32_t>& offsets) const = 0;
+
+        // The k entities whose bounds are closest to each point, nearest
+        // first, written to hits[i * k] up to hits[i * k + k]; missing
+        // entries keep kNullEntity. hits must hold points.size() * k entries.
+        virtual void Nearest(
+            std::span<glm::vec3 const> points,
+            size_t k,
+            std::span<SceneNearestHit> hits) const = 0;
+
+        virtual size_t GetEntityCount() const = 0;
+    };
+
+    struct SceneQueryModuleFactory {
+        std::unique_ptr<EngineModule> operator()() const;
+    };
+}
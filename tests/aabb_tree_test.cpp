@@ -157,6 +157,271 @@ TEST_F(AABBTreeTest, RemoveNodeTest) {
     EXPECT_TRUE(tree->Validate());
 }
 
+TEST_F(AABBTreeTest, QueryMatchesBruteForceTest) {
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::vector<AABB> boxes;
+    std::vector<int> leaves;
+    for (int i = 0; i < 500; ++i) {
+        boxes.push_back(CreateUnitAABB(pos(rng), pos(rng), pos(rng)));
+        leaves.push_back(tree->Insert(boxes.back(), i));
+    }
+    // Remove a few so the query also walks a tree that has been restructured
+    for (int i = 0; i < 500; i += 7) {
+        tree->Remove(leaves[i]);
+    }
+
+    AABB query = CreateAABB(-10.0f, -10.0f, -10.0f, 10.0f, 10.0f, 10.0f);
+    std::vector<int> found;
+    tree->Query(query, [&](int data, int) { found.push_back(data); });
+
+    std::vector<int> expected;
+    for (int i = 0; i < 500; ++i) {
+        if (i % 7 != 0 && Intersects(boxes[i], query)) {
+            expected.push_back(i);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, expected);
+}
+
+TEST_F(AABBTreeTest, FlattenedQueryMatchesTreeTest) {
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::vector<int> leaves;
+    for (int i = 0; i < 500; ++i) {
+        leaves.push_back(tree->Insert(CreateUnitAABB(pos(rng), pos(rng), pos(rng)), i));
+    }
+    for (int i = 0; i < 500; i += 5) {
+        tree->Remove(leaves[i]);
+    }
+
+    auto flat = tree->Flatten();
+    EXPECT_EQ(flat.GetLeaves().size(), 400u);
+    EXPECT_EQ(flat.GetNodes().size(), 799u);
+    EXPECT_EQ(flat.GetNodes()[0].m_skip, 799u);
+
+    for (int q = 0; q < 20; ++q) {
+        auto x = pos(rng), y = pos(rng), z = pos(rng);
+        AABB query = CreateAABB(x, y, z, x + 15.0f, y + 15.0f, z + 15.0f);
+
+        std::vector<int> expected;
+        tree->Query(query, [&](int data, int) { expected.push_back(data); });
+        std::vector<int> found;
+        flat.Query(query, [&](int data) { found.push_back(data); });
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+}
+
+TEST_F(AABBTreeTest, FlattenedClosestRayHitTest) {
+    for (int i = 0; i < 10; ++i) {
+        tree->Insert(CreateUnitAABB(static_cast<float>(i) * 3.0f, 0.0f, 0.0f), i);
+    }
+    tree->Insert(CreateUnitAABB(0.0f, 5.0f, 0.0f), 100);
+    auto flat = tree->Flatten();
+
+    // Fired from the far end along -x; box 9 (at x = 27..28) is hit first
+    Ray ray{ glm::vec3(40.0f, 0.5f, 0.5f), glm::vec3(-1.0f, 0.0f, 0.0f) };
+    auto invDirection = 1.0f / ray.m_direction;
+    float best = std::numeric_limits<float>::infinity();
+    int hit = -1;
+    flat.Traverse(
+        [&](AABB const& box) { return IntersectRay(box, ray.m_origin, invDirection, best) >= 0.0f; },
+        [&](int data, AABB const& box) {
+            auto t = IntersectRay(box, ray.m_origin, invDirection, best);
+            if (t >= 0.0f && t < best) {
+                best = t;
+                hit = data;
+            }
+        });
+    EXPECT_EQ(hit, 9);
+    EXPECT_FLOAT_EQ(best, 12.0f);
+}
+
+TEST_F(AABBTreeTest, EmptyTreeFlattensToNothingTest) {
+    auto flat = tree->Flatten();
+    EXPECT_TRUE(flat.IsEmpty());
+    int visited = 0;
+    flat.Query(CreateUnitAABB(0, 0, 0), [&](int) { ++visited; });
+    EXPECT_EQ(visited, 0);
+}
+
+TEST_F(AABBTreeTest, FrustumIntersectsTest) {
+    // Orthographic box covering [-1, 1]^3
+    Frustum frustum = Frustum::FromMatrix(glm::mat4(1.0f));
+    EXPECT_TRUE(Intersects(frustum, CreateAABB(0.5f, 0.5f, 0.5f, 2.0f, 2.0f, 2.0f)));
+    EXPECT_TRUE(Intersects(frustum, CreateAABB(-5.0f, -5.0f, -5.0f, 5.0f, 5.0f, 5.0f)));
+    EXPECT_FALSE(Intersects(frustum, CreateAABB(1.5f, 0.0f, 0.0f, 2.0f, 1.0f, 1.0f)));
+    EXPECT_FALSE(Intersects(frustum, CreateAABB(0.0f, 0.0f, -3.0f, 1.0f, 1.0f, -2.0f)));
+}
+
+TEST_F(AABBTreeTest, BulkBuildMatchesBruteForceTest) {
+    // Large enough that the top of the tree is built in parallel
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::vector<AABB> boxes;
+    std::vector<int> datas;
+    for (int i = 0; i < 10000; ++i) {
+        boxes.push_back(CreateUnitAABB(pos(rng), pos(rng), pos(rng)));
+        datas.push_back(i);
+    }
+
+    auto built = AABBTree<int>::Build(boxes, datas);
+    EXPECT_TRUE(built.Validate());
+
+    for (int q = 0; q < 20; ++q) {
+        auto x = pos(rng), y = pos(rng), z = pos(rng);
+        AABB query = CreateAABB(x, y, z, x + 10.0f, y + 10.0f, z + 10.0f);
+
+        std::vector<int> found;
+        built.Query(query, [&](int data, int) { found.push_back(data); });
+        std::vector<int> expected;
+        for (int i = 0; i < 10000; ++i) {
+            if (Intersects(boxes[i], query)) {
+                expected.push_back(i);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+
+    // Still a dynamic tree afterwards
+    int leaf = built.Insert(CreateUnitAABB(500.0f, 500.0f, 500.0f), -1);
+    built.Remove(leaf);
+    EXPECT_TRUE(built.Validate());
+}
+
+TEST_F(AABBTreeTest, BulkBuildHandlesCoincidentBoxesTest) {
+    // Every centroid is the same, so no SAH split exists
+    std::vector<AABB> boxes(33, CreateUnitAABB(1.0f, 2.0f, 3.0f));
+    std::vector<int> datas(33);
+    for (int i = 0; i < 33; ++i) {
+        datas[i] = i;
+    }
+    auto built = AABBTree<int>::Build(boxes, datas);
+    EXPECT_TRUE(built.Validate());
+
+    int found = 0;
+    built.Query(CreateUnitAABB(1.5f, 2.5f, 3.5f), [&](int, int) { ++found; });
+    EXPECT_EQ(found, 33);
+
+    EXPECT_THROW(AABBTree<int>::Build(boxes, std::span<int const>(datas).first(3)), std::invalid_argument);
+}
+
+TEST_F(AABBTreeTest, CollapsedQueryMatchesTreeTest) {
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::vector<AABB> boxes;
+    std::vector<int> datas;
+    for (int i = 0; i < 1000; ++i) {
+        boxes.push_back(CreateUnitAABB(pos(rng), pos(rng), pos(rng)));
+        datas.push_back(i);
+    }
+    auto built = AABBTree<int>::Build(boxes, datas);
+    auto wide = built.Collapse();
+    EXPECT_EQ(wide.GetLeaves().size(), 1000u);
+    // Every node but the last level is full, give or take
+    EXPECT_LT(wide.GetNodes().size(), 500u);
+
+    for (int q = 0; q < 20; ++q) {
+        auto x = pos(rng), y = pos(rng), z = pos(rng);
+        AABB query = CreateAABB(x, y, z, x + 15.0f, y + 15.0f, z + 15.0f);
+
+        std::vector<int> expected;
+        built.Query(query, [&](int data, int) { expected.push_back(data); });
+        std::vector<int> found;
+        wide.Query(query, [&](int data) { found.push_back(data); });
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+}
+
+TEST_F(AABBTreeTest, CollapsedClosestRayHitTest) {
+    for (int i = 0; i < 10; ++i) {
+        tree->Insert(CreateUnitAABB(static_cast<float>(i) * 3.0f, 0.0f, 0.0f), i);
+    }
+    tree->Insert(CreateUnitAABB(0.0f, 5.0f, 0.0f), 100);
+    auto wide = tree->Collapse();
+
+    Ray ray{ glm::vec3(40.0f, 0.5f, 0.5f), glm::vec3(-1.0f, 0.0f, 0.0f) };
+    float best = std::numeric_limits<float>::infinity();
+    int hit = -1;
+    wide.Raycast(ray.m_origin, 1.0f / ray.m_direction, best, [&](int data, float t) {
+        if (t < best) {
+            best = t;
+            hit = data;
+        }
+        return best;
+    });
+    EXPECT_EQ(hit, 9);
+    EXPECT_FLOAT_EQ(best, 12.0f);
+
+    // Returning the old tMax reports every box along the ray
+    int hits = 0;
+    wide.Raycast(ray.m_origin, 1.0f / ray.m_direction, 100.0f, [&](int, float) {
+        ++hits;
+        return 100.0f;
+    });
+    EXPECT_EQ(hits, 10);
+}
+
+TEST_F(AABBTreeTest, CollapsedTraverseTest) {
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::vector<AABB> boxes;
+    std::vector<int> datas;
+    for (int i = 0; i < 500; ++i) {
+        boxes.push_back(CreateUnitAABB(pos(rng), pos(rng), pos(rng)));
+        datas.push_back(i);
+    }
+    auto wide = AABBTree<int>::Build(boxes, datas).Collapse();
+
+    // Same leaves as Query for an overlap test
+    AABB query = CreateAABB(-10.0f, -10.0f, -10.0f, 10.0f, 10.0f, 10.0f);
+    std::vector<int> expected;
+    wide.Query(query, [&](int data) { expected.push_back(data); });
+    std::vector<int> found;
+    wide.Traverse(
+        [&](AABB const& box) { return Intersects(box, query); },
+        [&](int data, AABB const& box) {
+            EXPECT_EQ(box.m_min, boxes[data].m_min);
+            found.push_back(data);
+        });
+    std::sort(expected.begin(), expected.end());
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, expected);
+
+    // A tightening test finds the nearest box
+    glm::vec3 point(3.0f, -7.0f, 12.0f);
+    float best = std::numeric_limits<float>::infinity();
+    int nearest = -1;
+    wide.Traverse(
+        [&](AABB const& box) { return DistanceSquared(box, point) < best; },
+        [&](int data, AABB const& box) {
+            best = DistanceSquared(box, point);
+            nearest = data;
+        });
+    auto closest = std::min_element(boxes.begin(), boxes.end(), [&](AABB const& a, AABB const& b) {
+        return DistanceSquared(a, point) < DistanceSquared(b, point);
+    });
+    EXPECT_FLOAT_EQ(best, DistanceSquared(*closest, point));
+    EXPECT_EQ(nearest, static_cast<int>(closest - boxes.begin()));
+}
+
+TEST_F(AABBTreeTest, CollapsedSingleLeafTest) {
+    EXPECT_TRUE(tree->Collapse().IsEmpty());
+
+    tree->Insert(CreateUnitAABB(0.0f, 0.0f, 0.0f), 7);
+    auto wide = tree->Collapse();
+    ASSERT_EQ(wide.GetNodes().size(), 1u);
+    std::vector<int> found;
+    wide.Query(CreateUnitAABB(0.5f, 0.5f, 0.5f), [&](int data) { found.push_back(data); });
+    EXPECT_EQ(found, std::vector<int>{ 7 });
+    found.clear();
+    wide.Query(CreateUnitAABB(5.0f, 5.0f, 5.0f), [&](int data) { found.push_back(data); });
+    EXPECT_TRUE(found.empty());
+}
+
 TEST_F(AABBTreeTest, RemoveFromSingleNodeTreeTest) {
     AABB box = CreateUnitAABB(0.0f, 0.0f, 0.0f);
     int nodeIndex = tree->Insert(box, 42);
@@ -386,4 +651,22 @@ TEST_F(AABBTree2DTest, OverlapTest) {
     tree->Insert(CreateAABB2(0, 0, 2, 2), 1);
     tree->Insert(CreateAABB2(1, 1, 3, 3), 2);
     EXPECT_TRUE(tree->Validate());
-}
\ No newline at end of file
+}
+
+TEST_F(AABBTree2DTest, BulkBuild) {
+    std::vector<AABB2> boxes;
+    std::vector<int> datas;
+    for (int i = 0; i < 64; ++i) {
+        float x = static_cast<float>(i % 8) * 2.0f;
+        float y = static_cast<float>(i / 8) * 2.0f;
+        boxes.push_back(CreateAABB2(x, y, x + 1.0f, y + 1.0f));
+        datas.push_back(i);
+    }
+    auto built = AABBTree<int, AABB2>::Build(boxes, datas);
+    EXPECT_TRUE(built.Validate());
+
+    std::vector<int> found;
+    built.Query(CreateAABB2(0.5f, 0.5f, 2.5f, 2.5f), [&](int data, int) { found.push_back(data); });
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<int>{ 0, 1, 8, 9 }));
+}
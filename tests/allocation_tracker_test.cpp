@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "../allocation_tracker.hpp"
+#include "../profiler.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace okami;
+
+TEST(AllocationTrackerTest, CountsThreadAllocations) {
+    if constexpr (!kAllocationTrackingEnabled) {
+        GTEST_SKIP() << "Built without OKAMI_TRACK_ALLOCATIONS";
+    }
+
+    auto before = GetThreadAllocations();
+    auto totalBefore = GetTotalAllocations();
+    {
+        auto data = std::make_unique<std::vector<int>>(1000);
+        EXPECT_EQ(data->size(), 1000u);
+    }
+    auto delta = GetThreadAllocations() - before;
+    EXPECT_EQ(delta.m_count, 2u);
+    EXPECT_GE(delta.m_bytes, 1000 * sizeof(int));
+
+    auto totalDelta = GetTotalAllocations() - totalBefore;
+    EXPECT_GE(totalDelta.m_count, delta.m_count);
+}
+
+TEST(AllocationTrackerTest, OtherThreadsDoNotCountLocally) {
+    if constexpr (!kAllocationTrackingEnabled) {
+        GTEST_SKIP() << "Built without OKAMI_TRACK_ALLOCATIONS";
+    }
+
+    std::thread worker([] {
+        auto before = GetThreadAllocations();
+        std::vector<int> data(64);
+        EXPECT_EQ((GetThreadAllocations() - before).m_count, 1u);
+    });
+
+    auto before = GetThreadAllocations();
+    worker.join();
+    EXPECT_EQ((GetThreadAllocations() - before).m_count, 0u);
+}
+
+TEST(AllocationTrackerTest, ProfileScopesCarryAllocations) {
+    if constexpr (!kAllocationTrackingEnabled) {
+        GTEST_SKIP() << "Built without OKAMI_TRACK_ALLOCATIONS";
+    }
+
+    ClearProfile();
+    SetProfilerEnabled(true);
+    {
+        OKAMI_PROFILE_SCOPE("Allocating");
+        std::vector<int> a(16);
+        std::vector<int> b(16);
+    }
+    {
+        OKAMI_PROFILE_SCOPE("NotAllocating");
+    }
+    SetProfilerEnabled(false);
+
+    auto events = CollectProfileEvents();
+    ClearProfile();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_STREQ(events[0].m_name, "Allocating");
+    EXPECT_EQ(events[0].m_allocations.m_count, 2u);
+    EXPECT_EQ(events[1].m_allocations.m_count, 0u);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "../asset_pack.hpp"
+#include "../vfs.hpp"
+#include "asset_pack_writer.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    std::vector<uint8_t> Bytes(std::string_view text) {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    std::string Text(std::span<uint8_t const> bytes) {
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    class AssetPackTest : public ::testing::Test {
+    protected:
+        std::filesystem::path m_dir;
+
+        void SetUp() override {
+            m_dir = std::filesystem::temp_directory_path() / "okami_asset_pack_test";
+            std::filesystem::remove_all(m_dir);
+            std::filesystem::create_directories(m_dir / "assets" / "textures");
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(m_dir);
+        }
+
+        void WriteLoose(std::filesystem::path const& relPath, std::string_view text) {
+            std::ofstream file(m_dir / "assets" / relPath, std::ios::binary);
+            file << text;
+        }
+    };
+}
+
+TEST_F(AssetPackTest, RoundTripsThroughTheMappedTable) {
+    AssetPackWriter writer;
+    writer.AddData("textures/albedo.ktx2", Bytes("albedo"));
+    writer.AddData("models/./crate.glb", Bytes("crate"));
+    writer.AddData("empty.bin", {});
+    for (int i = 0; i < 100; ++i) {
+        writer.AddData("many/" + std::to_string(i), Bytes(std::to_string(i * i)));
+    }
+    writer.AddData("textures/albedo.ktx2", Bytes("albedo v2"));
+
+    auto packPath = m_dir / "test.okpak";
+    auto stats = writer.Write(packPath, {});
+    EXPECT_EQ(stats.entryCount, 103u);
+    EXPECT_FALSE(std::filesystem::exists(packPath.string() + ".tmp"));
+
+    auto pack = AssetPack::Open(packPath);
+    ASSERT_TRUE(pack) << pack.error();
+    EXPECT_EQ((*pack)->GetEntries().size(), 103u);
+
+    auto const* albedo = (*pack)->Find("textures/albedo.ktx2");
+    ASSERT_NE(albedo, nullptr);
+    EXPECT_EQ(Text((*pack)->GetStoredData(*albedo)), "albedo v2");
+    EXPECT_EQ((*pack)->GetName(*albedo), "textures/albedo.ktx2");
+
+    // Keys are normalized on both sides
+    auto const* crate = (*pack)->Find("models/crate.glb");
+    ASSERT_NE(crate, nullptr);
+    EXPECT_EQ(Text((*pack)->GetStoredData(*crate)), "crate");
+
+    auto const* empty = (*pack)->Find("empty.bin");
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(empty->m_size, 0u);
+
+    for (int i = 0; i < 100; ++i) {
+        auto const* entry = (*pack)->Find("many/" + std::to_string(i));
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(Text((*pack)->GetStoredData(*entry)), std::to_string(i * i));
+        EXPECT_EQ(entry->m_offset % kAssetPackDefaultAlignment, 0u);
+    }
+
+    EXPECT_EQ((*pack)->Find("textures/missing.ktx2"), nullptr);
+    EXPECT_EQ((*pack)->Find("albedo.ktx2"), nullptr);
+}
+
+TEST_F(AssetPackTest, RejectsFilesThatAreNotPacks) {
+    WriteLoose("bogus.okpak", "definitely not an asset pack, but long enough for a header");
+    EXPECT_FALSE(AssetPack::Open(m_dir / "assets" / "bogus.okpak"));
+    EXPECT_FALSE(AssetPack::Open(m_dir / "missing.okpak"));
+
+    VirtualFileSystem vfs(m_dir / "assets");
+    EXPECT_TRUE(vfs.Mount(m_dir / "assets" / "bogus.okpak").IsError());
+    EXPECT_EQ(vfs.GetMountCount(), 0u);
+}
+
+TEST_F(AssetPackTest, LaterPacksShadowEarlierOnesAndLooseFiles) {
+    WriteLoose("textures/a.txt", "loose a");
+    WriteLoose("textures/b.txt", "loose b");
+
+    AssetPackWriter base;
+    base.AddData("textures/a.txt", Bytes("base a"));
+    base.AddData("textures/c.txt", Bytes("base c"));
+    base.Write(m_dir / "assets" / "0_base.okpak", {});
+
+    AssetPackWriter patch;
+    patch.AddData("textures/a.txt", Bytes("patch a"));
+    patch.Write(m_dir / "assets" / "1_patch.okpak", {});
+
+    VirtualFileSystem vfs(m_dir / "assets");
+    ASSERT_FALSE(vfs.MountAll(vfs.GetRoot()).IsError());
+    EXPECT_EQ(vfs.GetMountCount(), 2u);
+
+    auto a = vfs.Read("textures/a.txt");
+    ASSERT_TRUE(a) << a.error();
+    EXPECT_EQ(a->GetString(), "patch a");
+    EXPECT_TRUE(a->IsMapped());
+
+    auto b = vfs.Read("textures/b.txt");
+    ASSERT_TRUE(b) << b.error();
+    EXPECT_EQ(b->GetString(), "loose b");
+    EXPECT_FALSE(b->IsMapped());
+
+    // Absolute paths inside the root are found in packs too
+    auto c = vfs.Read(m_dir / "assets" / "textures" / "c.txt");
+    ASSERT_TRUE(c) << c.error();
+    EXPECT_EQ(c->GetString(), "base c");
+    EXPECT_TRUE(vfs.Exists("textures/../textures/c.txt"));
+
+    EXPECT_FALSE(vfs.Exists("textures/d.txt"));
+    EXPECT_FALSE(vfs.Read("textures/d.txt"));
+
+    // Data read from a pack stays valid after it is unmounted
+    vfs.UnmountAll();
+    EXPECT_EQ(a->GetString(), "patch a");
+    EXPECT_EQ(vfs.Read("textures/a.txt")->GetString(), "loose a");
+    EXPECT_FALSE(vfs.Exists("textures/c.txt"));
+}
+
+TEST_F(AssetPackTest, CompressedAssetsAreDecompressedOnRead) {
+    if (!AssetPackWriter::SupportsCompression()) {
+        GTEST_SKIP() << "Built without zstd";
+    }
+
+    std::string repetitive(64 * 1024, 'x');
+    AssetPackWriter writer;
+    writer.AddData("big.txt", Bytes(repetitive));
+    writer.AddData("tiny.txt", Bytes("t"));
+
+    AssetPackWriter::Options options;
+    options.compress = true;
+    auto stats = writer.Write(m_dir / "assets" / "compressed.okpak", options);
+    EXPECT_EQ(stats.compressedCount, 1u);
+    EXPECT_LT(stats.packBytes, repetitive.size());
+
+    VirtualFileSystem vfs(m_dir / "assets");
+    ASSERT_FALSE(vfs.Mount(m_dir / "assets" / "compressed.okpak").IsError());
+
+    auto big = vfs.Read("big.txt");
+    ASSERT_TRUE(big) << big.error();
+    EXPECT_EQ(big->GetString(), repetitive);
+    EXPECT_FALSE(big->IsMapped());
+
+    // Not worth compressing, so read in place
+    auto tiny = vfs.Read("tiny.txt");
+    ASSERT_TRUE(tiny) << tiny.error();
+    EXPECT_EQ(tiny->GetString(), "t");
+    EXPECT_TRUE(tiny->IsMapped());
+}
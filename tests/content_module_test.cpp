@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "../content.hpp"
+
+#include <optional>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    struct FakeResource {
+        struct Desc {
+            int m_value = 0;
+        };
+        struct LoadParams {
+            int m_scale = 1;
+        };
+
+        int m_value = 0;
+    };
+
+    struct FakeImpl {
+        int m_value = 0;
+    };
+
+    class FakeContentModule final : public ContentModule<FakeResource, FakeImpl> {
+    public:
+        std::vector<int> m_created;
+        std::vector<int> m_destroyed;
+
+    protected:
+        Expected<std::pair<FakeResource::Desc, FakeImpl>> CreateResource(FakeResource&& data) override {
+            m_created.push_back(data.m_value);
+            return std::make_pair(FakeResource::Desc{ data.m_value }, FakeImpl{ data.m_value });
+        }
+
+        void DestroyResourceImpl(FakeImpl& impl) override {
+            m_destroyed.push_back(impl.m_value);
+        }
+    };
+}
+
+class ContentModuleTest : public ::testing::Test {
+protected:
+    MessageBus m_bus;
+    InterfaceCollection m_interfaces;
+    entt::registry m_registry;
+    InitContext m_context{ m_bus, m_interfaces, m_registry };
+    DefaultSignalHandler<LoadResourceSignal<FakeResource>> m_loads;
+    FakeContentModule m_module;
+
+    void SetUp() override {
+        m_interfaces.RegisterSignalHandler<LoadResourceSignal<FakeResource>>(&m_loads);
+        ASSERT_FALSE(m_module.Register(m_interfaces).IsError());
+        ASSERT_FALSE(m_module.Startup(m_context).IsError());
+    }
+
+    void TearDown() override {
+        m_module.Shutdown(m_context);
+    }
+
+    // Load requests sent since the last call
+    std::vector<LoadResourceSignal<FakeResource>> TakeLoads() {
+        std::vector<LoadResourceSignal<FakeResource>> loads;
+        m_loads.Handle([&](LoadResourceSignal<FakeResource> load) {
+            loads.push_back(std::move(load));
+        });
+        return loads;
+    }
+
+    // Reports a load as finished, as the IO thread does
+    void FinishLoad(uint32_t id, int value) {
+        m_interfaces.SendSignal(OnResourceLoadedEvent<FakeResource>{
+            .m_data = FakeResource{ value },
+            .m_id = id,
+        });
+    }
+
+    void Receive() {
+        ASSERT_FALSE(m_module.ReceiveMessages(m_bus, RecieveMessagesParams{ m_registry }).IsError());
+    }
+};
+
+TEST_F(ContentModuleTest, LoadReturnsTheExistingResourceForAPath) {
+    auto first = m_module.Load("a.fake", {}, m_interfaces);
+    auto second = m_module.Load("a.fake", {}, m_interfaces);
+    EXPECT_EQ(first.Ptr(), second.Ptr());
+    EXPECT_EQ(first.GetId(), second.GetId());
+    EXPECT_EQ(m_module.GetResourceCount(), 1u);
+
+    auto loads = TakeLoads();
+    ASSERT_EQ(loads.size(), 1u);
+    EXPECT_EQ(loads[0].m_id, first.GetId());
+
+    FinishLoad(loads[0].m_id, 42);
+    Receive();
+    ASSERT_TRUE(second.IsLoaded());
+    EXPECT_EQ(second->m_value, 42);
+    ASSERT_NE(m_module.GetImpl(first), nullptr);
+    EXPECT_EQ(m_module.GetImpl(first)->m_value, 42);
+
+    // Still the same resource once loaded, without loading it again
+    auto third = m_module.Load("a.fake", {}, m_interfaces);
+    EXPECT_EQ(third.Ptr(), first.Ptr());
+    EXPECT_TRUE(TakeLoads().empty());
+}
+
+TEST_F(ContentModuleTest, CancelsTheLoadOnlyOnceTheResourceIsDestroyed) {
+    ResourceId id;
+    {
+        auto handle = m_module.Load("b.fake", {}, m_interfaces);
+        id = handle.GetId();
+    }
+    auto loads = TakeLoads();
+    ASSERT_EQ(loads.size(), 1u);
+    EXPECT_FALSE(loads[0].m_cancelled->load());
+
+    // Picked up again before the destroy ran: the same resource, still
+    // waiting on its first load
+    std::optional<ResHandle<FakeResource>> handle = m_module.Load("b.fake", {}, m_interfaces);
+    EXPECT_EQ(handle->GetId(), id);
+    EXPECT_TRUE(TakeLoads().empty());
+
+    Receive();
+    EXPECT_EQ(m_module.GetResourceCount(), 1u);
+    EXPECT_TRUE(m_module.m_destroyed.empty());
+    EXPECT_FALSE(loads[0].m_cancelled->load());
+
+    // Dropped for good: the queued load is skipped
+    handle.reset();
+    Receive();
+    EXPECT_EQ(m_module.GetResourceCount(), 0u);
+    EXPECT_TRUE(loads[0].m_cancelled->load());
+}
+
+TEST_F(ContentModuleTest, DestroysOnlyOnceNoHandlesRemain) {
+    std::optional<ResHandle<FakeResource>> kept = m_module.Load("kept.fake", {}, m_interfaces);
+    std::optional<ResHandle<FakeResource>> dropped = m_module.Load("dropped.fake", {}, m_interfaces);
+    for (auto const& load : TakeLoads()) {
+        FinishLoad(load.m_id, load.m_path == "kept.fake" ? 1 : 2);
+    }
+    Receive();
+    ASSERT_TRUE(kept->IsLoaded());
+    ASSERT_TRUE(dropped->IsLoaded());
+
+    // Both go to zero, but kept.fake is loaded again before the destroys
+    // are processed
+    const auto droppedId = dropped->GetId();
+    dropped.reset();
+    kept.reset();
+    kept = m_module.Load("kept.fake", {}, m_interfaces);
+    EXPECT_TRUE(TakeLoads().empty());
+
+    Receive();
+    EXPECT_EQ(m_module.m_destroyed, std::vector<int>{ 2 });
+    EXPECT_EQ(m_module.GetResourceCount(), 1u);
+    ASSERT_TRUE(kept->IsLoaded());
+    EXPECT_EQ(m_module.GetImpl(*kept)->m_value, 1);
+
+    // The destroyed path loads afresh
+    auto again = m_module.Load("dropped.fake", {}, m_interfaces);
+    EXPECT_NE(again.GetId(), droppedId);
+    EXPECT_FALSE(again.IsLoaded());
+    EXPECT_EQ(TakeLoads().size(), 1u);
+}
+
+TEST_F(ContentModuleTest, DropsALoadThatFinishesAfterItsSlotWasReused) {
+    {
+        auto handle = m_module.Load("old.fake", {}, m_interfaces);
+    }
+    auto oldLoads = TakeLoads();
+    ASSERT_EQ(oldLoads.size(), 1u);
+    Receive();
+    EXPECT_EQ(m_module.GetResourceCount(), 0u);
+
+    auto handle = m_module.Load("new.fake", {}, m_interfaces);
+    auto newLoads = TakeLoads();
+    ASSERT_EQ(newLoads.size(), 1u);
+    using Table = ResourceTable<int>;
+    ASSERT_EQ(Table::GetIndex(newLoads[0].m_id), Table::GetIndex(oldLoads[0].m_id));
+    ASSERT_NE(newLoads[0].m_id, oldLoads[0].m_id);
+
+    // The old load was already running and reports back late
+    FinishLoad(oldLoads[0].m_id, 1);
+    Receive();
+    EXPECT_FALSE(handle.IsLoaded());
+    EXPECT_TRUE(m_module.m_created.empty());
+
+    FinishLoad(newLoads[0].m_id, 2);
+    Receive();
+    ASSERT_TRUE(handle.IsLoaded());
+    EXPECT_EQ(handle->m_value, 2);
+    EXPECT_EQ(m_module.m_created, std::vector<int>{ 2 });
+}
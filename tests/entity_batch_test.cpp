@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "../engine.hpp"
+#include "../transform.hpp"
+
+#include <entt/entt.hpp>
+
+using namespace okami;
+
+TEST(EntityBatchTest, SendsOneBatchPerSignalType) {
+    entt::registry registry;
+    std::vector<entity_t> entities(4);
+    registry.create(entities.begin(), entities.end());
+    auto parent = registry.create();
+
+    EntityBatch batch(entities, parent);
+    batch.SetParent(3, entities[0]);
+    batch.SetName(1, "Named");
+    for (size_t i = 0; i < batch.GetSize(); ++i) {
+        batch.Add(i, Transform::Translate(static_cast<float>(i), 0.0f, 0.0f));
+    }
+
+    MessageBus bus;
+    batch.Send(bus);
+    EXPECT_EQ(batch.GetSize(), 0u);
+
+    auto* created = bus.GetPort<EntityCreatedSignal>();
+    ASSERT_NE(created, nullptr);
+    ASSERT_EQ(created->m_messages.size(), 4u);
+    EXPECT_EQ(created->m_messages[2].m_entity, entities[2]);
+
+    auto* parents = bus.GetPort<EntityParentChangeSignal>();
+    ASSERT_NE(parents, nullptr);
+    ASSERT_EQ(parents->m_messages.size(), 4u);
+    EXPECT_EQ(parents->m_messages[0].m_newParent, parent);
+    EXPECT_EQ(parents->m_messages[3].m_newParent, entities[0]);
+
+    auto* names = bus.GetPort<AddComponentSignal<NameComponent>>();
+    ASSERT_NE(names, nullptr);
+    ASSERT_EQ(names->m_messages.size(), 1u);
+    EXPECT_EQ(names->m_messages[0].m_entity, entities[1]);
+    EXPECT_EQ(names->m_messages[0].m_component.m_name, "Named");
+
+    auto* transforms = bus.GetPort<AddComponentSignal<Transform>>();
+    ASSERT_NE(transforms, nullptr);
+    EXPECT_EQ(transforms->m_messages.size(), 4u);
+}
+
+TEST(EntityBatchTest, SpawnedBatchIsLinkedIntoTheTree) {
+    Engine en;
+    ASSERT_FALSE(en.Startup().IsError());
+
+    constexpr size_t kCount = 1000;
+    auto batch = en.CreateEntityBatch(kCount);
+    std::vector<entity_t> entities(batch.GetEntities().begin(), batch.GetEntities().end());
+    for (size_t i = 0; i < kCount; ++i) {
+        if (i > 0) {
+            batch.SetParent(i, entities[0]);
+        }
+        batch.Add(i, Transform::Translate(static_cast<float>(i), 0.0f, 0.0f));
+    }
+    en.SpawnBatch(batch);
+
+    RunParams params;
+    params.frameCount = 1;
+    params.frameTime = 1.0 / 60.0;
+    en.Run(params);
+
+    auto const& registry = en.GetRegistry();
+    auto root = registry.ctx().get<EntityManagerCtx>().m_rootEntity;
+    EXPECT_EQ(registry.get<EntityTreeComponent>(entities[0]).m_parent, root);
+
+    // Children keep batch order
+    size_t index = 1;
+    for (auto child = registry.get<EntityTreeComponent>(entities[0]).m_firstChild;
+        child != kNullEntity;
+        child = registry.get<EntityTreeComponent>(child).m_nextSibling) {
+        ASSERT_LT(index, kCount);
+        EXPECT_EQ(child, entities[index]);
+        EXPECT_FLOAT_EQ(registry.get<Transform>(child).m_position.x, static_cast<float>(index));
+        ++index;
+    }
+    EXPECT_EQ(index, kCount);
+
+    en.Shutdown();
+}
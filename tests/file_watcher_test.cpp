@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "../file_watcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    class FileWatcherTest : public ::testing::Test {
+    protected:
+        std::filesystem::path m_dir;
+
+        void SetUp() override {
+            m_dir = std::filesystem::temp_directory_path() / "okami_file_watcher_test";
+            std::filesystem::remove_all(m_dir);
+            std::filesystem::create_directories(m_dir / "textures");
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(m_dir);
+        }
+
+        void Write(std::filesystem::path const& relPath, std::string_view text) {
+            std::ofstream file(m_dir / relPath, std::ios::binary);
+            file << text;
+        }
+
+        // Collects changes until 'path' shows up, or gives up after a few
+        // seconds; the polling fallback only rescans every kPollInterval
+        static std::vector<FileChange> WaitFor(FileWatcher& watcher, std::filesystem::path const& path) {
+            std::vector<FileChange> all;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (std::chrono::steady_clock::now() < deadline) {
+                auto changes = watcher.Wait(std::chrono::milliseconds(100));
+                all.insert(all.end(), changes.begin(), changes.end());
+                if (Find(all, path)) {
+                    break;
+                }
+            }
+            return all;
+        }
+
+        static FileChange const* Find(std::vector<FileChange> const& changes, std::filesystem::path const& path) {
+            auto it = std::find_if(changes.begin(), changes.end(), [&](FileChange const& change) {
+                return change.m_path.generic_string() == path.generic_string();
+            });
+            return it == changes.end() ? nullptr : &*it;
+        }
+    };
+}
+
+TEST_F(FileWatcherTest, ReportsAddedModifiedAndRemovedFiles) {
+    Write("textures/existing.txt", "v1");
+
+    FileWatcher watcher(m_dir);
+    ASSERT_TRUE(watcher.IsWatching());
+    EXPECT_TRUE(watcher.Poll().empty());
+
+    Write("textures/new.txt", "new");
+    auto changes = WaitFor(watcher, "textures/new.txt");
+    auto const* added = Find(changes, "textures/new.txt");
+    ASSERT_NE(added, nullptr);
+    EXPECT_EQ(added->m_type, FileChangeType::Added);
+
+    Write("textures/existing.txt", "version two");
+    changes = WaitFor(watcher, "textures/existing.txt");
+    auto const* modified = Find(changes, "textures/existing.txt");
+    ASSERT_NE(modified, nullptr);
+    EXPECT_EQ(modified->m_type, FileChangeType::Modified);
+
+    std::filesystem::remove(m_dir / "textures" / "existing.txt");
+    changes = WaitFor(watcher, "textures/existing.txt");
+    auto const* removed = Find(changes, "textures/existing.txt");
+    ASSERT_NE(removed, nullptr);
+    EXPECT_EQ(removed->m_type, FileChangeType::Removed);
+}
+
+TEST_F(FileWatcherTest, WatchesDirectoriesCreatedAfterStartup) {
+    FileWatcher watcher(m_dir);
+    ASSERT_TRUE(watcher.IsWatching());
+
+    std::filesystem::create_directories(m_dir / "models" / "props");
+    Write("models/props/crate.glb", "crate");
+    auto changes = WaitFor(watcher, "models/props/crate.glb");
+    ASSERT_NE(Find(changes, "models/props/crate.glb"), nullptr);
+
+    // The new directory is watched from then on
+    Write("models/props/crate.glb", "crate v2");
+    changes = WaitFor(watcher, "models/props/crate.glb");
+    auto const* modified = Find(changes, "models/props/crate.glb");
+    ASSERT_NE(modified, nullptr);
+    EXPECT_EQ(modified->m_type, FileChangeType::Modified);
+}
+
+TEST_F(FileWatcherTest, MissingRootIsNotWatched) {
+    FileWatcher watcher(m_dir / "missing");
+    EXPECT_FALSE(watcher.IsWatching());
+    EXPECT_TRUE(watcher.Poll().empty());
+}
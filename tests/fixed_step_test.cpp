@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "../fixed_step.hpp"
+
+using namespace okami;
+
+TEST(FixedStepClockTest, MatchingFrameTimeStepsOncePerFrame) {
+    FixedStepClock clock(1.0 / 60.0);
+    for (int frame = 0; frame < 600; ++frame) {
+        ASSERT_EQ(clock.Advance(1.0 / 60.0), 1u) << "frame " << frame;
+        clock.Step();
+    }
+    EXPECT_EQ(clock.GetStepCount(), 600u);
+    EXPECT_EQ(clock.GetDroppedTime(), 0.0);
+}
+
+TEST(FixedStepClockTest, FastFramesSkipSteps) {
+    FixedStepClock clock(1.0 / 30.0);
+
+    EXPECT_EQ(clock.Advance(1.0 / 120.0), 0u);
+    EXPECT_NEAR(clock.GetAlpha(), 0.25f, 1e-5f);
+    EXPECT_EQ(clock.Advance(1.0 / 120.0), 0u);
+    EXPECT_EQ(clock.Advance(1.0 / 120.0), 0u);
+    EXPECT_NEAR(clock.GetAlpha(), 0.75f, 1e-5f);
+
+    ASSERT_EQ(clock.Advance(1.0 / 120.0), 1u);
+    clock.Step();
+    EXPECT_NEAR(clock.GetAlpha(), 0.0f, 1e-5f);
+}
+
+TEST(FixedStepClockTest, SlowFramesCatchUpWithinLimit) {
+    FixedStepClock clock(0.01, 4);
+
+    ASSERT_EQ(clock.Advance(0.035), 3u);
+    for (int i = 0; i < 3; ++i) {
+        clock.Step();
+    }
+    EXPECT_NEAR(clock.GetAlpha(), 0.5f, 1e-5f);
+    EXPECT_EQ(clock.GetDroppedTime(), 0.0);
+
+    // A long stall runs at most four steps and forgets the rest
+    ASSERT_EQ(clock.Advance(1.0), 4u);
+    for (int i = 0; i < 4; ++i) {
+        clock.Step();
+    }
+    EXPECT_NEAR(clock.GetDroppedTime(), 1.005 - 0.04, 1e-9);
+    EXPECT_EQ(clock.Advance(0.0), 0u);
+}
+
+TEST(FixedStepClockTest, StepTimeAdvancesByStep) {
+    FixedStepClock clock(0.5);
+    ASSERT_EQ(clock.Advance(1.0), 2u);
+
+    auto first = clock.GetStepTime();
+    EXPECT_EQ(first.m_deltaTime, 0.5);
+    EXPECT_EQ(first.m_lastFrameTime, 0.0);
+    EXPECT_EQ(first.m_nextFrameTime, 0.5);
+    EXPECT_EQ(first.m_nextFrame, 0u);
+    clock.Step();
+
+    auto second = clock.GetStepTime();
+    EXPECT_EQ(second.m_lastFrameTime, 0.5);
+    EXPECT_EQ(second.m_nextFrame, 1u);
+}
+
+TEST(FixedStepInterpolationTest, BlendsBetweenLastTwoSteps) {
+    entt::registry registry;
+    auto moving = registry.create();
+    auto spawned = registry.create();
+    registry.emplace<Transform>(moving, Transform::Translate(0.0f, 0.0f, 0.0f));
+
+    SavePreviousTransforms(registry);
+    registry.get<Transform>(moving) = Transform::Translate(2.0f, 0.0f, 0.0f);
+    // Created during the step, so it has no previous state yet
+    registry.emplace<Transform>(spawned, Transform::Translate(5.0f, 0.0f, 0.0f));
+
+    entt::registry snapshot;
+    for (auto entity : { moving, spawned }) {
+        snapshot.create(entity);
+        snapshot.emplace<Transform>(entity, registry.get<Transform>(entity));
+    }
+    InterpolateTransforms(registry, snapshot, 0.25f);
+
+    EXPECT_NEAR(snapshot.get<Transform>(moving).m_position.x, 0.5f, 1e-5f);
+    EXPECT_EQ(snapshot.get<Transform>(spawned).m_position.x, 5.0f);
+    // The simulation state itself is untouched
+    EXPECT_EQ(registry.get<Transform>(moving).m_position.x, 2.0f);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "../frame_allocator.hpp"
+#include "../jobs.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace okami;
+
+TEST(FrameAllocatorTest, AllocationsAreAlignedAndDistinct) {
+    FrameArena arena(1024);
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    void* c = arena.allocate(16, 64);
+    EXPECT_NE(a, b);
+    EXPECT_NE(b, c);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0u);
+    EXPECT_GE(arena.GetBytesUsed(), 3u + 8u + 16u);
+}
+
+TEST(FrameAllocatorTest, ResetReusesMemory) {
+    FrameArena arena(1024);
+    void* first = arena.allocate(64, 16);
+    arena.Reset();
+    EXPECT_EQ(arena.GetBytesUsed(), 0u);
+    EXPECT_EQ(arena.allocate(64, 16), first);
+}
+
+TEST(FrameAllocatorTest, OverflowingFrameCoalescesOnReset) {
+    FrameArena arena(256);
+    for (int i = 0; i < 16; ++i) {
+        arena.allocate(100, 8);
+    }
+    // Larger than a block
+    void* large = arena.allocate(4096, 8);
+    std::memset(large, 0xAB, 4096);
+    auto used = arena.GetBytesUsed();
+    EXPECT_GE(used, 16u * 100u + 4096u);
+
+    arena.Reset();
+    EXPECT_EQ(arena.GetPeakBytesUsed(), used);
+
+    // The whole previous frame now fits without growing
+    auto capacity = arena.GetCapacity();
+    for (int i = 0; i < 16; ++i) {
+        arena.allocate(100, 8);
+    }
+    arena.allocate(4096, 8);
+    EXPECT_EQ(arena.GetCapacity(), capacity);
+}
+
+TEST(FrameAllocatorTest, PmrContainersUseArena) {
+    FrameArena arena;
+    std::pmr::vector<std::pmr::string> strings(&arena);
+    for (int i = 0; i < 100; ++i) {
+        strings.emplace_back("a string long enough to skip the small buffer " + std::to_string(i));
+    }
+    EXPECT_EQ(strings.size(), 100u);
+    EXPECT_EQ(strings[42].get_allocator().resource(), &arena);
+    EXPECT_GT(arena.GetBytesUsed(), 100u * sizeof(std::pmr::string));
+}
+
+TEST(FrameAllocatorTest, ThreadArenasAreDistinct) {
+    FrameAllocator allocator;
+    FrameArena* mainArena = &allocator.GetThreadArena();
+    EXPECT_EQ(&allocator.GetThreadArena(), mainArena);
+
+    FrameArena* workerArena = nullptr;
+    std::thread worker([&] {
+        workerArena = &allocator.GetThreadArena();
+        workerArena->allocate(128, 8);
+    });
+    worker.join();
+
+    EXPECT_NE(workerArena, mainArena);
+    EXPECT_GE(allocator.GetBytesUsed(), 128u);
+    allocator.Reset();
+    EXPECT_EQ(allocator.GetBytesUsed(), 0u);
+
+    // A second allocator on the same thread gets its own arena
+    FrameAllocator other;
+    EXPECT_NE(&other.GetThreadArena(), mainArena);
+}
+
+TEST(FrameAllocatorTest, JobContextFallsBackToHeap) {
+    MessageBus bus;
+    JobContext context{ .m_messageBus = bus };
+    EXPECT_EQ(context.GetFrameResource(), std::pmr::new_delete_resource());
+
+    FrameAllocator allocator;
+    JobContext frameContext{ .m_messageBus = bus, .m_frameAllocator = &allocator };
+    EXPECT_EQ(frameContext.GetFrameResource(), &allocator.GetThreadArena());
+}
+
+TEST(FrameAllocatorTest, MessagePortsReleaseArenaStorage) {
+    FrameAllocator allocator;
+    MessageBus bus(&allocator.GetSharedArena());
+    for (int i = 0; i < 100; ++i) {
+        bus.Send(i);
+    }
+    auto* port = bus.GetPort<int>();
+    ASSERT_NE(port, nullptr);
+    EXPECT_EQ(port->m_messages.size(), 100u);
+    EXPECT_GE(allocator.GetSharedArena().GetBytesUsed(), 100u * sizeof(int));
+
+    bus.Release();
+    allocator.Reset();
+    EXPECT_TRUE(port->m_messages.empty());
+    EXPECT_EQ(port->m_messages.capacity(), 0u);
+
+    bus.Send(7);
+    EXPECT_EQ(port->m_messages[0], 7);
+}
+
+TEST(FrameAllocatorTest, ClaimedArenasSkipGlobalReset) {
+    FrameAllocator allocator;
+    std::thread worker([&] {
+        allocator.ClaimThreadArena();
+        auto& arena = allocator.GetThreadArena();
+        arena.allocate(256, 8);
+
+        allocator.Reset();
+        EXPECT_GE(arena.GetBytesUsed(), 256u);
+
+        allocator.ResetThreadArena();
+        EXPECT_EQ(arena.GetBytesUsed(), 0u);
+    });
+    worker.join();
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include "frame_stats.hpp"
+
+using namespace okami;
+
+TEST(FrameStatsTest, EmptySeriesIsZero) {
+    auto s = Summarize({});
+    EXPECT_EQ(s.m_mean, 0.0);
+    EXPECT_EQ(s.m_p99, 0.0);
+}
+
+TEST(FrameStatsTest, NearestRankPercentiles) {
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; --i) {
+        samples.push_back(static_cast<double>(i));
+    }
+    auto s = Summarize(samples);
+    EXPECT_DOUBLE_EQ(s.m_min, 1.0);
+    EXPECT_DOUBLE_EQ(s.m_max, 100.0);
+    EXPECT_DOUBLE_EQ(s.m_mean, 50.5);
+    EXPECT_DOUBLE_EQ(s.m_p50, 50.0);
+    EXPECT_DOUBLE_EQ(s.m_p95, 95.0);
+    EXPECT_DOUBLE_EQ(s.m_p99, 99.0);
+}
+
+TEST(FrameStatsTest, SingleSample) {
+    auto s = Summarize({ 4.0 });
+    EXPECT_DOUBLE_EQ(s.m_p50, 4.0);
+    EXPECT_DOUBLE_EQ(s.m_p99, 4.0);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "../engine.hpp"
+#include "../gltf_scene.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace okami;
+
+namespace {
+    // One triangle, referenced by every primitive below
+    constexpr const char* kSceneJson = R"({
+        "asset": { "version": "2.0" },
+        "buffers": [{
+            "byteLength": 36,
+            "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAA"
+        }],
+        "bufferViews": [{ "buffer": 0, "byteOffset": 0, "byteLength": 36 }],
+        "accessors": [{
+            "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+            "min": [0, 0, 0], "max": [1, 1, 0]
+        }],
+        "meshes": [
+            { "primitives": [{ "attributes": { "POSITION": 0 } }] },
+            { "primitives": [
+                { "attributes": { "POSITION": 0 } },
+                { "attributes": { "POSITION": 0 } }
+            ] }
+        ],
+        "nodes": [
+            { "mesh": 0 },
+            { "mesh": 0, "translation": [2, 0, 0] },
+            { "children": [3] },
+            { "mesh": 1 },
+            { "mesh": 0, "translation": [0, 2, 0] }
+        ],
+        "scenes": [{ "nodes": [0, 1, 2, 4] }],
+        "scene": 0
+    })";
+
+    class FakeGeometry final : public IGeometry {
+    public:
+        GeometryDesc m_desc;
+
+        GeometryDesc const& GetDesc() const override { return m_desc; }
+        bool IsLoaded() const override { return true; }
+    };
+
+    // Counts the geometry the scene asks for
+    class FakeGeometryManager final : public EngineModule, public IGeometryManager {
+    public:
+        size_t m_loaded = 0;
+        size_t m_created = 0;
+
+        GeometryHandle LoadGeometry(
+            std::filesystem::path const&,
+            GeometryLoadParams,
+            InterfaceCollection&,
+            LoadPriority) override {
+            ++m_loaded;
+            return std::make_shared<FakeGeometry>();
+        }
+
+        GeometryHandle CreateGeometry(Geometry data) override {
+            ++m_created;
+            auto geometry = std::make_shared<FakeGeometry>();
+            geometry->m_desc = data.GetDesc();
+            return geometry;
+        }
+
+    protected:
+        Error RegisterImpl(InterfaceCollection& interfaces) override {
+            interfaces.Register<IGeometryManager>(this);
+            return {};
+        }
+    };
+
+    struct FakeGeometryManagerFactory {
+        std::unique_ptr<FakeGeometryManager> operator()() {
+            return std::make_unique<FakeGeometryManager>();
+        }
+    };
+
+    class GltfSceneTest : public ::testing::Test {
+    protected:
+        std::filesystem::path m_path;
+
+        void SetUp() override {
+            auto dir = std::filesystem::temp_directory_path() / "okami_gltf_scene_test";
+            std::filesystem::create_directories(dir);
+            m_path = dir / "shared_meshes.gltf";
+            std::ofstream file(m_path, std::ios::binary);
+            file << kSceneJson;
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(m_path.parent_path());
+        }
+    };
+}
+
+TEST_F(GltfSceneTest, ExtractsEachMeshPrimitiveOnce) {
+    auto scene = GltfScene::FromFile(m_path);
+    ASSERT_TRUE(scene.has_value()) << scene.error();
+    auto const& desc = scene->m_data;
+
+    // Mesh 0 is used by three nodes, mesh 1 (two primitives) by one
+    ASSERT_EQ(desc.m_meshInstances.size(), 5u);
+    EXPECT_EQ(desc.m_geometries.size(), 3u);
+
+    for (auto const& instance : desc.m_meshInstances) {
+        ASSERT_GE(instance.m_geometryIndex, 0);
+        ASSERT_LT(instance.m_geometryIndex, static_cast<int>(desc.m_geometries.size()));
+    }
+    // Depth-first node order: nodes 0, 1, then 3 (under 2), then 4
+    EXPECT_EQ(desc.m_meshInstances[0].m_geometryIndex, desc.m_meshInstances[1].m_geometryIndex);
+    EXPECT_EQ(desc.m_meshInstances[0].m_geometryIndex, desc.m_meshInstances[4].m_geometryIndex);
+    EXPECT_NE(desc.m_meshInstances[2].m_geometryIndex, desc.m_meshInstances[3].m_geometryIndex);
+    EXPECT_NE(desc.m_meshInstances[0].m_geometryIndex, desc.m_meshInstances[2].m_geometryIndex);
+    EXPECT_NE(desc.m_meshInstances[0].m_geometryIndex, desc.m_meshInstances[3].m_geometryIndex);
+}
+
+TEST_F(GltfSceneTest, SpawnCreatesEachGeometryOnce) {
+    auto scene = GltfScene::FromFile(m_path);
+    ASSERT_TRUE(scene.has_value()) << scene.error();
+
+    Engine en;
+    auto* geometries = en.CreateModule(FakeGeometryManagerFactory{});
+    ASSERT_FALSE(en.Startup().IsError());
+
+    SpawnGltfScene(en, std::move(scene->m_data));
+    EXPECT_EQ(geometries->m_created, 3u);
+    EXPECT_EQ(geometries->m_loaded, 0u);
+}
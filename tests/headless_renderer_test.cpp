@@ -105,8 +105,12 @@ protected:
 
     // Run a sample headlessly and compare frame 0 (the initial rendered frame,
     // before any accumulated script updates) against the named golden image.
+    //
+    // Pipelined runs (frameLatency > 0) render the state after each frame's
+    // simulation instead of before it, so they produce one frame fewer and
+    // their last frame matches the serial run's last frame.
     template <typename TSample>
-    void RunHeadlessSample(const char* captureName, const char* goldenName) {
+    void RunHeadlessSample(const char* captureName, const char* goldenName, uint32_t frameLatency = 0) {
         auto captureDir = CaptureDir(captureName);
 
         TSample sample;
@@ -118,13 +122,15 @@ protected:
         RunParams params;
         params.frameCount = sample.GetTestFrameCount();
         params.frameTime = 1.0 / 60.0; // 60 FPS
+        params.frameLatency = frameLatency;
         en.Run(params);
         en.Shutdown();
 
         // Frame 0 is the first rendered output, before any script updates have
         // had a chance to mutate scene state, so it is deterministic regardless
         // of frame timing.
-        CompareWithGoldenImage(FramePath(captureDir, sample.GetTestFrameCount()), goldenName);
+        auto lastFrame = sample.GetTestFrameCount() - (frameLatency > 0 ? 1 : 0);
+        CompareWithGoldenImage(FramePath(captureDir, lastFrame), goldenName);
     }
 };
 
@@ -136,6 +142,14 @@ TEST_F(HeadlessRendererTest, HelloWorld) {
     RunHeadlessSample<sample_hello_world::HelloWorldSample>("hello_world", "hello_world.png");
 }
 
+TEST_F(HeadlessRendererTest, HelloWorldPipelined) {
+    RunHeadlessSample<sample_hello_world::HelloWorldSample>("hello_world_pipelined", "hello_world.png", 1);
+}
+
+TEST_F(HeadlessRendererTest, HelloWorldPipelinedLatency2) {
+    RunHeadlessSample<sample_hello_world::HelloWorldSample>("hello_world_pipelined_2", "hello_world.png", 2);
+}
+
 // ---------------------------------------------------------------------------
 // Sample 02 – Zoo
 // ---------------------------------------------------------------------------
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "../input_recording.hpp"
+
+using namespace okami;
+
+namespace {
+    IOState MakeIOState(std::initializer_list<Key> keys, double cursorX, double cursorY, double prevX, double prevY) {
+        IOState io;
+        for (auto key : keys) {
+            io.m_keyboard.m_keyStates[static_cast<size_t>(key)] = true;
+        }
+        io.m_mouse.m_cursorX = cursorX;
+        io.m_mouse.m_cursorY = cursorY;
+        io.m_mouse.m_deltaX = cursorX - prevX;
+        io.m_mouse.m_deltaY = cursorY - prevY;
+        return io;
+    }
+
+    template <typename T>
+    std::vector<T> Drain(MessageBus const& bus) {
+        std::vector<T> messages;
+        if (auto* port = bus.GetPort<T>()) {
+            messages.assign(port->m_messages.begin(), port->m_messages.end());
+        }
+        return messages;
+    }
+}
+
+TEST(InputRecordingTest, RoundTripsFrames) {
+    InputRecorder recorder;
+    MessageBus bus;
+
+    bus.Send(Time{ .m_deltaTime = 0.016 });
+    bus.Send(MakeIOState({ Key::W }, 10.0, 20.0, 0.0, 0.0));
+    bus.Send(KeyMessage{ Key::W, Action::Press });
+    bus.Send(ScrollMessage{ 0.0, -1.5 });
+    recorder.Capture(bus);
+    bus.Clear();
+
+    // Nothing changed and no events: only flags and time are written
+    bus.Send(Time{ .m_deltaTime = 0.017 });
+    bus.Send(MakeIOState({ Key::W }, 10.0, 20.0, 10.0, 20.0));
+    recorder.Capture(bus);
+    bus.Clear();
+
+    auto io = MakeIOState({ Key::A, Key::LeftShift }, 12.0, 18.0, 10.0, 20.0);
+    io.m_mouse.m_buttonStates[MouseButton::Right] = true;
+    bus.Send(Time{ .m_deltaTime = 0.015 });
+    bus.Send(io);
+    bus.Send(MouseButtonMessage{ MouseButton::Right, Action::Press });
+    bus.Send(CharMessage{ 'a' });
+    recorder.Capture(bus);
+
+    ASSERT_EQ(recorder.GetFrameCount(), 3u);
+
+    auto replay = InputReplay::Deserialize(recorder.Serialize());
+    ASSERT_TRUE(replay.has_value()) << replay.error();
+    ASSERT_EQ(replay->GetFrameCount(), 3u);
+
+    auto frames = replay->GetFrames();
+    EXPECT_EQ(frames[0].m_deltaTime, 0.016);
+    EXPECT_TRUE(frames[0].m_ioState.m_keyboard.IsKeyPressed(Key::W));
+    ASSERT_EQ(frames[0].m_keys.size(), 1u);
+    EXPECT_EQ(frames[0].m_keys[0].m_key, Key::W);
+    ASSERT_EQ(frames[0].m_scrolls.size(), 1u);
+    EXPECT_EQ(frames[0].m_scrolls[0].m_yOffset, -1.5);
+    EXPECT_EQ(frames[0].m_ioState.m_mouse.m_deltaX, 10.0);
+
+    EXPECT_TRUE(frames[1].m_ioState.m_keyboard.IsKeyPressed(Key::W));
+    EXPECT_EQ(frames[1].m_ioState.m_mouse.m_cursorY, 20.0);
+    EXPECT_EQ(frames[1].m_ioState.m_mouse.m_deltaY, 0.0);
+    EXPECT_TRUE(frames[1].m_keys.empty());
+
+    EXPECT_FALSE(frames[2].m_ioState.m_keyboard.IsKeyPressed(Key::W));
+    EXPECT_TRUE(frames[2].m_ioState.m_keyboard.IsKeyPressed(Key::LeftShift));
+    EXPECT_TRUE(frames[2].m_ioState.m_mouse.IsButtonPressed(MouseButton::Right));
+    EXPECT_EQ(frames[2].m_ioState.m_mouse.m_deltaX, 2.0);
+    ASSERT_EQ(frames[2].m_chars.size(), 1u);
+    EXPECT_EQ(frames[2].m_chars[0].m_char, uint32_t('a'));
+}
+
+TEST(InputRecordingTest, ReplayReplacesPlatformInput) {
+    InputRecorder recorder;
+    MessageBus recordBus;
+    recordBus.Send(Time{ .m_deltaTime = 0.25 });
+    recordBus.Send(MakeIOState({ Key::Space }, 0.0, 0.0, 0.0, 0.0));
+    recordBus.Send(KeyMessage{ Key::Space, Action::Press });
+    recorder.Capture(recordBus);
+    recordBus.Clear();
+    recordBus.Send(Time{ .m_deltaTime = 0.5 });
+    recorder.Capture(recordBus);
+
+    auto replay = InputReplay::Deserialize(recorder.Serialize());
+    ASSERT_TRUE(replay.has_value()) << replay.error();
+
+    // What a headless window sends
+    MessageBus bus;
+    bus.Send(Time{ .m_deltaTime = 1.0 / 60.0 });
+    bus.Send(IOState{});
+    ASSERT_TRUE(replay->Apply(bus));
+
+    auto times = Drain<Time>(bus);
+    ASSERT_EQ(times.size(), 1u);
+    EXPECT_EQ(times[0].m_deltaTime, 0.25);
+    auto states = Drain<IOState>(bus);
+    ASSERT_EQ(states.size(), 1u);
+    EXPECT_TRUE(states[0].m_keyboard.IsKeyPressed(Key::Space));
+    EXPECT_EQ(Drain<KeyMessage>(bus).size(), 1u);
+
+    bus.Clear();
+    ASSERT_TRUE(replay->Apply(bus));
+    times = Drain<Time>(bus);
+    EXPECT_EQ(times[0].m_lastFrameTime, 0.25);
+    EXPECT_EQ(times[0].m_nextFrame, 1u);
+    EXPECT_FALSE(Drain<IOState>(bus)[0].m_keyboard.IsKeyPressed(Key::Space));
+    EXPECT_TRUE(Drain<KeyMessage>(bus).empty());
+
+    EXPECT_TRUE(replay->IsFinished());
+    EXPECT_FALSE(replay->Apply(bus));
+
+    replay->Rewind();
+    EXPECT_FALSE(replay->IsFinished());
+}
+
+TEST(InputRecordingTest, RejectsCorruptLogs) {
+    InputRecorder recorder;
+    MessageBus bus;
+    bus.Send(KeyMessage{ Key::Q, Action::Press });
+    recorder.Capture(bus);
+
+    auto data = recorder.Serialize();
+    data.pop_back();
+    EXPECT_FALSE(InputReplay::Deserialize(data).has_value());
+
+    data[0] = std::byte{ 0 };
+    EXPECT_FALSE(InputReplay::Deserialize(data).has_value());
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "../load_scheduler.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    LoadRequest MakeRequest(std::vector<std::string>& log, std::string name,
+        LoadPriority priority = {}, LoadCancelFlag cancelled = nullptr) {
+        return LoadRequest{
+            .m_priority = priority,
+            .m_cancelled = std::move(cancelled),
+            .m_run = [&log, name]() { log.push_back(name); },
+            .m_reject = [&log, name]() { log.push_back("rejected " + name); },
+        };
+    }
+}
+
+TEST(LoadSchedulerTest, RunsByUrgencyThenDistanceThenRequestOrder) {
+    LoadScheduler scheduler;
+    std::vector<std::string> log;
+
+    scheduler.SetViewPosition(glm::vec3(10.0f, 0.0f, 0.0f));
+    scheduler.Enqueue(MakeRequest(log, "far", { .m_position = glm::vec3(100.0f, 0.0f, 0.0f) }));
+    scheduler.Enqueue(MakeRequest(log, "first"));
+    scheduler.Enqueue(MakeRequest(log, "near", { .m_position = glm::vec3(12.0f, 0.0f, 0.0f) }));
+    scheduler.Enqueue(MakeRequest(log, "background", { .m_urgency = LoadPriority::kBackground }));
+    scheduler.Enqueue(MakeRequest(log, "urgent", { .m_urgency = LoadPriority::kUrgent }));
+    scheduler.Enqueue(MakeRequest(log, "second"));
+
+    EXPECT_EQ(scheduler.Process(), 6u);
+    std::vector<std::string> expected{ "urgent", "first", "second", "near", "far", "background" };
+    EXPECT_EQ(log, expected);
+    EXPECT_EQ(scheduler.GetQueueDepth(), 0u);
+}
+
+TEST(LoadSchedulerTest, PerFrameLimitReranksAgainstTheView) {
+    LoadScheduler scheduler;
+    std::vector<std::string> log;
+    scheduler.SetMaxLoadsPerFrame(1);
+
+    scheduler.Enqueue(MakeRequest(log, "a", { .m_position = glm::vec3(1.0f, 0.0f, 0.0f) }));
+    scheduler.Enqueue(MakeRequest(log, "b", { .m_position = glm::vec3(5.0f, 0.0f, 0.0f) }));
+    scheduler.Enqueue(MakeRequest(log, "c", { .m_position = glm::vec3(9.0f, 0.0f, 0.0f) }));
+
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(scheduler.GetQueueDepth(), 2u);
+
+    // The camera moved next to c
+    scheduler.SetViewPosition(glm::vec3(10.0f, 0.0f, 0.0f));
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(scheduler.Process(), 0u);
+
+    std::vector<std::string> expected{ "a", "c", "b" };
+    EXPECT_EQ(log, expected);
+}
+
+TEST(LoadSchedulerTest, CancelledLoadsAreDropped) {
+    LoadScheduler scheduler;
+    std::vector<std::string> log;
+
+    auto cancelled = MakeLoadCancelFlag();
+    auto kept = MakeLoadCancelFlag();
+    scheduler.Enqueue(MakeRequest(log, "cancelled", {}, cancelled));
+    scheduler.Enqueue(MakeRequest(log, "kept", {}, kept));
+    cancelled->store(true);
+
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(log, std::vector<std::string>{ "kept" });
+    EXPECT_EQ(scheduler.GetCancelledCount(), 1u);
+
+    // Requests already cancelled are never queued
+    scheduler.Enqueue(MakeRequest(log, "late", {}, cancelled));
+    EXPECT_EQ(scheduler.GetQueueDepth(), 0u);
+    EXPECT_EQ(scheduler.GetCancelledCount(), 2u);
+}
+
+TEST(LoadSchedulerTest, FullQueueRejectsTheLeastImportant) {
+    LoadScheduler scheduler(2);
+    std::vector<std::string> log;
+
+    scheduler.Enqueue(MakeRequest(log, "normal"));
+    scheduler.Enqueue(MakeRequest(log, "background", { .m_urgency = LoadPriority::kBackground }));
+    scheduler.Enqueue(MakeRequest(log, "urgent", { .m_urgency = LoadPriority::kUrgent }));
+    scheduler.Enqueue(MakeRequest(log, "another background", { .m_urgency = LoadPriority::kBackground }));
+
+    EXPECT_EQ(scheduler.GetQueueDepth(), 2u);
+    EXPECT_EQ(scheduler.GetRejectedCount(), 2u);
+    EXPECT_EQ(scheduler.Process(), 2u);
+
+    std::vector<std::string> expected{ "rejected background", "rejected another background", "urgent", "normal" };
+    EXPECT_EQ(log, expected);
+}
+
+TEST(LoadSchedulerTest, LoadsMayQueueFollowUps) {
+    LoadScheduler scheduler;
+    std::vector<std::string> log;
+
+    scheduler.Enqueue(LoadRequest{
+        .m_run = [&]() {
+            log.push_back("scene");
+            scheduler.Enqueue(MakeRequest(log, "texture"));
+        },
+    });
+
+    EXPECT_EQ(scheduler.Process(), 1u);
+    EXPECT_EQ(scheduler.GetQueueDepth(), 1u);
+    EXPECT_EQ(scheduler.Process(), 1u);
+    std::vector<std::string> expected{ "scene", "texture" };
+    EXPECT_EQ(log, expected);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "../png_decoder.hpp"
+#include "../texture.hpp"
+#include "../lodepng.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    struct EncodeOptions {
+        LodePNGColorType colorType = LCT_RGBA;
+        unsigned bitDepth = 8;
+        LodePNGFilterStrategy filter = LFS_MINSUM;
+        bool interlaced = false;
+    };
+
+    // Channels vary smoothly with some noise, so every filter has work to do
+    std::vector<uint8_t> MakePixels(uint32_t width, uint32_t height, uint32_t channels) {
+        std::vector<uint8_t> pixels(size_t(width) * height * channels);
+        uint32_t seed = 12345;
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                for (uint32_t c = 0; c < channels; ++c) {
+                    seed = seed * 1664525u + 1013904223u;
+                    pixels[(size_t(y) * width + x) * channels + c] =
+                        uint8_t(x * 7 + y * 3 + c * 50 + ((seed >> 24) & 15));
+                }
+            }
+        }
+        return pixels;
+    }
+
+    void AddPalette(LodePNGColorMode& mode, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            lodepng_palette_add(&mode, uint8_t(i * 3), uint8_t(255 - i), uint8_t(i * 11), uint8_t(i < 8 ? i * 30 : 255));
+        }
+    }
+
+    std::vector<uint8_t> Encode(std::vector<uint8_t> const& pixels, uint32_t width, uint32_t height,
+        EncodeOptions const& options, std::function<void(lodepng::State&)> const& setup = {}) {
+        lodepng::State state;
+        state.encoder.auto_convert = 0;
+        state.encoder.filter_strategy = options.filter;
+        state.encoder.filter_palette_zero = 0;
+        state.info_png.interlace_method = options.interlaced ? 1 : 0;
+        state.info_raw.colortype = options.colorType;
+        state.info_raw.bitdepth = options.bitDepth;
+        state.info_png.color.colortype = options.colorType;
+        state.info_png.color.bitdepth = options.bitDepth;
+        if (options.colorType == LCT_PALETTE) {
+            AddPalette(state.info_raw, 64);
+            AddPalette(state.info_png.color, 64);
+        }
+        if (setup) {
+            setup(state);
+        }
+
+        unsigned char* encoded = nullptr;
+        size_t encodedSize = 0;
+        unsigned error = lodepng_encode(&encoded, &encodedSize, pixels.data(), width, height, &state);
+        EXPECT_EQ(error, 0u) << lodepng_error_text(error);
+        std::vector<uint8_t> result(encoded, encoded + encodedSize);
+        free(encoded);
+        return result;
+    }
+
+    std::vector<uint8_t> DecodeWithLodePNG(std::vector<uint8_t> const& png) {
+        std::vector<uint8_t> pixels;
+        unsigned width = 0, height = 0;
+        unsigned error = lodepng::decode(pixels, width, height, png);
+        EXPECT_EQ(error, 0u) << lodepng_error_text(error);
+        return pixels;
+    }
+
+    std::vector<uint8_t> DecodeFast(std::vector<uint8_t> const& png) {
+        auto header = ReadPNGHeader(png);
+        EXPECT_TRUE(header);
+        if (!header) {
+            return {};
+        }
+        EXPECT_TRUE(CanDecodePNGFast(*header));
+        std::vector<uint8_t> pixels(size_t(header->m_width) * header->m_height * 4);
+        auto error = DecodePNGToRGBA8(png, *header, pixels);
+        EXPECT_FALSE(error.IsError()) << error;
+        return pixels;
+    }
+}
+
+TEST(PNGDecoderTest, MatchesLodePNGForEveryColorTypeAndFilter) {
+    // Odd sizes leave partial SIMD blocks at the end of each row
+    constexpr uint32_t kWidth = 37;
+    constexpr uint32_t kHeight = 19;
+    struct ColorCase { LodePNGColorType type; uint32_t channels; };
+    ColorCase const colors[] = {
+        { LCT_GREY, 1 }, { LCT_GREY_ALPHA, 2 }, { LCT_RGB, 3 }, { LCT_RGBA, 4 }, { LCT_PALETTE, 1 },
+    };
+    LodePNGFilterStrategy const filters[] = { LFS_ZERO, LFS_ONE, LFS_TWO, LFS_THREE, LFS_FOUR, LFS_MINSUM };
+
+    for (auto const& color : colors) {
+        auto pixels = MakePixels(kWidth, kHeight, color.channels);
+        if (color.type == LCT_PALETTE) {
+            for (auto& index : pixels) {
+                index %= 64;
+            }
+        }
+        for (auto filter : filters) {
+            SCOPED_TRACE(testing::Message() << "color type " << color.type << ", filter " << filter);
+            auto png = Encode(pixels, kWidth, kHeight, { color.type, 8, filter });
+            EXPECT_EQ(DecodeFast(png), DecodeWithLodePNG(png));
+        }
+    }
+}
+
+TEST(PNGDecoderTest, AppliesTransparency) {
+    constexpr uint32_t kSize = 16;
+
+    // Color key on RGB: pixels matching the first one become transparent
+    auto rgb = MakePixels(kSize, kSize, 3);
+    std::copy(rgb.begin(), rgb.begin() + 3, rgb.begin() + 5 * 3);
+    auto keyed = Encode(rgb, kSize, kSize, { LCT_RGB }, [&](lodepng::State& state) {
+        for (auto* mode : { &state.info_raw, &state.info_png.color }) {
+            mode->key_defined = 1;
+            mode->key_r = rgb[0];
+            mode->key_g = rgb[1];
+            mode->key_b = rgb[2];
+        }
+    });
+    auto decoded = DecodeFast(keyed);
+    EXPECT_EQ(decoded, DecodeWithLodePNG(keyed));
+    EXPECT_EQ(decoded[3], 0);
+    EXPECT_EQ(decoded[5 * 4 + 3], 0);
+    EXPECT_EQ(decoded[1 * 4 + 3], 255);
+
+    // Palette alpha comes from tRNS
+    auto indices = MakePixels(kSize, kSize, 1);
+    for (auto& index : indices) {
+        index %= 64;
+    }
+    auto palette = Encode(indices, kSize, kSize, { LCT_PALETTE });
+    EXPECT_EQ(DecodeFast(palette), DecodeWithLodePNG(palette));
+}
+
+TEST(PNGDecoderTest, LeavesUnsupportedFilesToLodePNG) {
+    constexpr uint32_t kSize = 8;
+    auto pixels = MakePixels(kSize, kSize, 8);
+
+    auto deep = Encode(pixels, kSize, kSize, { LCT_RGBA, 16 });
+    auto deepHeader = ReadPNGHeader(deep);
+    ASSERT_TRUE(deepHeader);
+    EXPECT_EQ(deepHeader->m_bitDepth, 16);
+    EXPECT_FALSE(CanDecodePNGFast(*deepHeader));
+
+    pixels.resize(kSize * kSize * 4);
+    auto interlaced = Encode(pixels, kSize, kSize, { LCT_RGBA, 8, LFS_MINSUM, true });
+    auto interlacedHeader = ReadPNGHeader(interlaced);
+    ASSERT_TRUE(interlacedHeader);
+    EXPECT_TRUE(interlacedHeader->b_interlaced);
+    EXPECT_FALSE(CanDecodePNGFast(*interlacedHeader));
+
+    // Texture::FromPNG still loads both
+    for (auto const* png : { &deep, &interlaced }) {
+        auto texture = Texture::FromPNG(std::span<uint8_t const>(*png), {});
+        ASSERT_TRUE(texture) << texture.error();
+        EXPECT_EQ(texture->GetDesc().width, kSize);
+        EXPECT_EQ(texture->GetDesc().format, TextureFormat::RGBA8);
+    }
+    auto texture = Texture::FromPNG(std::span<uint8_t const>(interlaced), {});
+    ASSERT_TRUE(texture);
+    EXPECT_TRUE(std::equal(pixels.begin(), pixels.end(), texture->GetData().begin()));
+}
+
+TEST(PNGDecoderTest, RejectsDamagedFiles) {
+    std::vector<uint8_t> notPNG(64, 'x');
+    EXPECT_FALSE(ReadPNGHeader(notPNG));
+
+    constexpr uint32_t kSize = 16;
+    auto png = Encode(MakePixels(kSize, kSize, 4), kSize, kSize, { LCT_RGBA });
+    auto header = ReadPNGHeader(png);
+    ASSERT_TRUE(header);
+    std::vector<uint8_t> pixels(kSize * kSize * 4);
+
+    auto truncated = std::vector<uint8_t>(png.begin(), png.begin() + png.size() / 2);
+    EXPECT_TRUE(DecodePNGToRGBA8(truncated, *header, pixels).IsError());
+    EXPECT_FALSE(Texture::FromPNG(std::span<uint8_t const>(truncated), {}));
+
+    // Output buffer of the wrong size
+    pixels.pop_back();
+    EXPECT_TRUE(DecodePNGToRGBA8(png, *header, pixels).IsError());
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "../profiler.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace okami;
+
+namespace {
+    std::string ReadTrace(std::filesystem::path const& path) {
+        std::ifstream file(path);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    class ProfilerTest : public ::testing::Test {
+    protected:
+        std::filesystem::path m_tracePath;
+
+        void SetUp() override {
+            m_tracePath = std::filesystem::temp_directory_path() / "okami_profiler_test.json";
+            SetProfilerEnabled(false);
+            ClearProfile();
+        }
+
+        void TearDown() override {
+            SetProfilerEnabled(false);
+            std::filesystem::remove(m_tracePath);
+        }
+    };
+}
+
+TEST_F(ProfilerTest, DisabledRecordsNothing) {
+    {
+        OKAMI_PROFILE_SCOPE("DisabledScope");
+    }
+    ASSERT_TRUE(WriteChromeTrace(m_tracePath).IsOk());
+    auto trace = ReadTrace(m_tracePath);
+    EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+    EXPECT_EQ(trace.find("DisabledScope"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, ExportsScopesFromEveryThread) {
+    SetProfilerEnabled(true);
+    {
+        OKAMI_PROFILE_SCOPE("MainScope");
+    }
+    std::thread worker([] {
+        SetProfilerThreadName("Worker \"1\"");
+        OKAMI_PROFILE_SCOPE(InternProfileName(std::string("Worker") + "Scope"));
+    });
+    worker.join();
+    SetProfilerEnabled(false);
+
+    ASSERT_TRUE(WriteChromeTrace(m_tracePath).IsOk());
+    auto trace = ReadTrace(m_tracePath);
+    EXPECT_NE(trace.find("\"name\":\"MainScope\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"WorkerScope\""), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"Worker \\\"1\\\"\""), std::string::npos);
+}
+
+TEST_F(ProfilerTest, ClearDropsEarlierEvents) {
+    SetProfilerEnabled(true);
+    {
+        OKAMI_PROFILE_SCOPE("BeforeClear");
+    }
+    ClearProfile();
+    {
+        OKAMI_PROFILE_SCOPE("AfterClear");
+    }
+    SetProfilerEnabled(false);
+
+    ASSERT_TRUE(WriteChromeTrace(m_tracePath).IsOk());
+    auto trace = ReadTrace(m_tracePath);
+    EXPECT_EQ(trace.find("BeforeClear"), std::string::npos);
+    EXPECT_NE(trace.find("AfterClear"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, InternReturnsStablePointer) {
+    const char* a = InternProfileName("Module");
+    const char* b = InternProfileName(std::string("Mod") + "ule");
+    EXPECT_EQ(a, b);
+    EXPECT_STREQ(a, "Module");
+}
+
+TEST_F(ProfilerTest, CollectReturnsEventsSinceClear) {
+    SetProfilerEnabled(true);
+    {
+        OKAMI_PROFILE_SCOPE("Outer");
+        OKAMI_PROFILE_SCOPE("Inner");
+    }
+    SetProfilerEnabled(false);
+
+    auto events = CollectProfileEvents();
+    ASSERT_EQ(events.size(), 2u);
+    // Scopes are recorded when they close, so the inner one comes first
+    EXPECT_STREQ(events[0].m_name, "Inner");
+    EXPECT_STREQ(events[1].m_name, "Outer");
+    EXPECT_EQ(events[0].m_threadId, events[1].m_threadId);
+    EXPECT_LE(events[1].m_start, events[0].m_start);
+    EXPECT_GE(events[1].m_end, events[0].m_end);
+
+    ClearProfile();
+    EXPECT_TRUE(CollectProfileEvents().empty());
+}
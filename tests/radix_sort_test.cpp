@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "../radix_sort.hpp"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace okami;
+
+struct KeyedItem {
+    uint64_t key;
+    int payload;
+};
+
+TEST(RadixSortTest, MatchesStableSort) {
+    std::mt19937_64 rng(42);
+    std::vector<KeyedItem> items;
+    for (int i = 0; i < 10000; ++i) {
+        // Narrow key range to force many duplicates and exercise stability
+        items.push_back({rng() % 512, i});
+    }
+
+    auto expected = items;
+    std::stable_sort(expected.begin(), expected.end(),
+        [](auto const& a, auto const& b) { return a.key < b.key; });
+
+    std::vector<KeyedItem> scratch;
+    RadixSort(items, scratch, [](KeyedItem const& item) { return item.key; });
+
+    ASSERT_EQ(items.size(), expected.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        EXPECT_EQ(items[i].key, expected[i].key);
+        EXPECT_EQ(items[i].payload, expected[i].payload);
+    }
+}
+
+TEST(RadixSortTest, FullWidthKeys) {
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> items(5000);
+    for (auto& item : items) {
+        item = rng();
+    }
+
+    auto expected = items;
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<uint64_t> scratch;
+    RadixSort(items, scratch, [](uint64_t k) { return k; });
+    EXPECT_EQ(items, expected);
+}
+
+TEST(RadixSortTest, HandlesTrivialInputs) {
+    std::vector<uint64_t> empty, scratch;
+    RadixSort(empty, scratch, [](uint64_t k) { return k; });
+    EXPECT_TRUE(empty.empty());
+
+    std::vector<uint64_t> same(100, 3);
+    RadixSort(same, scratch, [](uint64_t k) { return k; });
+    EXPECT_EQ(same, std::vector<uint64_t>(100, 3));
+}
+
+TEST(RadixSortTest, FloatKeysPreserveOrder) {
+    std::vector<float> values = { 3.5f, -1.0f, 0.0f, -0.0f, 100.0f, -250.25f, 1e-6f, -1e-6f };
+    std::vector<float> sorted = values;
+    std::vector<float> scratch;
+
+    RadixSort(sorted, scratch, [](float v) { return uint64_t{FloatToSortableBits(v)}; });
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        EXPECT_LE(sorted[i - 1], sorted[i]);
+    }
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../range_allocator.hpp"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace okami;
+
+TEST(RangeAllocatorTest, AllocatesSequentially) {
+    RangeAllocator alloc(100);
+
+    auto a = alloc.Allocate(10);
+    auto b = alloc.Allocate(20);
+    ASSERT_TRUE(a && b);
+    EXPECT_EQ(*a, 0u);
+    EXPECT_EQ(*b, 10u);
+    EXPECT_EQ(alloc.GetFreeCount(), 70u);
+}
+
+TEST(RangeAllocatorTest, FailsWhenFull) {
+    RangeAllocator alloc(16);
+
+    EXPECT_TRUE(alloc.Allocate(16));
+    EXPECT_FALSE(alloc.Allocate(1));
+    EXPECT_FALSE(alloc.Allocate(0));
+}
+
+TEST(RangeAllocatorTest, CoalescesFreedNeighbours) {
+    RangeAllocator alloc(30);
+
+    auto a = alloc.Allocate(10);
+    auto b = alloc.Allocate(10);
+    auto c = alloc.Allocate(10);
+    ASSERT_TRUE(a && b && c);
+
+    alloc.Free(*a, 10);
+    alloc.Free(*c, 10);
+    EXPECT_EQ(alloc.GetFreeBlockCount(), 2u);
+
+    // Freeing the middle block should merge everything back into one range
+    alloc.Free(*b, 10);
+    EXPECT_EQ(alloc.GetFreeBlockCount(), 1u);
+    EXPECT_EQ(alloc.GetFreeCount(), 30u);
+
+    auto whole = alloc.Allocate(30);
+    ASSERT_TRUE(whole);
+    EXPECT_EQ(*whole, 0u);
+}
+
+TEST(RangeAllocatorTest, GrowExtendsTrailingFreeBlock) {
+    RangeAllocator alloc(10);
+
+    auto a = alloc.Allocate(4);
+    ASSERT_TRUE(a);
+    EXPECT_FALSE(alloc.Allocate(10));
+
+    alloc.Grow(20);
+    EXPECT_EQ(alloc.GetCapacity(), 20u);
+    EXPECT_EQ(alloc.GetFreeBlockCount(), 1u);
+
+    auto b = alloc.Allocate(16);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(*b, 4u);
+}
+
+TEST(RangeAllocatorTest, RandomChurnKeepsAccounting) {
+    RangeAllocator alloc(4096);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> sizeDist(1, 64);
+
+    struct Block { uint32_t offset; uint32_t count; };
+    std::vector<Block> live;
+    uint32_t used = 0;
+
+    for (int i = 0; i < 2000; ++i) {
+        if (live.empty() || (rng() % 3 != 0)) {
+            uint32_t count = sizeDist(rng);
+            if (auto offset = alloc.Allocate(count)) {
+                // New block must not overlap any live block
+                for (auto const& blk : live) {
+                    EXPECT_TRUE(*offset + count <= blk.offset || blk.offset + blk.count <= *offset);
+                }
+                live.push_back({*offset, count});
+                used += count;
+            }
+        } else {
+            size_t idx = rng() % live.size();
+            alloc.Free(live[idx].offset, live[idx].count);
+            used -= live[idx].count;
+            live.erase(live.begin() + idx);
+        }
+        ASSERT_EQ(alloc.GetFreeCount() + used, alloc.GetCapacity());
+    }
+
+    for (auto const& blk : live) {
+        alloc.Free(blk.offset, blk.count);
+    }
+    EXPECT_EQ(alloc.GetFreeBlockCount(), 1u);
+    EXPECT_EQ(alloc.GetFreeCount(), 4096u);
+}
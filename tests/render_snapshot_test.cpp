@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../render_snapshot.hpp"
+
+#include <string>
+
+using namespace okami;
+
+namespace {
+    struct Position {
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+
+    struct Name {
+        std::string m_value;
+    };
+
+    struct Tag {};
+
+    struct Settings {
+        int m_quality = 0;
+    };
+}
+
+TEST(RenderSnapshotTest, CopiesRegisteredComponentsWithIds) {
+    RenderSnapshotSchema schema;
+    schema.AddComponent<Position>();
+    schema.AddComponent<Tag>();
+
+    entt::registry source;
+    auto a = source.create();
+    auto b = source.create();
+    auto c = source.create();
+    source.emplace<Position>(a, 1.0f, 2.0f);
+    source.emplace<Tag>(b);
+    source.emplace<Name>(c, "not rendered");
+
+    entt::registry snapshot;
+    schema.Extract(source, snapshot);
+
+    ASSERT_TRUE(snapshot.valid(a));
+    EXPECT_EQ(snapshot.get<Position>(a).y, 2.0f);
+    ASSERT_TRUE(snapshot.valid(b));
+    EXPECT_TRUE(snapshot.all_of<Tag>(b));
+    EXPECT_FALSE(snapshot.valid(c));
+}
+
+TEST(RenderSnapshotTest, SnapshotIsIndependentOfSource) {
+    RenderSnapshotSchema schema;
+    schema.AddComponent<Name>();
+
+    entt::registry source;
+    auto e = source.create();
+    source.emplace<Name>(e, "before");
+
+    entt::registry snapshot;
+    schema.Extract(source, snapshot);
+    source.get<Name>(e).m_value = "after";
+
+    EXPECT_EQ(snapshot.get<Name>(e).m_value, "before");
+}
+
+TEST(RenderSnapshotTest, ReextractDropsDestroyedEntities) {
+    RenderSnapshotSchema schema;
+    schema.AddComponent<Position>();
+
+    entt::registry source;
+    auto keep = source.create();
+    auto drop = source.create();
+    source.emplace<Position>(keep);
+    source.emplace<Position>(drop);
+
+    entt::registry snapshot;
+    schema.Extract(source, snapshot);
+    EXPECT_TRUE(snapshot.valid(drop));
+
+    source.destroy(drop);
+    source.get<Position>(keep).x = 5.0f;
+    schema.Extract(source, snapshot);
+
+    EXPECT_FALSE(snapshot.valid(drop));
+    ASSERT_TRUE(snapshot.valid(keep));
+    EXPECT_EQ(snapshot.get<Position>(keep).x, 5.0f);
+}
+
+TEST(RenderSnapshotTest, CopiesAndClearsContext) {
+    RenderSnapshotSchema schema;
+    schema.AddContext<Settings>();
+    schema.AddContext<Settings>();
+    EXPECT_EQ(schema.GetTypeCount(), 1u);
+
+    entt::registry source;
+    source.ctx().emplace<Settings>(Settings{ .m_quality = 3 });
+
+    entt::registry snapshot;
+    schema.Extract(source, snapshot);
+    ASSERT_NE(snapshot.ctx().find<Settings>(), nullptr);
+    EXPECT_EQ(snapshot.ctx().get<Settings>().m_quality, 3);
+
+    source.ctx().erase<Settings>();
+    schema.Extract(source, snapshot);
+    EXPECT_EQ(snapshot.ctx().find<Settings>(), nullptr);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../residency.hpp"
+
+#include <vector>
+
+using namespace okami;
+
+namespace {
+    ResidentResource MakeTexture(size_t bytes, uint64_t lastUsedFrame, bool evictable = true) {
+        return ResidentResource{
+            .m_kind           = ResidencyKind::Texture,
+            .m_bytes          = bytes,
+            .m_evictableBytes = evictable ? bytes : 0,
+            .m_lastUsedFrame  = lastUsedFrame,
+        };
+    }
+
+    ResidentResource MakeGeometry(size_t bytes, uint64_t lastUsedFrame) {
+        return ResidentResource{
+            .m_kind           = ResidencyKind::Geometry,
+            .m_bytes          = bytes,
+            .m_evictableBytes = bytes,
+            .m_lastUsedFrame  = lastUsedFrame,
+        };
+    }
+}
+
+TEST(ResidencyTest, NothingIsEvictedWithinBudget) {
+    std::vector<ResidentResource> resources{ MakeTexture(100, 1), MakeGeometry(100, 1) };
+    EXPECT_TRUE(SelectEvictions(resources, 200, 1000, 10).empty());
+    // 0 is unlimited
+    EXPECT_TRUE(SelectEvictions(resources, 0, 1000, 10).empty());
+}
+
+TEST(ResidencyTest, EvictsIdleResourcesLeastRecentlyUsedFirst) {
+    std::vector<ResidentResource> resources{
+        MakeTexture(100, 50),
+        MakeGeometry(100, 20),
+        MakeTexture(100, 95),       // used too recently
+        MakeTexture(100, 10, false), // created from memory
+        MakeGeometry(100, 40),
+    };
+
+    // 500 resident against a budget of 300: the two oldest evictable go
+    auto evicted = SelectEvictions(resources, 300, 100, 10);
+    EXPECT_EQ(evicted, (std::vector<size_t>{ 1, 4 }));
+
+    // Past what idle resources can free, the budget is exceeded instead
+    evicted = SelectEvictions(resources, 50, 100, 10);
+    EXPECT_EQ(evicted, (std::vector<size_t>{ 1, 4, 0 }));
+}
+
+TEST(ResidencyTest, PrefersLargerResourcesAmongEquallyOld) {
+    std::vector<ResidentResource> resources{ MakeTexture(10, 5), MakeGeometry(300, 5), MakeTexture(50, 5) };
+    EXPECT_EQ(SelectEvictions(resources, 100, 100, 10), (std::vector<size_t>{ 1 }));
+}
+
+TEST(ResidencyTest, PartlyEvictableTexturesFreeOnlyTheirFinerMips) {
+    // A streamed texture keeps its tail
+    std::vector<ResidentResource> resources{ MakeTexture(400, 1), MakeGeometry(100, 1) };
+    resources[0].m_evictableBytes = 300;
+    EXPECT_EQ(SelectEvictions(resources, 150, 100, 10), (std::vector<size_t>{ 0, 1 }));
+}
+
+TEST(ResidencyTest, AccountsBytesPerKindAndKeepsTotals) {
+    GPUResidencyStats stats{ .m_budgetBytes = 250, .m_evictions = 3 };
+    std::vector<ResidentResource> resources{ MakeTexture(100, 1), MakeGeometry(200, 1), MakeGeometry(0, 1) };
+    AccountResidency(resources, stats);
+
+    EXPECT_EQ(stats.m_textureBytes, 100u);
+    EXPECT_EQ(stats.m_geometryBytes, 200u);
+    EXPECT_EQ(stats.m_textureCount, 1u);
+    EXPECT_EQ(stats.m_geometryCount, 2u);
+    EXPECT_EQ(stats.GetResidentBytes(), 300u);
+    EXPECT_TRUE(stats.IsOverBudget());
+    EXPECT_EQ(stats.m_evictions, 3u);
+}
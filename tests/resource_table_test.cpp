@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "../resource_table.hpp"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace okami;
+
+TEST(ResourceTableTest, StaleIdsStopResolvingWhenSlotsAreReused) {
+    ResourceTable<std::string> table;
+    auto [first, firstValue] = table.Emplace("first");
+    auto [second, secondValue] = table.Emplace("second");
+    ASSERT_NE(firstValue, nullptr);
+    ASSERT_NE(secondValue, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(table.Get(first), firstValue);
+    EXPECT_EQ(*table.Get(second), "second");
+    EXPECT_EQ(table.GetLiveCount(), 2u);
+
+    EXPECT_TRUE(table.Erase(first));
+    EXPECT_FALSE(table.Erase(first));
+    EXPECT_EQ(table.Get(first), nullptr);
+    EXPECT_EQ(table.GetLiveCount(), 1u);
+
+    // The freed slot comes back under a new generation
+    auto [third, thirdValue] = table.Emplace("third");
+    EXPECT_EQ(ResourceTable<std::string>::GetIndex(third), ResourceTable<std::string>::GetIndex(first));
+    EXPECT_NE(ResourceTable<std::string>::GetGeneration(third), ResourceTable<std::string>::GetGeneration(first));
+    EXPECT_EQ(table.Get(first), nullptr);
+    EXPECT_EQ(*table.Get(third), "third");
+
+    EXPECT_EQ(table.Get(kNullResource), nullptr);
+    EXPECT_EQ(table.Get(12345), nullptr);
+}
+
+TEST(ResourceTableTest, ValuesDoNotMoveAsTheTableGrows) {
+    ResourceTable<int> table;
+    std::vector<std::pair<ResourceId, int*>> entries;
+    for (int i = 0; i < 5000; ++i) {
+        entries.push_back(table.Emplace(i));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        EXPECT_EQ(table.Get(entries[i].first), entries[i].second);
+        EXPECT_EQ(*entries[i].second, i);
+    }
+}
+
+TEST(ResourceTableTest, ReadersRunAlongsideWriters) {
+    ResourceTable<int> table;
+    std::vector<ResourceId> stable;
+    for (int i = 0; i < 1000; ++i) {
+        stable.push_back(table.Emplace(i).first);
+    }
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> mismatches{ 0 };
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                for (int i = 0; i < 1000; ++i) {
+                    int* value = table.Get(stable[i]);
+                    if (!value || *value != i) {
+                        mismatches.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    // Churn other slots, growing the table into new pages
+    for (int round = 0; round < 50; ++round) {
+        std::vector<ResourceId> churn;
+        for (int i = 0; i < 500; ++i) {
+            churn.push_back(table.Emplace(-1).first);
+        }
+        for (auto id : churn) {
+            EXPECT_TRUE(table.Erase(id));
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(table.GetLiveCount(), 1000u);
+}
+
+TEST(ResourceTableTest, PathMapSpreadsPathsOverShards) {
+    ResourcePathMap<int> paths;
+    for (int i = 0; i < 256; ++i) {
+        auto path = std::filesystem::path("textures") / ("tex" + std::to_string(i) + ".png");
+        auto& shard = paths.GetShard(path);
+        std::unique_lock<std::shared_mutex> lock(shard.m_mutex);
+        shard.m_map.emplace(path, i);
+    }
+
+    // The same path always lands in the same shard
+    auto const& shard = paths.GetShard("textures/tex7.png");
+    EXPECT_EQ(&shard, &paths.GetShard(std::filesystem::path("textures") / "tex7.png"));
+    EXPECT_EQ(shard.m_map.at("textures/tex7.png"), 7);
+
+    size_t count = 0;
+    paths.ForEach([&](std::filesystem::path const&, int) { ++count; });
+    EXPECT_EQ(count, 256u);
+
+    std::set<void const*> usedShards;
+    for (int i = 0; i < 256; ++i) {
+        usedShards.insert(&paths.GetShard(std::filesystem::path("textures") / ("tex" + std::to_string(i) + ".png")));
+    }
+    EXPECT_GT(usedShards.size(), ResourcePathMap<int>::kShardCount / 2);
+
+    paths.Clear();
+    count = 0;
+    paths.ForEach([&](std::filesystem::path const&, int) { ++count; });
+    EXPECT_EQ(count, 0u);
+}
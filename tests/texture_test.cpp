@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <filesystem>
 #include "../texture.hpp"
 #include "../paths.hpp"
@@ -311,4 +312,58 @@ TEST_F(TextureTest, PNGRoundTripWithRealAssetTest) {
         std::cout << "PNG round-trip test passed with " << differentPixels 
                   << " different pixels out of " << totalPixels << std::endl;
     }
-}
\ No newline at end of file
+}
+
+TEST_F(TextureTest, MipChainHelpers) {
+    TextureDesc desc = {};
+    desc.type = TextureType::TEXTURE_2D;
+    desc.format = TextureFormat::RGBA8;
+    desc.width = 256;
+    desc.height = 64;
+    desc.depth = 1;
+    desc.arraySize = 1;
+    desc.mipLevels = 9;
+
+    EXPECT_EQ(GetMipLevelForSize(desc, 256), 0u);
+    EXPECT_EQ(GetMipLevelForSize(desc, 255), 1u);
+    EXPECT_EQ(GetMipLevelForSize(desc, 32), 3u);
+    EXPECT_EQ(GetMipLevelForSize(desc, 0), 8u);
+
+    auto tail = GetMipChainDesc(desc, 3);
+    EXPECT_EQ(tail.width, 32u);
+    EXPECT_EQ(tail.height, 8u);
+    EXPECT_EQ(tail.mipLevels, 6u);
+    EXPECT_EQ(GetTextureSize(tail), GetTextureSize(desc) - GetMipOffset(desc, 3));
+
+    auto range = GetMipChainDesc(desc, 7, 5);
+    EXPECT_EQ(range.width, 2u);
+    EXPECT_EQ(range.height, 1u);
+    EXPECT_EQ(range.mipLevels, 2u);
+}
+
+TEST_F(TextureTest, LoadKTX2MipRange) {
+    auto path = GetTestAssetPath("test.ktx2");
+    auto full = Texture::FromKTX2(path);
+    ASSERT_TRUE(full.has_value()) << full.error();
+    auto const& fullDesc = full->GetDesc();
+    EXPECT_EQ(full->GetFirstMip(), 0u);
+    if (fullDesc.mipLevels < 2) {
+        GTEST_SKIP() << "test.ktx2 has no mip chain";
+    }
+
+    auto tail = Texture::FromKTX2(path, TextureLoadParams{ .m_maxSize = 1 });
+    ASSERT_TRUE(tail.has_value()) << tail.error();
+    EXPECT_EQ(tail->GetFirstMip(), fullDesc.mipLevels - 1);
+    EXPECT_EQ(tail->GetDesc().mipLevels, 1u);
+    EXPECT_EQ(tail->GetSourceDesc().width, fullDesc.width);
+
+    auto range = Texture::FromKTX2(path, TextureLoadParams{ .m_firstMip = 1, .m_mipCount = 1 });
+    ASSERT_TRUE(range.has_value()) << range.error();
+    EXPECT_EQ(range->GetFirstMip(), 1u);
+    EXPECT_EQ(range->GetDesc().mipLevels, 1u);
+    EXPECT_EQ(range->GetDesc().width, std::max(1u, fullDesc.width >> 1));
+    auto expected = full->GetData(1);
+    auto actual = range->GetData(0);
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin()));
+}
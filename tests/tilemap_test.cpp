@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "../tilemap.hpp"
+
+using namespace okami;
+
+TEST(TileMapTest, SetTileBumpsOnlyOwningChunk) {
+    TileLayerData layer("Ground", glm::uvec2(40, 33));
+
+    auto chunks = layer.GetChunkCount();
+    EXPECT_EQ(chunks.x, 2u);
+    EXPECT_EQ(chunks.y, 2u);
+
+    layer.SetTile(35, 2, 7);
+    EXPECT_EQ(layer.GetTile(35, 2), 7u);
+    EXPECT_EQ(layer.GetChunkRevision(1, 0), 1u);
+    EXPECT_EQ(layer.GetChunkRevision(0, 0), 0u);
+    EXPECT_EQ(layer.GetChunkRevision(0, 1), 0u);
+    EXPECT_EQ(layer.GetChunkRevision(1, 1), 0u);
+
+    // Writing the same value is not a change.
+    layer.SetTile(35, 2, 7);
+    EXPECT_EQ(layer.GetChunkRevision(1, 0), 1u);
+
+    layer.SetTile(0, 32, 7 | kTileFlipHorizontal);
+    EXPECT_EQ(layer.GetChunkRevision(0, 1), 1u);
+}
+
+TEST(TileMapTest, FindTileSetByGid) {
+    TileMapDesc map;
+    map.m_tileSets.push_back(TileSetDef{ .m_firstGid = 1,  .m_tileCount = 16 });
+    map.m_tileSets.push_back(TileSetDef{ .m_firstGid = 17, .m_tileCount = 4 });
+    map.m_tileSets.push_back(TileSetDef{ .m_firstGid = 40, .m_tileCount = 8 });
+
+    EXPECT_EQ(map.FindTileSet(0), -1);
+    EXPECT_EQ(map.FindTileSet(1), 0);
+    EXPECT_EQ(map.FindTileSet(16), 0);
+    EXPECT_EQ(map.FindTileSet(17), 1);
+    EXPECT_EQ(map.FindTileSet(20), 1);
+    EXPECT_EQ(map.FindTileSet(21), -1); // gap between tilesets
+    EXPECT_EQ(map.FindTileSet(47), 2);
+    EXPECT_EQ(map.FindTileSet(48), -1);
+}
+
+TEST(TileMapTest, EditMapCopiesOnlyASharedMap) {
+    TileMapDesc desc;
+    desc.m_layers.emplace_back("Ground", glm::uvec2(40, 33));
+
+    TileMapComponent component;
+    component.m_map = std::make_shared<TileMapDesc>(std::move(desc));
+    auto const* original = component.m_map.get();
+
+    // Held only by the component: edited in place
+    component.EditMap().m_layers[0].SetTile(1, 1, 3);
+    EXPECT_EQ(component.m_map.get(), original);
+    EXPECT_TRUE(component.m_editedFrom.expired());
+
+    // Held by a snapshot too: the snapshot keeps the old tiles
+    auto snapshot = component.m_map;
+    component.EditMap().m_layers[0].SetTile(35, 2, 7);
+    EXPECT_NE(component.m_map.get(), original);
+    EXPECT_EQ(component.m_editedFrom.lock(), snapshot);
+    EXPECT_EQ(snapshot->m_layers[0].GetTile(35, 2), 0u);
+    EXPECT_EQ(component.m_map->m_layers[0].GetTile(35, 2), 7u);
+    EXPECT_EQ(component.m_map->m_layers[0].GetTile(1, 1), 3u);
+
+    // The copy keeps the revisions, so only the edited chunk changed
+    EXPECT_EQ(component.m_map->m_layers[0].GetChunkRevision(0, 0), snapshot->m_layers[0].GetChunkRevision(0, 0));
+    EXPECT_NE(component.m_map->m_layers[0].GetChunkRevision(1, 0), snapshot->m_layers[0].GetChunkRevision(1, 0));
+}
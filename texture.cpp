@@ -11,6 +11,8 @@
 #endif
 
 #include "texture.hpp"
+#include "vfs.hpp"
+#include "png_decoder.hpp"
 #include "lodepng.h"
 
 #ifdef USE_KTX
@@ -188,19 +190,71 @@ size_t okami::GetSubresourceCount(TextureDesc const& desc) {
     return desc.arraySize * desc.mipLevels;
 }
 
+uint32_t okami::GetMipLevelForSize(TextureDesc const& desc, uint32_t maxSize) {
+    uint32_t mip = 0;
+    while (mip + 1 < desc.mipLevels &&
+        std::max(desc.width >> mip, desc.height >> mip) > maxSize) {
+        ++mip;
+    }
+    return mip;
+}
+
+TextureDesc okami::GetMipChainDesc(TextureDesc const& desc, uint32_t firstMip, uint32_t mipCount) {
+    if (firstMip >= desc.mipLevels) {
+        throw std::out_of_range("Invalid mip level");
+    }
+
+    uint32_t available = desc.mipLevels - firstMip;
+    TextureDesc result = desc;
+    result.width = std::max(1u, desc.width >> firstMip);
+    result.height = std::max(1u, desc.height >> firstMip);
+    if (desc.type == TextureType::TEXTURE_3D) {
+        result.depth = std::max(1u, desc.depth >> firstMip);
+    }
+    result.mipLevels = mipCount == 0 ? available : std::min(mipCount, available);
+    return result;
+}
+
+// PNGs are loaded as RGBA8, 2D texture, single mip level
+static TextureDesc GetPNGTextureDesc(uint32_t width, uint32_t height) {
+    TextureDesc info = {};
+    info.type = TextureType::TEXTURE_2D;
+    info.format = TextureFormat::RGBA8;
+    info.width = width;
+    info.height = height;
+    info.depth = 1;
+    info.arraySize = 1;
+    info.mipLevels = 1;
+    return info;
+}
+
 Expected<Texture> Texture::FromPNG(const std::filesystem::path& path,
     const TextureLoadParams& params) {
     // Check if file exists
     OKAMI_UNEXPECTED_RETURN_IF(!std::filesystem::exists(path), "PNG file does not exist: " + path.string());
-    
-    // Convert path to string for lodepng (which expects char*)
-    std::string pathStr = path.string();
-    
+
+    auto data = ReadFileBytes(path);
+    OKAMI_UNEXPECTED_RETURN(data);
+    return FromPNG(std::span<uint8_t const>(*data), params);
+}
+
+Expected<Texture> Texture::FromPNG(std::span<uint8_t const> data,
+    const TextureLoadParams& params) {
+    // Common 8-bit PNGs decode straight into the texture's storage
+    if (auto header = ReadPNGHeader(data); header && CanDecodePNGFast(*header)) {
+        Texture texture(GetPNGTextureDesc(header->m_width, header->m_height), params);
+        if (!DecodePNGToRGBA8(data, *header, texture.m_data).IsError()) {
+            return texture;
+        }
+        // Otherwise lodepng decodes what the fast path couldn't, or reports
+        // what is wrong with the file
+    }
+
     unsigned char* imageData = nullptr;
     unsigned width, height;
     
-    // Load PNG with 32-bit RGBA format
-    unsigned error = lodepng_decode32_file(&imageData, &width, &height, pathStr.c_str());
+    // Decode PNG with 32-bit RGBA format
+    unsigned error = lodepng_decode32(&imageData, &width, &height, data.data(), data.size());
     OKAMI_DEFER({
         if (imageData) {
             free(imageData);
@@ -211,18 +265,8 @@ Expected<Texture> Texture::FromPNG(const std::filesystem::path& path,
     // Ensure we have valid data
     OKAMI_UNEXPECTED_RETURN_IF(!imageData || width == 0 || height == 0, "Invalid PNG data");
     
-    // Create texture info - PNG loaded as RGBA8, 2D texture, single mip level
-    TextureDesc info = {};
-    info.type = TextureType::TEXTURE_2D;
-    info.format = TextureFormat::RGBA8;
-    info.width = width;
-    info.height = height;
-    info.depth = 1;
-    info.arraySize = 1;
-    info.mipLevels = 1;
-    
     // Create texture
-    Texture texture(info, params);
+    Texture texture(GetPNGTextureDesc(width, height), params);
     
     // Copy data to texture
     uint32_t dataSize = width * height * 4; // RGBA8 = 4 bytes per pixel
@@ -254,16 +298,27 @@ Expected<Texture> Texture::FromKTX2(const std::filesystem::path& path,
     // Check if file exists
     OKAMI_UNEXPECTED_RETURN_IF(!std::filesystem::exists(path), "KTX2 file does not exist: " + path.string());
 
-    // Load KTX texture from file
+    auto data = ReadFileBytes(path);
+    OKAMI_UNEXPECTED_RETURN(data);
+    auto texture = FromKTX2(std::span<uint8_t const>(*data), params);
+    OKAMI_UNEXPECTED_RETURN_IF(!texture,
+        "Failed to load KTX2 file: " + path.string() + " (" + texture.error().Str() + ")");
+    return texture;
+}
+
+Expected<Texture> Texture::FromKTX2(std::span<uint8_t const> data,
+    const TextureLoadParams& params) {
+    // Load KTX texture from memory
     ktxTexture* ktxTex = nullptr;
-    KTX_error_code result = ktxTexture_CreateFromNamedFile(
-        path.string().c_str(), 
+    KTX_error_code result = ktxTexture_CreateFromMemory(
+        data.data(),
+        data.size(),
         KTX_TEXTURE_CREATE_NO_FLAGS, 
         &ktxTex
     );
 
     OKAMI_UNEXPECTED_RETURN_IF(result != KTX_SUCCESS, 
-        "Failed to load KTX2 file: " + path.string() + " (error code: " + std::to_string(result) + ")");
+        "Failed to load KTX2 data (error code: " + std::to_string(result) + ")");
     OKAMI_UNEXPECTED_RETURN_IF(!ktxTex, "KTX texture is null");
     OKAMI_DEFER({
         ktxTexture_Destroy(ktxTex);
@@ -301,14 +356,27 @@ Expected<Texture> Texture::FromKTX2(const std::filesystem::path& path,
     info.depth = ktxTex->baseDepth;
     info.arraySize = ktxTex->numLayers;
     info.mipLevels = ktxTex->numLevels;
+
+    // Only the requested part of the mip chain is kept; the size limit
+    // never drops the range's coarsest level
+    uint32_t firstMip = std::min(params.m_firstMip, info.mipLevels - 1);
+    uint32_t endMip = params.m_mipCount == 0
+        ? info.mipLevels
+        : std::min(firstMip + params.m_mipCount, info.mipLevels);
+    if (params.m_maxSize != 0) {
+        firstMip = std::min(std::max(firstMip, GetMipLevelForSize(info, params.m_maxSize)), endMip - 1);
+    }
     
     // Create texture object
-    Texture texture(info, params);
+    Texture texture(GetMipChainDesc(info, firstMip, endMip - firstMip), params);
+    texture.m_sourceDesc = info;
+    texture.m_firstMip = firstMip;
     
     OKAMI_UNEXPECTED_RETURN_IF(ktxTexture_NeedsTranscoding(ktxTex), 
         "KTX2 texture requires transcoding, which is not currently supported");
 
-    // Load the image data into memory
+    // Load the image data into memory. libktx reads the whole chain; levels
+    // outside the requested range are dropped below.
     result = ktxTexture_LoadImageData(ktxTex, nullptr, 0);
     OKAMI_UNEXPECTED_RETURN_IF(result != KTX_SUCCESS, "Failed to load KTX2 image data (error code: " + std::to_string(result) + ")");
     
@@ -320,9 +388,9 @@ Expected<Texture> Texture::FromKTX2(const std::filesystem::path& path,
     OKAMI_UNEXPECTED_RETURN_IF(imDataSz == 0, "KTX2 texture data size is zero after loading");
 
     for (uint32_t layer = 0; layer < ktxTex->numLayers; ++layer) {
-        for (uint32_t mip = 0; mip < ktxTex->numLevels; ++mip) {
+        for (uint32_t mip = 0; mip < texture.m_desc.mipLevels; ++mip) {
             ktx_size_t offset;
-            result = ktxTexture_GetImageOffset(ktxTex, mip, layer, 0, &offset);
+            result = ktxTexture_GetImageOffset(ktxTex, firstMip + mip, layer, 0, &offset);
 
             OKAMI_UNEXPECTED_RETURN_IF(result != KTX_SUCCESS, 
                 "Failed to get image offset for mip " + std::to_string(mip) + ", layer " + std::to_string(layer));
@@ -346,6 +414,11 @@ Expected<Texture> Texture::FromKTX2(const std::filesystem::path& path,
     const TextureLoadParams& params) {
     return std::unexpected(Error("KTX2 support not compiled in"));
 }
+
+Expected<Texture> Texture::FromKTX2(std::span<uint8_t const> data,
+    const TextureLoadParams& params) {
+    return std::unexpected(Error("KTX2 support not compiled in"));
+}
 #endif
 
 Error Texture::SavePNG(const std::filesystem::path& path, bool saveMips) const {
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "common.hpp"
+#include "load_scheduler.hpp"
 
 #include <glm/vec2.hpp>
 
@@ -50,9 +51,21 @@ namespace okami {
     size_t GetMipOffset(TextureDesc const& desc, uint32_t mipLevel);
     size_t GetSubresourceIndex(TextureDesc const& desc, uint32_t mipLevel, uint32_t layer);
     size_t GetSubresourceCount(TextureDesc const& desc);
+    // Finest mip level whose width and height are both at most maxSize, or
+    // the last level if none are
+    uint32_t GetMipLevelForSize(TextureDesc const& desc, uint32_t maxSize);
+    // Describes mips [firstMip, firstMip + mipCount) of desc as a chain of
+    // its own. A mipCount of 0 runs to the end of the chain.
+    TextureDesc GetMipChainDesc(TextureDesc const& desc, uint32_t firstMip, uint32_t mipCount = 0);
 
     struct TextureLoadParams {
         bool m_srgb = false;
+        // Part of the file's mip chain to load, used to stream large
+        // textures in. The default loads the whole chain.
+        uint32_t m_firstMip = 0;
+        uint32_t m_mipCount = 0; // 0 loads through the end of the chain
+        // If non-zero, starts the load no finer than GetMipLevelForSize
+        uint32_t m_maxSize = 0;
     };
 
     struct SubDesc {
@@ -67,14 +80,18 @@ namespace okami {
         TextureLoadParams m_params;
         std::vector<uint8_t> m_data; // Raw texture data
         std::vector<SubDesc> m_subDescs;
+        // When only part of a file's mip chain was loaded, m_desc describes
+        // the loaded part and these locate it within the file's chain
+        TextureDesc m_sourceDesc;
+        uint32_t m_firstMip = 0;
 
         void UpdateSubDescs();
 
     public:
         inline Texture(const TextureDesc& info, const TextureLoadParams& params = {}) 
-            : m_desc(info), m_params(params), m_data(GetTextureSize(info), 0) { UpdateSubDescs(); }
+            : m_desc(info), m_params(params), m_data(GetTextureSize(info), 0), m_sourceDesc(info) { UpdateSubDescs(); }
         inline Texture(const TextureDesc& info, std::vector<uint8_t>&& data, const TextureLoadParams& params = {}) 
-            : m_desc(info), m_params(params), m_data(std::move(data)) {
+            : m_desc(info), m_params(params), m_data(std::move(data)), m_sourceDesc(info) {
             // Ensure size is correct
             if (m_data.size() != GetTextureSize(info)) {
                 throw std::runtime_error("Texture data size does not match description");
@@ -90,6 +107,16 @@ namespace okami {
             return m_params;
         }
 
+        // The full mip chain this texture's levels were loaded from
+        inline const TextureDesc& GetSourceDesc() const {
+            return m_sourceDesc;
+        }
+
+        // Level of the source chain that this texture's mip 0 holds
+        inline uint32_t GetFirstMip() const {
+            return m_firstMip;
+        }
+
         const std::span<uint8_t const> GetData(uint32_t mipLevel = 0, uint32_t layer = 0) const;
         std::span<uint8_t> GetData(uint32_t mipLevel = 0, uint32_t layer = 0);
 
@@ -97,6 +124,11 @@ namespace okami {
             const TextureLoadParams& params = {});
         static Expected<Texture> FromKTX2(const std::filesystem::path& path,
             const TextureLoadParams& params = {});
+        // Decode a file already in memory, e.g. read from an asset pack
+        static Expected<Texture> FromPNG(std::span<uint8_t const> data,
+            const TextureLoadParams& params = {});
+        static Expected<Texture> FromKTX2(std::span<uint8_t const> data,
+            const TextureLoadParams& params = {});
 
         Error SavePNG(const std::filesystem::path& path, bool saveMips = false) const;
         Error SaveKTX2(const std::filesystem::path& path) const;
@@ -128,7 +160,8 @@ namespace okami {
         virtual TextureHandle LoadTexture(
             std::filesystem::path const& path,
             TextureLoadParams            params,
-            InterfaceCollection&         ic) = 0;
+            InterfaceCollection&         ic,
+            LoadPriority                 priority = {}) = 0;
 
         // Synchronously upload CPU-side Texture data and return a ready handle.
         virtual TextureHandle CreateTexture(Texture data) = 0;
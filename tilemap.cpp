@@ -0,0 +1,215 @@
+#include "tilemap.hpp"
+#include "vfs.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+
+#include <glm/common.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace okami {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TileLayerData / TileMapDesc
+// ─────────────────────────────────────────────────────────────────────────────
+
+TileLayerData::TileLayerData(std::string name, glm::uvec2 size, glm::ivec2 origin) :
+    m_tiles(static_cast<size_t>(size.x) * size.y, 0u),
+    m_name(std::move(name)),
+    m_size(size),
+    m_origin(origin) {
+    auto chunks = GetChunkCount();
+    m_chunkRevisions.assign(static_cast<size_t>(chunks.x) * chunks.y, 0u);
+}
+
+void TileLayerData::SetTile(uint32_t x, uint32_t y, uint32_t tile) {
+    auto& dst = m_tiles[y * m_size.x + x];
+    if (dst == tile) {
+        return;
+    }
+    dst = tile;
+    ++m_chunkRevisions[(y / kChunkSize) * GetChunkCount().x + (x / kChunkSize)];
+}
+
+int TileMapDesc::FindTileSet(uint32_t gid) const {
+    auto it = std::upper_bound(m_tileSets.begin(), m_tileSets.end(), gid,
+        [](uint32_t value, TileSetDef const& ts) { return value < ts.m_firstGid; });
+    if (it == m_tileSets.begin()) {
+        return -1;
+    }
+    --it;
+    return it->Contains(gid) ? static_cast<int>(it - m_tileSets.begin()) : -1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TMX loading
+// ─────────────────────────────────────────────────────────────────────────────
+
+static uint32_t EncodeTile(tmx::TileLayer::Tile const& tile) {
+    // tmxlite splits the flip bits out of the gid (H = 0x8, V = 0x4, D = 0x2);
+    // shifting them back up restores the TMX encoding.
+    return (tile.ID & kTileGidMask) | (static_cast<uint32_t>(tile.flipFlags) << 28);
+}
+
+static TileLayerData ConvertTileLayer(tmx::TileLayer const& layer, glm::uvec2 mapSize, bool infinite) {
+    TileLayerData result;
+
+    if (!infinite) {
+        result = TileLayerData(layer.getName(), mapSize);
+        auto const& tiles = layer.getTiles();
+        for (uint32_t y = 0; y < mapSize.y; ++y) {
+            for (uint32_t x = 0; x < mapSize.x; ++x) {
+                size_t idx = static_cast<size_t>(y) * mapSize.x + x;
+                if (idx < tiles.size()) {
+                    result.SetTile(x, y, EncodeTile(tiles[idx]));
+                }
+            }
+        }
+    } else {
+        // Infinite maps store tiles in sparse chunks; flatten them into the
+        // bounding grid and remember where it starts.
+        auto const& chunks = layer.getChunks();
+        glm::ivec2 lo(std::numeric_limits<int>::max());
+        glm::ivec2 hi(std::numeric_limits<int>::min());
+        for (auto const& chunk : chunks) {
+            lo = glm::min(lo, glm::ivec2(chunk.position.x, chunk.position.y));
+            hi = glm::max(hi, glm::ivec2(chunk.position.x + chunk.size.x, chunk.position.y + chunk.size.y));
+        }
+        if (chunks.empty()) {
+            lo = hi = glm::ivec2(0);
+        }
+
+        result = TileLayerData(layer.getName(), glm::uvec2(hi - lo), lo);
+        for (auto const& chunk : chunks) {
+            for (int cy = 0; cy < chunk.size.y; ++cy) {
+                for (int cx = 0; cx < chunk.size.x; ++cx) {
+                    auto const& tile = chunk.tiles[static_cast<size_t>(cy) * chunk.size.x + cx];
+                    result.SetTile(
+                        static_cast<uint32_t>(chunk.position.x + cx - lo.x),
+                        static_cast<uint32_t>(chunk.position.y + cy - lo.y),
+                        EncodeTile(tile));
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static void CollectTileLayers(
+    std::vector<tmx::Layer::Ptr> const& layers,
+    glm::uvec2                          mapSize,
+    bool                                infinite,
+    glm::vec2                           parentOffset,
+    float                               parentOpacity,
+    bool                                parentVisible,
+    std::vector<TileLayerData>&         out) {
+    for (auto const& layer : layers) {
+        glm::vec2 offset  = parentOffset + glm::vec2(layer->getOffset().x, layer->getOffset().y);
+        float     opacity = parentOpacity * layer->getOpacity();
+        bool      visible = parentVisible && layer->getVisible();
+
+        switch (layer->getType()) {
+            case tmx::Layer::Type::Tile: {
+                // Offsets, opacity and visibility accumulate through groups.
+                auto data = ConvertTileLayer(layer->getLayerAs<tmx::TileLayer>(), mapSize, infinite);
+                data.m_offset  = offset;
+                data.m_opacity = opacity;
+                data.b_visible = visible;
+                out.push_back(std::move(data));
+                break;
+            }
+            case tmx::Layer::Type::Group:
+                CollectTileLayers(layer->getLayerAs<tmx::LayerGroup>().getLayers(),
+                    mapSize, infinite, offset, opacity, visible, out);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+Expected<TileMap> TileMap::FromFile(std::filesystem::path const& path, TileMapLoadParams const& params,
+    VirtualFileSystem const* fileSystem) {
+    tmx::Map map;
+    if (fileSystem) {
+        auto file = fileSystem->Read(path);
+        OKAMI_UNEXPECTED_RETURN(file);
+        // Tileset images resolve against where the map would be on disk
+        auto workingDir = fileSystem->GetLoosePath(path).parent_path();
+        OKAMI_UNEXPECTED_RETURN_IF(!map.loadFromString(std::string(file->GetString()), workingDir.string()),
+            "Failed to load TMX map: " + path.string());
+    } else {
+        OKAMI_UNEXPECTED_RETURN_IF(!map.load(path.string()),
+            "Failed to load TMX map: " + path.string());
+    }
+    OKAMI_UNEXPECTED_RETURN_IF(map.getOrientation() != tmx::Orientation::Orthogonal,
+        "Only orthogonal TMX maps are supported: " + path.string());
+
+    TileMapDesc desc;
+    desc.m_mapSize  = glm::uvec2(map.getTileCount().x, map.getTileCount().y);
+    desc.m_tileSize = glm::uvec2(map.getTileSize().x, map.getTileSize().y);
+
+    for (auto const& ts : map.getTilesets()) {
+        if (ts.getImagePath().empty()) {
+            LOG(WARNING) << "TileMap: skipping image-collection tileset '" << ts.getName()
+                << "' in " << path;
+            continue;
+        }
+        desc.m_tileSets.push_back(TileSetDef{
+            .m_imagePath = std::filesystem::absolute(ts.getImagePath()),
+            .m_firstGid  = ts.getFirstGID(),
+            .m_tileCount = ts.getTileCount(),
+            .m_columns   = std::max(1u, ts.getColumnCount()),
+            .m_tileSize  = glm::uvec2(ts.getTileSize().x, ts.getTileSize().y),
+            .m_imageSize = glm::uvec2(ts.getImageSize().x, ts.getImageSize().y),
+            .m_spacing   = ts.getSpacing(),
+            .m_margin    = ts.getMargin(),
+        });
+    }
+    std::sort(desc.m_tileSets.begin(), desc.m_tileSets.end(),
+        [](TileSetDef const& a, TileSetDef const& b) { return a.m_firstGid < b.m_firstGid; });
+
+    CollectTileLayers(map.getLayers(), desc.m_mapSize, map.isInfinite(),
+        glm::vec2(0.0f), 1.0f, true, desc.m_layers);
+
+    return TileMap{std::move(desc)};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TileMapComponent
+// ─────────────────────────────────────────────────────────────────────────────
+
+TileMapDesc& TileMapComponent::EditMap() {
+    // Snapshots only ever take references on the main thread, so a map held
+    // by nothing else stays that way while it is edited.
+    if (m_map.use_count() != 1) {
+        m_editedFrom = m_map;
+        m_map = std::make_shared<TileMapDesc>(*m_map);
+    }
+    return const_cast<TileMapDesc&>(*m_map);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SpawnTileMap
+// ─────────────────────────────────────────────────────────────────────────────
+
+entity_t SpawnTileMap(Engine& en, TileMapDesc&& map, Transform const& root, std::string_view name) {
+    TileMapComponent component;
+    component.m_tileSetTextures.reserve(map.m_tileSets.size());
+    for (auto const& ts : map.m_tileSets) {
+        component.m_tileSetTextures.push_back(en.LoadTexture(ts.m_imagePath));
+    }
+    component.m_map = std::make_shared<TileMapDesc>(std::move(map));
+
+    entity_t entity = en.CreateEntity(kNullEntity, name);
+    en.AddComponent(entity, root);
+    en.AddComponent(entity, std::move(component));
+    return entity;
+}
+
+} // namespace okami
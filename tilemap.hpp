@@ -0,0 +1,158 @@
+#pragma once
+
+#include "renderer.hpp"   // Engine, TextureHandle
+#include "transform.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <glm/vec2.hpp>
+
+namespace okami {
+    class VirtualFileSystem;
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Parameters
+    // ─────────────────────────────────────────────────────────────────────────
+
+    struct TileMapLoadParams {
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Map data
+    // ─────────────────────────────────────────────────────────────────────────
+
+    // Tile values use the TMX global tile id encoding: the low bits are the
+    // gid (0 = empty), the top three bits are flip flags.
+    constexpr uint32_t kTileFlipHorizontal = 0x80000000u;
+    constexpr uint32_t kTileFlipVertical   = 0x40000000u;
+    constexpr uint32_t kTileFlipDiagonal   = 0x20000000u;
+    constexpr uint32_t kTileGidMask        = 0x1FFFFFFFu;
+
+    // One image-based tileset referenced by the map.
+    struct TileSetDef {
+        // Absolute path to the tileset image.
+        std::filesystem::path m_imagePath;
+        uint32_t   m_firstGid  = 1;
+        uint32_t   m_tileCount = 0;
+        uint32_t   m_columns   = 1;
+        glm::uvec2 m_tileSize{0};
+        glm::uvec2 m_imageSize{0};
+        uint32_t   m_spacing = 0;
+        uint32_t   m_margin  = 0;
+
+        bool Contains(uint32_t gid) const {
+            return gid >= m_firstGid && gid < m_firstGid + m_tileCount;
+        }
+    };
+
+    // Tile data for one layer. Tiles are grouped into kChunkSize² chunks; every
+    // SetTile() bumps the owning chunk's revision so renderers only rebuild
+    // the chunks that changed.
+    class TileLayerData {
+    public:
+        static constexpr uint32_t kChunkSize = 32;
+
+    private:
+        std::vector<uint32_t> m_tiles;          // row-major, m_size.x * m_size.y
+        std::vector<uint32_t> m_chunkRevisions; // row-major over chunks
+
+    public:
+        std::string m_name;
+        glm::uvec2  m_size{0};     // in tiles
+        glm::ivec2  m_origin{0};   // tile coordinate of m_tiles[0]; non-zero for infinite maps
+        glm::vec2   m_offset{0.0f}; // pixel offset from the TMX layer, y down
+        float       m_opacity = 1.0f;
+        bool        b_visible = true;
+
+        TileLayerData() = default;
+        TileLayerData(std::string name, glm::uvec2 size, glm::ivec2 origin = glm::ivec2(0));
+
+        uint32_t GetTile(uint32_t x, uint32_t y) const {
+            return m_tiles[y * m_size.x + x];
+        }
+        void SetTile(uint32_t x, uint32_t y, uint32_t tile);
+
+        glm::uvec2 GetChunkCount() const {
+            return (m_size + glm::uvec2(kChunkSize - 1)) / kChunkSize;
+        }
+        uint32_t GetChunkRevision(uint32_t chunkX, uint32_t chunkY) const {
+            return m_chunkRevisions[chunkY * GetChunkCount().x + chunkX];
+        }
+    };
+
+    // The complete map. Produced by TileMap::FromFile() and shared between the
+    // spawned TileMapComponent and the renderer.
+    struct TileMapDesc {
+        glm::uvec2                 m_mapSize{0};  // in tiles
+        glm::uvec2                 m_tileSize{0}; // in pixels
+        std::vector<TileSetDef>    m_tileSets;    // sorted by m_firstGid
+        std::vector<TileLayerData> m_layers;      // draw order, bottom first
+
+        // Returns the index of the tileset owning gid, or -1.
+        int FindTileSet(uint32_t gid) const;
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // TileMap resource type (satisfies the ResourceType concept)
+    // ─────────────────────────────────────────────────────────────────────────
+
+    class TileMap {
+    public:
+        using Desc       = TileMapDesc;
+        using LoadParams = TileMapLoadParams;
+
+        TileMapDesc m_data;
+
+        OKAMI_NO_COPY(TileMap);
+        OKAMI_MOVE(TileMap);
+
+        TileMap() = default;
+        explicit TileMap(TileMapDesc data) : m_data(std::move(data)) {}
+
+        // Synchronously load an orthogonal TMX map with tmxlite. Group layers are
+        // flattened; object and image layers are ignored. Tilesets must be
+        // image based (image-collection tilesets are skipped with a warning).
+        // With a file system, the map is read through it (and so may come
+        // from an asset pack); external .tsx tilesets are always read from
+        // disk by tmxlite.
+        static Expected<TileMap> FromFile(
+            std::filesystem::path const& path,
+            TileMapLoadParams     const& params     = {},
+            VirtualFileSystem     const* fileSystem = nullptr);
+    };
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // Component + spawn helper
+    // ─────────────────────────────────────────────────────────────────────────
+
+    // Draws a tile map in the entity's local space: one map pixel is one unit,
+    // x right, y up, with the top-left corner of the map at the origin.
+    //
+    // The map is shared with render snapshots that may still be drawing on
+    // the render thread, so it is read-only here. Modify tiles through
+    // EditMap().m_layers[i].SetTile(), which copies the map first if anything
+    // else holds it; the renderer picks up the change on the next frame and
+    // rebuilds only the chunks whose revision changed.
+    struct TileMapComponent {
+        std::shared_ptr<TileMapDesc const> m_map;
+        std::vector<TextureHandle>         m_tileSetTextures; // parallel to m_map->m_tileSets
+        // The map EditMap() last copied from, so renderers can tell a copy
+        // from a different map. Reset it when assigning another map.
+        std::weak_ptr<TileMapDesc const>   m_editedFrom;
+
+        // Main thread only. m_map must be set, and allocated non-const.
+        TileMapDesc& EditMap();
+    };
+
+    // Creates an entity with a TileMapComponent for the map, loading each
+    // tileset image as a texture.
+    entity_t SpawnTileMap(
+        Engine&          en,
+        TileMapDesc&&    map,
+        Transform const& root = Transform::Identity(),
+        std::string_view name = "TileMap");
+
+} // namespace okami
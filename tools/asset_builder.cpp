@@ -1,6 +1,7 @@
 // asset_builder — graph-based incremental asset processor
 //
 // Usage: asset_builder <input_dir> <output_dir> [--verbose|--quiet|--clean]
+//                      [--pack <file> [--compress]] [--watch]
 //
 // Constructs a ResourceGraph representing every source file, its settings
 // configs, and the output nodes produced by each AssetProcessor.  The graph
@@ -24,13 +25,22 @@
 //  Build   ResourceGraph::Build() propagates staleness and dispatches stale
 //          output nodes to their processor's Process() method.
 //  Cache   SaveCache() persists updated timestamps for the next run.
+//  Pack    With --pack, every file in the output directory (except the graph
+//          cache) is written into one asset pack for shipping.
+//  Watch   With --watch, the builder then keeps running and repeats Build
+//          (and Pack) whenever files under the input directory change.  Edits
+//          to known sources reuse the graph, so only their outputs rebuild;
+//          added or removed files and settings YAML reconstruct it first.
 
 #include "asset_graph.hpp"
 #include "asset_processor.hpp"
 #include "texture_processor.hpp"
 #include "shader_processor.hpp"
 #include "geometry_processor.hpp"
+#include "asset_pack_writer.hpp"
+#include "file_watcher.hpp"
 
+#include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <memory>
@@ -43,67 +53,21 @@
 
 namespace fs = std::filesystem;
 
+// How long the input tree must stay quiet before a watch-mode rebuild starts
+static constexpr std::chrono::milliseconds kWatchSettleTime{100};
+
 // ---------------------------------------------------------------------------
-// main
+// Graph construction
 // ---------------------------------------------------------------------------
 
-int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cerr << "Usage: " << argv[0]
-                  << " <input_dir> <output_dir> [--verbose|--quiet|--clean]\n";
-        return 1;
-    }
-
-    bool quiet   = false;
-    bool verbose = false;
-    bool clean   = false;
-    for (int i = 3; i < argc; ++i) {
-        if      (std::strcmp(argv[i], "--quiet")   == 0) quiet   = true;
-        else if (std::strcmp(argv[i], "--verbose") == 0) verbose = true;
-        else if (std::strcmp(argv[i], "--clean")   == 0) clean   = true;
-        else {
-            std::cerr << "Unknown flag: " << argv[i] << "\n";
-            return 1;
-        }
-    }
-
-    fs::path inputRoot  = fs::absolute(argv[1]);
-    fs::path outputRoot = fs::absolute(argv[2]);
-
-    if (!fs::exists(inputRoot) || !fs::is_directory(inputRoot)) {
-        std::cerr << "Error: input directory does not exist: " << inputRoot << "\n";
-        return 1;
-    }
-
-    if (clean && fs::exists(outputRoot)) {
-        if (!quiet)
-            std::cout << "Cleaning output directory: " << outputRoot << "\n";
-        fs::remove_all(outputRoot);
-    }
-
-    // -----------------------------------------------------------------------
-    // Processor registration
-    // -----------------------------------------------------------------------
-
-    auto texProcOwned  = std::make_unique<TextureProcessor>(/*quiet=*/quiet);
-    auto shaderProc    = std::make_unique<ShaderAssetProcessor>(inputRoot, /*quiet=*/quiet);
-    auto geoProcOwned  = std::make_unique<GeometryProcessor>(/*quiet=*/quiet);
-
-    // Ordered list used for CanProcess dispatch — first match wins.
-    std::vector<AssetProcessor*> processors = {
-        geoProcOwned.get(),   // geometry before texture so it owns .gltf/.glb
-        texProcOwned.get(),
-        shaderProc.get(),
-    };
-
-    // Map: settings-filename → processor (e.g. "texture.yaml" → TextureProcessor)
-    std::unordered_map<std::string, AssetProcessor*> settingsFileMap;
-    for (AssetProcessor* p : processors) {
-        std::string sf = p->SettingsFileName();
-        if (!sf.empty())
-            settingsFileMap[sf] = p;
-    }
-
+// Builds the graph for the current contents of the input tree (passes 1-4),
+// loads cached timestamps, and deletes outputs whose source is gone.
+static std::unique_ptr<ResourceGraph> ConstructGraph(
+    const fs::path&                                         inputRoot,
+    const fs::path&                                         outputRoot,
+    const std::vector<AssetProcessor*>&                     processors,
+    const std::unordered_map<std::string, AssetProcessor*>& settingsFileMap,
+    bool                                                    quiet) {
     // -----------------------------------------------------------------------
     // Collect orphaned output paths from the previous cache BEFORE building
     // the new graph.  Any output path in the old cache that has no matching
@@ -128,7 +92,8 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    ResourceGraph graph(inputRoot, outputRoot);
+    auto result = std::make_unique<ResourceGraph>(inputRoot, outputRoot);
+    ResourceGraph& graph = *result;
 
     for (AssetProcessor* p : processors)
         graph.RegisterProcessor(p);
@@ -316,10 +281,15 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    // -----------------------------------------------------------------------
-    // Build and persist
-    // -----------------------------------------------------------------------
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Build, persist and pack
+// ---------------------------------------------------------------------------
 
+// Rebuilds stale nodes and saves the cache.  Returns the process exit code.
+static int BuildGraph(ResourceGraph& graph, bool verbose) {
     int exitCode = 0;
     try {
         graph.Build(verbose);
@@ -334,7 +304,166 @@ int main(int argc, char* argv[]) {
     } catch (const std::exception& e) {
         std::cerr << "Warning: could not save asset graph cache: " << e.what() << "\n";
     }
-
     return exitCode;
 }
 
+// Writes every file in the output directory (except the graph cache) into
+// one asset pack.  Returns the process exit code.
+static int WritePack(const fs::path& outputRoot, const fs::path& packPath, bool compress, bool quiet) {
+    try {
+        AssetPackWriter writer;
+        writer.AddDirectory(outputRoot, { fs::path(ResourceGraph::kCacheFileName) });
+
+        AssetPackWriter::Options options;
+        options.compress = compress;
+        auto stats = writer.Write(packPath, options);
+        if (!quiet)
+            std::cout << "  pack " << packPath.filename().string() << ": "
+                      << stats.entryCount << " assets ("
+                      << stats.compressedCount << " compressed), "
+                      << stats.rawBytes << " -> " << stats.packBytes << " bytes\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Pack error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Watch mode
+// ---------------------------------------------------------------------------
+
+// Edits to files the graph already knows about only make nodes stale, so
+// Build() on the existing graph rebuilds just the affected outputs.  New or
+// deleted files, and settings YAML (whose contents are baked into config
+// nodes when the graph is constructed), need the graph constructed again.
+static bool NeedsNewGraph(const ResourceGraph& graph, const std::vector<okami::FileChange>& changes) {
+    for (const auto& change : changes) {
+        if (change.m_type != okami::FileChangeType::Modified) return true;
+        if (change.m_path.extension() == ".yaml") return true;
+        if (graph.FindByInput(change.m_path) == kInvalidNode) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <input_dir> <output_dir> [--verbose|--quiet|--clean]"
+                  << " [--pack <file> [--compress]] [--watch]\n";
+        return 1;
+    }
+
+    bool quiet    = false;
+    bool verbose  = false;
+    bool clean    = false;
+    bool compress = false;
+    bool watch    = false;
+    fs::path packPath;
+    for (int i = 3; i < argc; ++i) {
+        if      (std::strcmp(argv[i], "--quiet")    == 0) quiet    = true;
+        else if (std::strcmp(argv[i], "--verbose")  == 0) verbose  = true;
+        else if (std::strcmp(argv[i], "--clean")    == 0) clean    = true;
+        else if (std::strcmp(argv[i], "--compress") == 0) compress = true;
+        else if (std::strcmp(argv[i], "--watch")    == 0) watch    = true;
+        else if (std::strcmp(argv[i], "--pack")     == 0 && i + 1 < argc) {
+            packPath = fs::absolute(argv[++i]);
+        }
+        else {
+            std::cerr << "Unknown flag: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    if (compress && packPath.empty()) {
+        std::cerr << "Error: --compress requires --pack\n";
+        return 1;
+    }
+
+    fs::path inputRoot  = fs::absolute(argv[1]);
+    fs::path outputRoot = fs::absolute(argv[2]);
+
+    if (!fs::exists(inputRoot) || !fs::is_directory(inputRoot)) {
+        std::cerr << "Error: input directory does not exist: " << inputRoot << "\n";
+        return 1;
+    }
+
+    if (clean && fs::exists(outputRoot)) {
+        if (!quiet)
+            std::cout << "Cleaning output directory: " << outputRoot << "\n";
+        fs::remove_all(outputRoot);
+    }
+
+    // -----------------------------------------------------------------------
+    // Processor registration
+    // -----------------------------------------------------------------------
+
+    auto texProcOwned  = std::make_unique<TextureProcessor>(/*quiet=*/quiet);
+    auto shaderProc    = std::make_unique<ShaderAssetProcessor>(inputRoot, /*quiet=*/quiet);
+    auto geoProcOwned  = std::make_unique<GeometryProcessor>(/*quiet=*/quiet);
+
+    // Ordered list used for CanProcess dispatch — first match wins.
+    std::vector<AssetProcessor*> processors = {
+        geoProcOwned.get(),   // geometry before texture so it owns .gltf/.glb
+        texProcOwned.get(),
+        shaderProc.get(),
+    };
+
+    // Map: settings-filename → processor (e.g. "texture.yaml" → TextureProcessor)
+    std::unordered_map<std::string, AssetProcessor*> settingsFileMap;
+    for (AssetProcessor* p : processors) {
+        std::string sf = p->SettingsFileName();
+        if (!sf.empty())
+            settingsFileMap[sf] = p;
+    }
+
+    auto graph = ConstructGraph(inputRoot, outputRoot, processors, settingsFileMap, quiet);
+
+    int exitCode = BuildGraph(*graph, verbose);
+    if (!packPath.empty() && exitCode == 0)
+        exitCode = WritePack(outputRoot, packPath, compress, quiet);
+
+    if (!watch)
+        return exitCode;
+
+    // -----------------------------------------------------------------------
+    // Watch mode: rebuild whatever the changed sources feed into
+    // -----------------------------------------------------------------------
+
+    okami::FileWatcher watcher(inputRoot);
+    if (!watcher.IsWatching()) {
+        std::cerr << "Error: cannot watch input directory: " << inputRoot << "\n";
+        return 1;
+    }
+    if (!quiet)
+        std::cout << "Watching " << inputRoot << " for changes\n";
+
+    while (true) {
+        auto changes = watcher.Wait(std::chrono::seconds(1));
+        if (changes.empty()) continue;
+
+        // Editors and exporters often write several files, or one file in
+        // several steps; wait for them to settle before building
+        for (auto more = watcher.Wait(kWatchSettleTime); !more.empty();
+             more = watcher.Wait(kWatchSettleTime))
+            changes.insert(changes.end(), more.begin(), more.end());
+
+        if (!quiet)
+            std::cout << changes.size() << " changed file(s), rebuilding\n";
+
+        try {
+            if (NeedsNewGraph(*graph, changes))
+                graph = ConstructGraph(inputRoot, outputRoot, processors, settingsFileMap, quiet);
+        } catch (const std::exception& e) {
+            std::cerr << "Build error: " << e.what() << "\n";
+            continue;
+        }
+
+        if (BuildGraph(*graph, verbose) == 0 && !packPath.empty())
+            WritePack(outputRoot, packPath, compress, quiet);
+    }
+}
@@ -0,0 +1,215 @@
+#include "asset_pack_writer.hpp"
+#include "asset_pack_format.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef OKAMI_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+using namespace okami;
+
+namespace {
+
+std::vector<std::uint8_t> ReadWholeFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("cannot open '" + path.string() + "' for reading");
+
+    std::vector<std::uint8_t> bytes(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size())))
+        throw std::runtime_error("failed to read '" + path.string() + "'");
+    return bytes;
+}
+
+std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+void WritePod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+void AssetPackWriter::AddFile(const fs::path& assetPath, const fs::path& sourceFile) {
+    m_inputs.push_back(Input{ GetAssetPackKey(assetPath), sourceFile, {} });
+}
+
+void AssetPackWriter::AddData(const fs::path& assetPath, std::vector<std::uint8_t> data) {
+    m_inputs.push_back(Input{ GetAssetPackKey(assetPath), {}, std::move(data) });
+}
+
+void AssetPackWriter::AddDirectory(const fs::path& root, const std::vector<fs::path>& exclude) {
+    std::vector<std::string> excluded;
+    for (const auto& path : exclude)
+        excluded.push_back(GetAssetPackKey(path));
+
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        if (entry.path().extension() == kAssetPackExtension) continue;  // packs never nest
+
+        std::string key = GetAssetPackKey(fs::relative(entry.path(), root));
+        if (std::find(excluded.begin(), excluded.end(), key) != excluded.end()) continue;
+
+        m_inputs.push_back(Input{ std::move(key), entry.path(), {} });
+    }
+}
+
+bool AssetPackWriter::SupportsCompression() {
+#ifdef OKAMI_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+AssetPackWriter::Stats AssetPackWriter::Write(const fs::path& packPath, const Options& options) const {
+    if (options.compress && !SupportsCompression())
+        throw std::runtime_error("asset pack compression requested, but AssetBuilder was built without zstd");
+
+    const std::uint32_t alignment = options.alignment ? options.alignment : kAssetPackDefaultAlignment;
+    if ((alignment & (alignment - 1)) != 0)
+        throw std::runtime_error("asset pack alignment must be a power of two");
+
+    // Last addition of each key wins.  Blobs are laid out in path order so
+    // assets from the same directory end up next to each other on disk.
+    std::unordered_map<std::string, const Input*> byKey;
+    for (const auto& input : m_inputs)
+        byKey[input.key] = &input;
+
+    std::vector<const Input*> inputs;
+    inputs.reserve(byKey.size());
+    for (const auto& kv : byKey)
+        inputs.push_back(kv.second);
+    std::sort(inputs.begin(), inputs.end(),
+              [](const Input* a, const Input* b) { return a->key < b->key; });
+
+    if (inputs.size() > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("too many assets for one pack");
+
+    std::vector<AssetPackEntry> entries(inputs.size());
+    std::string names;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (names.size() + inputs[i]->key.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::runtime_error("asset paths too long for one pack");
+
+        AssetPackEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.m_pathHash   = HashAssetPackKey(inputs[i]->key);
+        entry.m_nameOffset = static_cast<std::uint32_t>(names.size());
+        entry.m_nameSize   = static_cast<std::uint32_t>(inputs[i]->key.size());
+        names += inputs[i]->key;
+    }
+
+    AssetPackHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, kAssetPackMagic, sizeof(kAssetPackMagic));
+    header.m_version     = kAssetPackVersion;
+    header.m_entryCount  = static_cast<std::uint32_t>(entries.size());
+    header.m_alignment   = alignment;
+    header.m_tocOffset   = sizeof(AssetPackHeader);
+    header.m_namesOffset = header.m_tocOffset + entries.size() * sizeof(AssetPackEntry);
+    header.m_namesSize   = names.size();
+
+    // Written beside the destination and renamed over it, so a running
+    // engine that has the old pack mapped never sees a half-written file.
+    fs::path tmpPath = packPath;
+    tmpPath += ".tmp";
+    if (packPath.has_parent_path())
+        fs::create_directories(packPath.parent_path());
+
+    Stats stats;
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("cannot open '" + tmpPath.string() + "' for writing");
+
+        // The table of contents is rewritten once blob offsets are known
+        WritePod(out, header);
+        for (const auto& entry : entries)
+            WritePod(out, entry);
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+        std::uint64_t offset = header.m_namesOffset + header.m_namesSize;
+        const char zeros[256] = {};
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            const Input& input = *inputs[i];
+            std::vector<std::uint8_t> fileData;
+            const std::vector<std::uint8_t>* data = &input.data;
+            if (!input.sourceFile.empty()) {
+                fileData = ReadWholeFile(input.sourceFile);
+                data = &fileData;
+            }
+
+            AssetPackEntry& entry = entries[i];
+            entry.m_uncompressedSize = data->size();
+            stats.rawBytes += data->size();
+
+#ifdef OKAMI_ZSTD
+            std::vector<std::uint8_t> compressed;
+            if (options.compress && !data->empty()) {
+                compressed.resize(ZSTD_compressBound(data->size()));
+                std::size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                                                 data->data(), data->size(),
+                                                 options.compressionLevel);
+                if (ZSTD_isError(size))
+                    throw std::runtime_error("zstd: failed to compress '" + input.key +
+                                             "': " + ZSTD_getErrorName(size));
+                if (size < data->size()) {
+                    compressed.resize(size);
+                    data = &compressed;
+                    entry.m_flags |= kAssetPackEntryCompressed;
+                    ++stats.compressedCount;
+                }
+            }
+#endif
+
+            std::uint64_t aligned = AlignUp(offset, alignment);
+            for (std::uint64_t pad = aligned - offset; pad > 0;) {
+                std::uint64_t n = std::min<std::uint64_t>(pad, sizeof(zeros));
+                out.write(zeros, static_cast<std::streamsize>(n));
+                pad -= n;
+            }
+
+            entry.m_offset = aligned;
+            entry.m_size   = data->size();
+            out.write(reinterpret_cast<const char*>(data->data()),
+                      static_cast<std::streamsize>(data->size()));
+            offset = aligned + data->size();
+        }
+        stats.packBytes = offset;
+
+        // Sorted by hash for lookup; names break ties so the order is stable
+        std::vector<AssetPackEntry> toc = entries;
+        std::sort(toc.begin(), toc.end(),
+                  [&names](const AssetPackEntry& a, const AssetPackEntry& b) {
+                      if (a.m_pathHash != b.m_pathHash) return a.m_pathHash < b.m_pathHash;
+                      return names.compare(a.m_nameOffset, a.m_nameSize,
+                                           names, b.m_nameOffset, b.m_nameSize) < 0;
+                  });
+
+        out.seekp(static_cast<std::streamoff>(header.m_tocOffset));
+        for (const auto& entry : toc)
+            WritePod(out, entry);
+
+        out.flush();
+        if (!out)
+            throw std::runtime_error("failed to write '" + tmpPath.string() + "'");
+    }
+
+    fs::rename(tmpPath, packPath);
+
+    stats.entryCount = entries.size();
+    return stats;
+}
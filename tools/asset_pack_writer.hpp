@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Writes an asset pack (.okpak) — see asset_pack_format.hpp for the layout.
+//
+// Assets are added under the path the engine will ask for them by, relative
+// to the asset root.  The table of contents is sorted by path hash so the
+// runtime can binary search it straight out of the mapped file, and each
+// blob is padded to the pack alignment so it can be used in place.
+//
+// With compression on (and AssetBuilder built with zstd), each blob is stored
+// as a zstd frame unless that doesn't make it smaller.
+class AssetPackWriter {
+public:
+    struct Options {
+        bool     compress         = false;
+        int      compressionLevel = 19;
+        uint32_t alignment        = 0;  // 0 = kAssetPackDefaultAlignment
+    };
+
+    struct Stats {
+        std::size_t   entryCount      = 0;
+        std::size_t   compressedCount = 0;
+        std::uint64_t rawBytes        = 0;  // sum of asset sizes
+        std::uint64_t packBytes       = 0;  // size of the pack file
+    };
+
+    // Adds a file from disk; read when the pack is written.
+    void AddFile(const std::filesystem::path& assetPath,
+                 const std::filesystem::path& sourceFile);
+
+    // Adds an asset from memory.
+    void AddData(const std::filesystem::path& assetPath,
+                 std::vector<std::uint8_t>    data);
+
+    // Adds every regular file under 'root', keyed by its path relative to it.
+    // Files whose relative path is in 'exclude', and other packs, are skipped.
+    void AddDirectory(const std::filesystem::path&              root,
+                      const std::vector<std::filesystem::path>& exclude = {});
+
+    std::size_t Size() const { return m_inputs.size(); }
+
+    // Writes the pack, replacing 'packPath'.  Later additions of the same
+    // asset path replace earlier ones.
+    // Throws std::runtime_error on failure.
+    Stats Write(const std::filesystem::path& packPath, const Options& options) const;
+
+    // True if this build can compress blobs.
+    static bool SupportsCompression();
+
+private:
+    struct Input {
+        std::string               key;
+        std::filesystem::path     sourceFile;  // empty if the data is in memory
+        std::vector<std::uint8_t> data;
+    };
+
+    std::vector<Input> m_inputs;
+};
@@ -0,0 +1,141 @@
+#include "vfs.hpp"
+#include "paths.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+using namespace okami;
+
+Expected<std::vector<uint8_t>> okami::ReadFileBytes(std::filesystem::path const& path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	OKAMI_UNEXPECTED_RETURN_IF(!file, "File does not exist: " + path.string());
+
+	std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	OKAMI_UNEXPECTED_RETURN_IF(!file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()),
+		"Failed to read file: " + path.string());
+	return bytes;
+}
+
+okami::FileData::FileData(std::vector<uint8_t> bytes) :
+	m_bytes(std::move(bytes)), m_view(m_bytes) {
+}
+
+okami::FileData::FileData(std::span<uint8_t const> view, std::shared_ptr<void const> owner) :
+	m_owner(std::move(owner)), m_view(view) {
+}
+
+okami::VirtualFileSystem::VirtualFileSystem() : VirtualFileSystem(GetAssetsPath()) {
+}
+
+okami::VirtualFileSystem::VirtualFileSystem(std::filesystem::path root) :
+	m_root(std::move(root)) {
+}
+
+Error okami::VirtualFileSystem::Mount(std::filesystem::path const& packPath) {
+	auto pack = AssetPack::Open(packPath);
+	OKAMI_ERROR_RETURN(pack);
+
+	std::unique_lock lock(m_mutex);
+	m_packs.push_back(std::move(*pack));
+	return {};
+}
+
+Error okami::VirtualFileSystem::MountAll(std::filesystem::path const& directory) {
+	std::error_code ec;
+	if (!std::filesystem::is_directory(directory, ec)) {
+		return {};
+	}
+
+	std::vector<std::filesystem::path> packs;
+	for (auto const& entry : std::filesystem::directory_iterator(directory, ec)) {
+		if (entry.is_regular_file() && entry.path().extension() == kAssetPackExtension) {
+			packs.push_back(entry.path());
+		}
+	}
+	std::sort(packs.begin(), packs.end());
+
+	Error e;
+	for (auto const& pack : packs) {
+		e += Mount(pack);
+	}
+	return e;
+}
+
+void okami::VirtualFileSystem::UnmountAll() {
+	std::unique_lock lock(m_mutex);
+	m_packs.clear();
+}
+
+size_t okami::VirtualFileSystem::GetMountCount() const {
+	std::shared_lock lock(m_mutex);
+	return m_packs.size();
+}
+
+std::string okami::VirtualFileSystem::GetAssetKey(std::filesystem::path const& path) const {
+	if (path.is_relative()) {
+		return GetAssetPackKey(path);
+	}
+	if (m_root.empty()) {
+		return {};
+	}
+	auto relative = path.lexically_normal().lexically_relative(m_root.lexically_normal());
+	if (relative.empty() || *relative.begin() == "..") {
+		return {};
+	}
+	return GetAssetPackKey(relative);
+}
+
+AssetPackEntry const* okami::VirtualFileSystem::FindInPacks(std::string_view key, size_t* packIndex) const {
+	if (key.empty()) {
+		return nullptr;
+	}
+	for (size_t i = m_packs.size(); i-- > 0;) {
+		if (auto const* entry = m_packs[i]->FindKey(key)) {
+			if (packIndex) {
+				*packIndex = i;
+			}
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+std::filesystem::path okami::VirtualFileSystem::GetLoosePath(std::filesystem::path const& path) const {
+	return path.is_absolute() ? path : m_root / path;
+}
+
+Expected<FileData> okami::VirtualFileSystem::Read(std::filesystem::path const& path) const {
+	auto key = GetAssetKey(path);
+	{
+		std::shared_lock lock(m_mutex);
+		size_t packIndex = 0;
+		if (auto const* entry = FindInPacks(key, &packIndex)) {
+			auto const& pack = m_packs[packIndex];
+			if (entry->m_flags & kAssetPackEntryCompressed) {
+				auto bytes = pack->Decompress(*entry);
+				OKAMI_UNEXPECTED_RETURN(bytes);
+				return FileData(std::move(*bytes));
+			}
+			// The data holds the pack so the view outlives an unmount
+			return FileData(pack->GetStoredData(*entry), pack);
+		}
+	}
+
+	auto bytes = ReadFileBytes(GetLoosePath(path));
+	OKAMI_UNEXPECTED_RETURN(bytes);
+	return FileData(std::move(*bytes));
+}
+
+bool okami::VirtualFileSystem::Exists(std::filesystem::path const& path) const {
+	auto key = GetAssetKey(path);
+	{
+		std::shared_lock lock(m_mutex);
+		if (FindInPacks(key)) {
+			return true;
+		}
+	}
+	std::error_code ec;
+	return std::filesystem::is_regular_file(GetLoosePath(path), ec);
+}
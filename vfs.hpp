@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common.hpp"
+#include "asset_pack.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace okami {
+	// The contents of a file read through the VirtualFileSystem. Either a
+	// view into a mapped asset pack, which the data keeps mapped, or bytes of
+	// its own.
+	class FileData {
+	public:
+		FileData() = default;
+		explicit FileData(std::vector<uint8_t> bytes);
+		FileData(std::span<uint8_t const> view, std::shared_ptr<void const> owner);
+		OKAMI_NO_COPY(FileData);
+		OKAMI_MOVE(FileData);
+
+		inline std::span<uint8_t const> GetBytes() const { return m_view; }
+		inline std::string_view GetString() const {
+			return { reinterpret_cast<char const*>(m_view.data()), m_view.size() };
+		}
+		inline size_t GetSize() const { return m_view.size(); }
+		// True if the bytes point into a mapped pack rather than a copy
+		inline bool IsMapped() const { return m_owner != nullptr; }
+
+	private:
+		std::vector<uint8_t> m_bytes;
+		std::shared_ptr<void const> m_owner;
+		std::span<uint8_t const> m_view;
+	};
+
+	// Reads a whole file from disk, bypassing any mounted packs
+	Expected<std::vector<uint8_t>> ReadFileBytes(std::filesystem::path const& path);
+
+	// Resolves asset paths against mounted asset packs, then against loose
+	// files under the asset root, so loaders don't care where an asset lives.
+	// Packs mounted later take precedence over earlier ones. Paths may be
+	// relative to the asset root, or absolute paths inside it; anything else
+	// is only ever read as a loose file.
+	//
+	// Thread safe; loaders on IO threads read while packs are mounted.
+	class VirtualFileSystem {
+	public:
+		VirtualFileSystem();
+		explicit VirtualFileSystem(std::filesystem::path root);
+
+		Error Mount(std::filesystem::path const& packPath);
+		// Mounts every pack in the directory, in name order
+		Error MountAll(std::filesystem::path const& directory);
+		void UnmountAll();
+		size_t GetMountCount() const;
+
+		Expected<FileData> Read(std::filesystem::path const& path) const;
+		bool Exists(std::filesystem::path const& path) const;
+		// Where the asset would be as a loose file
+		std::filesystem::path GetLoosePath(std::filesystem::path const& path) const;
+
+		// The pack key for a path, or empty if packs can't hold it. Two
+		// paths name the same asset when their keys match.
+		std::string GetAssetKey(std::filesystem::path const& path) const;
+
+		inline std::filesystem::path const& GetRoot() const { return m_root; }
+
+	private:
+		// Latest mounted pack holding the key first; caller holds the lock
+		AssetPackEntry const* FindInPacks(std::string_view key, size_t* packIndex = nullptr) const;
+
+		std::filesystem::path m_root;
+		mutable std::shared_mutex m_mutex;
+		std::vector<std::shared_ptr<AssetPack>> m_packs;
+	};
+}